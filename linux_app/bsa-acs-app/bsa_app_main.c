@@ -21,6 +21,7 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/resource.h>
 #include "include/bsa_app.h"
 #include <getopt.h>
 
@@ -29,6 +30,10 @@ unsigned int  g_sw_view[3] = {1, 1, 1}; //Operating System, Hypervisor, Platform
 int  g_skip_test_num[3] = {10000, 10000, 10000};
 unsigned long int  g_exception_ret_addr;
 
+/* Include and exclude ranges from --tests and --skip, in command line order */
+static drv_test_range_t *g_test_range;
+static unsigned int      g_num_test_range;
+
 int
 initialize_test_environment(unsigned int print_level)
 {
@@ -43,8 +48,84 @@ cleanup_test_environment()
     call_drv_clean_test_env();
 }
 
+/* CPU time this process has used so far, in milliseconds */
+static unsigned long
+app_cpu_time_ms(void)
+{
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+}
+
+/**
+  Parse a comma separated list of test numbers and ranges, e.g. "801,805-810",
+  appending each entry to the selection.
+**/
+static int
+app_parse_test_list(char *list, int exclude)
+{
+    drv_test_range_t *range;
+    unsigned long start, end;
+    char *pt, *endptr;
+
+    for (pt = strtok(list, ","); pt != NULL; pt = strtok(NULL, ",")) {
+        start = strtoul(pt, &endptr, 10);
+        end = start;
+        if ((endptr != pt) && (*endptr == '-'))
+            end = strtoul(endptr + 1, &endptr, 10);
+        if ((endptr == pt) || *endptr || (end < start)) {
+            fprintf(stderr, "Invalid test number or range `%s'.\n", pt);
+            return 1;
+        }
+
+        range = realloc(g_test_range, (g_num_test_range + 1) * sizeof(*range));
+        if (range == NULL) {
+            fprintf(stderr, "Out of memory for the test selection.\n");
+            return 1;
+        }
+        g_test_range = range;
+        g_test_range[g_num_test_range].start = start;
+        g_test_range[g_num_test_range].end = end;
+        g_test_range[g_num_test_range].exclude = exclude;
+        g_num_test_range++;
+    }
+
+    return 0;
+}
+
+/**
+  Hand the test selection to the driver. A driver without selection support only
+  has the three entry skip list, which is enough for a few single exclusions.
+**/
+static int
+app_select_tests(int timing)
+{
+    unsigned int i, num_skip = 0;
+
+    if (call_drv_capabilities() & DRV_CAP_TEST_SELECT)
+        return call_drv_select_tests(g_test_range, g_num_test_range, timing);
+
+    for (i = 0; i < g_num_test_range; i++) {
+        if (!g_test_range[i].exclude || (g_test_range[i].start != g_test_range[i].end) ||
+            (num_skip == sizeof(g_skip_test_num) / sizeof(g_skip_test_num[0])))
+            break;
+        g_skip_test_num[num_skip++] = g_test_range[i].start;
+    }
+
+    if ((i < g_num_test_range) || timing) {
+        printf("BSA kernel module only supports skipping up to %u single tests \n",
+               (unsigned int)(sizeof(g_skip_test_num) / sizeof(g_skip_test_num[0])));
+        return 1;
+    }
+    return 0;
+}
+
 void print_help(){
-  printf ("\nUsage: Bsa [-v <n>] | [--skip <n>]\n"
+  printf ("\nUsage: Bsa [-v <n>] | [--skip <n>] | [--tests <n>]\n"
          "Options:\n"
          "-v      Verbosity of the Prints\n"
          "        1 shows all prints, 5 shows Errors\n"
@@ -52,9 +133,21 @@ void print_help(){
          "        Refer to section 4 of BSA_ACS_User_Guide\n"
          "        To skip a module, use Model_ID as mentioned in user guide\n"
          "        To skip a particular test within a module, use the exact testcase number\n"
+         "        Ranges such as 801-810 are accepted, and the list has no length limit\n"
+         "--tests Test(s) to be run, in the same format as --skip. Others are not run\n"
+         "--time  Report the wall time of each test\n"
+         "--keep-tables\n"
+         "        Leave the info tables in the driver for the next run to reuse\n"
+         "--json <file>   Write the test results as JSON, updated as each test completes\n"
+         "--junit <file>  Write the test results as JUnit XML, updated as each test completes\n"
          "-os     Enable the execution of operating system tests\n"
          "-hyp    Enable the execution of hypervisor tests\n"
          "-ps     Enable the execution of platform security tests\n"
+         "--timestamp  Prefix driver messages with the time they were logged\n"
+         "--msg-bench <n>\n"
+         "        Measure the driver message ring with n synthetic messages and exit\n"
+         "Exit status is 0 when no test failed, 1 if the tests could not be run\n"
+         "and 2 if any test failed\n"
   );
 }
 
@@ -62,11 +155,14 @@ int
 main (int argc, char **argv)
 {
 
-    int   c = 0,i=0;
-    char *endptr, *pt;
+    int   c = 0;
+    char *endptr;
     int   status;
     int   run_exerciser = 0;
     int   sw_view = 0;
+    int   test_timing = 0;
+    char *json_path = NULL;
+    char *junit_path = NULL;
 
     struct option long_opt[] =
     {
@@ -75,6 +171,13 @@ main (int argc, char **argv)
       {"os", no_argument, NULL, 'o'},
       {"hyp", no_argument, NULL, 'q'},
       {"ps", no_argument, NULL, 'p'},
+      {"timestamp", no_argument, NULL, 't'},
+      {"msg-bench", required_argument, NULL, 'b'},
+      {"tests", required_argument, NULL, 's'},
+      {"time", no_argument, NULL, 'w'},
+      {"keep-tables", no_argument, NULL, 'k'},
+      {"json", required_argument, NULL, 'j'},
+      {"junit", required_argument, NULL, 'u'},
       {NULL, 0, NULL, 0}
     };
 
@@ -91,12 +194,24 @@ main (int argc, char **argv)
          return 1;
          break;
        case 'n':/*SKIP tests */
-         pt = strtok(optarg, ",");
-         while((pt!=NULL) && (i<3)){
-           int a = atoi(pt);
-           g_skip_test_num[i++] = a;
-           pt = strtok(NULL, ",");
-         }
+         if (app_parse_test_list(optarg, 1))
+           return 1;
+         break;
+       case 's':
+         if (app_parse_test_list(optarg, 0))
+           return 1;
+         break;
+       case 'w':
+         test_timing = 1;
+         break;
+       case 'k':
+         call_drv_keep_tables(1);
+         break;
+       case 'j':
+         json_path = optarg;
+         break;
+       case 'u':
+         junit_path = optarg;
          break;
        case 'o':
          sw_view = sw_view | (1 << G_SW_OS);
@@ -110,6 +225,11 @@ main (int argc, char **argv)
        case 'e':
          run_exerciser = 1;
          break;
+       case 't':
+         call_drv_msg_timestamp(1);
+         break;
+       case 'b':
+         return run_msg_ring_bench(strtoul(optarg, &endptr, 10));
        case '?':
          if (isprint (optopt))
            fprintf (stderr, "Unknown option `-%c'.\n", optopt);
@@ -136,11 +256,22 @@ main (int argc, char **argv)
 
     printf ("\n Starting tests (Print level is %2d)\n\n", g_print_level);
 
+    if (results_open(json_path, junit_path, g_print_level))
+        return 1;
+
     printf (" Gathering system information.... \n");
     status = initialize_test_environment(g_print_level);
     if (status) {
         printf ("Cannot initialize test environment. Exiting.... \n");
-        return 0;
+        results_close();
+        return 1;
+    }
+
+    if ((g_num_test_range || test_timing) && app_select_tests(test_timing)) {
+        cleanup_test_environment();
+        call_drv_close();
+        results_close();
+        return 1;
     }
 
     printf("\n      *** Starting Peripherals tests ***  \n");
@@ -161,5 +292,15 @@ main (int argc, char **argv)
 
     cleanup_test_environment();
 
-    return 0;
+    if (call_drv_msg_dropped())
+        printf(" Driver messages dropped : %u \n", call_drv_msg_dropped());
+
+    call_drv_close();
+    free(g_test_range);
+    results_close();
+
+    /* Time spent by the app itself, e.g. waiting on the driver, perturbs the tests */
+    printf(" App CPU time : %lu ms \n", app_cpu_time_ms());
+
+    return results_failed() ? 2 : 0;
 }
@@ -0,0 +1,118 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <stdint.h>
+#include "include/bsa_app.h"
+#include "val/include/bsa_acs_msg_ring.h"
+
+static uint64_t
+bench_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Synthetic producer standing in for the kernel module: messages of varying
+   length, each carrying its sequence number as data */
+static void
+bench_produce(bsa_msg_ring_t *ring, unsigned long num_msgs)
+{
+  char msg[BSA_MSG_MAX_LEN];
+  unsigned long seq;
+  int len;
+
+  for (seq = 0; seq < num_msgs; seq++) {
+    len = snprintf(msg, sizeof(msg), "\n       Synthetic message %lu %.*s", seq,
+                   (int)(seq % 200), "................................................"
+                   "........................................................................"
+                   "................................................................................");
+    /* The module drops when full; the bench waits so every record is counted */
+    while (bsa_msg_ring_put(ring, 3, bench_now_ns(), msg, len, seq))
+      sched_yield();
+  }
+}
+
+/**
+  Flood a message ring from a forked producer and consume it here, checking
+  that records arrive complete and in order. Needs no driver.
+**/
+int
+run_msg_ring_bench(unsigned long num_msgs)
+{
+  bsa_msg_ring_t *ring;
+  uint64_t rec_buf[(sizeof(bsa_msg_rec_t) + BSA_MSG_MAX_LEN) / sizeof(uint64_t) + 1];
+  bsa_msg_rec_t *rec;
+  unsigned long received = 0, errors = 0;
+  unsigned long long bytes = 0;
+  uint64_t start, elapsed;
+  pid_t pid;
+
+  ring = mmap(NULL, BSA_MSG_RING_MAP_SIZE, PROT_READ | PROT_WRITE,
+              MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (ring == MAP_FAILED) {
+    printf("mmap failed \n");
+    return 1;
+  }
+  bsa_msg_ring_init(ring, BSA_MSG_RING_DATA_SIZE);
+
+  start = bench_now_ns();
+  pid = fork();
+  if (pid < 0) {
+    printf("fork failed \n");
+    munmap(ring, BSA_MSG_RING_MAP_SIZE);
+    return 1;
+  }
+  if (pid == 0) {
+    bench_produce(ring, num_msgs);
+    _exit(0);
+  }
+
+  while (received < num_msgs) {
+    rec = bsa_msg_ring_get(ring, rec_buf, sizeof(rec_buf));
+    if (rec == NULL) {
+      sched_yield();
+      continue;
+    }
+    if (rec->data != received)
+      errors++;
+    bytes += rec->len;
+    received++;
+  }
+  elapsed = bench_now_ns() - start;
+  waitpid(pid, NULL, 0);
+
+  printf("\n Message ring: %lu records, %llu bytes in %lu us \n", received, bytes,
+         (unsigned long)(elapsed / 1000));
+  printf(" Message ring: %lu records/s, %lu MB/s, %lu out of order \n",
+         (unsigned long)(received * 1000000000ULL / (elapsed ? elapsed : 1)),
+         (unsigned long)(bytes * 1000ULL / (elapsed ? elapsed : 1)), errors);
+
+  munmap(ring, BSA_MSG_RING_MAP_SIZE);
+  return errors ? 1 : 0;
+}
@@ -38,10 +38,8 @@ execute_tests_pcie(int num_pe, unsigned int print_level)
 {
 
     int status;
-    call_update_sw_view(BSA_UPDATE_SW_VIEW, g_sw_view);
-    call_update_skip_list(BSA_UPDATE_SKIP_LIST, g_skip_test_num);
-    call_drv_execute_test(BSA_PCIE_EXECUTE_TEST, num_pe, print_level, 0);
-    status  = call_drv_wait_for_completion();
+    status = call_drv_run_tests(BSA_PCIE_EXECUTE_TEST, num_pe, print_level,
+                                (int *)g_sw_view, g_skip_test_num);
     return status;
 }
 
@@ -50,9 +48,7 @@ execute_tests_exerciser(int num_pe, unsigned int print_level)
 {
 
     int status;
-    call_update_sw_view(BSA_UPDATE_SW_VIEW, g_sw_view);
-    call_update_skip_list(BSA_UPDATE_SKIP_LIST, g_skip_test_num);
-    call_drv_execute_test(BSA_EXERCISER_EXECUTE_TEST, num_pe, print_level, 0);
-    status  = call_drv_wait_for_completion();
+    status = call_drv_run_tests(BSA_EXERCISER_EXECUTE_TEST, num_pe, print_level,
+                                (int *)g_sw_view, g_skip_test_num);
     return status;
 }
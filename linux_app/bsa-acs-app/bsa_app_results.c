@@ -0,0 +1,371 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <stdint.h>
+#include "include/bsa_app.h"
+#include "val/include/bsa_acs_common.h"
+
+/*
+ * Test results are recovered from the driver messages: val_initialize_test prints
+ * the test number with the number as data, then the description, and
+ * val_report_status prints the result with the status word as data.
+ *
+ * Each result file is kept a complete document at all times: the closing text is
+ * rewritten after every test, so a hang or a crash loses only the running test.
+ */
+
+#define RES_CAPTURE_LEVEL   3           /* ACS_PRINT_TEST, descriptions and results */
+#define RES_DESC_LEN        128
+#define RES_MSG_LEN         8192        /* messages kept per test */
+
+#define RES_JSON_CLOSE      "\n]}\n"
+#define RES_JUNIT_CLOSE     "</testsuite>\n</testsuites>\n"
+#define RES_JUNIT_SUITE_LEN 128         /* testsuite tag, padded so it is rewritten in place */
+
+typedef struct {
+    FILE            *fp;
+    long            close_pos;          /* where the closing text starts */
+} res_file_t;
+
+static struct {
+    res_file_t      json;
+    res_file_t      junit;
+    long            junit_suite_pos;    /* where the testsuite tag starts */
+    int             active;             /* a test started and has no result yet */
+    int             want_desc;
+    unsigned int    test_num;
+    char            desc[RES_DESC_LEN];
+    char            msg[RES_MSG_LEN];
+    unsigned int    msg_len;
+    uint64_t        start_ns;
+    unsigned int    total;
+    unsigned int    pass;
+    unsigned int    fail;
+    unsigned int    skip;
+    unsigned int    unknown;
+    uint64_t        overhead_ns;
+} g_res;
+
+static const char *g_res_module[] = {
+    "pe", "memory", "gic", "smmu", "timer", "wakeup", "peripheral", "watchdog",
+    "pcie", "exerciser"
+};
+
+static uint64_t
+res_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+res_put_json_str(FILE *fp, const char *str)
+{
+    unsigned char c;
+
+    fputc('"', fp);
+    while ((c = *str++)) {
+        if ((c == '"') || (c == '\\'))
+            fprintf(fp, "\\%c", c);
+        else if (c == '\n')
+            fputs("\\n", fp);
+        else if (c == '\t')
+            fputs("\\t", fp);
+        else if (c < 0x20)
+            fprintf(fp, "\\u%04x", c);
+        else
+            fputc(c, fp);
+    }
+    fputc('"', fp);
+}
+
+static void
+res_put_xml_str(FILE *fp, const char *str)
+{
+    unsigned char c;
+
+    while ((c = *str++)) {
+        if (c == '&')
+            fputs("&amp;", fp);
+        else if (c == '<')
+            fputs("&lt;", fp);
+        else if (c == '>')
+            fputs("&gt;", fp);
+        else if (c == '"')
+            fputs("&quot;", fp);
+        else if ((c < 0x20) && (c != '\n') && (c != '\t'))
+            fputc(' ', fp);
+        else
+            fputc(c, fp);
+    }
+}
+
+/* Position the file at its closing text, for the next record to replace it */
+static void
+res_file_begin(res_file_t *f)
+{
+    fseek(f->fp, f->close_pos, SEEK_SET);
+}
+
+/* Close the document again after a record, and push it out to the file */
+static void
+res_file_end(res_file_t *f, const char *close)
+{
+    f->close_pos = ftell(f->fp);
+    fputs(close, f->fp);
+    fflush(f->fp);
+    if (ftruncate(fileno(f->fp), ftell(f->fp)))
+        perror("results file");
+}
+
+/* Write the testsuite tag with the counts so far, always the same length */
+static void
+res_junit_suite(void)
+{
+    char tag[RES_JUNIT_SUITE_LEN];
+
+    snprintf(tag, sizeof(tag), "<testsuite name=\"BSA\" tests=\"%u\" failures=\"%u\" "
+             "errors=\"%u\" skipped=\"%u\"", g_res.total, g_res.fail, g_res.unknown, g_res.skip);
+    fseek(g_res.junit.fp, g_res.junit_suite_pos, SEEK_SET);
+    fprintf(g_res.junit.fp, "%-*s>\n", RES_JUNIT_SUITE_LEN - 1, tag);
+}
+
+static int
+res_file_open(res_file_t *f, const char *path, const char *head, const char *close)
+{
+    f->fp = fopen(path, "w");
+    if (f->fp == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    fputs(head, f->fp);
+    res_file_end(f, close);
+    return 0;
+}
+
+static void
+res_write_test(const char *status, unsigned int sub_code, uint64_t elapsed_ns)
+{
+    unsigned int module = g_res.test_num / 100;
+    const char *module_name = (module < sizeof(g_res_module) / sizeof(g_res_module[0])) ?
+                              g_res_module[module] : "other";
+    FILE *fp;
+
+    if (g_res.json.fp) {
+        fp = g_res.json.fp;
+        res_file_begin(&g_res.json);
+        fprintf(fp, "%s\n  {\"test\": %u, \"module\": \"%s\", \"description\": ",
+                (g_res.total > 1) ? "," : "", g_res.test_num, module_name);
+        res_put_json_str(fp, g_res.desc);
+        fprintf(fp, ", \"status\": \"%s\", \"sub_code\": %u, \"elapsed_us\": %lu, \"messages\": ",
+                status, sub_code, (unsigned long)(elapsed_ns / 1000));
+        res_put_json_str(fp, g_res.msg);
+        fputc('}', fp);
+        res_file_end(&g_res.json, RES_JSON_CLOSE);
+    }
+
+    if (g_res.junit.fp) {
+        fp = g_res.junit.fp;
+        res_file_begin(&g_res.junit);
+        fprintf(fp, "<testcase classname=\"bsa.%s\" name=\"%u ", module_name, g_res.test_num);
+        res_put_xml_str(fp, g_res.desc);
+        fprintf(fp, "\" time=\"%lu.%06lu\">\n", (unsigned long)(elapsed_ns / 1000000000),
+                (unsigned long)(elapsed_ns % 1000000000) / 1000);
+        if (!strcmp(status, "FAIL"))
+            fprintf(fp, "<failure type=\"FAIL\" message=\"sub-code 0x%x\"/>\n", sub_code);
+        else if (!strcmp(status, "UNKNOWN"))
+            fputs("<error type=\"UNKNOWN\" message=\"no result reported\"/>\n", fp);
+        else if (strcmp(status, "PASS"))
+            fprintf(fp, "<skipped message=\"%s sub-code 0x%x\"/>\n", status, sub_code);
+        if (g_res.msg_len) {
+            fputs("<system-out>", fp);
+            res_put_xml_str(fp, g_res.msg);
+            fputs("</system-out>\n", fp);
+        }
+        fputs("</testcase>\n", fp);
+        res_file_end(&g_res.junit, RES_JUNIT_CLOSE);
+        res_junit_suite();
+        fflush(fp);
+    }
+}
+
+static void
+res_finish_test(const char *status, unsigned int sub_code, uint64_t now_ns)
+{
+    g_res.total++;
+    res_write_test(status, sub_code, now_ns - g_res.start_ns);
+    g_res.active = 0;
+    g_res.want_desc = 0;
+}
+
+/* Copy a message, dropping the padding the test descriptions carry */
+static void
+res_copy_trimmed(char *dst, unsigned int size, const char *src)
+{
+    unsigned int len;
+
+    while ((*src == '\n') || (*src == ' '))
+        src++;
+    len = strlen(src);
+    while (len && ((src[len - 1] == ' ') || (src[len - 1] == '\n')))
+        len--;
+    if (len >= size)
+        len = size - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+static void
+res_msg_hook(const char *string, unsigned int level, uint64_t data, uint64_t timestamp)
+{
+    uint64_t start = res_now_ns();
+    uint64_t now = timestamp ? timestamp : start;
+    unsigned int num, len;
+    int end = -1;
+
+    (void)level;
+
+    /* "%4d : " with the test number as data starts a test */
+    if ((sscanf(string, "%u : %n", &num, &end) == 1) && (end > 0) && !string[end] &&
+        (num == data)) {
+        if (g_res.active) {
+            g_res.unknown++;
+            res_finish_test("UNKNOWN", 0, now);
+        }
+        g_res.active = 1;
+        g_res.want_desc = 1;
+        g_res.test_num = num;
+        g_res.desc[0] = '\0';
+        g_res.msg[0] = '\0';
+        g_res.msg_len = 0;
+        g_res.start_ns = now;
+        goto done;
+    }
+
+    if (!g_res.active)
+        goto done;
+
+    if (strstr(string, "Result:") && (((data >> TEST_NUM_BIT) & TEST_NUM_MASK) == g_res.test_num)) {
+        if (IS_TEST_PASS(data)) {
+            g_res.pass++;
+            res_finish_test("PASS", data & STATUS_MASK, now);
+            goto done;
+        }
+        if (IS_TEST_FAIL(data)) {
+            g_res.fail++;
+            res_finish_test("FAIL", data & STATUS_MASK, now);
+            goto done;
+        }
+        if (IS_TEST_SKIP(data)) {
+            g_res.skip++;
+            res_finish_test("SKIP", data & STATUS_MASK, now);
+            goto done;
+        }
+    }
+
+    if (g_res.want_desc) {
+        res_copy_trimmed(g_res.desc, sizeof(g_res.desc), string);
+        g_res.want_desc = 0;
+        goto done;
+    }
+
+    len = strlen(string);
+    if (g_res.msg_len + len < sizeof(g_res.msg)) {
+        memcpy(&g_res.msg[g_res.msg_len], string, len + 1);
+        g_res.msg_len += len;
+    }
+
+done:
+    g_res.overhead_ns += res_now_ns() - start;
+}
+
+/**
+  Start following test results. Either path may be NULL; with neither the results
+  are only counted, for the exit status.
+**/
+int
+results_open(const char *json_path, const char *junit_path, unsigned int print_level)
+{
+    memset(&g_res, 0, sizeof(g_res));
+
+    if (json_path && res_file_open(&g_res.json, json_path,
+        "{\"suite\": \"BSA\", \"version\": \"" BSA_APP_VERSION_STRING "\", \"tests\": [",
+        RES_JSON_CLOSE))
+        return 1;
+
+    if (junit_path) {
+        if (res_file_open(&g_res.junit, junit_path,
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n", RES_JUNIT_CLOSE))
+            return 1;
+        g_res.junit_suite_pos = g_res.junit.close_pos;
+        res_junit_suite();
+        res_file_end(&g_res.junit, RES_JUNIT_CLOSE);
+    }
+
+    /* Results files need every description and result, whatever is shown */
+    call_drv_msg_hook(res_msg_hook,
+                      (json_path || junit_path) ? RES_CAPTURE_LEVEL : print_level);
+    return 0;
+}
+
+void
+results_close(void)
+{
+    uint64_t start = res_now_ns();
+
+    if (g_res.active) {
+        g_res.unknown++;
+        res_finish_test("UNKNOWN", 0, start);
+    }
+
+    if (g_res.json.fp) {
+        res_file_begin(&g_res.json);
+        fprintf(g_res.json.fp, "\n], \"summary\": {\"total\": %u, \"pass\": %u, \"fail\": %u, "
+                "\"skip\": %u, \"unknown\": %u}}\n",
+                g_res.total, g_res.pass, g_res.fail, g_res.skip, g_res.unknown);
+        res_file_end(&g_res.json, "");
+        fclose(g_res.json.fp);
+    }
+
+    if (g_res.junit.fp)
+        fclose(g_res.junit.fp);
+
+    g_res.overhead_ns += res_now_ns() - start;
+    if (g_res.json.fp || g_res.junit.fp)
+        printf(" Results files : %u tests, %lu us spent writing \n", g_res.total,
+               (unsigned long)(g_res.overhead_ns / 1000));
+
+    g_res.json.fp = NULL;
+    g_res.junit.fp = NULL;
+    call_drv_msg_hook(NULL, 0);
+}
+
+unsigned int
+results_failed(void)
+{
+    return g_res.fail;
+}
@@ -18,9 +18,24 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include <stdint.h>
 #include "include/bsa_drv_intf.h"
+#include "val/include/bsa_acs_msg_ring.h"
+
+/* Back-off bounds while the driver reports pending without waking us, in ms */
+#define DRV_WAIT_MIN_MS          1
+#define DRV_WAIT_MAX_MS          16
+
+/* Latency is tracked per API number, which the driver spaces 0x1000 apart */
+#define DRV_API_SLOT(api)        (((api) >> 12) & 0xF)
+#define DRV_API_SLOTS            16
 
 typedef
 struct __BSA_DRV_PARMS__
@@ -33,29 +48,237 @@ struct __BSA_DRV_PARMS__
     unsigned long   arg2;
 }bsa_drv_parms_t;
 
+typedef struct {
+    unsigned int    calls;
+    uint64_t        total_ns;
+    uint64_t        max_ns;
+} drv_latency_t;
+
+/* Driver session: the interface is opened once for the whole run */
+typedef struct {
+    int             fd;                 /* /proc/bsa, -1 when closed */
+    int             msg_fd;             /* /proc/bsa_msg */
+    bsa_msg_ring_t  *msg_ring;          /* NULL when the driver only offers read() */
+    unsigned int    caps;               /* DRV_CAP_* reported by the driver */
+    int             keep_tables;        /* leave the info tables to the next run */
+    int             poll_unsupported;   /* poll reported ready without progress */
+    unsigned int    print_level;
+    unsigned int    capture_level;      /* level the driver prints at, <= print_level */
+    drv_msg_hook_t  msg_hook;
+    int             level_forced;       /* read() only: the console shows capture_level too */
+    int             msg_timestamp;
+    drv_latency_t   latency[DRV_API_SLOTS];
+} drv_session_t;
+
+static drv_session_t g_drv = { .fd = -1, .msg_fd = -1 };
+
+static int drv_drain_msg(void);
+
+/* Level to hand the driver. The app filters ring messages itself, so it can ask
+   for more than it shows when a message hook wants them. Messages read() returns
+   carry no level, so without the ring the console shows them as well */
+static unsigned int
+drv_level(unsigned int print_level)
+{
+  if (!g_drv.msg_hook || (g_drv.capture_level >= print_level))
+    return print_level;
+
+  if (!g_drv.msg_ring && !g_drv.level_forced) {
+    printf(" Driver has no message ring, printing level %u messages for the results files \n",
+           g_drv.capture_level);
+    g_drv.level_forced = 1;
+  }
+  return g_drv.capture_level;
+}
+
+static uint64_t
+drv_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void
+drv_account(unsigned int api_num, uint64_t start_ns)
+{
+  drv_latency_t *lat = &g_drv.latency[DRV_API_SLOT(api_num)];
+  uint64_t ns = drv_now_ns() - start_ns;
+
+  lat->calls++;
+  lat->total_ns += ns;
+  if (ns > lat->max_ns)
+    lat->max_ns = ns;
+}
+
+static bsa_msg_ring_t *
+drv_map_msg_ring(int fd)
+{
+  bsa_msg_ring_t *ring;
+
+  ring = mmap(NULL, BSA_MSG_RING_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (ring == MAP_FAILED)
+      return NULL;
 
+  if ((ring->magic != BSA_MSG_RING_MAGIC) || (ring->version != BSA_MSG_RING_VERSION) ||
+      (ring->size > BSA_MSG_RING_DATA_SIZE) || (ring->size & (ring->size - 1))) {
+      munmap(ring, BSA_MSG_RING_MAP_SIZE);
+      return NULL;
+  }
+
+  return ring;
+}
+
+static int
+drv_read_status(bsa_drv_parms_t *params)
+{
+  /* Read from the start every time, as a fresh open would */
+  if (pread(g_drv.fd, params, sizeof(*params), 0) != sizeof(*params)) {
+      printf("read of /proc/bsa failed \n");
+      return 1;
+  }
+  return 0;
+}
+
+/**
+  Ask the driver what it supports. Drivers that predate the query must only
+  ever be given one command per write and none of the later commands, so
+  anything but a well formed reply counts as no capabilities.
+**/
+static unsigned int
+drv_query_caps(void)
+{
+  bsa_drv_parms_t query;
+  bsa_drv_parms_t reply;
+
+  memset(&query, 0, sizeof(query));
+  query.api_num = BSA_QUERY_CAPS;
+  query.arg0    = DRV_CAPS_QUERY_MAGIC;
+
+  if ((pwrite(g_drv.fd, &query, sizeof(query), 0) != sizeof(query)) || drv_read_status(&reply))
+      return 0;
+
+  if ((reply.arg0 != DRV_CAPS_REPLY_MAGIC) || (reply.arg1 < DRV_CAPS_VERSION))
+      return 0;
+
+  return (unsigned int)reply.arg2;
+}
+
+/**
+  Open the driver interface for the rest of the run.
+  Returns non-zero, with a message, if the BSA kernel module is not loaded.
+**/
 int
-call_drv_get_status(unsigned long int *arg0, unsigned long int *arg1, unsigned long int *arg2)
+call_drv_open()
 {
+  bsa_drv_parms_t status;
 
-    FILE  *fd = NULL;
-    bsa_drv_parms_t test_params;
+  if (g_drv.fd >= 0)
+      return 0;
 
+  g_drv.fd = open("/proc/bsa", O_RDWR);
+  if (g_drv.fd < 0) {
+      printf("Cannot open /proc/bsa (%s). Is the BSA kernel module loaded? \n",
+             strerror(errno));
+      return 1;
+  }
 
-    fd = fopen("/proc/bsa", "r");
+  /* The consumer index lives in the ring, so mapping it needs write access */
+  g_drv.msg_fd = open("/proc/bsa_msg", O_RDWR);
+  if (g_drv.msg_fd >= 0)
+      g_drv.msg_ring = drv_map_msg_ring(g_drv.msg_fd);
+  else
+      g_drv.msg_fd = open("/proc/bsa_msg", O_RDONLY);
+
+  if ((g_drv.msg_fd < 0) || drv_read_status(&status)) {
+      printf("Cannot use the BSA kernel module interface (%s) \n", strerror(errno));
+      call_drv_close();
+      return 1;
+  }
 
-    fseek(fd, 0, SEEK_SET);
+  g_drv.caps = drv_query_caps();
+  return 0;
+}
 
-    if (NULL == fd)
-    {
-        printf("fopen failed \n");
-        return 1;
-    }
-  fread(&test_params,1,sizeof(test_params),fd);
+void
+call_drv_close()
+{
+  unsigned int i;
+
+  for (i = 0; i < DRV_API_SLOTS; i++) {
+      if (!g_drv.latency[i].calls)
+          continue;
+      printf(" Driver API 0x%x : %4u calls, avg %8lu us, max %8lu us \n", i << 12,
+             g_drv.latency[i].calls,
+             (unsigned long)(g_drv.latency[i].total_ns / g_drv.latency[i].calls / 1000),
+             (unsigned long)(g_drv.latency[i].max_ns / 1000));
+  }
+  memset(g_drv.latency, 0, sizeof(g_drv.latency));
+
+  if (g_drv.msg_ring)
+      munmap(g_drv.msg_ring, BSA_MSG_RING_MAP_SIZE);
+  if (g_drv.msg_fd >= 0)
+      close(g_drv.msg_fd);
+  if (g_drv.fd >= 0)
+      close(g_drv.fd);
+  g_drv.msg_ring = NULL;
+  g_drv.msg_fd = -1;
+  g_drv.fd = -1;
+}
+
+/**
+  Hand a vector of commands to the driver: in one write when the driver supports
+  batches, else one write per command on the same open descriptor.
+**/
+static int
+drv_submit(bsa_drv_parms_t *cmds, unsigned int num)
+{
+  bsa_drv_parms_t batch[DRV_MAX_BATCH + 1];
+  unsigned int i;
+  uint64_t start;
+  ssize_t len;
+
+  if (g_drv.fd < 0) {
+      printf("BSA kernel module interface is not open \n");
+      return 1;
+  }
+
+  if ((g_drv.caps & DRV_CAP_BATCH) && (num > 1) && (num <= DRV_MAX_BATCH)) {
+      memset(&batch[0], 0, sizeof(batch[0]));
+      batch[0].api_num = BSA_BATCH_COMMANDS;
+      batch[0].num_pe  = num;
+      memcpy(&batch[1], cmds, num * sizeof(*cmds));
+
+      len = (num + 1) * sizeof(*cmds);
+      start = drv_now_ns();
+      if (pwrite(g_drv.fd, batch, len, 0) != len) {
+          printf("write to /proc/bsa failed (%s) \n", strerror(errno));
+          return 1;
+      }
+      drv_account(BSA_BATCH_COMMANDS, start);
+      return 0;
+  }
+
+  for (i = 0; i < num; i++) {
+      start = drv_now_ns();
+      if (pwrite(g_drv.fd, &cmds[i], sizeof(cmds[i]), 0) != sizeof(cmds[i])) {
+          printf("write to /proc/bsa failed (%s) \n", strerror(errno));
+          return 1;
+      }
+      drv_account(cmds[i].api_num, start);
+  }
+  return 0;
+}
+
+int
+call_drv_get_status(unsigned long int *arg0, unsigned long int *arg1, unsigned long int *arg2)
+{
 
-  //printf("read back value is %x %lx \n", test_params.api_num, test_params.arg1);
+    bsa_drv_parms_t test_params;
 
-  fclose(fd);
+    if ((g_drv.fd < 0) || drv_read_status(&test_params))
+        return 1;
 
   *arg0 = test_params.arg0;
   *arg1 = test_params.arg1;
@@ -64,153 +287,243 @@ call_drv_get_status(unsigned long int *arg0, unsigned long int *arg1, unsigned l
   return test_params.api_num;
 }
 
+/* Sleep until the driver signals either descriptor or the timeout expires.
+   Returns non-zero if the wake-up came from the driver. */
+static int
+drv_wait_event(int timeout_ms)
+{
+  struct pollfd fds[2];
+
+  fds[0].fd = g_drv.fd;
+  fds[0].events = POLLIN | POLLPRI;
+  fds[1].fd = g_drv.msg_fd;
+  fds[1].events = POLLIN | POLLPRI;
+
+  return poll(fds, 2, timeout_ms) > 0;
+}
+
 int
 call_drv_wait_for_completion()
 {
-  unsigned long int arg0, arg1, arg2;
+  bsa_drv_parms_t status;
+  struct timespec backoff;
+  int wait_ms = DRV_WAIT_MIN_MS;
+  int woken = 0;
 
-  arg0 = DRV_STATUS_PENDING;
+  if (g_drv.fd < 0)
+    return 1;
 
-  while (arg0 == DRV_STATUS_PENDING){
-    call_drv_get_status(&arg0, &arg1, &arg2);
-    read_from_proc_bsa_msg();
+  while (1) {
+    if (drv_read_status(&status))
+      return 1;
+
+    if (!drv_drain_msg() && woken && (status.arg0 == DRV_STATUS_PENDING))
+      g_drv.poll_unsupported = 1;
+    if (status.arg0 != DRV_STATUS_PENDING)
+      break;
+
+    /* A driver that implements poll wakes us on new status or messages, and the
+       timeout only bounds a missed wake-up. Without it procfs reports the files
+       always ready, so sleep with back-off instead of spinning */
+    if (!g_drv.poll_unsupported) {
+      woken = drv_wait_event(DRV_WAIT_MAX_MS);
+      continue;
+    }
+    backoff.tv_sec = 0;
+    backoff.tv_nsec = wait_ms * 1000000L;
+    nanosleep(&backoff, NULL);
+    if (wait_ms < DRV_WAIT_MAX_MS)
+      wait_ms <<= 1;
   }
 
-  return arg1;
+  return status.arg1;
 }
 
+/* Submit commands, the last of which runs on the driver, and wait for it */
+static int
+drv_run(bsa_drv_parms_t *cmds, unsigned int num)
+{
+  uint64_t start = drv_now_ns();
+  int status;
+
+  if (drv_submit(cmds, num))
+    return 1;
+
+  status = call_drv_wait_for_completion();
+  drv_account(cmds[num - 1].api_num, start);
+  return status;
+}
 
 int
 call_drv_init_test_env(unsigned int print_level)
 {
-    FILE             *fd = NULL;
     bsa_drv_parms_t test_params;
+    uint64_t start;
+    int status;
 
-    fd = fopen("/proc/bsa", "rw+");
-
-    if (NULL == fd)
-    {
-        printf("fopen failed \n");
+    if (call_drv_open())
         return 1;
-    }
 
+    memset(&test_params, 0, sizeof(test_params));
+    g_drv.print_level    = print_level;
     test_params.api_num  = BSA_CREATE_INFO_TABLES;
-    test_params.arg1     = print_level;
-    test_params.arg2     = 0;
-
-    fwrite(&test_params,1,sizeof(test_params),fd);
+    test_params.arg1     = drv_level(print_level);
 
-    fclose(fd);
-
-    call_drv_wait_for_completion();
+    if (g_drv.keep_tables && !(g_drv.caps & DRV_CAP_KEEP_TABLES)) {
+        printf(" Driver cannot keep info tables between runs, rebuilding them \n");
+        g_drv.keep_tables = 0;
+    }
+    if (g_drv.keep_tables)
+        test_params.arg0 = BSA_TABLES_REUSE;
+    if (g_drv.caps & DRV_CAP_STARTUP_REPORT)
+        test_params.arg0 |= BSA_TABLES_STARTUP_REPORT;
+
+    start = drv_now_ns();
+    status = drv_run(&test_params, 1);
+    if (status) {
+        printf(" Info table creation failed, status %d \n", status);
+        return status;
+    }
+    printf(" Info tables ready in %lu us \n", (unsigned long)((drv_now_ns() - start) / 1000));
 
+    if (g_drv.keep_tables && !drv_read_status(&test_params) && test_params.arg2)
+        printf(" Reusing info tables from the previous run \n");
+    return 0;
 }
 
 int
 call_drv_clean_test_env()
 {
-    FILE             *fd = NULL;
     bsa_drv_parms_t test_params;
 
-    fd = fopen("/proc/bsa", "rw+");
-
-    if (NULL == fd)
-    {
-        printf("fopen failed \n");
-        return 1;
-    }
+    /* The driver frees the kept tables when it is unloaded */
+    if (g_drv.keep_tables)
+        return 0;
 
+    memset(&test_params, 0, sizeof(test_params));
     test_params.api_num  = BSA_FREE_INFO_TABLES;
-    test_params.arg1     = 0;
-    test_params.arg2     = 0;
 
-    fwrite(&test_params,1,sizeof(test_params),fd);
+    return drv_run(&test_params, 1);
+}
 
-    fclose(fd);
+static void
+drv_fill_test(bsa_drv_parms_t *params, unsigned int api_num, unsigned int num_pe,
+  unsigned int print_level, unsigned long int test_input)
+{
+    memset(params, 0, sizeof(*params));
+    params->api_num  = api_num;
+    params->num_pe   = num_pe;
+    params->arg0     = test_input;
+    params->arg1     = drv_level(print_level);
+}
 
-    call_drv_wait_for_completion();
+static void
+drv_fill_triple(bsa_drv_parms_t *params, unsigned int api_num, int *p_arg)
+{
+    memset(params, 0, sizeof(*params));
+    params->api_num  = api_num;
+    params->arg0     = p_arg[0];
+    params->arg1     = p_arg[1];
+    params->arg2     = p_arg[2];
 }
 
 int
 call_drv_execute_test(unsigned int api_num, unsigned int num_pe,
   unsigned int print_level, unsigned long int test_input)
 {
-    FILE             *fd = NULL;
     bsa_drv_parms_t test_params;
 
-    fd = fopen("/proc/bsa", "rw+");
-
-    if (NULL == fd)
-    {
-        printf("fopen failed \n");
-        return 1;
-    }
-
-    test_params.api_num  = api_num;
-    test_params.num_pe   = num_pe;
-    test_params.level    = 0;
-    test_params.arg0     = test_input;
-    test_params.arg1     = print_level;
-    test_params.arg2     = 0;
-
-    fwrite(&test_params,1,sizeof(test_params),fd);
-
-    fclose(fd);
-
+    drv_fill_test(&test_params, api_num, num_pe, print_level, test_input);
+    return drv_submit(&test_params, 1);
 }
 
 int
 call_update_skip_list(unsigned int api_num, int *p_skip_test_num)
 {
-    FILE             *fd = NULL;
     bsa_drv_parms_t test_params;
 
-    fd = fopen("/proc/bsa", "rw+");
+    drv_fill_triple(&test_params, api_num, p_skip_test_num);
+    return drv_submit(&test_params, 1);
+}
 
-    if (NULL == fd)
-    {
-        printf("fopen failed \n");
-        return 1;
-    }
+int
+call_update_sw_view(unsigned int api_num, int *p_sw_view)
+{
+    bsa_drv_parms_t test_params;
 
-    test_params.api_num  = api_num;
-    test_params.num_pe   = 0;
-    test_params.level    = 0;
-    test_params.arg0     = p_skip_test_num[0];
-    test_params.arg1     = p_skip_test_num[1];
-    test_params.arg2     = p_skip_test_num[2];
+    drv_fill_triple(&test_params, api_num, p_sw_view);
+    return drv_submit(&test_params, 1);
+}
 
-    fwrite(&test_params,1,sizeof(test_params),fd);
+/**
+  Run one test module: the software view, the skip list and the module's test
+  command go to the driver together, then wait for the module to complete.
+**/
+int
+call_drv_run_tests(unsigned int api_num, unsigned int num_pe, unsigned int print_level,
+  int *p_sw_view, int *p_skip_test_num)
+{
+    bsa_drv_parms_t cmds[3];
 
-    fclose(fd);
+    drv_fill_triple(&cmds[0], BSA_UPDATE_SW_VIEW, p_sw_view);
+    drv_fill_triple(&cmds[1], BSA_UPDATE_SKIP_LIST, p_skip_test_num);
+    drv_fill_test(&cmds[2], api_num, num_pe, print_level, 0);
 
+    return drv_run(cmds, 3);
 }
 
+/**
+  Replace the driver's test selection with the given include and exclude ranges.
+  The list is unbounded; it goes to the driver in batches of DRV_MAX_BATCH.
+**/
 int
-call_update_sw_view(unsigned int api_num, int *p_sw_view)
+call_drv_select_tests(const drv_test_range_t *p_range, unsigned int num_range, int timing)
 {
-    FILE             *fd = NULL;
-    bsa_drv_parms_t test_params;
+    bsa_drv_parms_t cmds[DRV_MAX_BATCH];
+    unsigned int i, num = 0;
 
-    fd = fopen("/proc/bsa", "rw+");
-
-    if (NULL == fd)
-    {
-        printf("fopen failed \n");
+    if (!(g_drv.caps & DRV_CAP_TEST_SELECT)) {
+        printf("BSA kernel module does not support test selection \n");
         return 1;
     }
 
-    test_params.api_num  = api_num;
-    test_params.num_pe   = 0;
-    test_params.level    = 0;
-    test_params.arg0     = p_sw_view[0];
-    test_params.arg1     = p_sw_view[1];
-    test_params.arg2     = p_sw_view[2];
+    memset(cmds, 0, sizeof(cmds));
+    cmds[num].api_num = BSA_UPDATE_TEST_SELECT;
+    cmds[num++].arg0  = BSA_SELECT_CLEAR;
+
+    for (i = 0; i <= num_range; i++) {
+        if (num == DRV_MAX_BATCH) {
+            if (drv_submit(cmds, num))
+                return 1;
+            memset(cmds, 0, sizeof(cmds));
+            num = 0;
+        }
+
+        cmds[num].api_num = BSA_UPDATE_TEST_SELECT;
+        if (i == num_range) {
+            /* Timing goes last, so the list always ends with a known command */
+            cmds[num].arg0 = BSA_SELECT_TIMING;
+            cmds[num++].arg1 = timing ? 1 : 0;
+            break;
+        }
+        cmds[num].arg0 = p_range[i].exclude ? BSA_SELECT_EXCLUDE : BSA_SELECT_INCLUDE;
+        cmds[num].arg1 = p_range[i].start;
+        cmds[num++].arg2 = p_range[i].end;
+    }
 
-    fwrite(&test_params,1,sizeof(test_params),fd);
+    return drv_submit(cmds, num);
+}
 
-    fclose(fd);
+unsigned int
+call_drv_capabilities()
+{
+    return g_drv.caps;
+}
 
+void
+call_drv_keep_tables(int enable)
+{
+    g_drv.keep_tables = enable;
 }
 
 typedef struct __BSA_MSG__ {
@@ -218,26 +531,77 @@ typedef struct __BSA_MSG__ {
     unsigned long data;
 }bsa_msg_parms_t;
 
-int read_from_proc_bsa_msg() {
+/**
+  Print one message taken from the ring, applying the same print level
+  filter as val_print.
+**/
+static void
+drv_print_msg(const bsa_msg_rec_t *rec)
+{
+  if (g_drv.msg_hook)
+    g_drv.msg_hook(rec->string, rec->level, rec->data, rec->timestamp);
 
-  char buf_msg[sizeof(bsa_msg_parms_t)];
+  if (rec->level < g_drv.print_level)
+    return;
 
-  FILE  *fd = NULL;
-  bsa_msg_parms_t msg_params;
+  if (g_drv.msg_timestamp)
+    printf("[%5lu.%06lu] ", (unsigned long)(rec->timestamp / 1000000000),
+           (unsigned long)(rec->timestamp % 1000000000) / 1000);
+  printf("%s", rec->string);
+}
 
-  fd = fopen("/proc/bsa_msg", "r");
+/* Print every pending driver message, returning how many there were */
+static int drv_drain_msg(void) {
 
-  fseek(fd, 0, SEEK_SET);
+  char buf_msg[sizeof(bsa_msg_parms_t)];
+  uint64_t rec_buf[(sizeof(bsa_msg_rec_t) + BSA_MSG_MAX_LEN) / sizeof(uint64_t) + 1];
+  int count = 0;
 
-  if (NULL == fd) {
-    printf("fopen failed \n");
-    return 1;
+  if (g_drv.msg_ring) {
+    while (bsa_msg_ring_get(g_drv.msg_ring, rec_buf, sizeof(rec_buf))) {
+      drv_print_msg((bsa_msg_rec_t *)rec_buf);
+      count++;
+    }
+    return count;
   }
 
   /* Print Until buffer is empty */
-  while(fread(buf_msg,sizeof(buf_msg),1,fd)){
+  lseek(g_drv.msg_fd, 0, SEEK_SET);
+  while (read(g_drv.msg_fd, buf_msg, sizeof(buf_msg)) == sizeof(buf_msg)) {
+    if (g_drv.msg_hook)
+      g_drv.msg_hook(((bsa_msg_parms_t *)buf_msg)->string, 0,
+                     ((bsa_msg_parms_t *)buf_msg)->data, 0);
     printf("%s", buf_msg);
+    count++;
   }
 
-  fclose(fd);
+  return count;
+}
+
+int read_from_proc_bsa_msg() {
+
+  if (g_drv.msg_fd < 0)
+    return 1;
+
+  drv_drain_msg();
+  return 0;
+}
+
+void
+call_drv_msg_timestamp(int enable)
+{
+  g_drv.msg_timestamp = enable;
+}
+
+unsigned int
+call_drv_msg_dropped()
+{
+  return g_drv.msg_ring ? g_drv.msg_ring->dropped : 0;
+}
+
+void
+call_drv_msg_hook(drv_msg_hook_t hook, unsigned int capture_level)
+{
+  g_drv.msg_hook = hook;
+  g_drv.capture_level = capture_level;
 }
@@ -23,6 +23,10 @@
 #define BSA_APP_VERSION_MAJOR  0
 #define BSA_APP_VERSION_MINOR  5
 
+#define BSA_APP_STR_HELPER(x)  #x
+#define BSA_APP_STR(x)         BSA_APP_STR_HELPER(x)
+#define BSA_APP_VERSION_STRING BSA_APP_STR(BSA_APP_VERSION_MAJOR) "." BSA_APP_STR(BSA_APP_VERSION_MINOR)
+
 #define G_SW_OS            0
 #define G_SW_HYP           1
 #define G_SW_PS            2
@@ -43,4 +47,13 @@ execute_tests_peripheral(int num_pe, unsigned int print_level);
 
 int
 execute_tests_memory(int num_pe, unsigned int print_level);
+
+int
+results_open(const char *json_path, const char *junit_path, unsigned int print_level);
+
+void
+results_close(void);
+
+unsigned int
+results_failed(void);
 #endif
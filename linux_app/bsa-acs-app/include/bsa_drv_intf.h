@@ -19,6 +19,8 @@
 #ifndef __BSA_DRV_INTF_H__
 #define __BSA_DRV_INTF_H__
 
+#include <stdint.h>
+
 
 /* API NUMBERS to COMMUNICATE with DRIVER */
 
@@ -30,17 +32,64 @@
 #define BSA_PER_EXECUTE_TEST     0x6000
 #define BSA_MEM_EXECUTE_TEST     0x7000
 #define BSA_FREE_INFO_TABLES     0x9000
+#define BSA_BATCH_COMMANDS       0xA000  /* num_pe commands follow in the same write */
+#define BSA_UPDATE_TEST_SELECT   0xB000  /* arg0 BSA_SELECT_*, arg1 first, arg2 last test */
+#define BSA_QUERY_CAPS           0xC000  /* arg0 DRV_CAPS_QUERY_MAGIC */
+
+/* BSA_UPDATE_TEST_SELECT operations, applied in order through val_test_select_* */
+#define BSA_SELECT_CLEAR         0x0
+#define BSA_SELECT_INCLUDE       0x1
+#define BSA_SELECT_EXCLUDE       0x2
+#define BSA_SELECT_TIMING        0x3     /* arg1 enables the per-test wall time */
+
+/* BSA_CREATE_INFO_TABLES arg0 flags. With BSA_TABLES_REUSE a driver that still
+   holds the tables of an earlier run keeps them, and completes with arg2 set.
+   BSA_TABLES_STARTUP_REPORT prints the per table startup profile once created */
+#define BSA_TABLES_REUSE          0x1
+#define BSA_TABLES_STARTUP_REPORT 0x2
 
 
 /* STATUS MESSAGES */
 #define DRV_STATUS_AVAILABLE     0x10000000
 #define DRV_STATUS_PENDING       0x40000000
 
+/* BSA_QUERY_CAPS handshake. A driver that knows the query completes it with
+   arg0 DRV_CAPS_REPLY_MAGIC, arg1 its DRV_CAPS_VERSION and arg2 the DRV_CAP_*
+   it supports. Any other status, such as an older driver echoing the request,
+   means no capabilities */
+#define DRV_CAPS_QUERY_MAGIC     0x42534151      /* "BSAQ" */
+#define DRV_CAPS_REPLY_MAGIC     0x42534143      /* "BSAC" */
+#define DRV_CAPS_VERSION         1
+
+/* Capabilities the driver reports in reply to BSA_QUERY_CAPS */
+#define DRV_CAP_BATCH            0x1
+#define DRV_CAP_TEST_SELECT      0x2     /* takes BSA_UPDATE_TEST_SELECT */
+#define DRV_CAP_KEEP_TABLES      0x4     /* honours BSA_TABLES_REUSE */
+#define DRV_CAP_STARTUP_REPORT   0x8     /* honours BSA_TABLES_STARTUP_REPORT */
+
+#define DRV_MAX_BATCH            8
+
+typedef struct {
+    unsigned int    start;
+    unsigned int    end;                /* inclusive */
+    int             exclude;
+} drv_test_range_t;
+
+/* Called for every driver message, before the print level filter is applied.
+   level and timestamp are 0 when the driver only offers fixed size reads */
+typedef void (*drv_msg_hook_t)(const char *string, unsigned int level,
+                               uint64_t data, uint64_t timestamp);
 
 
 
 /* Function Prototypes */
 
+int
+call_drv_open();
+
+void
+call_drv_close();
+
 int
 call_drv_init_test_env();
 
@@ -54,12 +103,37 @@ call_drv_execute_test(unsigned int test_num, unsigned int num_pe,
 int
 call_update_skip_list(unsigned int api_num, int *p_skip_test_num);
 
+int
+call_drv_select_tests(const drv_test_range_t *p_range, unsigned int num_range, int timing);
+
+unsigned int
+call_drv_capabilities();
+
+void
+call_drv_keep_tables(int enable);
+
 int
 call_update_sw_view(unsigned int api_num, int *p_sw_view);
 
+int
+call_drv_run_tests(unsigned int api_num, unsigned int num_pe, unsigned int print_level,
+  int *p_sw_view, int *p_skip_test_num);
+
 int
 call_drv_wait_for_completion();
 
 int read_from_proc_bsa_msg();
 
+void
+call_drv_msg_timestamp(int enable);
+
+unsigned int
+call_drv_msg_dropped();
+
+void
+call_drv_msg_hook(drv_msg_hook_t hook, unsigned int capture_level);
+
+int
+run_msg_ring_bench(unsigned long num_msgs);
+
 #endif
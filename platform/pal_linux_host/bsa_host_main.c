@@ -0,0 +1,637 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+/*
+ * Runs the Linux set of VAL and tests as a host process, against a platform
+ * described by files or synthesized. Stands in for the kernel module and the
+ * app together: it owns the globals the module would, creates the info tables
+ * and runs the modules, timing each phase.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "include/pal_linux_host.h"
+#include "val/include/val_interface.h"
+#include "val/include/bsa_acs_cfg.h"
+#include "val/include/bsa_acs_memory.h"
+#include "val/include/bsa_acs_smmu.h"
+#include "val/include/bsa_acs_pgt.h"
+
+#define DMA_INFO_TABLE_SZ         4096
+
+/* Streams mapped on each SMMU model, and where their windows sit */
+#define HOST_SMMU_STREAMS         8
+#define HOST_SMMU_IOVA            0x10000000ULL
+#define HOST_SMMU_PA              0x80000000ULL
+#define HOST_SMMU_LENGTH          0x201000ULL    /* A 2MB block and a page */
+#define HOST_SMMU_SSID            0x405          /* In the second leaf of a two level CD table */
+
+#define HOST_ITS_DEVID            0x100          /* Requester of the single vector */
+#define HOST_ITS_LPI              0x203A
+#define HOST_ITS_RANGE_DEVID      0x200          /* Requester of the range */
+#define HOST_ITS_RANGE_LPI        0x2100
+#define HOST_ITS_MAX_VECTORS      256            /* The driver does not wrap its command queue */
+
+#define HOST_MEMMAP_LOOKUPS       10000
+
+uint32_t g_print_level = ACS_PRINT_TEST;
+uint32_t g_skip_test_num[MAX_TEST_SKIP_NUM] = {10000, 10000, 10000};
+uint32_t g_bsa_tests_total;
+uint32_t g_bsa_tests_pass;
+uint32_t g_bsa_tests_fail;
+uint64_t g_stack_pointer;
+uint64_t g_exception_ret_addr;
+uint64_t g_ret_addr;
+
+static uint32_t g_sw_view[3] = {1, 1, 1};
+
+/* The modules the Linux set has, in the order the kernel module runs them */
+static const TEST_MODULE g_host_modules[] = {
+  {"\n      *** Starting Peripheral tests ***  ", val_peripheral_execute_tests},
+  {"\n      *** Starting Memory Map tests ***  ", val_memory_execute_tests},
+  {"\n      *** Starting PCIe tests ***  ",       val_pcie_execute_tests},
+};
+
+static uint64_t
+host_now_us(void)
+{
+  uint64_t freq;
+  uint64_t count = pal_host_counter_read(&freq);
+
+  return count / (freq / 1000000);
+}
+
+static void
+host_usage(const char *prog)
+{
+  printf("Usage: %s [options]\n"
+         "  -v <n>               Verbosity, 1 (all) to 5 (errors only)\n"
+         "  --ecam <file>[@<base>[,<seg>[,<bus>]]]\n"
+         "                       Raw ECAM image, whole 1MB buses from <bus> on\n"
+         "  --memmap <file>      Memory map, \"ram|device|reserved <base> <size>\" lines\n"
+         "  --madt <file>        Raw ACPI MADT describing the PEs\n"
+         "  --synth <pe>,<rp>,<ep>\n"
+         "                       Synthetic platform: PEs, root ports, endpoints per port\n"
+         "  --smmu <n>[,<sid_bits>]\n"
+         "                       SMMUv3 models to map, translate and unmap streams through\n"
+         "  --its <vectors>      GICv3 ITS model to map, deliver and unmap MSIs through\n"
+         "  --memmap-synth <n>   Synthetic memory map of n regions to time VAL lookups in\n"
+         "  --tests <list>       Run only these tests, e.g. 800,801-805\n"
+         "  --skip <list>        Skip these tests\n"
+         "  --time               Print the time each test takes\n"
+         "  --cost-order         Run the cheaper tests of each module first\n"
+
+         "  --iterations <n>     Run the modules n times, for profiling\n", prog);
+}
+
+static int
+host_select(char *list, uint32_t exclude)
+{
+  unsigned long start, end;
+  char *pt, *endptr;
+
+  for (pt = strtok(list, ","); pt != NULL; pt = strtok(NULL, ",")) {
+      start = strtoul(pt, &endptr, 10);
+      end = start;
+      if ((endptr != pt) && (*endptr == '-'))
+          end = strtoul(endptr + 1, &endptr, 10);
+      if ((endptr == pt) || *endptr || (end < start) || val_test_select_add(start, end, exclude)) {
+          fprintf(stderr, "Invalid test number or range `%s'.\n", pt);
+          return 1;
+      }
+  }
+
+  return 0;
+}
+
+static int
+host_add_smmus(const char *arg)
+{
+  unsigned int num, sid_bits = 16, i;
+
+  if ((sscanf(arg, "%u,%u", &num, &sid_bits) < 1) || (num == 0) || (sid_bits > 24))
+      return 1;
+
+  for (i = 0; i < num; i++) {
+      if (pal_host_add_smmu(PAL_HOST_SMMU_BASE + (uint64_t)i * PAL_HOST_SMMU_SIZE, sid_bits))
+          return 1;
+  }
+
+  return 0;
+}
+
+/* Check the model translates iova as the tables were built, or faults if unmapped */
+static uint32_t
+host_smmu_check(uint32_t index, uint32_t sid, uint32_t ssid, uint64_t iova_base, uint64_t pa_base,
+                uint32_t mapped)
+{
+  static const uint64_t offset[] = {0, 0x1000, 0x1FFFF8, 0x200ABC, HOST_SMMU_LENGTH};
+  uint64_t pa;
+  uint32_t i, fault, expect_fault;
+
+  for (i = 0; i < sizeof(offset) / sizeof(offset[0]); i++) {
+      fault = pal_host_smmu_translate(index, sid, ssid, iova_base + offset[i], &pa);
+      expect_fault = !mapped || (offset[i] >= HOST_SMMU_LENGTH);
+      if (fault != expect_fault || (!fault && (pa != pa_base + offset[i]))) {
+          printf("\n       SMMU %u sid 0x%x: iova 0x%llx %s", index, sid,
+                 (unsigned long long)(iova_base + offset[i]),
+                 fault ? "faults" : "translates to the wrong address");
+          return 1;
+      }
+  }
+
+  return 0;
+}
+
+/**
+  @brief  Drive the SMMUv3 models with the VAL driver: map streams alternately
+          through stage 1 and stage 2 tables, check the translations the model
+          makes, unmap, and compare the driver's command queue statistics with
+          the commands the model consumed
+
+  @return Number of failures
+**/
+static uint32_t
+host_smmu_run(void)
+{
+  memory_region_descriptor_t mem_desc[2];
+  pgt_descriptor_t pgt_desc;
+  smmu_master_attributes_t master;
+  PAL_HOST_SMMU *model;
+  uint64_t cmds, cfgi, tlbi, sync;
+  uint32_t page_log2, bits, num_levels, num_sid, step;
+  uint32_t i, s, fail = 0;
+
+  if (val_smmu_init()) {
+      printf("\n       SMMU initialisation failed\n");
+      return 1;
+  }
+  val_smmu_clear_stats();
+
+  page_log2 = 0;
+  while ((1u << page_log2) < val_memory_page_size())
+      page_log2++;
+  bits = page_log2 - 3;
+
+  for (i = 0; i < g_pal_host.num_smmu; i++) {
+      model = &g_pal_host.smmu[i];
+      cmds = model->num_cmds;
+      cfgi = model->num_cfgi;
+      tlbi = model->num_tlbi;
+      sync = model->num_sync;
+
+      num_sid = 1u << (pal_mmio_read(model->base + SMMUv3_IDR1) & 0x3F);
+      step = (num_sid > HOST_SMMU_STREAMS) ? (num_sid / HOST_SMMU_STREAMS) : 1;
+
+      for (s = 0; (s < HOST_SMMU_STREAMS) && (s < num_sid); s++) {
+          memset(&pgt_desc, 0, sizeof(pgt_desc));
+          memset(&master, 0, sizeof(master));
+          memset(mem_desc, 0, sizeof(mem_desc));
+
+          master.smmu_index = i;
+          master.streamid = s * step + (step > 1 ? s : 0);
+          master.stage2 = s & 1;
+          if (!master.stage2 && (s & 2)) {
+              master.ssid_bits = 11;
+              master.substreamid = HOST_SMMU_SSID;
+          }
+
+          pgt_desc.ias = val_smmu_get_info(SMMU_IN_ADDR_SIZE, i);
+          pgt_desc.oas = val_smmu_get_info(SMMU_OUT_ADDR_SIZE, i);
+          pgt_desc.stage = master.stage2 ? PGT_STAGE2 : PGT_STAGE1;
+          pgt_desc.tcr.tg_size_log2 = page_log2;
+          pgt_desc.tcr.tg = (page_log2 == 16) ? 1 : ((page_log2 == 14) ? 2 : 0);
+          pgt_desc.tcr.tsz = 64 - pgt_desc.ias;
+          num_levels = (pgt_desc.ias - page_log2 + bits - 1) / bits;
+          pgt_desc.tcr.sl = ((page_log2 == 12) ? 2 : 3) - (4 - num_levels);
+
+          /* Half of the streams start their region a page past the block
+             boundary, so the tables mix pages and blocks across windows */
+          mem_desc[0].virtual_address = HOST_SMMU_IOVA;
+          mem_desc[0].physical_address = HOST_SMMU_PA + (uint64_t)s * 0x400000;
+          if (s & 4) {
+              mem_desc[0].virtual_address += val_memory_page_size();
+              mem_desc[0].physical_address += val_memory_page_size();
+          }
+          mem_desc[0].length = HOST_SMMU_LENGTH;
+          mem_desc[0].attributes = master.stage2 ? PGT_STAGE2_AP_RW : PGT_STAGE1_AP_RW;
+
+          if (val_pgt_create(mem_desc, &pgt_desc)) {
+              printf("\n       SMMU %u sid 0x%x: page table creation failed", i, master.streamid);
+              fail++;
+              continue;
+          }
+
+          if (val_smmu_map(master, pgt_desc)) {
+              printf("\n       SMMU %u sid 0x%x: map failed", i, master.streamid);
+              fail++;
+          } else {
+              fail += host_smmu_check(i, master.streamid, master.substreamid,
+                                      mem_desc[0].virtual_address,
+                                      mem_desc[0].physical_address, 1);
+              val_smmu_unmap(master);
+              fail += host_smmu_check(i, master.streamid, master.substreamid,
+                                      mem_desc[0].virtual_address,
+                                      mem_desc[0].physical_address, 0);
+          }
+          val_pgt_destroy(pgt_desc);
+      }
+
+      cmds = model->num_cmds - cmds;
+      cfgi = model->num_cfgi - cfgi;
+      tlbi = model->num_tlbi - tlbi;
+      sync = model->num_sync - sync;
+      printf("\n     SMMU %u : %u streams, commands %lu (invalidations %lu, syncs %lu)",
+             i, s, (unsigned long)cmds, (unsigned long)(cfgi + tlbi), (unsigned long)sync);
+      if ((val_smmu_get_info(SMMU_CMDQ_NUM_CMDS, i) != cmds) ||
+          (val_smmu_get_info(SMMU_CMDQ_NUM_INV, i) != cfgi + tlbi) ||
+          (val_smmu_get_info(SMMU_CMDQ_NUM_SYNC, i) != sync)) {
+          printf("\n       driver counted commands %lu (invalidations %lu, syncs %lu)",
+                 (unsigned long)val_smmu_get_info(SMMU_CMDQ_NUM_CMDS, i),
+                 (unsigned long)val_smmu_get_info(SMMU_CMDQ_NUM_INV, i),
+                 (unsigned long)val_smmu_get_info(SMMU_CMDQ_NUM_SYNC, i));
+          fail++;
+      }
+  }
+  printf("\n");
+
+  val_smmu_stop();
+  return fail;
+}
+
+/* Send an MSI from devid and check the LPI it makes pending, 0 if it should be dropped */
+static uint32_t
+host_its_check(uint32_t devid, uint32_t addr, uint32_t data, uint32_t expect_intid)
+{
+  uint32_t intid = 0;
+  uint32_t dropped = pal_host_its_msi(devid, addr, data, &intid);
+
+  if (expect_intid == 0) {
+      if (dropped)
+          return 0;
+      printf("\n       ITS DeviceID 0x%x EventID 0x%x: LPI 0x%x pending after unmap",
+             devid, data, intid);
+      return 1;
+  }
+
+  if (dropped || (intid != expect_intid) || !pal_host_its_ack(intid)) {
+      printf("\n       ITS DeviceID 0x%x EventID 0x%x: LPI 0x%x not delivered",
+             devid, data, expect_intid);
+      return 1;
+  }
+  return 0;
+}
+
+/**
+  @brief  Drive the ITS model with the UEFI PAL's ITS driver: map a vector on
+          its own and a range of vectors in one batch, deliver MSIs through
+          GITS_TRANSLATER, unmap, and check the commands the model consumed
+          are the ones each request has to issue
+
+  @return Number of failures
+**/
+static uint32_t
+host_its_run(uint32_t num_vectors)
+{
+  PAL_HOST_ITS *model = &g_pal_host.its;
+  uint32_t expect[16] = {0};
+  uint32_t addr, data, i, cmds = 0, fail = 0;
+
+  if (pal_host_gic_its_configure()) {
+      printf("\n       ITS initialisation failed\n");
+      return 1;
+  }
+
+  if (pal_gic_request_msi(0, HOST_ITS_DEVID, HOST_ITS_LPI, 0, &addr, &data)) {
+      printf("\n       ITS DeviceID 0x%x: MSI request failed", HOST_ITS_DEVID);
+      fail++;
+  } else {
+      fail += host_its_check(HOST_ITS_DEVID, addr, data, HOST_ITS_LPI);
+      pal_gic_free_msi(0, HOST_ITS_DEVID, HOST_ITS_LPI, 0);
+      fail += host_its_check(HOST_ITS_DEVID, addr, data, 0);
+      /* MAPD, MAPC, MAPTI, INV, SYNC then DISCARD, SYNC */
+      expect[0x8]++; expect[0x9]++; expect[0xA]++; expect[0xC]++; expect[0x5] += 2; expect[0xF]++;
+  }
+
+  if (pal_gic_request_msi_range(0, HOST_ITS_RANGE_DEVID, HOST_ITS_RANGE_LPI, 0, num_vectors,
+                                &addr, &data)) {
+      printf("\n       ITS DeviceID 0x%x: MSI range request failed", HOST_ITS_RANGE_DEVID);
+      fail++;
+  } else {
+      for (i = 0; i < num_vectors; i++)
+          fail += host_its_check(HOST_ITS_RANGE_DEVID, addr, data + i, HOST_ITS_RANGE_LPI + i);
+      fail += host_its_check(HOST_ITS_RANGE_DEVID, addr, data + num_vectors, 0);
+      for (i = 0; i < num_vectors; i++) {
+          pal_gic_free_msi(0, HOST_ITS_RANGE_DEVID, HOST_ITS_RANGE_LPI + i, i);
+          fail += host_its_check(HOST_ITS_RANGE_DEVID, addr, data + i, 0);
+      }
+      /* MAPD, MAPC, a MAPTI per vector, INVALL, SYNC then DISCARD, SYNC per vector */
+      expect[0x8]++; expect[0x9]++; expect[0xA] += num_vectors; expect[0xD]++;
+      expect[0x5] += 1 + num_vectors; expect[0xF] += num_vectors;
+  }
+
+  for (i = 0; i < 16; i++) {
+      cmds += model->num_cmds[i];
+      if (model->num_cmds[i] != expect[i]) {
+          printf("\n       ITS command 0x%x issued %u times, expected %u", i, model->num_cmds[i], expect[i]);
+          fail++;
+      }
+  }
+  if (model->num_errors) {
+      printf("\n       ITS model rejected %u commands", model->num_errors);
+      fail++;
+  }
+
+  printf("\n     ITS 0 : %u vectors, commands %u (redundant SYNC %u, INV %u), LPIs delivered %u\n",
+         num_vectors + 1, cmds, model->redundant_sync, model->redundant_inv, model->num_delivered);
+  return fail;
+}
+
+/* Type of addr in the memory map the PAL was given, walked in order */
+static uint64_t
+host_memmap_type(uint64_t addr)
+{
+  static const uint64_t type[] = {MEM_TYPE_NORMAL, MEM_TYPE_DEVICE, MEM_TYPE_RESERVED};
+  uint32_t i;
+
+  for (i = 0; i < g_pal_host.num_mem; i++) {
+      if ((addr >= g_pal_host.mem[i].base) &&
+          (addr < g_pal_host.mem[i].base + g_pal_host.mem[i].size))
+          return type[g_pal_host.mem[i].type];
+  }
+
+  return MEM_TYPE_NOT_POPULATED;
+}
+
+/**
+  @brief  Look addresses spread over the memory map up with val_memory_get_info,
+          which binary searches the sorted and merged info table, and with a
+          walk of the PAL's map, checking both classify every address the same
+
+  @return Number of failures
+**/
+static uint32_t
+host_memmap_run(MEMORY_INFO_TABLE *table)
+{
+  uint64_t first = g_pal_host.mem[0].base;
+  uint64_t last = g_pal_host.mem[g_pal_host.num_mem - 1].base +
+                  g_pal_host.mem[g_pal_host.num_mem - 1].size;
+  uint64_t *addr, *found;
+  uint64_t attr, seed = 1, start, t_search, t_walk;
+  uint32_t i, num_entries = 0, fail = 0;
+
+  addr = malloc(HOST_MEMMAP_LOOKUPS * sizeof(uint64_t));
+  found = malloc(HOST_MEMMAP_LOOKUPS * sizeof(uint64_t));
+  if (!addr || !found) {
+      free(addr);
+      free(found);
+      printf("\n       Out of memory for the memory map lookups\n");
+      return 1;
+  }
+
+  while (table->info[num_entries].type != MEMORY_TYPE_LAST_ENTRY)
+      num_entries++;
+
+  for (i = 0; i < HOST_MEMMAP_LOOKUPS; i++) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      addr[i] = first + (seed >> 11) % (last - first);
+  }
+
+  start = pal_host_counter_read(NULL);
+  for (i = 0; i < HOST_MEMMAP_LOOKUPS; i++)
+      found[i] = val_memory_get_info(addr[i], &attr);
+  t_search = pal_host_counter_read(NULL) - start;
+
+  start = pal_host_counter_read(NULL);
+  for (i = 0; i < HOST_MEMMAP_LOOKUPS; i++) {
+      if (host_memmap_type(addr[i]) != found[i]) {
+          if (!fail)
+              printf("\n       Memory map: 0x%llx classified as 0x%llx", (unsigned long long)addr[i],
+                     (unsigned long long)found[i]);
+          fail++;
+      }
+  }
+  t_walk = pal_host_counter_read(NULL) - start;
+
+  printf("\n     Memory map : %u regions, %u after merging, lookup %lu ns (walk %lu ns)\n",
+         g_pal_host.num_mem, num_entries, (unsigned long)(t_search / HOST_MEMMAP_LOOKUPS),
+         (unsigned long)(t_walk / HOST_MEMMAP_LOOKUPS));
+
+  free(found);
+  free(addr);
+  return fail ? 1 : 0;
+}
+
+static int
+host_load_ecam(char *arg)
+{
+  unsigned long long base = 0x40000000;
+  unsigned int seg = 0, bus = 0;
+  char *at = strchr(arg, '@');
+
+  if (at) {
+      *at++ = '\0';
+      if (sscanf(at, "%lli,%u,%u", &base, &seg, &bus) < 1) {
+          fprintf(stderr, "Invalid ECAM location `%s'.\n", at);
+          return 1;
+      }
+  }
+
+  return pal_host_load_ecam(arg, base, seg, bus);
+}
+
+int
+main(int argc, char **argv)
+{
+  void *pe_table, *pcie_table, *per_table, *iovirt_table, *dma_table, *mem_table = NULL;
+  uint32_t pe, rp, ep;
+  uint32_t iterations = 1, iter;
+  uint32_t smmu_fail = 0, its_fail = 0, its_vectors = 0, memmap_fail = 0, memmap_synth = 0;
+  uint64_t start, t_tables, t_tests = 0;
+  int described = 0;
+  int c;
+
+  struct option long_opt[] =
+  {
+    {"ecam",       required_argument, NULL, 'e'},
+    {"memmap",     required_argument, NULL, 'm'},
+    {"madt",       required_argument, NULL, 'a'},
+    {"synth",      required_argument, NULL, 'y'},
+    {"smmu",       required_argument, NULL, 'u'},
+    {"its",        required_argument, NULL, 'g'},
+    {"memmap-synth", required_argument, NULL, 'n'},
+    {"tests",      required_argument, NULL, 's'},
+    {"skip",       required_argument, NULL, 'x'},
+    {"time",       no_argument,       NULL, 'w'},
+    {"cost-order", no_argument,       NULL, 'c'},
+    {"iterations", required_argument, NULL, 'i'},
+    {"help",       no_argument,       NULL, 'h'},
+    {NULL, 0, NULL, 0}
+  };
+
+  val_test_select_clear();
+
+  while ((c = getopt_long(argc, argv, "v:h", long_opt, NULL)) != -1) {
+      switch (c) {
+      case 'v':
+        g_print_level = strtoul(optarg, NULL, 0);
+        if ((g_print_level < ACS_PRINT_INFO) || (g_print_level > ACS_PRINT_ERR))
+            g_print_level = ACS_PRINT_TEST;
+        break;
+      case 'e':
+        if (host_load_ecam(optarg))
+            return 1;
+        described = 1;
+        break;
+      case 'm':
+        if (pal_host_load_memmap(optarg))
+            return 1;
+        break;
+      case 'a':
+        if (pal_host_load_madt(optarg))
+            return 1;
+        break;
+      case 'y':
+        if ((sscanf(optarg, "%u,%u,%u", &pe, &rp, &ep) != 3) ||
+            pal_host_synth_platform(pe, rp, ep)) {
+            fprintf(stderr, "Invalid synthetic platform `%s'.\n", optarg);
+            return 1;
+        }
+        described = 1;
+        break;
+      case 'u':
+        if (host_add_smmus(optarg)) {
+            fprintf(stderr, "Invalid SMMU description `%s'.\n", optarg);
+            return 1;
+        }
+        break;
+      case 'g':
+        its_vectors = strtoul(optarg, NULL, 0);
+        if ((its_vectors == 0) || (its_vectors > HOST_ITS_MAX_VECTORS) || pal_host_add_its()) {
+            fprintf(stderr, "Invalid number of ITS vectors `%s'.\n", optarg);
+            return 1;
+        }
+        break;
+      case 'n':
+        memmap_synth = strtoul(optarg, NULL, 0);
+        if ((memmap_synth == 0) || pal_host_synth_memmap(memmap_synth)) {
+            fprintf(stderr, "Invalid synthetic memory map `%s'.\n", optarg);
+            return 1;
+        }
+        break;
+      case 's':
+      case 'x':
+        if (host_select(optarg, c == 'x'))
+            return 1;
+        break;
+      case 'w':
+        val_test_select_timing(1);
+        break;
+      case 'c':
+        val_test_select_order(1);
+        break;
+      case 'i':
+        iterations = strtoul(optarg, NULL, 0);
+        if (iterations == 0)
+            iterations = 1;
+        break;
+      case 'h':
+        host_usage(argv[0]);
+        return 0;
+      default:
+        host_usage(argv[0]);
+        return 1;
+      }
+  }
+
+  if (!described) {
+      fprintf(stderr, "Describe the platform with --ecam or --synth.\n");
+      host_usage(argv[0]);
+      return 1;
+  }
+
+  printf("\n ************ BSA Architecture Compliance Suite (host PAL) *********\n");
+
+  start = host_now_us();
+
+  pe_table = calloc(1, PE_INFO_TABLE_SZ);
+  pcie_table = calloc(1, PCIE_INFO_TABLE_SZ);
+  per_table = calloc(1, PERIPHERAL_INFO_TABLE_SZ);
+  iovirt_table = calloc(1, IOVIRT_INFO_TABLE_SZ);
+  dma_table = calloc(1, DMA_INFO_TABLE_SZ);
+  if (!pe_table || !pcie_table || !per_table || !iovirt_table || !dma_table) {
+      fprintf(stderr, "Out of memory for the info tables.\n");
+      return 1;
+  }
+
+  if (val_pe_create_info_table(pe_table))
+      return 1;
+  val_allocate_shared_mem();
+  val_pcie_create_info_table(pcie_table);
+  val_iovirt_create_info_table(iovirt_table);
+  val_peripheral_create_info_table(per_table);
+  val_dma_create_info_table(dma_table);
+  if (g_pal_host.num_mem) {
+      mem_table = calloc(1, val_memory_get_info_table_size());
+      if (mem_table == NULL) {
+          fprintf(stderr, "Out of memory for the memory info table.\n");
+          return 1;
+      }
+      val_memory_create_info_table(mem_table);
+  }
+
+  t_tables = host_now_us() - start;
+  val_startup_report();
+
+  for (iter = 0; iter < iterations; iter++) {
+      g_bsa_tests_total = 0;
+      g_bsa_tests_pass = 0;
+      g_bsa_tests_fail = 0;
+
+      start = host_now_us();
+      val_run_modules(g_host_modules, sizeof(g_host_modules) / sizeof(g_host_modules[0]), g_sw_view);
+      t_tests += host_now_us() - start;
+  }
+
+  printf("\n     -------------------------------------------------------\n");
+  printf("     Total Tests run  = %4d  Tests Passed  = %4d  Tests Failed = %4d\n",
+         g_bsa_tests_total, g_bsa_tests_pass, g_bsa_tests_fail);
+  printf("     -------------------------------------------------------\n");
+  printf("     Info tables : %lu us, tests : %lu us per iteration\n",
+         (unsigned long)t_tables, (unsigned long)(t_tests / iterations));
+
+  if (g_pal_host.num_smmu)
+      smmu_fail = host_smmu_run();
+  if (g_pal_host.num_its)
+      its_fail = host_its_run(its_vectors);
+  if (memmap_synth)
+      memmap_fail = host_memmap_run(mem_table);
+
+  val_free_shared_mem();
+  free(mem_table);
+  free(dma_table);
+  free(iovirt_table);
+  free(per_table);
+  free(pcie_table);
+  free(pe_table);
+  pal_host_reset();
+
+  return (g_bsa_tests_fail || smmu_fail || its_fail || memmap_fail) ? 2 : 0;
+}
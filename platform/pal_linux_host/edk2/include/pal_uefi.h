@@ -0,0 +1,3 @@
+/* SPDX-License-Identifier : Apache-2.0 */
+/* Stand-in for the UEFI PAL header of this name, see pal_host_edk2.h */
+#include "pal_host_edk2.h"
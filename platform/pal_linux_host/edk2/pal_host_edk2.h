@@ -0,0 +1,115 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef __PAL_HOST_EDK2_H__
+#define __PAL_HOST_EDK2_H__
+
+/*
+ * The EDK2 types and library calls the UEFI PAL's ITS driver uses, so that
+ * platform/pal_uefi/src_gic_its builds into bsa_host unchanged. Every EDK2
+ * header that driver includes is a stub including this one. MMIO goes through
+ * the host PAL, page allocations are identity mapped host memory described to
+ * the PAL as a region, so the ITS model can read the tables the driver builds.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t   UINT8;
+typedef uint16_t  UINT16;
+typedef uint32_t  UINT32;
+typedef uint64_t  UINT64;
+typedef int64_t   INT64;
+typedef uint64_t  UINTN;
+typedef int64_t   INTN;
+typedef char      CHAR8;
+typedef uint8_t   BOOLEAN;
+typedef UINTN     EFI_STATUS;
+typedef UINT64    EFI_PHYSICAL_ADDRESS;
+
+#define VOID      void
+#define IN
+#define OUT
+#define EFIAPI
+#define CONST     const
+
+#define EFI_SUCCESS           0
+#define EFI_UNSUPPORTED       (0x8000000000000000ULL | 3)
+#define EFI_NOT_READY         (0x8000000000000000ULL | 6)
+#define EFI_OUT_OF_RESOURCES  (0x8000000000000000ULL | 9)
+#define EFI_ERROR(Status)     ((INTN)(EFI_STATUS)(Status) < 0)
+
+#define SIZE_4KB              0x00001000
+#define SIZE_64KB             0x00010000
+#define EFI_PAGE_SIZE         SIZE_4KB
+#define EFI_SIZE_TO_PAGES(Size)   (((Size) + EFI_PAGE_SIZE - 1) / EFI_PAGE_SIZE)
+#define EFI_PAGES_TO_SIZE(Pages)  ((UINTN)(Pages) * EFI_PAGE_SIZE)
+
+/* ArmLib.h, ArmGicLib.h */
+#define ARM_CORE_AFF0                 0xFF
+#define ARM_CORE_AFF1                 (0xFF << 8)
+#define ARM_CORE_AFF2                 (0xFF << 16)
+#define ARM_CORE_AFF3                 (0xFFULL << 32)
+#define ARM_GICR_TYPER                0x0008
+#define ARM_GICR_CTLR_FRAME_SIZE      SIZE_64KB
+#define ARM_GICR_SGI_PPI_FRAME_SIZE   SIZE_64KB
+
+/* DebugLib.h, printed by the host PAL at its DEBUG and ERR levels */
+#define DEBUG_INFO            0x00000040
+#define DEBUG_ERROR           0x80000000
+#define DEBUG(Expression)     pal_host_edk2_debug Expression
+
+void pal_host_edk2_debug(UINTN level, const CHAR8 *format, ...);
+
+/* IoLib.h */
+uint8_t  pal_mmio_read8(uint64_t addr);
+uint32_t pal_mmio_read(uint64_t addr);
+uint64_t pal_mmio_read64(uint64_t addr);
+void     pal_mmio_write8(uint64_t addr, uint8_t data);
+void     pal_mmio_write(uint64_t addr, uint32_t data);
+void     pal_mmio_write64(uint64_t addr, uint64_t data);
+
+#define MmioRead8(Address)          pal_mmio_read8(Address)
+#define MmioRead32(Address)         pal_mmio_read(Address)
+#define MmioRead64(Address)         pal_mmio_read64(Address)
+#define MmioWrite8(Address, Value)  pal_mmio_write8(Address, Value)
+#define MmioWrite32(Address, Value) pal_mmio_write(Address, Value)
+#define MmioWrite64(Address, Value) pal_mmio_write64(Address, Value)
+
+/* MemoryAllocationLib.h, BaseMemoryLib.h, UefiBootServicesTableLib.h */
+VOID *AllocatePool(UINTN AllocationSize);
+VOID *AllocateZeroPool(UINTN AllocationSize);
+VOID *AllocateAlignedPages(UINTN Pages, UINTN Alignment);
+VOID *ZeroMem(VOID *Buffer, UINTN Length);
+
+#define AllocateAnyPages      0
+#define EfiBootServicesData   4
+
+typedef struct {
+  EFI_STATUS (*AllocatePages)(UINT32 Type, UINT32 MemoryType, UINTN Pages,
+                              EFI_PHYSICAL_ADDRESS *Memory);
+} EFI_BOOT_SERVICES;
+
+extern EFI_BOOT_SERVICES *gBS;
+
+/* TimerLib.h, the host counter runs at 1GHz */
+uint64_t pal_host_counter_read(uint64_t *freq);
+
+#define GetPerformanceCounter()     pal_host_counter_read(NULL)
+#define GetTimeInNanoSecond(Ticks)  (Ticks)
+
+#endif
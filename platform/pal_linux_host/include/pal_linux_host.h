@@ -0,0 +1,171 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#ifndef __PAL_LINUX_HOST_H__
+#define __PAL_LINUX_HOST_H__
+
+/*
+ * User-space PAL for running the Linux build of VAL on any host. The platform is
+ * described to the PAL, synthetically or from files, before the VAL info tables
+ * are created: ECAM images, a memory map and an ACPI MADT. Physical addresses
+ * that fall in a registered region are backed by host memory; everything else
+ * reads as all ones and ignores writes, as an unclaimed access would.
+ */
+
+#include <stdio.h>
+#include "val/include/pal_interface.h"
+
+extern uint32_t g_print_level;
+
+#define ACS_PRINT_ERR   5      /* Only Errors. use this to de-clutter the terminal and focus only on specifics */
+#define ACS_PRINT_WARN  4      /* Only warnings & errors. use this to de-clutter the terminal and focus only on specifics */
+#define ACS_PRINT_TEST  3      /* Test description and result descriptions. THIS is DEFAULT */
+#define ACS_PRINT_DEBUG 2      /* For Debug statements. contains register dumps etc */
+#define ACS_PRINT_INFO  1      /* Print all statements. Do not use unless really needed */
+
+#define host_print(verbose, ...) do { if ((verbose) >= g_print_level) printf(__VA_ARGS__); } while (0)
+
+#define PAL_HOST_MAX_REGIONS   32
+#define PAL_HOST_MAX_ECAM      8
+#define PAL_HOST_MAX_SMMU      4
+
+#define PAL_HOST_SMMU_BASE     0x2B400000ULL
+#define PAL_HOST_SMMU_SIZE     0x20000    /* Two 64KB register pages */
+#define PAL_HOST_SMMU_REGS     0x100      /* Registers the model implements */
+
+#define PAL_HOST_GICD_BASE     0x2F000000ULL
+#define PAL_HOST_GICD_SIZE     0x10000
+#define PAL_HOST_GICD_REGS     0x10
+#define PAL_HOST_ITS_BASE      0x2F020000ULL
+#define PAL_HOST_ITS_SIZE      0x20000    /* Control and translation register pages */
+#define PAL_HOST_ITS_REGS      0x140
+#define PAL_HOST_GICR_BASE     0x2F100000ULL
+#define PAL_HOST_GICR_SIZE     0x20000    /* RD_base and SGI_base frames of one PE */
+#define PAL_HOST_GICR_REGS     0x80
+#define PAL_HOST_ITS_NUM_LPIS  ((1 << 16) - 8192)
+
+#define PAL_HOST_ECAM_BUS_SIZE (1 << 20)  /* 32 devices x 8 functions x 4KB */
+#define PAL_HOST_CFG_SIZE      4096
+
+/* Sizes of the info tables bsa_host allocates. The VAL passes INFO_TABLE_UNSIZED
+   for them, so the PAL bounds its writes by these instead. */
+#define PE_INFO_TABLE_SZ          16384
+#define PCIE_INFO_TABLE_SZ        4096
+#define PERIPHERAL_INFO_TABLE_SZ  8192
+#define IOVIRT_INFO_TABLE_SZ      1048576
+
+#define PAL_HOST_TABLE_ENTRIES(max, size, table, entry) \
+  (((max) != INFO_TABLE_UNSIZED) ? (max) : (uint32_t)(((size) - sizeof(table)) / sizeof(entry)))
+
+typedef enum {
+  PAL_HOST_MEM_RAM = 0,
+  PAL_HOST_MEM_DEVICE,
+  PAL_HOST_MEM_RESERVED
+} PAL_HOST_MEM_TYPE_e;
+
+/* A physical address range backed by host memory */
+typedef struct {
+  uint64_t base;
+  uint64_t size;
+  uint8_t  *host;
+  uint32_t owned;        /* 1: malloc'ed by the PAL, 2: mapped from a file */
+} PAL_HOST_REGION;
+
+typedef struct {
+  uint64_t base;
+  uint64_t size;
+  uint32_t type;         /* PAL_HOST_MEM_TYPE_e */
+} PAL_HOST_MEM;
+
+/* SMMUv3 register model: the command queue is consumed on each CMDQ_PROD write */
+typedef struct {
+  uint64_t base;
+  uint8_t  regs[PAL_HOST_SMMU_REGS];
+  uint64_t num_cmds;
+  uint64_t num_cfgi;
+  uint64_t num_tlbi;
+  uint64_t num_sync;
+} PAL_HOST_SMMU;
+
+/* GICv3 ITS model with the distributor and the one redistributor it targets.
+   Commands are consumed on each CWRITER write and counted by opcode. */
+typedef struct {
+  uint8_t  gicd_regs[PAL_HOST_GICD_REGS];
+  uint8_t  its_regs[PAL_HOST_ITS_REGS];
+  uint8_t  gicr_regs[PAL_HOST_GICR_REGS];
+  uint8_t  lpi_cfg[PAL_HOST_ITS_NUM_LPIS];          /* configuration the RD has cached */
+  uint8_t  lpi_cached[PAL_HOST_ITS_NUM_LPIS / 8];
+  uint32_t num_cmds[16];                            /* by opcode, others counted as 0 */
+  uint32_t num_errors;
+  uint32_t cmds_since_sync;
+  uint32_t redundant_sync;                          /* SYNC with nothing to synchronise */
+  uint32_t redundant_inv;                           /* INV/INVALL that changed no cached config */
+  uint32_t num_delivered;
+} PAL_HOST_ITS;
+
+typedef struct {
+  PAL_HOST_REGION  region[PAL_HOST_MAX_REGIONS];
+  uint32_t         num_region;
+  uint32_t         last_region;        /* lookup hint, accesses come in runs */
+  PCIE_INFO_BLOCK  ecam[PAL_HOST_MAX_ECAM];
+  uint32_t         num_ecam;
+  PAL_HOST_MEM     *mem;               /* sorted by base, grown as entries are added */
+  uint32_t         num_mem;
+  uint32_t         max_mem;
+  uint8_t          *madt;
+  uint32_t         madt_len;
+  PAL_HOST_SMMU    smmu[PAL_HOST_MAX_SMMU];
+  uint32_t         num_smmu;
+  PAL_HOST_ITS     its;
+  uint32_t         num_its;
+} PAL_HOST_PLATFORM;
+
+extern PAL_HOST_PLATFORM g_pal_host;
+
+/* Platform description, called before the VAL create_info_table APIs */
+void     pal_host_reset(void);
+uint32_t pal_host_add_region(uint64_t base, uint64_t size, void *host);
+uint32_t pal_host_add_ecam(uint64_t base, uint32_t segment, uint32_t start_bus,
+                           uint32_t end_bus, void *cfg);
+uint32_t pal_host_add_mem(uint64_t base, uint64_t size, uint32_t type);
+uint32_t pal_host_set_madt(const void *madt, uint32_t length);
+uint32_t pal_host_load_ecam(const char *path, uint64_t base, uint32_t segment, uint32_t start_bus);
+uint32_t pal_host_load_memmap(const char *path);
+uint32_t pal_host_load_madt(const char *path);
+uint32_t pal_host_synth_platform(uint32_t num_pe, uint32_t num_rp, uint32_t num_ep);
+uint32_t pal_host_synth_memmap(uint32_t num_regions);
+uint32_t pal_host_add_smmu(uint64_t base, uint32_t sid_bits);
+uint32_t pal_host_add_its(void);
+
+/* SMMUv3 model. The accessors return 1 when addr is an SMMU register */
+uint32_t pal_host_smmu_read(uint64_t addr, uint32_t size, uint64_t *data);
+uint32_t pal_host_smmu_write(uint64_t addr, uint32_t size, uint64_t data);
+uint32_t pal_host_smmu_translate(uint32_t index, uint32_t sid, uint32_t ssid, uint64_t iova,
+                                 uint64_t *pa);
+
+/* GICv3 ITS model. The accessors return 1 when addr is a GICD, GICR or ITS register */
+uint32_t pal_host_its_read(uint64_t addr, uint32_t size, uint64_t *data);
+uint32_t pal_host_its_write(uint64_t addr, uint32_t size, uint64_t data);
+uint32_t pal_host_its_msi(uint32_t devid, uint64_t addr, uint32_t data, uint32_t *intid);
+uint32_t pal_host_its_ack(uint32_t intid);
+uint32_t pal_host_gic_its_configure(void);
+
+/* Host pointer behind a physical address range, NULL if it is not backed */
+void    *pal_host_phys_to_host(uint64_t addr, uint32_t len);
+uint8_t *pal_host_cfg_space(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn);
+
+#endif
@@ -0,0 +1,207 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "include/pal_linux_host.h"
+#include "platform/pal_uefi/src_gic_its/bsa_gic_its.h"
+
+/*
+ * The MSI half of the UEFI PAL's pal_gic.c, over the UEFI ITS driver built
+ * from platform/pal_uefi/src_gic_its against the ITS model, and the EDK2
+ * services that driver needs (see edk2/pal_host_edk2.h).
+ */
+
+GIC_ITS_INFO *g_gic_its_info;
+
+UINT64
+ArmReadMpidr (
+  VOID
+  )
+{
+  return 0;
+}
+
+VOID
+pal_host_edk2_debug(UINTN level, const CHAR8 *format, ...)
+{
+  char fmt[256];
+  char *pt;
+  va_list args;
+
+  if (((level & DEBUG_ERROR) ? ACS_PRINT_ERR : ACS_PRINT_DEBUG) < g_print_level)
+      return;
+
+  /* %a is the EDK2 conversion for an ASCII string */
+  snprintf(fmt, sizeof(fmt), "%s", format);
+  for (pt = strstr(fmt, "%a"); pt != NULL; pt = strstr(pt + 2, "%a"))
+      pt[1] = 's';
+
+  va_start(args, format);
+  vprintf(fmt, args);
+  va_end(args);
+}
+
+VOID *
+AllocatePool (
+  UINTN  AllocationSize
+  )
+{
+  return malloc(AllocationSize);
+}
+
+VOID *
+AllocateZeroPool (
+  UINTN  AllocationSize
+  )
+{
+  return calloc(1, AllocationSize);
+}
+
+/* Pages are device visible: identity mapped and described to the PAL as a region,
+   which pal_host_reset frees with the others */
+VOID *
+AllocateAlignedPages (
+  UINTN  Pages,
+  UINTN  Alignment
+  )
+{
+  void *buffer;
+
+  if (Alignment < EFI_PAGE_SIZE)
+      Alignment = EFI_PAGE_SIZE;
+  if (posix_memalign(&buffer, Alignment, EFI_PAGES_TO_SIZE(Pages)))
+      return NULL;
+  if (pal_host_add_region((uint64_t)(uintptr_t)buffer, EFI_PAGES_TO_SIZE(Pages), buffer)) {
+      free(buffer);
+      return NULL;
+  }
+  g_pal_host.region[g_pal_host.num_region - 1].owned = 1;
+  return buffer;
+}
+
+VOID *
+ZeroMem (
+  VOID   *Buffer,
+  UINTN  Length
+  )
+{
+  return memset(Buffer, 0, Length);
+}
+
+static EFI_STATUS
+host_allocate_pages (
+  UINT32                Type,
+  UINT32                MemoryType,
+  UINTN                 Pages,
+  EFI_PHYSICAL_ADDRESS  *Memory
+  )
+{
+  VOID *buffer;
+
+  (void)Type;
+  (void)MemoryType;
+  buffer = AllocateAlignedPages(Pages, EFI_PAGE_SIZE);
+  if (buffer == NULL)
+      return EFI_OUT_OF_RESOURCES;
+  *Memory = (EFI_PHYSICAL_ADDRESS)(uintptr_t)buffer;
+  return EFI_SUCCESS;
+}
+
+static EFI_BOOT_SERVICES g_host_boot_services = { host_allocate_pages };
+EFI_BOOT_SERVICES *gBS = &g_host_boot_services;
+
+/**
+  @brief  Describe the ITS model to the ITS driver and let it set the ITS and
+          the redistributor up, as pal_gic_its_configure does from the MADT
+
+  @return 0 on success, 0xFFFFFFFF on failure
+**/
+uint32_t
+pal_host_gic_its_configure(void)
+{
+  if (!g_pal_host.num_its)
+      return 0xFFFFFFFF;
+
+  free(g_gic_its_info);
+  g_gic_its_info = calloc(1, sizeof(GIC_ITS_INFO) + sizeof(GIC_ITS_BLOCK));
+  if (g_gic_its_info == NULL)
+      return 0xFFFFFFFF;
+
+  g_gic_its_info->GicDBase = PAL_HOST_GICD_BASE;
+  g_gic_its_info->GicRdBase = PAL_HOST_GICR_BASE;
+  g_gic_its_info->GicIts[0].ID = 0;
+  g_gic_its_info->GicIts[0].Base = PAL_HOST_ITS_BASE;
+  g_gic_its_info->GicNumIts = 1;
+
+  if (!ArmGICDSupportsLPIs(g_gic_its_info->GicDBase) ||
+      !ArmGICRSupportsLPIs(g_gic_its_info->GicRdBase))
+      return 0xFFFFFFFF;
+
+  if (EFI_ERROR(ArmGicItsConfiguration()))
+      return 0xFFFFFFFF;
+
+  return 0;
+}
+
+uint32_t
+pal_gic_get_max_lpi_id(void)
+{
+  return ArmGicItsGetMaxLpiID();
+}
+
+uint32_t
+pal_gic_request_msi(uint32_t its_id, uint32_t DevID, uint32_t IntID, uint32_t msi_index,
+                    uint32_t *msi_addr, uint32_t *msi_data)
+{
+  if ((g_gic_its_info == NULL) || (its_id != g_gic_its_info->GicIts[0].ID))
+      return 0xFFFFFFFF;
+
+  if (EFI_ERROR(ArmGicItsCreateLpiMap(0, DevID, msi_index, IntID, LPI_PRIORITY1)))
+      return 0xFFFFFFFF;
+
+  *msi_addr = ArmGicItsGetGITSTranslatorAddress(0);
+  *msi_data = msi_index;
+  return 0;
+}
+
+uint32_t
+pal_gic_request_msi_range(uint32_t its_id, uint32_t DevID, uint32_t IntID, uint32_t msi_index,
+                          uint32_t num_vectors, uint32_t *msi_addr, uint32_t *msi_data)
+{
+  if ((g_gic_its_info == NULL) || (its_id != g_gic_its_info->GicIts[0].ID))
+      return 0xFFFFFFFF;
+
+  if (EFI_ERROR(ArmGicItsCreateLpiMapRange(0, DevID, msi_index, IntID, num_vectors,
+                                           LPI_PRIORITY1)))
+      return 0xFFFFFFFF;
+
+  *msi_addr = ArmGicItsGetGITSTranslatorAddress(0);
+  *msi_data = msi_index;
+  return 0;
+}
+
+void
+pal_gic_free_msi(uint32_t its_id, uint32_t DevID, uint32_t IntID, uint32_t msi_index)
+{
+  if ((g_gic_its_info == NULL) || (its_id != g_gic_its_info->GicIts[0].ID))
+      return;
+
+  ArmGicItsClearLpiMappings(0, DevID, msi_index, IntID);
+}
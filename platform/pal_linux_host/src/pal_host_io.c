@@ -0,0 +1,284 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <string.h>
+
+#include "include/pal_linux_host.h"
+#include "val/include/bsa_acs_pcie.h"
+
+#define USB_CLASSCODE   0x0C0300
+#define SATA_CLASSCODE  0x010600
+
+/*
+ * Peripherals, IO virtualization and DMA. Only the PCIe controllers found in
+ * the ECAM images are described, and no controller can be driven to perform
+ * DMA. There is no IORT: the IO virtualization table lists the modelled SMMUs
+ * alone, with no ID mappings.
+ */
+
+static uint32_t
+host_incr_bus_dev(uint32_t bdf)
+{
+  uint32_t dev = PCIE_EXTRACT_BDF_DEV(bdf);
+  uint32_t bus = PCIE_EXTRACT_BDF_BUS(bdf);
+
+  if (dev < 31)
+      return PCIE_CREATE_BDF(PCIE_EXTRACT_BDF_SEG(bdf), bus, (dev + 1), 0);
+  return PCIE_CREATE_BDF(PCIE_EXTRACT_BDF_SEG(bdf), (bus + 1), 0, 0);
+}
+
+/* Adds the controllers of one class code, stopping at last, the end marker slot */
+static PERIPHERAL_INFO_BLOCK *
+host_add_controllers(PERIPHERAL_INFO_BLOCK *per_info, PERIPHERAL_INFO_BLOCK *last,
+                     uint32_t class_code, PER_INFO_TYPE_e type, uint32_t *count)
+{
+  uint32_t start_bdf = 0;
+  uint32_t bdf;
+  uint32_t bar0;
+
+  while ((bdf = pal_pcie_get_bdf_wrapper(class_code, start_bdf)) != 0) {
+      if (per_info >= last) {
+          host_print(ACS_PRINT_WARN, " PERIPHERAL_INFO: Table full \n");
+          break;
+      }
+      memset(per_info, 0, sizeof(*per_info));
+      per_info->type = type;
+      per_info->bdf  = bdf;
+      if (pal_pcie_io_read_cfg(bdf, 0x10, &bar0) == 0)
+          per_info->base0 = bar0 & ~0xFu;
+      host_print(ACS_PRINT_INFO, "Found a controller at BDF %x \n", bdf);
+      (*count)++;
+      per_info++;
+
+      /* Stop at the last bus rather than wrap around to bus 0 */
+      if ((PCIE_EXTRACT_BDF_BUS(bdf) == 0xFF) && (PCIE_EXTRACT_BDF_DEV(bdf) == 31))
+          break;
+      start_bdf = host_incr_bus_dev(bdf);
+  }
+
+  return per_info;
+}
+
+/**
+  @brief  Fill the peripheral info table with the USB and SATA controllers
+          present in the ECAM images
+
+  @param  peripheralInfoTable  Address where the information needs to be filled
+  @param  max_entries          Number of entries the table has room for, end marker included
+
+  @return None
+**/
+void
+pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable, uint32_t max_entries)
+{
+  PERIPHERAL_INFO_BLOCK *per_info, *last;
+
+  if (peripheralInfoTable == NULL) {
+      host_print(ACS_PRINT_ERR, "Input Peripheral Table Pointer is NULL. Cannot create Peripheral INFO \n");
+      return;
+  }
+
+  peripheralInfoTable->header.num_usb = 0;
+  peripheralInfoTable->header.num_sata = 0;
+  peripheralInfoTable->header.num_uart = 0;
+  peripheralInfoTable->header.num_all = 0;
+
+  max_entries = PAL_HOST_TABLE_ENTRIES(max_entries, PERIPHERAL_INFO_TABLE_SZ, PERIPHERAL_INFO_TABLE,
+                                       PERIPHERAL_INFO_BLOCK);
+  if (max_entries == 0)
+      return;
+
+  per_info = peripheralInfoTable->info;
+  last = &peripheralInfoTable->info[max_entries - 1];
+  per_info = host_add_controllers(per_info, last, USB_CLASSCODE, PERIPHERAL_TYPE_USB,
+                                  &peripheralInfoTable->header.num_usb);
+  per_info = host_add_controllers(per_info, last, SATA_CLASSCODE, PERIPHERAL_TYPE_SATA,
+                                  &peripheralInfoTable->header.num_sata);
+
+  per_info->type = 0xFF; //indicate end of table
+}
+
+uint32_t
+pal_peripheral_is_pcie(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  return (pal_pcie_get_pcie_type(seg, bus, dev, fn) != 0xFFFFFFFF);
+}
+
+/**
+  @brief  Fill the IO virtualization info table with a block for each SMMUv3
+          model
+
+  @param  iovirt    Address where the information needs to be filled
+  @param  max_size  Size of the table in bytes
+
+  @return None
+**/
+void
+pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *iovirt, uint32_t max_size)
+{
+  IOVIRT_BLOCK *block;
+  uint32_t i;
+
+  if (iovirt == NULL)
+      return;
+
+  memset(iovirt, 0, sizeof(*iovirt));
+  if (max_size == INFO_TABLE_UNSIZED)
+      max_size = IOVIRT_INFO_TABLE_SZ;
+
+  block = &iovirt->blocks[0];
+  for (i = 0; i < g_pal_host.num_smmu; i++) {
+      if ((uint8_t *)(block + 1) > (uint8_t *)iovirt + max_size) {
+          host_print(ACS_PRINT_WARN, " IOVIRT_INFO: Table full \n");
+          break;
+      }
+      memset(block, 0, sizeof(*block));
+      block->type = IOVIRT_NODE_SMMU_V3;
+      block->data.smmu.arch_major_rev = 3;
+      block->data.smmu.base = g_pal_host.smmu[i].base;
+      iovirt->num_smmus++;
+      iovirt->num_blocks++;
+      block = IOVIRT_NEXT_BLOCK(block);
+  }
+}
+
+uint32_t
+pal_iovirt_check_unique_ctx_intid(uint64_t smmu_block)
+{
+  (void)smmu_block;
+  return 1;
+}
+
+uint32_t
+pal_iovirt_unique_rid_strid_map(uint64_t rc_block)
+{
+  (void)rc_block;
+  return 1;
+}
+
+uint64_t
+pal_iovirt_get_rc_smmu_base(IOVIRT_INFO_TABLE *iovirt, uint32_t rc_seg_num)
+{
+  (void)iovirt;
+  (void)rc_seg_num;
+  return 0;
+}
+
+uint32_t
+pal_smmu_check_device_iova(void *port, uint64_t dma_addr)
+{
+  (void)port;
+  (void)dma_addr;
+  return 0;
+}
+
+void
+pal_smmu_device_start_monitor_iova(void *port)
+{
+  (void)port;
+}
+
+void
+pal_smmu_device_stop_monitor_iova(void *port)
+{
+  (void)port;
+}
+
+uint32_t
+pal_smmu_max_pasids(uint64_t smmu_base)
+{
+  (void)smmu_base;
+  return 0;
+}
+
+uint32_t
+pal_smmu_create_pasid_entry(uint64_t smmu_base, uint32_t pasid)
+{
+  (void)smmu_base;
+  (void)pasid;
+  return 1;
+}
+
+uint64_t
+pal_smmu_pa2iova(uint64_t smmu_base, uint64_t pa)
+{
+  (void)smmu_base;
+  (void)pa;
+  return 0;
+}
+
+void
+pal_dma_create_info_table(DMA_INFO_TABLE *dma_info_table)
+{
+  if (dma_info_table != NULL)
+      dma_info_table->num_dma_ctrls = 0;
+}
+
+uint32_t
+pal_dma_start_from_device(void *dma_target_buf, uint32_t length, void *host, void *dev)
+{
+  (void)dma_target_buf; (void)length; (void)host; (void)dev;
+  return 1;
+}
+
+uint32_t
+pal_dma_start_to_device(void *dma_source_buf, uint32_t length, void *host, void *target,
+                        uint32_t timeout)
+{
+  (void)dma_source_buf; (void)length; (void)host; (void)target; (void)timeout;
+  return 1;
+}
+
+uint64_t
+pal_dma_mem_alloc(void **buffer, uint32_t length, void *dev, uint32_t flags)
+{
+  (void)dev;
+  (void)flags;
+  *buffer = pal_mem_alloc(length);
+  return (uint64_t)(uintptr_t)*buffer;
+}
+
+void
+pal_dma_mem_free(void *buffer, addr_t mem_dma, unsigned int length, void *port, unsigned int flags)
+{
+  (void)mem_dma; (void)length; (void)port; (void)flags;
+  pal_mem_free(buffer);
+}
+
+void
+pal_dma_scsi_get_dma_addr(void *port, void *dma_addr, uint32_t *dma_len)
+{
+  (void)port;
+  (void)dma_addr;
+  *dma_len = 0;
+}
+
+int
+pal_dma_mem_get_attrs(void *buf, uint32_t *attr, uint32_t *sh)
+{
+  (void)buf; (void)attr; (void)sh;
+  return 1;
+}
+
+/**
+  @brief  There is no GIC for the ACS to drive on the host
+**/
+uint32_t
+pal_bsa_gic_imp(void)
+{
+  return 0;
+}
@@ -0,0 +1,557 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <string.h>
+
+#include "include/pal_linux_host.h"
+
+/*
+ * GICv3 ITS model, with the GICD_TYPER and the single redistributor frame the
+ * UEFI PAL's ITS driver programs. The command queue is consumed as soon as
+ * CWRITER moves; device, collection and interrupt translation entries are
+ * kept in the tables the driver allocated, so a table too small for the IDs
+ * it is asked to map is an error here as it would be corruption on hardware.
+ * The redistributor caches LPI configuration until an INV or INVALL drops it,
+ * and an MSI to GITS_TRANSLATER sets the LPI pending in the pending table.
+ * Commands that cannot be executed are counted and skipped.
+ */
+
+#define GICD_TYPER          0x04
+#define GICD_TYPER_LPIS     (1u << 17)
+#define GICD_TYPER_IDBITS   19
+
+#define GITS_CTLR           0x00
+#define GITS_IIDR           0x04
+#define GITS_TYPER          0x08
+#define GITS_CBASER         0x80
+#define GITS_CWRITER        0x88
+#define GITS_CREADR         0x90
+#define GITS_BASER(n)       (0x100 + 8 * (n))
+#define GITS_TRANSLATER     0x10040
+
+#define GITS_CTLR_ENABLED   (1u << 0)
+#define GITS_CTLR_QUIESCENT (1u << 31)
+#define GITS_TYPER_PHYSICAL (1ULL << 0)
+#define GITS_TYPER_ITT_SZ   4
+#define GITS_TYPER_IDBITS   8
+#define GITS_TYPER_DEVBITS  13
+#define GITS_TYPER_PTA      (1ULL << 19)
+#define GITS_CBASER_VALID   (1ULL << 63)
+#define GITS_CREADR_STALLED (1ULL << 0)
+#define GITS_CWRITER_RETRY  (1ULL << 0)
+#define GITS_BASER_VALID    (1ULL << 63)
+#define GITS_BASER_RO       (0x7ULL << 56 | 0x1FULL << 48)
+#define GITS_BASER_DEVICE   1
+#define GITS_BASER_CLCN     4
+
+#define GICR_CTLR           0x00
+#define GICR_TYPER          0x08
+#define GICR_PROPBASER      0x70
+#define GICR_PENDBASER      0x78
+#define GICR_CTLR_ENLPIS    (1u << 0)
+#define GICR_TYPER_PLPIS    (1u << 0)
+#define GICR_TYPER_LAST     (1u << 4)
+
+#define CMD_MAPD            0x08
+#define CMD_MAPC            0x09
+#define CMD_MAPTI           0x0A
+#define CMD_MAPI            0x0B
+#define CMD_INV             0x0C
+#define CMD_INVALL          0x0D
+#define CMD_DISCARD         0x0F
+#define CMD_INT             0x03
+#define CMD_SYNC            0x05
+#define CMD_BYTES           32
+
+#define MODEL_ID_BITS       15        /* GICD and GITS IDbits fields, 16-bit INTIDs */
+#define MODEL_DEV_BITS      15
+#define MODEL_ENTRY_SIZE    8         /* DTE, CTE and ITE */
+#define LPI_MIN_ID          8192
+#define LPI_ENABLE          (1u << 0)
+
+#define ENTRY_VALID         (1ULL << 63)
+#define ADDR_MASK(lo)       (((1ULL << 52) - 1) & ~((1ULL << (lo)) - 1))
+#define RDBASE_MASK         (((1ULL << 51) - 1) & ~((1ULL << 16) - 1))
+#define FIELD(v, hi, lo)    (((v) >> (lo)) & ((1ULL << ((hi) - (lo) + 1)) - 1))
+
+static uint64_t
+reg64(uint8_t *regs, uint32_t offset)
+{
+  uint64_t value;
+
+  memcpy(&value, &regs[offset], sizeof(value));
+  return value;
+}
+
+static void
+set_reg64(uint8_t *regs, uint32_t offset, uint64_t value)
+{
+  memcpy(&regs[offset], &value, sizeof(value));
+}
+
+/* Entry index of the GITS_BASER table of the given type, NULL when it is out of the table */
+static uint64_t *
+its_table_entry(PAL_HOST_ITS *its, uint32_t type, uint32_t index)
+{
+  static const uint64_t page_size[4] = {0x1000, 0x4000, 0x10000, 0x10000};
+  uint64_t baser, size;
+  uint32_t n;
+
+  for (n = 0; n < 8; n++) {
+      baser = reg64(its->its_regs, GITS_BASER(n));
+      if (FIELD(baser, 58, 56) == type)
+          break;
+  }
+  if ((n == 8) || !(baser & GITS_BASER_VALID))
+      return NULL;
+
+  size = (FIELD(baser, 7, 0) + 1) * page_size[FIELD(baser, 9, 8)];
+  if ((uint64_t)index * MODEL_ENTRY_SIZE >= size)
+      return NULL;
+  return pal_host_phys_to_host((baser & ADDR_MASK(12) & ((1ULL << 48) - 1)) +
+                               (uint64_t)index * MODEL_ENTRY_SIZE, MODEL_ENTRY_SIZE);
+}
+
+/* Interrupt translation entry of (devid, eventid) in the ITT MAPD gave the device */
+static const char *
+its_ite(PAL_HOST_ITS *its, uint32_t devid, uint32_t eventid, uint64_t **ite)
+{
+  uint64_t *dte = its_table_entry(its, GITS_BASER_DEVICE, devid);
+
+  if (dte == NULL)
+      return "DeviceID out of the device table";
+  if (!(*dte & ENTRY_VALID))
+      return "device not mapped";
+  if (eventid >> (FIELD(*dte, 4, 0) + 1))
+      return "EventID out of the device's ITT";
+
+  *ite = pal_host_phys_to_host((*dte & ADDR_MASK(8)) + (uint64_t)eventid * MODEL_ENTRY_SIZE,
+                               MODEL_ENTRY_SIZE);
+  if (*ite == NULL)
+      return "ITT entry outside the memory the driver allocated";
+  return NULL;
+}
+
+/* LPI configuration byte of intid in the table GICR_PROPBASER points to */
+static uint8_t *
+rd_lpi_config(PAL_HOST_ITS *its, uint32_t intid)
+{
+  uint64_t propbaser = reg64(its->gicr_regs, GICR_PROPBASER);
+
+  if ((intid < LPI_MIN_ID) || (intid >> (FIELD(propbaser, 4, 0) + 1)) ||
+      (intid - LPI_MIN_ID >= PAL_HOST_ITS_NUM_LPIS))
+      return NULL;
+  return pal_host_phys_to_host((propbaser & ADDR_MASK(12)) + intid - LPI_MIN_ID, 1);
+}
+
+static uint8_t *
+rd_lpi_pending(PAL_HOST_ITS *its, uint32_t intid, uint8_t *bit)
+{
+  *bit = 1u << (intid % 8);
+  return pal_host_phys_to_host((reg64(its->gicr_regs, GICR_PENDBASER) & ADDR_MASK(16)) + intid / 8, 1);
+}
+
+/* Drop the cached configuration of an LPI, return 1 if it differed from memory */
+static uint32_t
+rd_lpi_invalidate(PAL_HOST_ITS *its, uint32_t lpi)
+{
+  uint8_t *cfg = rd_lpi_config(its, lpi + LPI_MIN_ID);
+  uint32_t stale;
+
+  if ((lpi >= PAL_HOST_ITS_NUM_LPIS) || !(its->lpi_cached[lpi / 8] & (1u << (lpi % 8))))
+      return 0;
+  stale = (cfg == NULL) || (*cfg != its->lpi_cfg[lpi]);
+  its->lpi_cached[lpi / 8] &= ~(1u << (lpi % 8));
+  return stale;
+}
+
+/* Make intid pending at the redistributor, as a translated MSI or an INT would */
+static const char *
+rd_set_pending(PAL_HOST_ITS *its, uint32_t intid)
+{
+  uint8_t *cfg = rd_lpi_config(its, intid);
+  uint32_t lpi = intid - LPI_MIN_ID;
+  uint8_t *pend, bit;
+
+  if (!(its->gicr_regs[GICR_CTLR] & GICR_CTLR_ENLPIS))
+      return "LPIs not enabled at the redistributor";
+  if (cfg == NULL)
+      return "pINTID out of the configuration table";
+
+  /* The configuration is read on first use and held until invalidated */
+  if (!(its->lpi_cached[lpi / 8] & (1u << (lpi % 8)))) {
+      its->lpi_cfg[lpi] = *cfg;
+      its->lpi_cached[lpi / 8] |= 1u << (lpi % 8);
+  }
+  if (!(its->lpi_cfg[lpi] & LPI_ENABLE))
+      return "LPI disabled in its configuration";
+
+  pend = rd_lpi_pending(its, intid, &bit);
+  if (pend == NULL)
+      return "pending table outside the memory the driver allocated";
+  *pend |= bit;
+  its->num_delivered++;
+  return NULL;
+}
+
+static const char *
+its_translate(PAL_HOST_ITS *its, uint32_t devid, uint32_t eventid, uint32_t *intid)
+{
+  const char *err;
+  uint64_t *ite, *cte;
+
+  err = its_ite(its, devid, eventid, &ite);
+  if (err)
+      return err;
+  if (!(*ite & ENTRY_VALID))
+      return "event not mapped";
+
+  cte = its_table_entry(its, GITS_BASER_CLCN, FIELD(*ite, 47, 32));
+  if ((cte == NULL) || !(*cte & ENTRY_VALID))
+      return "collection not mapped";
+
+  *intid = (uint32_t)*ite;
+  return rd_set_pending(its, *intid);
+}
+
+static const char *
+its_command(PAL_HOST_ITS *its, uint64_t *cmd)
+{
+  uint32_t opcode = cmd[0] & 0xFF;
+  uint32_t devid = cmd[0] >> 32;
+  uint32_t eventid = (uint32_t)cmd[1];
+  uint32_t icid = FIELD(cmd[2], 15, 0);
+  uint32_t intid, lpi, stale;
+  uint64_t *entry, *ite;
+  const char *err;
+  uint8_t *pend, bit;
+
+  its->num_cmds[(opcode < 16) ? opcode : 0]++;
+  if (opcode != CMD_SYNC)
+      its->cmds_since_sync++;
+
+  switch (opcode) {
+  case CMD_MAPD:
+    entry = its_table_entry(its, GITS_BASER_DEVICE, devid);
+    if (entry == NULL)
+        return "DeviceID out of the device table";
+    if (!(cmd[2] & ENTRY_VALID)) {
+        *entry = 0;
+        return NULL;
+    }
+    if (FIELD(cmd[1], 4, 0) > MODEL_ID_BITS)
+        return "ITT size larger than GITS_TYPER.IDbits";
+    *entry = ENTRY_VALID | (cmd[2] & ADDR_MASK(8)) | FIELD(cmd[1], 4, 0);
+    return NULL;
+
+  case CMD_MAPC:
+    entry = its_table_entry(its, GITS_BASER_CLCN, icid);
+    if (entry == NULL)
+        return "ICID out of the collection table";
+    if ((cmd[2] & ENTRY_VALID) && ((cmd[2] & RDBASE_MASK) != PAL_HOST_GICR_BASE))
+        return "RDbase is not a redistributor";
+    *entry = cmd[2] & (ENTRY_VALID | RDBASE_MASK);
+    return NULL;
+
+  case CMD_MAPTI:
+  case CMD_MAPI:
+    intid = (opcode == CMD_MAPI) ? eventid : (uint32_t)(cmd[1] >> 32);
+    err = its_ite(its, devid, eventid, &ite);
+    if (err)
+        return err;
+    if (its_table_entry(its, GITS_BASER_CLCN, icid) == NULL)
+        return "ICID out of the collection table";
+    if (rd_lpi_config(its, intid) == NULL)
+        return "pINTID out of the configuration table";
+    *ite = ENTRY_VALID | ((uint64_t)icid << 32) | intid;
+    return NULL;
+
+  case CMD_INV:
+  case CMD_DISCARD:
+  case CMD_INT:
+    err = its_ite(its, devid, eventid, &ite);
+    if (err)
+        return err;
+    if (!(*ite & ENTRY_VALID))
+        return "event not mapped";
+    intid = (uint32_t)*ite;
+
+    if (opcode == CMD_INT)
+        return its_translate(its, devid, eventid, &intid);
+
+    if (opcode == CMD_INV) {
+        if (!rd_lpi_invalidate(its, intid - LPI_MIN_ID))
+            its->redundant_inv++;
+        return NULL;
+    }
+
+    /* DISCARD removes the mapping and any pending state of the LPI */
+    *ite = 0;
+    pend = rd_lpi_pending(its, intid, &bit);
+    if (pend)
+        *pend &= ~bit;
+    return NULL;
+
+  case CMD_INVALL:
+    entry = its_table_entry(its, GITS_BASER_CLCN, icid);
+    if ((entry == NULL) || !(*entry & ENTRY_VALID))
+        return "collection not mapped";
+    for (lpi = 0, stale = 0; lpi < PAL_HOST_ITS_NUM_LPIS; lpi++)
+        stale |= rd_lpi_invalidate(its, lpi);
+    if (!stale)
+        its->redundant_inv++;
+    return NULL;
+
+  case CMD_SYNC:
+    if (its->cmds_since_sync == 0)
+        its->redundant_sync++;
+    its->cmds_since_sync = 0;
+    if ((cmd[2] & RDBASE_MASK) != PAL_HOST_GICR_BASE)
+        return "RDbase is not a redistributor";
+    return NULL;
+
+  default:
+    return "unsupported command";
+  }
+}
+
+/* Consume the commands between CREADR and CWRITER, stalling if the queue is not usable.
+   A stall is reported once, not on every retry of the driver. */
+static void
+its_cmdq_consume(PAL_HOST_ITS *its)
+{
+  uint64_t cbaser = reg64(its->its_regs, GITS_CBASER);
+  uint64_t size = (FIELD(cbaser, 7, 0) + 1) * 0x1000;
+  uint64_t cwriter = reg64(its->its_regs, GITS_CWRITER) & ADDR_MASK(5) & 0xFFFFF;
+  uint64_t creadr = reg64(its->its_regs, GITS_CREADR) & ADDR_MASK(5) & 0xFFFFF;
+  uint64_t stalled = reg64(its->its_regs, GITS_CREADR) & GITS_CREADR_STALLED;
+  uint64_t cmd[CMD_BYTES / 8];
+  const char *err;
+  uint8_t *queue;
+
+  if (!(its->its_regs[GITS_CTLR] & GITS_CTLR_ENABLED) || !(cbaser & GITS_CBASER_VALID))
+      return;
+
+  queue = pal_host_phys_to_host(cbaser & ADDR_MASK(12), size);
+  if ((queue == NULL) || (cwriter >= size)) {
+      if (!stalled) {
+          host_print(ACS_PRINT_ERR, " ITS: CWRITER 0x%llx outside the %llu byte command queue \n",
+                     (unsigned long long)cwriter, (unsigned long long)size);
+          its->num_errors++;
+      }
+      set_reg64(its->its_regs, GITS_CREADR, creadr | GITS_CREADR_STALLED);
+      return;
+  }
+
+  while (creadr != cwriter) {
+      memcpy(cmd, queue + creadr, CMD_BYTES);
+      err = its_command(its, cmd);
+      if (err) {
+          host_print(ACS_PRINT_ERR, " ITS: command 0x%x DeviceID 0x%x EventID 0x%x: %s \n",
+                     (unsigned int)(cmd[0] & 0xFF), (unsigned int)(cmd[0] >> 32),
+                     (unsigned int)cmd[1], err);
+          its->num_errors++;
+      }
+      creadr = (creadr + CMD_BYTES) % size;
+  }
+
+  set_reg64(its->its_regs, GITS_CREADR, creadr);
+}
+
+/**
+  @brief  Add the ITS, its distributor and one redistributor, at the fixed
+          PAL_HOST_GICD_BASE, PAL_HOST_ITS_BASE and PAL_HOST_GICR_BASE. The ITS
+          has a flat device and collection table, 16-bit DeviceIDs and INTIDs,
+          and takes physical RDbase addresses.
+
+  @return 0 on success, 1 if the ITS is already there
+**/
+uint32_t
+pal_host_add_its(void)
+{
+  PAL_HOST_ITS *its = &g_pal_host.its;
+
+  if (g_pal_host.num_its)
+      return 1;
+
+  memset(its, 0, sizeof(*its));
+  g_pal_host.num_its = 1;
+
+  set_reg64(its->gicd_regs, GICD_TYPER, GICD_TYPER_LPIS | (MODEL_ID_BITS << GICD_TYPER_IDBITS));
+
+  set_reg64(its->its_regs, GITS_CTLR, GITS_CTLR_QUIESCENT);
+  set_reg64(its->its_regs, GITS_TYPER, GITS_TYPER_PHYSICAL | GITS_TYPER_PTA |
+                                       ((MODEL_ENTRY_SIZE - 1) << GITS_TYPER_ITT_SZ) |
+                                       (MODEL_ID_BITS << GITS_TYPER_IDBITS) |
+                                       (MODEL_DEV_BITS << GITS_TYPER_DEVBITS));
+  set_reg64(its->its_regs, GITS_BASER(0), ((uint64_t)GITS_BASER_DEVICE << 56) |
+                                          ((uint64_t)(MODEL_ENTRY_SIZE - 1) << 48));
+  set_reg64(its->its_regs, GITS_BASER(1), ((uint64_t)GITS_BASER_CLCN << 56) |
+                                          ((uint64_t)(MODEL_ENTRY_SIZE - 1) << 48));
+
+  set_reg64(its->gicr_regs, GICR_TYPER, GICR_TYPER_PLPIS | GICR_TYPER_LAST);
+
+  return 0;
+}
+
+/* Register file and offset addr falls in, NULL if it is not a GIC frame */
+static uint8_t *
+its_frame(uint64_t addr, uint32_t size, uint64_t *offset, uint32_t *regs_size)
+{
+  PAL_HOST_ITS *its = &g_pal_host.its;
+
+  if (!g_pal_host.num_its)
+      return NULL;
+
+  if ((addr >= PAL_HOST_GICD_BASE) && (addr + size <= PAL_HOST_GICD_BASE + PAL_HOST_GICD_SIZE)) {
+      *offset = addr - PAL_HOST_GICD_BASE;
+      *regs_size = PAL_HOST_GICD_REGS;
+      return its->gicd_regs;
+  }
+  if ((addr >= PAL_HOST_ITS_BASE) && (addr + size <= PAL_HOST_ITS_BASE + PAL_HOST_ITS_SIZE)) {
+      *offset = addr - PAL_HOST_ITS_BASE;
+      *regs_size = PAL_HOST_ITS_REGS;
+      return its->its_regs;
+  }
+  if ((addr >= PAL_HOST_GICR_BASE) && (addr + size <= PAL_HOST_GICR_BASE + PAL_HOST_GICR_SIZE)) {
+      *offset = addr - PAL_HOST_GICR_BASE;
+      *regs_size = PAL_HOST_GICR_REGS;
+      return its->gicr_regs;
+  }
+  return NULL;
+}
+
+uint32_t
+pal_host_its_read(uint64_t addr, uint32_t size, uint64_t *data)
+{
+  uint32_t regs_size;
+  uint64_t offset;
+  uint8_t *regs = its_frame(addr, size, &offset, &regs_size);
+
+  if (regs == NULL)
+      return 0;
+
+  *data = 0;
+  if (offset + size <= regs_size)
+      memcpy(data, &regs[offset], size);
+  return 1;
+}
+
+uint32_t
+pal_host_its_write(uint64_t addr, uint32_t size, uint64_t data)
+{
+  PAL_HOST_ITS *its = &g_pal_host.its;
+  uint32_t regs_size, n;
+  uint64_t offset, saved[8];
+  uint8_t *regs = its_frame(addr, size, &offset, &regs_size);
+
+  if (regs == NULL)
+      return 0;
+  if ((regs == its->gicd_regs) || (offset + size > regs_size))
+      return 1;
+
+  if (regs == its->gicr_regs) {
+      if ((offset >= GICR_TYPER) && (offset < GICR_TYPER + 8))
+          return 1;
+      /* The tables cannot move once LPIs are enabled */
+      if ((offset >= GICR_PROPBASER) && (its->gicr_regs[GICR_CTLR] & GICR_CTLR_ENLPIS)) {
+          host_print(ACS_PRINT_ERR, " ITS: GICR 0x%llx written with LPIs enabled \n",
+                     (unsigned long long)offset);
+          its->num_errors++;
+          return 1;
+      }
+      memcpy(&regs[offset], &data, size);
+      return 1;
+  }
+
+  if ((offset >= GITS_IIDR) && (offset < GITS_TYPER + 8))
+      return 1;
+  if ((offset >= GITS_CREADR) && (offset < GITS_CREADR + 8))
+      return 1;
+
+  for (n = 0; n < 8; n++)
+      saved[n] = reg64(regs, GITS_BASER(n));
+  memcpy(&regs[offset], &data, size);
+  for (n = 0; n < 8; n++)
+      set_reg64(regs, GITS_BASER(n), (reg64(regs, GITS_BASER(n)) & ~GITS_BASER_RO) |
+                                     (saved[n] & GITS_BASER_RO));
+
+  if (offset < GITS_IIDR) {
+      if (regs[GITS_CTLR] & GITS_CTLR_ENABLED)
+          regs[GITS_CTLR + 3] &= ~(GITS_CTLR_QUIESCENT >> 24);
+      else
+          regs[GITS_CTLR + 3] |= GITS_CTLR_QUIESCENT >> 24;
+      its_cmdq_consume(its);
+  } else if ((offset >= GITS_CBASER) && (offset < GITS_CBASER + 8)) {
+      set_reg64(regs, GITS_CREADR, 0);
+  } else if ((offset >= GITS_CWRITER) && (offset < GITS_CWRITER + 8)) {
+      if (!(reg64(regs, GITS_CREADR) & GITS_CREADR_STALLED) ||
+          (reg64(regs, GITS_CWRITER) & GITS_CWRITER_RETRY))
+          its_cmdq_consume(its);
+  }
+
+  return 1;
+}
+
+/**
+  @brief  Deliver an MSI: a write of data to addr by the device devid, which
+          the ITS translates when addr is its GITS_TRANSLATER
+
+  @param  devid  DeviceID of the requester
+  @param  addr   Doorbell address the device was given
+  @param  data   Message data, the EventID
+  @param  intid  LPI made pending
+
+  @return 0 if an LPI was made pending, 1 if the MSI was dropped
+**/
+uint32_t
+pal_host_its_msi(uint32_t devid, uint64_t addr, uint32_t data, uint32_t *intid)
+{
+  PAL_HOST_ITS *its = &g_pal_host.its;
+  const char *err = "not GITS_TRANSLATER";
+
+  if (!g_pal_host.num_its)
+      return 1;
+
+  if (addr == PAL_HOST_ITS_BASE + GITS_TRANSLATER)
+      err = (its->its_regs[GITS_CTLR] & GITS_CTLR_ENABLED) ?
+            its_translate(its, devid, data, intid) : "ITS disabled";
+  if (err)
+      host_print(ACS_PRINT_DEBUG, " ITS: MSI DeviceID 0x%x EventID 0x%x dropped: %s \n",
+                 devid, data, err);
+  return (err != NULL);
+}
+
+/**
+  @brief  Acknowledge an LPI, clearing its pending state as the PE would
+
+  @return 1 if the LPI was pending
+**/
+uint32_t
+pal_host_its_ack(uint32_t intid)
+{
+  uint8_t *pend, bit;
+
+  if (!g_pal_host.num_its)
+      return 0;
+
+  pend = rd_lpi_pending(&g_pal_host.its, intid, &bit);
+  if ((pend == NULL) || !(*pend & bit))
+      return 0;
+  *pend &= ~bit;
+  return 1;
+}
@@ -0,0 +1,363 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "include/pal_linux_host.h"
+
+static void *g_host_shared_mem;
+
+/**
+  @brief  Print a message with one argument, the format being the caller's
+
+  @param  string  Format string
+  @param  data    Value for the format
+
+  @return None
+**/
+void
+pal_print(char8_t *string, uint64_t data)
+{
+  printf(string, data);
+}
+
+/**
+  @brief  There is no UART on the host, raw prints go to stdout as well
+**/
+void
+pal_print_raw(uint64_t addr, char8_t *string, uint64_t data)
+{
+  (void)addr;
+  printf(string, data);
+}
+
+uint32_t
+pal_strncmp(char8_t *str1, char8_t *str2, uint32_t len)
+{
+  return strncmp(str1, str2, len);
+}
+
+void *
+pal_memcpy(void *dest_buffer, void *src_buffer, uint32_t len)
+{
+  return memcpy(dest_buffer, src_buffer, len);
+}
+
+int
+pal_mem_compare(void *src, void *dest, uint32_t len)
+{
+  return memcmp(src, dest, len);
+}
+
+void
+pal_mem_set(void *buf, uint32_t size, uint8_t value)
+{
+  memset(buf, value, size);
+}
+
+void *
+pal_mem_alloc(uint32_t size)
+{
+  return malloc(size);
+}
+
+void
+pal_mem_free(void *buffer)
+{
+  free(buffer);
+}
+
+/**
+  @brief  Host memory is its own physical address space: allocations are
+          identity mapped, which is all the tests rely on.
+**/
+void *
+pal_mem_alloc_cacheable(uint32_t bdf, uint32_t size, void **pa)
+{
+  void *va;
+
+  (void)bdf;
+  va = calloc(1, size);
+  *pa = va;
+  return va;
+}
+
+void
+pal_mem_free_cacheable(uint32_t bdf, unsigned int size, void *va, void *pa)
+{
+  (void)bdf;
+  (void)size;
+  (void)pa;
+  free(va);
+}
+
+void *
+pal_mem_virt_to_phys(void *va)
+{
+  return va;
+}
+
+void *
+pal_mem_phys_to_virt(uint64_t pa)
+{
+  void *va = pal_host_phys_to_host(pa, 1);
+
+  return va ? va : (void *)(uintptr_t)pa;
+}
+
+uint32_t
+pal_mem_page_size(void)
+{
+  return sysconf(_SC_PAGESIZE);
+}
+
+void *
+pal_mem_alloc_pages(uint32_t num_pages)
+{
+  void *pages;
+
+  if (posix_memalign(&pages, pal_mem_page_size(), (size_t)num_pages * pal_mem_page_size()))
+      return NULL;
+  return pages;
+}
+
+void
+pal_mem_free_pages(void *page_base, uint32_t num_pages)
+{
+  (void)num_pages;
+  free(page_base);
+}
+
+void
+pal_mem_allocate_shared(uint32_t num_pe, uint32_t sizeofentry)
+{
+  free(g_host_shared_mem);
+  g_host_shared_mem = calloc(num_pe, sizeofentry);
+}
+
+void
+pal_mem_free_shared(void)
+{
+  free(g_host_shared_mem);
+  g_host_shared_mem = NULL;
+}
+
+uint64_t
+pal_mem_get_shared_addr(void)
+{
+  return (uint64_t)(uintptr_t)g_host_shared_mem;
+}
+
+/**
+  @brief  Return the number of MEM_INFO entries pal_memory_create_info_table
+          fills: one per memory map entry and the end marker
+**/
+uint32_t
+pal_memory_info_table_entries(void)
+{
+  return g_pal_host.num_mem + 1;
+}
+
+/**
+  @brief  Fill the memory info table from the memory map, in its order, as the
+          UEFI PAL does from the UEFI memory map. Nothing is mapped on the host,
+          so virtual addresses are left 0.
+**/
+void
+pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable, uint32_t max_entries)
+{
+  static const MEM_INFO_TYPE_e type[] = {
+    [PAL_HOST_MEM_RAM]      = MEMORY_TYPE_NORMAL,
+    [PAL_HOST_MEM_DEVICE]   = MEMORY_TYPE_DEVICE,
+    [PAL_HOST_MEM_RESERVED] = MEMORY_TYPE_RESERVED
+  };
+  MEM_INFO_BLOCK *info = memoryInfoTable->info;
+  uint32_t i;
+
+  for (i = 0; (i < g_pal_host.num_mem) && (i + 1 < max_entries); i++) {
+      info[i].type = type[g_pal_host.mem[i].type];
+      info[i].phy_addr = g_pal_host.mem[i].base;
+      info[i].virt_addr = 0;
+      info[i].size = g_pal_host.mem[i].size;
+      info[i].flags = 0;
+  }
+  if (i < g_pal_host.num_mem)
+      host_print(ACS_PRINT_WARN, " MEMORY_INFO: Table full at %d entries \n", max_entries);
+
+  info[i].type = MEMORY_TYPE_LAST_ENTRY;
+}
+
+/**
+  @brief  Return the base of the instance'th gap in the memory map, skipping a
+          gap at address 0 as the UEFI PAL does
+
+  @return 0 with addr filled in, PCIE_NO_MAPPING if there is no such gap
+**/
+uint64_t
+pal_memory_get_unpopulated_addr(uint64_t *addr, uint32_t instance)
+{
+  uint64_t next = 0;
+  uint32_t count = 0;
+  uint32_t i;
+
+  for (i = 0; i <= g_pal_host.num_mem; i++) {
+      if ((i == g_pal_host.num_mem) || (g_pal_host.mem[i].base > next)) {
+          if (next != 0) {
+              if (count == instance) {
+                  *addr = next;
+                  host_print(ACS_PRINT_INFO, "Unpopulated region with base address 0x%llx found\n",
+                             (unsigned long long)next);
+                  return 0;
+              }
+              count++;
+          }
+      }
+      if (i < g_pal_host.num_mem)
+          next = g_pal_host.mem[i].base + g_pal_host.mem[i].size;
+  }
+
+  return PCIE_NO_MAPPING;
+}
+
+/**
+  @brief  Device memory needs no mapping on the host, the physical address is
+          returned and resolved on every access
+**/
+uint64_t
+pal_memory_ioremap(void *addr, uint32_t size, uint32_t attr)
+{
+  (void)size;
+  (void)attr;
+  return (uint64_t)(uintptr_t)addr;
+}
+
+void
+pal_memory_unmap(void *addr)
+{
+  (void)addr;
+}
+
+/*
+ * MMIO accesses go to the SMMU and GIC models first, then resolve the physical address
+ * against the described regions. An address the PAL knows nothing about reads
+ * as all ones and ignores writes, as a bus would for an access nothing claims.
+ */
+#define HOST_MMIO_READ(type, addr) \
+  do { \
+    type *ptr = pal_host_phys_to_host(addr, sizeof(type)); \
+    type value = (type)~0ULL; \
+    uint64_t reg; \
+    if (pal_host_smmu_read(addr, sizeof(type), &reg) || \
+        pal_host_its_read(addr, sizeof(type), &reg)) \
+        value = (type)reg; \
+    else if (ptr) \
+        memcpy(&value, ptr, sizeof(type)); \
+    host_print(ACS_PRINT_INFO, " MMIO read  %llx", (unsigned long long)(addr)); \
+    host_print(ACS_PRINT_INFO, " = %llx \n", (unsigned long long)value); \
+    return value; \
+  } while (0)
+
+#define HOST_MMIO_WRITE(type, addr, data) \
+  do { \
+    type *ptr = pal_host_phys_to_host(addr, sizeof(type)); \
+    type value = data; \
+    if (!pal_host_smmu_write(addr, sizeof(type), value) && \
+        !pal_host_its_write(addr, sizeof(type), value) && ptr) \
+        memcpy(ptr, &value, sizeof(type)); \
+    host_print(ACS_PRINT_INFO, " MMIO write %llx", (unsigned long long)(addr)); \
+    host_print(ACS_PRINT_INFO, " = %llx \n", (unsigned long long)value); \
+  } while (0)
+
+uint8_t
+pal_mmio_read8(uint64_t addr)
+{
+  HOST_MMIO_READ(uint8_t, addr);
+}
+
+uint16_t
+pal_mmio_read16(uint64_t addr)
+{
+  HOST_MMIO_READ(uint16_t, addr);
+}
+
+uint32_t
+pal_mmio_read(uint64_t addr)
+{
+  HOST_MMIO_READ(uint32_t, addr);
+}
+
+uint64_t
+pal_mmio_read64(uint64_t addr)
+{
+  HOST_MMIO_READ(uint64_t, addr);
+}
+
+void
+pal_mmio_write8(uint64_t addr, uint8_t data)
+{
+  HOST_MMIO_WRITE(uint8_t, addr, data);
+}
+
+void
+pal_mmio_write16(uint64_t addr, uint16_t data)
+{
+  HOST_MMIO_WRITE(uint16_t, addr, data);
+}
+
+void
+pal_mmio_write(uint64_t addr, uint32_t data)
+{
+  HOST_MMIO_WRITE(uint32_t, addr, data);
+}
+
+void
+pal_mmio_write64(uint64_t addr, uint64_t data)
+{
+  HOST_MMIO_WRITE(uint64_t, addr, data);
+}
+
+uint64_t
+pal_time_delay_ms(uint64_t time_ms)
+{
+  struct timespec ts;
+
+  ts.tv_sec = time_ms / 1000;
+  ts.tv_nsec = (time_ms % 1000) * 1000000;
+  nanosleep(&ts, NULL);
+  return 0;
+}
+
+/**
+  @brief  Free-running counter standing in for the generic timer
+
+  @param  freq  Filled with the counter frequency in Hz, may be NULL
+
+  @return Counter value
+**/
+uint64_t
+pal_host_counter_read(uint64_t *freq)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  if (freq)
+      *freq = 1000000000;
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
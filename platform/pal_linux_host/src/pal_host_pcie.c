@@ -0,0 +1,354 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <string.h>
+
+#include "include/pal_linux_host.h"
+#include "val/include/bsa_acs_pcie.h"
+
+#define CFG_VENDOR_ID         0x00
+#define CFG_CLASS_REV         0x08
+#define CFG_HEADER_TYPE       0x0E
+#define CFG_STATUS            0x06
+#define CFG_CAP_PTR           0x34
+#define CFG_STATUS_CAP_LIST   0x10
+#define CFG_PCIE_CAP_ID       0x10
+#define CFG_EXT_CAP_START     0x100
+
+#define HOST_PCI_MAX_DEVICE   31
+#define HOST_PCI_MAX_FUNC     7
+
+static uint32_t
+cfg_read32(const uint8_t *cfg, uint32_t offset)
+{
+  uint32_t v;
+
+  memcpy(&v, cfg + offset, sizeof(v));
+  return v;
+}
+
+/* Config space of a present function, NULL for an absent one */
+static uint8_t *
+host_pcie_function(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  uint8_t *cfg = pal_host_cfg_space(seg, bus, dev, fn);
+
+  if ((cfg == NULL) || ((cfg_read32(cfg, CFG_VENDOR_ID) & 0xFFFF) == 0xFFFF))
+      return NULL;
+  return cfg;
+}
+
+/* Offset of the PCI Express capability, 0 if the function has none */
+static uint32_t
+host_pcie_cap(const uint8_t *cfg)
+{
+  uint32_t next, count = 0;
+
+  if (!(cfg[CFG_STATUS] & CFG_STATUS_CAP_LIST))
+      return 0;
+
+  next = cfg[CFG_CAP_PTR] & 0xFC;
+  while (next && (next < PAL_HOST_CFG_SIZE - 2) && (count++ < 48)) {
+      if (cfg[next] == CFG_PCIE_CAP_ID)
+          return next;
+      next = cfg[next + 1] & 0xFC;
+  }
+  return 0;
+}
+
+/**
+  @brief  Return the ECAM base of the first region
+**/
+uint64_t
+pal_pcie_get_mcfg_ecam(void)
+{
+  return g_pal_host.num_ecam ? g_pal_host.ecam[0].ecam_base : 0;
+}
+
+/**
+  @brief  Fill the PCIe info table from the described ECAM regions
+
+  @param  PcieTable    Address where the PCIe information needs to be filled
+  @param  max_entries  Number of entries the table has room for
+
+  @return None
+**/
+void
+pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable, uint32_t max_entries)
+{
+  uint32_t i;
+
+  if (PcieTable == NULL) {
+      host_print(ACS_PRINT_ERR, "Input PCIe Table Pointer is NULL. Cannot create PCIe INFO \n");
+      return;
+  }
+
+  max_entries = PAL_HOST_TABLE_ENTRIES(max_entries, PCIE_INFO_TABLE_SZ, PCIE_INFO_TABLE,
+                                       PCIE_INFO_BLOCK);
+  for (i = 0; (i < g_pal_host.num_ecam) && (i < max_entries); i++)
+      PcieTable->block[i] = g_pal_host.ecam[i];
+  if (i < g_pal_host.num_ecam)
+      host_print(ACS_PRINT_WARN, " PCIE_INFO: Table full at %u entries \n", max_entries);
+  PcieTable->num_entries = i;
+}
+
+uint32_t
+pal_pcie_io_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data)
+{
+  uint8_t *cfg = host_pcie_function(PCIE_EXTRACT_BDF_SEG(bdf), PCIE_EXTRACT_BDF_BUS(bdf),
+                                     PCIE_EXTRACT_BDF_DEV(bdf), PCIE_EXTRACT_BDF_FUNC(bdf));
+
+  if ((cfg == NULL) || (offset > PAL_HOST_CFG_SIZE - 4))
+      return PCIE_NO_MAPPING;
+
+  *data = cfg_read32(cfg, offset & ~3u);
+  return 0;
+}
+
+void
+pal_pcie_io_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data)
+{
+  uint8_t *cfg = host_pcie_function(PCIE_EXTRACT_BDF_SEG(bdf), PCIE_EXTRACT_BDF_BUS(bdf),
+                                     PCIE_EXTRACT_BDF_DEV(bdf), PCIE_EXTRACT_BDF_FUNC(bdf));
+
+  if ((cfg != NULL) && (offset <= PAL_HOST_CFG_SIZE - 4))
+      memcpy(cfg + (offset & ~3u), &data, sizeof(data));
+}
+
+/**
+  @brief  Return the first function at or after StartBdf whose base class and
+          sub-class match ClassCode (base class << 16 | sub-class << 8), 0 if none
+**/
+uint32_t
+pal_pcie_get_bdf_wrapper(uint32_t ClassCode, uint32_t StartBdf)
+{
+  PCIE_INFO_BLOCK *ecam;
+  uint32_t class_code;
+  uint32_t i, bus, dev, fn;
+  uint8_t *cfg;
+
+  for (i = 0; i < g_pal_host.num_ecam; i++) {
+      ecam = &g_pal_host.ecam[i];
+      if (ecam->segment_num < PCIE_EXTRACT_BDF_SEG(StartBdf))
+          continue;
+
+      for (bus = ecam->start_bus_num; bus <= ecam->end_bus_num; bus++) {
+          for (dev = 0; dev <= HOST_PCI_MAX_DEVICE; dev++) {
+              if ((ecam->segment_num == PCIE_EXTRACT_BDF_SEG(StartBdf)) &&
+                  ((bus << 8 | dev) < (PCIE_EXTRACT_BDF_BUS(StartBdf) << 8 |
+                                       PCIE_EXTRACT_BDF_DEV(StartBdf))))
+                  continue;
+
+              for (fn = 0; fn <= HOST_PCI_MAX_FUNC; fn++) {
+                  cfg = host_pcie_function(ecam->segment_num, bus, dev, fn);
+                  if (cfg == NULL)
+                      continue;
+                  class_code = cfg_read32(cfg, CFG_CLASS_REV) >> 8;
+                  if ((class_code & 0xFFFF00) == (ClassCode & 0xFFFF00))
+                      return PCIE_CREATE_BDF(ecam->segment_num, bus, dev, fn);
+              }
+          }
+      }
+  }
+
+  return 0;
+}
+
+void *
+pal_pci_bdf_to_dev(uint32_t bdf)
+{
+  (void)bdf;
+  return NULL;
+}
+
+void
+pal_pcie_read_ext_cap_word(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn,
+                           uint32_t ext_cap_id, uint8_t offset, uint16_t *val)
+{
+  uint8_t *cfg = host_pcie_function(seg, bus, dev, fn);
+  uint32_t next = CFG_EXT_CAP_START;
+  uint32_t header, count = 0;
+
+  *val = 0;
+  if (cfg == NULL)
+      return;
+
+  while (next && (next <= PAL_HOST_CFG_SIZE - 4) && (count++ < 512)) {
+      header = cfg_read32(cfg, next);
+      if ((header == 0) || (header == 0xFFFFFFFF))
+          return;
+      if ((header & 0xFFFF) == ext_cap_id) {
+          if (next + offset + 2 <= PAL_HOST_CFG_SIZE)
+              memcpy(val, cfg + next + offset, sizeof(*val));
+          return;
+      }
+      next = (header >> 20) & 0xFFC;
+  }
+}
+
+/**
+  @brief  Return the device/port type field of the PCI Express capability,
+          0xFFFFFFFF if the function has no such capability
+**/
+uint32_t
+pal_pcie_get_pcie_type(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  uint8_t *cfg = host_pcie_function(seg, bus, dev, fn);
+  uint32_t cap;
+
+  if ((cfg == NULL) || ((cap = host_pcie_cap(cfg)) == 0))
+      return 0xFFFFFFFF;
+
+  return (cfg[cap + 2] >> 4) & 0xF;
+}
+
+/**
+  @return 1: Normal PCIe device, 2: PCIe Host bridge, 3: PCIe bridge device,
+          0: no function at this address
+**/
+uint32_t
+pal_pcie_get_device_type(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  uint8_t *cfg = host_pcie_function(seg, bus, dev, fn);
+  uint32_t class_code;
+
+  if (cfg == NULL)
+      return 0;
+
+  class_code = cfg_read32(cfg, CFG_CLASS_REV) >> 16;
+  if (class_code == 0x0600)
+      return 2;
+  if ((cfg[CFG_HEADER_TYPE] & 0x7F) == 0x01)
+      return 3;
+  return 1;
+}
+
+uint32_t
+pal_pcie_p2p_support(void)
+{
+  return 1;
+}
+
+uint32_t
+pal_pcie_dev_p2p_support(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 1;
+}
+
+uint32_t
+pal_pcie_is_cache_present(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 0;
+}
+
+uint32_t
+pal_get_msi_vectors(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn,
+                    PERIPHERAL_VECTOR_LIST **mvector)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  *mvector = NULL;
+  return 0;
+}
+
+/**
+  @brief  Legacy interrupt routing is not described to the host PAL
+**/
+uint32_t
+pal_pcie_get_legacy_irq_map(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn,
+                            PERIPHERAL_IRQ_MAP *irq_map)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn; (void)irq_map;
+  return 1;
+}
+
+uint32_t
+pal_pcie_get_root_port_bdf(uint32_t *seg, uint32_t *bus, uint32_t *dev, uint32_t *func)
+{
+  (void)seg; (void)bus; (void)dev; (void)func;
+  return 0;
+}
+
+uint32_t
+pal_pcie_is_device_behind_smmu(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 0;
+}
+
+/*
+ * No driver is bound to the described functions, so the attributes the kernel
+ * PAL takes from the bound driver report a device error.
+ */
+uint32_t
+pal_pcie_get_snoop_bit(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 2;
+}
+
+uint32_t
+pal_pcie_get_dma_support(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 2;
+}
+
+uint32_t
+pal_pcie_get_dma_coherent(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 2;
+}
+
+uint32_t
+pal_pcie_is_devicedma_64bit(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 0;
+}
+
+uint32_t
+pal_pcie_scan_bridge_devices_and_check_memtype(uint32_t seg, uint32_t bus,
+                                               uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 0;
+}
+
+uint32_t
+pal_pcie_get_rp_transaction_frwd_support(uint32_t seg, uint32_t bus,
+                                         uint32_t dev, uint32_t fn)
+{
+  (void)seg; (void)bus; (void)dev; (void)fn;
+  return 1;
+}
+
+/**
+  @brief  The ECAM images are taken as already enumerated
+**/
+void
+pal_pcie_enumerate(void)
+{
+}
+
+uint32_t
+pal_bsa_pcie_enumerate(void)
+{
+  return 0;
+}
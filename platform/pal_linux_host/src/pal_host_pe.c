@@ -0,0 +1,152 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <string.h>
+
+#include "include/pal_linux_host.h"
+#include "val/include/bsa_acs_val.h"
+
+#define MADT_HDR_SIZE        44
+#define MADT_TYPE_GICC       0x0B
+#define MADT_GICC_PMU_GSIV   20
+#define MADT_GICC_VGIC_GSIV  56
+#define MADT_GICC_MPIDR      68
+#define MADT_GICC_MIN_SIZE   76
+
+static uint32_t
+madt_read32(const uint8_t *p)
+{
+  uint32_t v;
+
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+/**
+  @brief  Fill the PE info table from the GICC entries of the MADT. Without a
+          MADT the host is described as a single PE with MPIDR 0, which is what
+          the Linux VAL reports as the current PE.
+
+  @param  PeTable      Address where the PE information needs to be filled
+  @param  max_entries  Number of entries the table has room for
+
+  @return None
+**/
+void
+pal_pe_create_info_table(PE_INFO_TABLE *PeTable, uint32_t max_entries)
+{
+  PE_INFO_ENTRY *Ptr;
+  uint8_t *entry, *end;
+  uint64_t mpidr;
+
+  if (PeTable == NULL) {
+      host_print(ACS_PRINT_ERR, "Input PE Table Pointer is NULL. Cannot create PE INFO \n");
+      return;
+  }
+
+  PeTable->header.num_of_pe = 0;
+  Ptr = PeTable->pe_info;
+
+  if (g_pal_host.madt == NULL) {
+      memset(Ptr, 0, sizeof(*Ptr));
+      PeTable->header.num_of_pe = 1;
+      return;
+  }
+
+  max_entries = PAL_HOST_TABLE_ENTRIES(max_entries, PE_INFO_TABLE_SZ, PE_INFO_TABLE, PE_INFO_ENTRY);
+  entry = g_pal_host.madt + MADT_HDR_SIZE;
+  end = g_pal_host.madt + g_pal_host.madt_len;
+
+  while ((entry + 2 <= end) && (entry[1] >= 2) && (entry + entry[1] <= end)) {
+      if ((entry[0] == MADT_TYPE_GICC) && (entry[1] >= MADT_GICC_MIN_SIZE)) {
+          if (PeTable->header.num_of_pe >= max_entries) {
+              host_print(ACS_PRINT_WARN, " PE_INFO: Table full at %u entries \n", max_entries);
+              break;
+          }
+          memcpy(&mpidr, entry + MADT_GICC_MPIDR, sizeof(mpidr));
+          Ptr->pe_num     = PeTable->header.num_of_pe;
+          Ptr->attr       = 0;
+          Ptr->mpidr      = mpidr;
+          Ptr->pmu_gsiv   = madt_read32(entry + MADT_GICC_PMU_GSIV);
+          Ptr->gmain_gsiv = madt_read32(entry + MADT_GICC_VGIC_GSIV);
+          host_print(ACS_PRINT_DEBUG, "MPIDR %llx ", (unsigned long long)Ptr->mpidr);
+          host_print(ACS_PRINT_DEBUG, "PE num %x \n", Ptr->pe_num);
+          Ptr++;
+          PeTable->header.num_of_pe++;
+      }
+      entry += entry[1];
+  }
+}
+
+/**
+  @brief  There is no firmware to call on the host; SMCs return NOT_SUPPORTED
+**/
+void
+pal_pe_call_smc(ARM_SMC_ARGS *args)
+{
+  args->Arg0 = (uint64_t)-1;
+}
+
+/**
+  @brief  Secondary PEs are not emulated. The request is accepted so the test
+          does not count it as a PSCI failure, and the PE reports a skip.
+
+  @param  args  PSCI CPU_ON arguments, Arg1 is the target MPIDR
+
+  @return None
+**/
+void
+pal_pe_execute_payload(ARM_SMC_ARGS *args)
+{
+  uint32_t index = val_pe_get_index_mpid(args->Arg1);
+
+  host_print(ACS_PRINT_WARN, "\n       Host PAL: no PE with MPIDR %llx to run the payload",
+             (unsigned long long)args->Arg1);
+  val_set_status(index, RESULT_SKIP(0, 0x1));
+  args->Arg0 = 0;
+}
+
+void
+pal_pe_update_elr(void *context, uint64_t offset)
+{
+  (void)context;
+  (void)offset;
+}
+
+uint64_t
+pal_pe_get_esr(void *context)
+{
+  (void)context;
+  return 0;
+}
+
+uint64_t
+pal_pe_get_far(void *context)
+{
+  (void)context;
+  return 0;
+}
+
+/**
+  @brief  Host memory is coherent with itself, cache maintenance is a no-op
+**/
+void
+pal_pe_data_cache_ops_by_va(uint64_t addr, uint32_t type)
+{
+  (void)addr;
+  (void)type;
+}
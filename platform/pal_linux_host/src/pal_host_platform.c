@@ -0,0 +1,502 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "include/pal_linux_host.h"
+
+#define REGION_OWNED_MALLOC  1
+#define REGION_OWNED_MMAP    2
+
+/* Where the synthetic platform places its ECAM and its DRAM */
+#define SYNTH_ECAM_BASE      0x40000000ULL
+#define SYNTH_DRAM_BASE      0x80000000ULL
+#define SYNTH_DRAM_SIZE      0x80000000ULL
+#define SYNTH_MEMMAP_BASE    0x10000000000ULL  /* Above anything else the PAL describes */
+
+/* ACPI MADT layout, as much of it as the PAL reads */
+#define MADT_HDR_SIZE        44
+#define MADT_TYPE_GICC       0x0B
+#define MADT_GICC_SIZE       80
+
+/* PCI config space offsets used to build the synthetic hierarchy */
+#define CFG_VENDOR           0x00
+#define CFG_COMMAND          0x04
+#define CFG_CLASS            0x08
+#define CFG_HEADER_TYPE      0x0E
+#define CFG_CAP_PTR          0x34
+#define CFG_BUS_NUMBERS      0x18
+#define CFG_PCIE_CAP         0x40
+#define PCIE_CAP_ID          0x10
+#define PCIE_TYPE_ENDPOINT   0x0
+#define PCIE_TYPE_ROOT_PORT  0x4
+
+PAL_HOST_PLATFORM g_pal_host;
+
+static void
+put16(uint8_t *p, uint16_t v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+static void
+put32(uint8_t *p, uint32_t v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+static void
+put64(uint8_t *p, uint64_t v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+/**
+  @brief  Forget the platform description, releasing the memory behind it
+
+  @param  None
+
+  @return None
+**/
+void
+pal_host_reset(void)
+{
+  uint32_t i;
+
+  for (i = 0; i < g_pal_host.num_region; i++) {
+      if (g_pal_host.region[i].owned == REGION_OWNED_MALLOC)
+          free(g_pal_host.region[i].host);
+      else if (g_pal_host.region[i].owned == REGION_OWNED_MMAP)
+          munmap(g_pal_host.region[i].host, g_pal_host.region[i].size);
+  }
+  free(g_pal_host.madt);
+  free(g_pal_host.mem);
+
+  memset(&g_pal_host, 0, sizeof(g_pal_host));
+}
+
+/**
+  @brief  Back a physical address range with host memory. A NULL host pointer
+          asks the PAL to allocate the backing, filled with ones.
+
+  @param  base  Physical base address
+  @param  size  Size of the range in bytes
+  @param  host  Host memory to use, or NULL
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_add_region(uint64_t base, uint64_t size, void *host)
+{
+  PAL_HOST_REGION *region;
+
+  if ((g_pal_host.num_region == PAL_HOST_MAX_REGIONS) || (size == 0)) {
+      host_print(ACS_PRINT_ERR, "Cannot add host region %llx \n", (unsigned long long)base);
+      return 1;
+  }
+
+  region = &g_pal_host.region[g_pal_host.num_region];
+  region->owned = 0;
+  if (host == NULL) {
+      host = malloc(size);
+      if (host == NULL)
+          return 1;
+      memset(host, 0xFF, size);
+      region->owned = REGION_OWNED_MALLOC;
+  }
+
+  region->base = base;
+  region->size = size;
+  region->host = host;
+  g_pal_host.num_region++;
+  return 0;
+}
+
+/**
+  @brief  Return the host pointer behind a physical address range
+
+  @param  addr  Physical address
+  @param  len   Access length, the whole access must be backed
+
+  @return Host pointer, or NULL if the range is not backed
+**/
+void *
+pal_host_phys_to_host(uint64_t addr, uint32_t len)
+{
+  PAL_HOST_REGION *region;
+  uint32_t i = g_pal_host.last_region;
+  uint32_t n;
+
+  for (n = 0; n < g_pal_host.num_region; n++, i++) {
+      if (i >= g_pal_host.num_region)
+          i = 0;
+      region = &g_pal_host.region[i];
+      if ((addr >= region->base) && (addr - region->base + len <= region->size)) {
+          g_pal_host.last_region = i;
+          return region->host + (addr - region->base);
+      }
+  }
+
+  return NULL;
+}
+
+/**
+  @brief  Describe an ECAM region. cfg points to (end_bus - start_bus + 1) MB of
+          config space, or is NULL for the PAL to allocate an empty hierarchy.
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_add_ecam(uint64_t base, uint32_t segment, uint32_t start_bus, uint32_t end_bus, void *cfg)
+{
+  PCIE_INFO_BLOCK *ecam;
+
+  if ((g_pal_host.num_ecam == PAL_HOST_MAX_ECAM) || (end_bus < start_bus) || (end_bus > 255))
+      return 1;
+
+  /* ECAM is addressed from bus 0, whatever bus the region starts at */
+  if (pal_host_add_region(base + (uint64_t)start_bus * PAL_HOST_ECAM_BUS_SIZE,
+                          (uint64_t)(end_bus - start_bus + 1) * PAL_HOST_ECAM_BUS_SIZE, cfg))
+      return 1;
+
+  ecam = &g_pal_host.ecam[g_pal_host.num_ecam++];
+  ecam->ecam_base = base;
+  ecam->segment_num = segment;
+  ecam->start_bus_num = start_bus;
+  ecam->end_bus_num = end_bus;
+  return 0;
+}
+
+/**
+  @brief  Return the config space of a function, NULL if no ECAM covers it
+**/
+uint8_t *
+pal_host_cfg_space(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn)
+{
+  PCIE_INFO_BLOCK *ecam;
+  uint32_t i;
+
+  for (i = 0; i < g_pal_host.num_ecam; i++) {
+      ecam = &g_pal_host.ecam[i];
+      if ((ecam->segment_num == seg) && (bus >= ecam->start_bus_num) && (bus <= ecam->end_bus_num))
+          return pal_host_phys_to_host(ecam->ecam_base + (uint64_t)bus * PAL_HOST_ECAM_BUS_SIZE +
+                                       (dev * 8 + fn) * PAL_HOST_CFG_SIZE, PAL_HOST_CFG_SIZE);
+  }
+
+  return NULL;
+}
+
+/**
+  @brief  Add a memory map entry. Entries only describe the address space; they
+          are not backed unless a region is also added for them.
+
+  @return 0 on success, 1 if out of memory
+**/
+uint32_t
+pal_host_add_mem(uint64_t base, uint64_t size, uint32_t type)
+{
+  PAL_HOST_MEM *mem;
+  uint32_t i;
+
+  if (g_pal_host.num_mem == g_pal_host.max_mem) {
+      i = g_pal_host.max_mem ? g_pal_host.max_mem * 2 : 64;
+      mem = realloc(g_pal_host.mem, i * sizeof(PAL_HOST_MEM));
+      if (mem == NULL)
+          return 1;
+      g_pal_host.mem = mem;
+      g_pal_host.max_mem = i;
+  }
+
+  /* Keep the map sorted by base, the unpopulated address search walks the gaps */
+  for (i = g_pal_host.num_mem; (i > 0) && (g_pal_host.mem[i - 1].base > base); i--)
+      g_pal_host.mem[i] = g_pal_host.mem[i - 1];
+
+  mem = &g_pal_host.mem[i];
+  mem->base = base;
+  mem->size = size;
+  mem->type = type;
+  g_pal_host.num_mem++;
+  return 0;
+}
+
+/**
+  @brief  Take a copy of an ACPI MADT to describe the PEs
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_set_madt(const void *madt, uint32_t length)
+{
+  uint32_t table_len;
+
+  if (length < MADT_HDR_SIZE)
+      return 1;
+
+  memcpy(&table_len, (const uint8_t *)madt + 4, sizeof(table_len));
+  if ((table_len < MADT_HDR_SIZE) || (table_len > length)) {
+      host_print(ACS_PRINT_ERR, "MADT length %x does not match the data \n", table_len);
+      return 1;
+  }
+
+  free(g_pal_host.madt);
+  g_pal_host.madt = malloc(table_len);
+  if (g_pal_host.madt == NULL)
+      return 1;
+
+  memcpy(g_pal_host.madt, madt, table_len);
+  g_pal_host.madt_len = table_len;
+  return 0;
+}
+
+/**
+  @brief  Map a raw ECAM image from a file. The file holds whole buses from
+          start_bus on; the mapping is private, so writes do not reach the file.
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_load_ecam(const char *path, uint64_t base, uint32_t segment, uint32_t start_bus)
+{
+  struct stat st;
+  void *cfg;
+  uint32_t num_bus;
+  int fd;
+
+  fd = open(path, O_RDONLY);
+  if ((fd < 0) || fstat(fd, &st)) {
+      perror(path);
+      if (fd >= 0)
+          close(fd);
+      return 1;
+  }
+
+  num_bus = st.st_size / PAL_HOST_ECAM_BUS_SIZE;
+  if ((num_bus == 0) || (st.st_size % PAL_HOST_ECAM_BUS_SIZE)) {
+      host_print(ACS_PRINT_ERR, "%s: ECAM image must be a whole number of 1MB buses \n", path);
+      close(fd);
+      return 1;
+  }
+
+  cfg = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (cfg == MAP_FAILED) {
+      perror(path);
+      return 1;
+  }
+
+  if (pal_host_add_ecam(base, segment, start_bus, start_bus + num_bus - 1, cfg)) {
+      munmap(cfg, st.st_size);
+      return 1;
+  }
+
+  g_pal_host.region[g_pal_host.num_region - 1].owned = REGION_OWNED_MMAP;
+  return 0;
+}
+
+/**
+  @brief  Read a memory map from a text file, one "<type> <base> <size>" entry
+          per line, type being ram, device or reserved. '#' starts a comment.
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_load_memmap(const char *path)
+{
+  char line[256], type[16];
+  unsigned long long base, size;
+  uint32_t line_num = 0;
+  uint32_t mem_type;
+  FILE *fp;
+
+  fp = fopen(path, "r");
+  if (fp == NULL) {
+      perror(path);
+      return 1;
+  }
+
+  while (fgets(line, sizeof(line), fp)) {
+      line_num++;
+      if (strchr(line, '#'))
+          *strchr(line, '#') = '\0';
+      if (sscanf(line, "%15s", type) != 1)
+          continue;
+
+      if (sscanf(line, "%15s %lli %lli", type, &base, &size) != 3)
+          goto bad_line;
+      if (!strcmp(type, "ram"))
+          mem_type = PAL_HOST_MEM_RAM;
+      else if (!strcmp(type, "device"))
+          mem_type = PAL_HOST_MEM_DEVICE;
+      else if (!strcmp(type, "reserved"))
+          mem_type = PAL_HOST_MEM_RESERVED;
+      else
+          goto bad_line;
+
+      if (pal_host_add_mem(base, size, mem_type))
+          goto bad_line;
+  }
+
+  fclose(fp);
+  return 0;
+
+bad_line:
+  host_print(ACS_PRINT_ERR, "%s:%d: invalid memory map entry \n", path, line_num);
+  fclose(fp);
+  return 1;
+}
+
+/**
+  @brief  Read a raw ACPI MADT, e.g. /sys/firmware/acpi/tables/APIC from a target
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_load_madt(const char *path)
+{
+  uint8_t buf[64 * 1024];
+  size_t len;
+  FILE *fp;
+
+  fp = fopen(path, "rb");
+  if (fp == NULL) {
+      perror(path);
+      return 1;
+  }
+
+  len = fread(buf, 1, sizeof(buf), fp);
+  fclose(fp);
+
+  return pal_host_set_madt(buf, len);
+}
+
+static void
+synth_function(uint8_t *cfg, uint32_t class_code, uint32_t header_type, uint32_t port_type)
+{
+  memset(cfg, 0, PAL_HOST_CFG_SIZE);
+  put16(cfg + CFG_VENDOR, 0x13B5);                /* Arm Ltd */
+  put16(cfg + CFG_VENDOR + 2, 0x0100 + port_type);
+  put16(cfg + CFG_COMMAND + 2, 0x0010);           /* capability list */
+  put32(cfg + CFG_CLASS, class_code << 8);
+  cfg[CFG_HEADER_TYPE] = header_type;
+  cfg[CFG_CAP_PTR] = CFG_PCIE_CAP;
+
+  /* PCI Express capability, version 2, and the end of the extended list */
+  cfg[CFG_PCIE_CAP] = PCIE_CAP_ID;
+  cfg[CFG_PCIE_CAP + 1] = 0;
+  put16(cfg + CFG_PCIE_CAP + 2, (port_type << 4) | 0x2);
+}
+
+/**
+  @brief  Describe a synthetic platform: num_pe PEs in clusters of four, and
+          num_rp root ports on bus 0, each with num_ep endpoint functions below it.
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_synth_platform(uint32_t num_pe, uint32_t num_rp, uint32_t num_ep)
+{
+  uint8_t *madt, *gicc, *cfg;
+  uint32_t madt_len = MADT_HDR_SIZE + num_pe * MADT_GICC_SIZE;
+  uint32_t i, fn;
+
+  if ((num_pe == 0) || (num_rp > 32) || (num_ep > 8))
+      return 1;
+
+  madt = calloc(1, madt_len);
+  if (madt == NULL)
+      return 1;
+
+  memcpy(madt, "APIC", 4);
+  put32(madt + 4, madt_len);
+  madt[8] = 5;
+  for (i = 0; i < num_pe; i++) {
+      gicc = madt + MADT_HDR_SIZE + i * MADT_GICC_SIZE;
+      gicc[0] = MADT_TYPE_GICC;
+      gicc[1] = MADT_GICC_SIZE;
+      put32(gicc + 4, i);                          /* CPU interface number */
+      put32(gicc + 8, i);                          /* ACPI processor UID */
+      put32(gicc + 12, 1);                         /* enabled */
+      put32(gicc + 20, 23);                        /* PMU GSIV */
+      put32(gicc + 56, 25);                        /* GIC maintenance GSIV */
+      put64(gicc + 68, ((uint64_t)(i / 4) << 8) | (i % 4));
+  }
+
+  i = pal_host_set_madt(madt, madt_len);
+  free(madt);
+  if (i)
+      return 1;
+
+  if (pal_host_add_mem(SYNTH_DRAM_BASE, SYNTH_DRAM_SIZE, PAL_HOST_MEM_RAM) ||
+      pal_host_add_mem(SYNTH_ECAM_BASE, (uint64_t)(num_rp + 1) * PAL_HOST_ECAM_BUS_SIZE,
+                       PAL_HOST_MEM_DEVICE))
+      return 1;
+
+  if (pal_host_add_ecam(SYNTH_ECAM_BASE, 0, 0, num_rp, NULL))
+      return 1;
+
+  for (i = 0; i < num_rp; i++) {
+      cfg = pal_host_cfg_space(0, 0, i, 0);
+      synth_function(cfg, 0x060400, 0x01, PCIE_TYPE_ROOT_PORT);
+      cfg[CFG_BUS_NUMBERS + 1] = i + 1;            /* secondary bus */
+      cfg[CFG_BUS_NUMBERS + 2] = i + 1;            /* subordinate bus */
+
+      for (fn = 0; fn < num_ep; fn++) {
+          cfg = pal_host_cfg_space(0, i + 1, 0, fn);
+          synth_function(cfg, 0x020000, (num_ep > 1) ? 0x80 : 0x00, PCIE_TYPE_ENDPOINT);
+      }
+  }
+
+  return 0;
+}
+
+/**
+  @brief  Describe a synthetic memory map of num_regions entries above the rest
+          of the platform, in the page sized pieces a firmware map comes in:
+          runs of the same type that the VAL merges, broken by type changes
+          and unpopulated gaps.
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_synth_memmap(uint32_t num_regions)
+{
+  uint64_t base = SYNTH_MEMMAP_BASE;
+  uint64_t size;
+  uint32_t seed = 1;
+  uint32_t type = PAL_HOST_MEM_RAM;
+  uint32_t i;
+
+  for (i = 0; i < num_regions; i++) {
+      seed = seed * 1103515245 + 12345;
+      size = (uint64_t)(((seed >> 16) & 0xF) + 1) * 0x1000;
+      if (((seed >> 20) & 0x3) == 0)
+          type = (type + 1) % (PAL_HOST_MEM_RESERVED + 1);
+      if (((seed >> 22) & 0x7) == 0)
+          base += (uint64_t)(((seed >> 25) & 0x3) + 1) * 0x1000;
+
+      if (pal_host_add_mem(base, size, type))
+          return 1;
+      base += size;
+  }
+
+  return 0;
+}
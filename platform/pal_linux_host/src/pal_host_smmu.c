@@ -0,0 +1,447 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+**/
+
+#include <string.h>
+
+#include "include/pal_linux_host.h"
+
+/*
+ * SMMUv3 register model, enough of it for the VAL driver to probe, reset, map
+ * and unmap: the ID registers, CR0/CR0ACK, the stream table base and the
+ * command queue. Commands are consumed as soon as CMDQ_PROD moves and counted
+ * by class, so the driver's own queue statistics can be checked against them.
+ * Translations are not performed on accesses; pal_host_smmu_translate walks
+ * the stream table, context descriptors and translation tables the driver
+ * wrote, as the SMMU would for a transaction. The register layout is
+ * repeated here rather than shared with smmu_reg.h, which defines data.
+ */
+
+#define SMMU_IDR0           0x00
+#define SMMU_IDR1           0x04
+#define SMMU_IDR5           0x14
+#define SMMU_CR0            0x20
+#define SMMU_CR0ACK         0x24
+#define SMMU_GERROR         0x60
+#define SMMU_GERRORN        0x64
+#define SMMU_STRTAB_BASE    0x80
+#define SMMU_STRTAB_CFG     0x88
+#define SMMU_CMDQ_BASE      0x90
+#define SMMU_CMDQ_PROD      0x98
+#define SMMU_CMDQ_CONS      0x9C
+
+#define IDR0_ST_LEVEL_2LVL  (1u << 27)
+#define IDR0_CD2L           (1u << 19)
+#define IDR0_TTF_AARCH64    (2u << 2)
+#define IDR0_S1P            (1u << 1)
+#define IDR0_S2P            (1u << 0)
+#define IDR1_CMDQS_SHIFT    21
+#define IDR1_SSIDSIZE_SHIFT 6
+#define IDR5_OAS_48         5
+#define IDR5_GRAN4K         (1u << 4)
+#define IDR5_GRAN64K        (1u << 6)
+
+#define CR0_SMMUEN          (1u << 0)
+#define CR0_CMDQEN          (1u << 3)
+#define GERROR_CMDQ_ERR     (1u << 0)
+#define CONS_ERR_SHIFT      24
+#define CONS_ERR_ILL        1
+
+#define MODEL_CMDQS         8         /* log2 of the most commands the queue holds */
+#define MODEL_SSID_BITS     16
+#define MODEL_STRTAB_SPLIT  8
+
+#define CMD_DWORDS          2
+#define STE_DWORDS          8
+#define CD_DWORDS           8
+
+#define ADDR_MASK(lo)       (((1ULL << 52) - 1) & ~((1ULL << (lo)) - 1))
+#define FIELD(v, hi, lo)    (((v) >> (lo)) & ((1ULL << ((hi) - (lo) + 1)) - 1))
+
+#define STE_CONFIG_BYPASS   4
+#define STE_CONFIG_S1       5
+#define STE_CONFIG_S2       6
+#define S1FMT_LINEAR        0
+#define S1FMT_4K_L2         1
+#define S1FMT_64K_L2        2
+
+static PAL_HOST_SMMU *
+smmu_at(uint64_t addr, uint32_t size)
+{
+  uint32_t i;
+
+  for (i = 0; i < g_pal_host.num_smmu; i++) {
+      if ((addr >= g_pal_host.smmu[i].base) &&
+          (addr + size <= g_pal_host.smmu[i].base + PAL_HOST_SMMU_SIZE))
+          return &g_pal_host.smmu[i];
+  }
+  return NULL;
+}
+
+static uint32_t
+reg32(PAL_HOST_SMMU *smmu, uint32_t offset)
+{
+  uint32_t value;
+
+  memcpy(&value, &smmu->regs[offset], sizeof(value));
+  return value;
+}
+
+static uint64_t
+reg64(PAL_HOST_SMMU *smmu, uint32_t offset)
+{
+  uint64_t value;
+
+  memcpy(&value, &smmu->regs[offset], sizeof(value));
+  return value;
+}
+
+static void
+set_reg32(PAL_HOST_SMMU *smmu, uint32_t offset, uint32_t value)
+{
+  memcpy(&smmu->regs[offset], &value, sizeof(value));
+}
+
+/* Tables the driver hands the SMMU live in host memory, identity mapped */
+static uint32_t
+read_dword(uint64_t pa, uint64_t *value)
+{
+  if (pa == 0)
+      return 1;
+  memcpy(value, pal_mem_phys_to_virt(pa), sizeof(*value));
+  return 0;
+}
+
+/* Consume the commands between CMDQ_CONS and CMDQ_PROD, stopping at an illegal one */
+static void
+smmu_cmdq_consume(PAL_HOST_SMMU *smmu)
+{
+  uint64_t queue_base = reg64(smmu, SMMU_CMDQ_BASE);
+  uint32_t log2nent = FIELD(queue_base, 4, 0);
+  uint32_t prod = reg32(smmu, SMMU_CMDQ_PROD);
+  uint32_t cons = reg32(smmu, SMMU_CMDQ_CONS);
+  uint32_t wrap_mask, cmd0;
+  uint64_t cmd;
+
+  if (!(reg32(smmu, SMMU_CR0ACK) & CR0_CMDQEN))
+      return;
+  if ((reg32(smmu, SMMU_GERROR) ^ reg32(smmu, SMMU_GERRORN)) & GERROR_CMDQ_ERR)
+      return;
+
+  if (log2nent > MODEL_CMDQS)
+      log2nent = MODEL_CMDQS;
+  wrap_mask = (2u << log2nent) - 1;
+  cons &= wrap_mask;
+
+  while (cons != (prod & wrap_mask)) {
+      cmd = (queue_base & ADDR_MASK(5)) + (uint64_t)(cons & ((1u << log2nent) - 1)) * CMD_DWORDS * 8;
+      if (read_dword(cmd, &cmd))
+          break;
+      cmd0 = cmd & 0xFF;
+
+      switch (cmd0) {
+      case 0x03:                      /* CFGI_STE */
+      case 0x04:                      /* CFGI_STE_RANGE, CFGI_ALL */
+      case 0x05:                      /* CFGI_CD */
+      case 0x06:                      /* CFGI_CD_ALL */
+        smmu->num_cfgi++;
+        break;
+      case 0x10:                      /* TLBI_NH_ALL */
+      case 0x11:                      /* TLBI_NH_ASID */
+      case 0x12:                      /* TLBI_NH_VA */
+      case 0x20:                      /* TLBI_EL2_ALL */
+      case 0x28:                      /* TLBI_S12_VMALL */
+      case 0x30:                      /* TLBI_NSNH_ALL */
+        smmu->num_tlbi++;
+        break;
+      case 0x46:                      /* CMD_SYNC */
+        smmu->num_sync++;
+        break;
+      default:
+        host_print(ACS_PRINT_ERR, " SMMU %llx: illegal command 0x%x \n",
+                   (unsigned long long)smmu->base, cmd0);
+        set_reg32(smmu, SMMU_CMDQ_CONS, cons | (CONS_ERR_ILL << CONS_ERR_SHIFT));
+        set_reg32(smmu, SMMU_GERROR, reg32(smmu, SMMU_GERROR) ^ GERROR_CMDQ_ERR);
+        return;
+      }
+      smmu->num_cmds++;
+      cons = (cons + 1) & wrap_mask;
+  }
+
+  set_reg32(smmu, SMMU_CMDQ_CONS, cons);
+}
+
+/**
+  @brief  Add an SMMUv3 with AArch64 stage 1 and stage 2 tables and a 48-bit
+          output address size. Stream tables are two level for sid_bits above
+          the split the VAL driver uses.
+
+  @param  base      Physical base of the register pages
+  @param  sid_bits  StreamID width
+
+  @return 0 on success, 1 on failure
+**/
+uint32_t
+pal_host_add_smmu(uint64_t base, uint32_t sid_bits)
+{
+  PAL_HOST_SMMU *smmu;
+  uint32_t idr0;
+
+  if ((g_pal_host.num_smmu >= PAL_HOST_MAX_SMMU) || (sid_bits == 0) || (sid_bits > 32))
+      return 1;
+  if (smmu_at(base, 1) || smmu_at(base + PAL_HOST_SMMU_SIZE - 1, 1))
+      return 1;
+
+  smmu = &g_pal_host.smmu[g_pal_host.num_smmu++];
+  memset(smmu, 0, sizeof(*smmu));
+  smmu->base = base;
+
+  idr0 = IDR0_CD2L | IDR0_TTF_AARCH64 | IDR0_S1P | IDR0_S2P;
+  if (sid_bits > MODEL_STRTAB_SPLIT)
+      idr0 |= IDR0_ST_LEVEL_2LVL;
+  set_reg32(smmu, SMMU_IDR0, idr0);
+  set_reg32(smmu, SMMU_IDR1, (MODEL_CMDQS << IDR1_CMDQS_SHIFT) |
+                             (MODEL_SSID_BITS << IDR1_SSIDSIZE_SHIFT) | sid_bits);
+  set_reg32(smmu, SMMU_IDR5, IDR5_GRAN64K | IDR5_GRAN4K | IDR5_OAS_48);
+
+  return 0;
+}
+
+uint32_t
+pal_host_smmu_read(uint64_t addr, uint32_t size, uint64_t *data)
+{
+  PAL_HOST_SMMU *smmu = smmu_at(addr, size);
+  uint64_t offset;
+
+  if (smmu == NULL)
+      return 0;
+
+  *data = 0;
+  offset = addr - smmu->base;
+  if (offset + size <= PAL_HOST_SMMU_REGS)
+      memcpy(data, &smmu->regs[offset], size);
+  return 1;
+}
+
+uint32_t
+pal_host_smmu_write(uint64_t addr, uint32_t size, uint64_t data)
+{
+  PAL_HOST_SMMU *smmu = smmu_at(addr, size);
+  uint64_t offset;
+
+  if (smmu == NULL)
+      return 0;
+
+  offset = addr - smmu->base;
+  if (offset + size > PAL_HOST_SMMU_REGS)
+      return 1;
+
+  /* ID registers, CR0ACK and GERROR are read-only */
+  if ((offset < SMMU_CR0) || (offset == SMMU_CR0ACK) || (offset == SMMU_GERROR))
+      return 1;
+
+  memcpy(&smmu->regs[offset], &data, size);
+
+  switch (offset) {
+  case SMMU_CR0:
+    set_reg32(smmu, SMMU_CR0ACK, reg32(smmu, SMMU_CR0));
+    smmu_cmdq_consume(smmu);
+    break;
+  case SMMU_CMDQ_PROD:
+    smmu_cmdq_consume(smmu);
+    break;
+  }
+
+  return 1;
+}
+
+/* Walk AArch64 translation tables from start_level; ias bits of input at the root */
+static uint32_t
+smmu_walk(uint64_t ttb, uint32_t ias, uint32_t granule_log2, uint32_t start_level,
+          uint64_t iova, uint64_t *pa)
+{
+  uint32_t bits = granule_log2 - 3;
+  uint32_t level = start_level;
+  uint32_t entry_log2, nbits;
+  uint64_t table = ttb & ADDR_MASK(granule_log2);
+  uint64_t desc;
+
+  if ((ias >= 64) || (iova >> ias) || (start_level > 3))
+      return 1;
+
+  while (1) {
+      entry_log2 = granule_log2 + (3 - level) * bits;
+      if (entry_log2 >= ias)
+          return 1;
+      /* Up to 16 concatenated tables at the root */
+      nbits = (level == start_level) ? (ias - entry_log2) : bits;
+      if (nbits > bits + 4)
+          return 1;
+
+      if (read_dword(table + ((iova >> entry_log2) & ((1ULL << nbits) - 1)) * 8, &desc))
+          return 1;
+      if (!(desc & 1))
+          return 1;
+
+      if (level == 3) {
+          if (!(desc & 2))
+              return 1;
+          break;
+      }
+      if (!(desc & 2))
+          break;
+
+      table = desc & ADDR_MASK(granule_log2) & ((1ULL << 48) - 1);
+      level++;
+  }
+
+  *pa = (desc & ADDR_MASK(entry_log2) & ((1ULL << 48) - 1)) | (iova & ((1ULL << entry_log2) - 1));
+  return 0;
+}
+
+/* TG0 of a CD and S2TG of a VTCR share the encoding */
+static uint32_t
+granule_log2(uint32_t tg)
+{
+  switch (tg) {
+  case 0:
+    return 12;
+  case 1:
+    return 16;
+  case 2:
+    return 14;
+  default:
+    return 0;
+  }
+}
+
+/* Stream table entry of sid, 0 when there is none */
+static uint64_t
+smmu_ste(PAL_HOST_SMMU *smmu, uint32_t sid)
+{
+  uint64_t strtab = reg64(smmu, SMMU_STRTAB_BASE) & ADDR_MASK(6);
+  uint32_t cfg = reg32(smmu, SMMU_STRTAB_CFG);
+  uint32_t log2size = FIELD(cfg, 5, 0);
+  uint32_t split = FIELD(cfg, 10, 6);
+  uint64_t l1;
+  uint32_t span;
+
+  if ((log2size < 32) && (sid >> log2size))
+      return 0;
+
+  if (FIELD(cfg, 17, 16) == 0)
+      return strtab + (uint64_t)sid * STE_DWORDS * 8;
+
+  if (read_dword(strtab + (uint64_t)(sid >> split) * 8, &l1))
+      return 0;
+  span = FIELD(l1, 4, 0);
+  if ((span == 0) || ((sid & ((1u << split) - 1)) >> (span - 1)))
+      return 0;
+  return (l1 & ADDR_MASK(6)) + (uint64_t)(sid & ((1u << split) - 1)) * STE_DWORDS * 8;
+}
+
+/* Context descriptor of ssid, 0 when there is none */
+static uint64_t
+smmu_cd(uint64_t ste0, uint32_t ssid)
+{
+  uint64_t cdtab = ste0 & ADDR_MASK(6);
+  uint32_t s1fmt = FIELD(ste0, 5, 4);
+  uint32_t s1cdmax = FIELD(ste0, 63, 59);
+  uint32_t split;
+  uint64_t l1;
+
+  if (ssid >> s1cdmax)
+      return 0;
+
+  if ((s1cdmax == 0) || (s1fmt == S1FMT_LINEAR))
+      return cdtab + (uint64_t)ssid * CD_DWORDS * 8;
+
+  split = (s1fmt == S1FMT_4K_L2) ? 6 : 10;
+  if (read_dword(cdtab + (uint64_t)(ssid >> split) * 8, &l1) || !(l1 & 1))
+      return 0;
+  return (l1 & ADDR_MASK(12)) + (uint64_t)(ssid & ((1u << split) - 1)) * CD_DWORDS * 8;
+}
+
+/**
+  @brief  Translate an address as the SMMU would for a transaction of the
+          stream sid, substream ssid
+
+  @param  index  SMMU index, in the order the SMMUs were added
+  @param  sid    StreamID
+  @param  ssid   SubstreamID, used by stage 1 only
+  @param  iova   Input address
+  @param  pa     Output address
+
+  @return 0 on success, 1 on a translation fault or an invalid configuration
+**/
+uint32_t
+pal_host_smmu_translate(uint32_t index, uint32_t sid, uint32_t ssid, uint64_t iova, uint64_t *pa)
+{
+  PAL_HOST_SMMU *smmu;
+  uint64_t ste, cd, ste0, desc, vtcr;
+  uint32_t ias, g, bits, sl0;
+
+  if (index >= g_pal_host.num_smmu)
+      return 1;
+  smmu = &g_pal_host.smmu[index];
+
+  /* Disabled, incoming transactions bypass as GBPA resets to */
+  if (!(reg32(smmu, SMMU_CR0ACK) & CR0_SMMUEN)) {
+      *pa = iova;
+      return 0;
+  }
+
+  ste = smmu_ste(smmu, sid);
+  if ((ste == 0) || read_dword(ste, &ste0) || !(ste0 & 1))
+      return 1;
+
+  switch (FIELD(ste0, 3, 1)) {
+  case STE_CONFIG_BYPASS:
+    *pa = iova;
+    return 0;
+
+  case STE_CONFIG_S1:
+    cd = smmu_cd(ste0, ssid);
+    if ((cd == 0) || read_dword(cd, &desc))
+        return 1;
+    /* V and AA64 */
+    if (!(desc & (1ULL << 31)) || !(desc & (1ULL << 41)))
+        return 1;
+    ias = 64 - FIELD(desc, 5, 0);
+    g = granule_log2(FIELD(desc, 7, 6));
+    if (read_dword(cd + 8, &desc) || (g == 0))
+        return 1;
+    bits = g - 3;
+    return smmu_walk(desc & ADDR_MASK(4), ias, g,
+                     4 - (ias - g + bits - 1) / bits, iova, pa);
+
+  case STE_CONFIG_S2:
+    if (read_dword(ste + 16, &desc))
+        return 1;
+    vtcr = FIELD(desc, 50, 32);
+    ias = 64 - FIELD(vtcr, 5, 0);
+    sl0 = FIELD(vtcr, 7, 6);
+    g = granule_log2(FIELD(vtcr, 15, 14));
+    if (read_dword(ste + 24, &desc) || (g == 0) || (sl0 == 3))
+        return 1;
+    /* SL0 counts back from level 2 for 4KB granules, from level 3 otherwise */
+    return smmu_walk(desc & ADDR_MASK(4), ias, g,
+                     ((g == 12) ? 2 : 3) - sl0, iova, pa);
+
+  default:
+    return 1;
+  }
+}
@@ -348,6 +348,8 @@ typedef struct PERIPHERAL_VECTOR_LIST_STRUCT
 
 UINT32 pal_get_msi_vectors (UINT32 seg, UINT32 bus, UINT32 dev, UINT32 fn, PERIPHERAL_VECTOR_LIST **mvector);
 
+UINT64 pal_get_acpi_table_ptr(UINT32 Signature, UINT32 Instance);
+
 #define LEGACY_PCI_IRQ_CNT 4  // Legacy PCI IRQ A, B, C. and D
 #define MAX_IRQ_CNT 0xFFFF    // This value is arbitrary and may have to be adjusted
 
@@ -389,7 +391,8 @@ typedef struct {
 } MEMORY_INFO_TABLE;
 
 
-VOID  pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable);
+VOID  pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable, UINT32 MaxEntries);
+UINT32 pal_memory_info_table_entries(VOID);
 
 VOID    *pal_mem_alloc(UINT32 size);
 VOID    *pal_mem_alloc_cacheable(UINT32 bdf, UINT32 size, VOID **pa);
@@ -40,16 +40,33 @@ pal_get_madt_ptr();
 GIC_INFO_ENTRY  *g_gic_entry = NULL;
 GIC_ITS_INFO    *g_gic_its_info;
 
+/**
+  @brief  Check whether Needed more entries, and the end marker after them, fit in
+          a GIC info table sized for MaxEntries entries. Warns when they do not.
+**/
+STATIC
+BOOLEAN
+pal_gic_table_full(GIC_INFO_TABLE *GicTable, GIC_INFO_ENTRY *GicEntry, UINT32 Needed,
+                   UINT32 MaxEntries)
+{
+  if ((UINT32)(GicEntry - GicTable->gic_info) + Needed < MaxEntries)
+    return FALSE;
+
+  bsa_print(ACS_PRINT_WARN, L" GIC_INFO: Table full at %d entries \n", MaxEntries);
+  return TRUE;
+}
+
 /**
   @brief  Populate information about the GIC sub-system at the input address.
           In a UEFI-ACPI framework, this information is part of the MADT table.
 
-  @param  GicTable  Address of the memory region where this information is to be filled in
+  @param  GicTable    Address of the memory region where this information is to be filled in
+  @param  MaxEntries  Number of entries the table has room for, end marker included
 
   @return None
 **/
 VOID
-pal_gic_create_info_table(GIC_INFO_TABLE *GicTable)
+pal_gic_create_info_table(GIC_INFO_TABLE *GicTable, UINT32 MaxEntries)
 {
   EFI_ACPI_6_1_GIC_STRUCTURE    *Entry = NULL;
   GIC_INFO_ENTRY                *GicEntry = NULL;
@@ -86,6 +103,10 @@ pal_gic_create_info_table(GIC_INFO_TABLE *GicTable)
 
   do {
 
+    /* A GICC structure adds up to three entries, the others one */
+    if (pal_gic_table_full(GicTable, GicEntry, (Entry->Type == EFI_ACPI_6_1_GIC) ? 3 : 1, MaxEntries))
+      break;
+
     if (Entry->Type == EFI_ACPI_6_1_GIC) {
       if (Entry->PhysicalBaseAddress != 0) {
         GicEntry->type = ENTRY_TYPE_CPUIF;
@@ -163,6 +184,38 @@ pal_gic_create_info_table(GIC_INFO_TABLE *GicTable)
 
 }
 
+/**
+  @brief  Return the number of GIC_INFO entries pal_gic_create_info_table may fill:
+          up to three for each GICC structure (CPU interface, redistributor, GICH),
+          one for every other MADT structure, and the end marker.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_gic_info_table_entries()
+{
+  EFI_ACPI_6_1_GIC_STRUCTURE    *Entry;
+  UINT32                        Length;
+  UINT32                        Count = 1;
+
+  gMadtHdr = (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER *) pal_get_madt_ptr();
+  if (gMadtHdr == NULL)
+    return 0;
+
+  Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) (gMadtHdr + 1);
+  Length = sizeof (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER);
+
+  while ((Length < gMadtHdr->Header.Length) && Entry->Length) {
+    Count += (Entry->Type == EFI_ACPI_6_1_GIC) ? 3 : 1;
+    Length += Entry->Length;
+    Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) ((UINT8 *)Entry + (Entry->Length));
+  }
+
+  return Count;
+}
+
 /**
   @brief  Enable the interrupt in the GIC Distributor and GIC CPU Interface and hook
           the interrupt service routine for the IRQ to the UEFI Framework
@@ -415,10 +468,64 @@ pal_gic_request_msi (
     return 0xFFFFFFFF;
   }
 
-  ArmGicItsCreateLpiMap(ItsIndex, DevID, IntID, LPI_PRIORITY1);
+  /* The MSI-X vector index is the EventID, as for a range */
+  if (EFI_ERROR(ArmGicItsCreateLpiMap(ItsIndex, DevID, msi_index, IntID, LPI_PRIORITY1)))
+    return 0xFFFFFFFF;
+
+  *msi_addr = ArmGicItsGetGITSTranslatorAddress(ItsIndex);
+  *msi_data = msi_index;
+
+  return 0;
+}
+
+/**
+  @brief  Map a block of consecutive MSI vectors of a device to consecutive LPIs
+          with one batch of ITS commands.
+
+  @param  ItsID       ITS block ID
+  @param  DevID       Device ID as seen by the ITS
+  @param  IntID       First LPI of the range
+  @param  msi_index   First event ID (MSI-X table index) of the range
+  @param  num_vectors Number of vectors to map
+  @param  msi_addr    Doorbell address to be programmed in the MSI-X table
+  @param  msi_data    Data of the first vector, incremented by one per vector
+
+  @return 0 on success, 0xFFFFFFFF on failure
+**/
+UINT32
+pal_gic_request_msi_range (
+  UINT32    ItsID,
+  UINT32    DevID,
+  UINT32    IntID,
+  UINT32    msi_index,
+  UINT32    num_vectors,
+  UINT32    *msi_addr,
+  UINT32    *msi_data
+  )
+{
+  UINT32  ItsIndex;
+
+  if ((g_gic_its_info == NULL) || (g_gic_its_info->GicNumIts == 0))
+    return 0xFFFFFFFF;
+
+  ItsIndex = getItsIndex(ItsID);
+  if (ItsIndex > g_gic_its_info->GicNumIts) {
+    bsa_print(ACS_PRINT_ERR, L"\n       Could not find ITS block in MADT", 0);
+    return 0xFFFFFFFF;
+  }
+
+  if ((g_gic_its_info->GicRdBase == 0) || (g_gic_its_info->GicDBase == 0))
+  {
+    bsa_print(ACS_PRINT_DEBUG, L"GICD/GICRD Base Invalid value.\n", 0);
+    return 0xFFFFFFFF;
+  }
+
+  if (EFI_ERROR(ArmGicItsCreateLpiMapRange(ItsIndex, DevID, msi_index, IntID, num_vectors,
+                                           LPI_PRIORITY1)))
+    return 0xFFFFFFFF;
 
   *msi_addr = ArmGicItsGetGITSTranslatorAddress(ItsIndex);
-  *msi_data = IntID;
+  *msi_data = msi_index;
 
   return 0;
 }
@@ -448,5 +555,5 @@ pal_gic_free_msi (
     return;
   }
 
-  ArmGicItsClearLpiMappings(ItsIndex, DevID, IntID);
+  ArmGicItsClearLpiMappings(ItsIndex, DevID, msi_index, IntID);
 }
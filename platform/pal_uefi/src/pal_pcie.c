@@ -66,12 +66,13 @@ pal_pcie_get_mcfg_ecam()
 /**
   @brief  Fill the PCIE Info table with the details of the PCIe sub-system
 
-  @param  PcieTable - Address where the PCIe information needs to be filled.
+  @param  PcieTable  - Address where the PCIe information needs to be filled.
+  @param  MaxEntries - Number of PCIE_INFO_BLOCK entries the table has room for.
 
   @return  None
  **/
 VOID
-pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
+pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable, UINT32 MaxEntries)
 {
 
   EFI_ACPI_MEMORY_MAPPED_ENHANCED_CONFIGURATION_SPACE_BASE_ADDRESS_ALLOCATION_STRUCTURE  *Entry = NULL;
@@ -105,6 +106,10 @@ pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
   do{
       if (Entry == NULL)  //Due to a buggy MCFG - first entry is null, then exit
           break;
+      if (i >= MaxEntries) {
+          bsa_print(ACS_PRINT_WARN, L" PCIE_INFO: Table full at %d entries \n", MaxEntries);
+          break;
+      }
       PcieTable->block[i].ecam_base     = Entry->BaseAddress;
       PcieTable->block[i].segment_num   = Entry->PciSegmentGroupNumber;
       PcieTable->block[i].start_bus_num = Entry->StartBusNumber;
@@ -118,6 +123,30 @@ pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
   return;
 }
 
+/**
+  @brief  Return the number of PCIE_INFO entries pal_pcie_create_info_table
+          fills, one per MCFG allocation structure.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_pcie_info_table_entries()
+{
+  UINT32 Count;
+
+  gMcfgHdr = (EFI_ACPI_MEMORY_MAPPED_CONFIGURATION_BASE_ADDRESS_TABLE_HEADER *) pal_get_mcfg_ptr();
+  if (gMcfgHdr == NULL)
+    return 0;
+
+  Count = (gMcfgHdr->Header.Length - sizeof(EFI_ACPI_MEMORY_MAPPED_CONFIGURATION_BASE_ADDRESS_TABLE_HEADER)) /
+          sizeof(EFI_ACPI_MEMORY_MAPPED_ENHANCED_CONFIGURATION_SPACE_BASE_ADDRESS_ALLOCATION_STRUCTURE);
+
+  /* The table is always written at least once, even from an empty MCFG */
+  return (Count == 0) ? 1 : Count;
+}
+
 /**
     @brief   Reads 32-bit data from PCIe config space pointed by Bus,
            Device, Function and register offset, using UEFI PciIoProtocol
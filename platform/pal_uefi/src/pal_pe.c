@@ -115,12 +115,13 @@ PalAllocateSecondaryStack(UINT64 mpidr)
   @brief  This API fills in the PE_INFO Table with information about the PEs in the
           system. This is achieved by parsing the ACPI - MADT table.
 
-  @param  PeTable  - Address where the PE information needs to be filled.
+  @param  PeTable    - Address where the PE information needs to be filled.
+  @param  MaxEntries - Number of PE entries the table has room for.
 
   @return  None
 **/
 VOID
-pal_pe_create_info_table(PE_INFO_TABLE *PeTable)
+pal_pe_create_info_table(PE_INFO_TABLE *PeTable, UINT32 MaxEntries)
 {
   EFI_ACPI_6_1_GIC_STRUCTURE    *Entry = NULL;
   PE_INFO_ENTRY                 *Ptr = NULL;
@@ -153,6 +154,10 @@ pal_pe_create_info_table(PE_INFO_TABLE *PeTable)
   do {
 
     if (Entry->Type == EFI_ACPI_6_1_GIC) {
+      if (PeTable->header.num_of_pe >= MaxEntries) {
+        bsa_print(ACS_PRINT_WARN, L" PE_INFO: Table full at %d entries \n", MaxEntries);
+        break;
+      }
       //Fill in the cpu num and the mpidr in pe info table
       Ptr->mpidr      = Entry->MPIDR;
       Ptr->pe_num     = PeTable->header.num_of_pe;
@@ -182,6 +187,38 @@ pal_pe_create_info_table(PE_INFO_TABLE *PeTable)
 
 }
 
+/**
+  @brief  Return the number of PE_INFO entries pal_pe_create_info_table fills,
+          one for each GICC structure in the MADT.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_pe_info_table_entries()
+{
+  EFI_ACPI_6_1_GIC_STRUCTURE    *Entry;
+  UINT32                        Length;
+  UINT32                        Count = 0;
+
+  gMadtHdr = (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER *) pal_get_madt_ptr();
+  if (gMadtHdr == NULL)
+    return 0;
+
+  Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) (gMadtHdr + 1);
+  Length = sizeof (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER);
+
+  while ((Length < gMadtHdr->Header.Length) && Entry->Length) {
+    if (Entry->Type == EFI_ACPI_6_1_GIC)
+      Count++;
+    Length += Entry->Length;
+    Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) ((UINT8 *)Entry + (Entry->Length));
+  }
+
+  return Count;
+}
+
 /**
   @brief  Install Exception Handler using UEFI CPU Architecture protocol's
           Register Interrupt Handler API
@@ -24,6 +24,7 @@
 #include <Library/DxeServicesTableLib.h>
 
 #include <Protocol/AcpiTable.h>
+#include <Protocol/PciIo.h>
 #include "Include/IndustryStandard/Acpi61.h"
 #include "Include/IndustryStandard/SerialPortConsoleRedirectionTable.h"
 
@@ -37,19 +38,39 @@
 #define BAR1            1
 #define BAR2            2
 
+/* Descriptors UEFI may add to the memory map between sizing and filling the memory table */
+#define MEM_INFO_TABLE_SLACK  8
+
 UINT64
 pal_get_spcr_ptr();
 
+/**
+  @brief  Check whether one more entry, and the end marker after it, fit in a
+          peripheral info table sized for MaxEntries entries. Warns when they do not.
+**/
+STATIC
+BOOLEAN
+pal_peripheral_table_full(PERIPHERAL_INFO_TABLE *peripheralInfoTable, PERIPHERAL_INFO_BLOCK *per_info,
+                          UINT32 MaxEntries)
+{
+  if ((UINT32)(per_info - peripheralInfoTable->info) + 1 < MaxEntries)
+    return FALSE;
+
+  bsa_print(ACS_PRINT_WARN, L" PERIPHERAL_INFO: Table full at %d entries \n", MaxEntries);
+  return TRUE;
+}
+
 /**
   @brief  This API fills in the PERIPHERAL_INFO_TABLE with information about peripherals
           in the system. This is achieved by parsing the ACPI - SPCR table and PCIe config space.
 
   @param  peripheralInfoTable  - Address where the Peripheral information needs to be filled.
+  @param  MaxEntries           - Number of entries the table has room for, end marker included.
 
   @return  None
 **/
 VOID
-pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
+pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries)
 {
   UINT32   DeviceBdf = 0;
   UINT32   StartBdf  = 0;
@@ -72,6 +93,8 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
 
        DeviceBdf = palPcieGetBdf(USB_CLASSCODE, StartBdf);
        if (DeviceBdf != 0) {
+          if (pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries))
+            break;
           per_info->type  = PERIPHERAL_TYPE_USB;
           per_info->base0 = palPcieGetBase(DeviceBdf, BAR0);
           per_info->bdf   = DeviceBdf;
@@ -89,6 +112,8 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
 
        DeviceBdf = palPcieGetBdf(SATA_CLASSCODE, StartBdf);
        if (DeviceBdf != 0) {
+          if (pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries))
+            break;
           per_info->type  = PERIPHERAL_TYPE_SATA;
           per_info->base0 = palPcieGetBase(DeviceBdf, BAR0);
           per_info->bdf   = DeviceBdf;
@@ -104,7 +129,7 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
   /* Search for a SPCR table in the system to get the UART details */
   spcr = (EFI_ACPI_SERIAL_PORT_CONSOLE_REDIRECTION_TABLE *)pal_get_spcr_ptr();
 
-  if (spcr) {
+  if (spcr && !pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries)) {
     peripheralInfoTable->header.num_uart++;
     per_info->base0 = spcr->BaseAddress.Address;
     per_info->irq   = spcr->GlobalSystemInterrupt;
@@ -112,7 +137,7 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
     per_info++;
   }
 
-  if (PLATFORM_GENERIC_UART_BASE) {
+  if (PLATFORM_GENERIC_UART_BASE && !pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries)) {
     peripheralInfoTable->header.num_uart++;
     per_info->base0 = PLATFORM_GENERIC_UART_BASE;
     per_info->irq   = PLATFORM_GENERIC_UART_INTID;
@@ -124,6 +149,34 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
 
 }
 
+/**
+  @brief  Return the number of PERIPHERAL_INFO entries pal_peripheral_create_info_table
+          may fill: every PCI function could be a USB or SATA controller, plus the
+          SPCR and override UARTs and the end marker.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_peripheral_info_table_entries()
+{
+  EFI_STATUS  Status;
+  EFI_HANDLE  *HandleBuffer;
+  UINTN       HandleCount = 0;
+  UINT32      Count;
+
+  Status = gBS->LocateHandleBuffer (ByProtocol, &gEfiPciIoProtocolGuid, NULL, &HandleCount, &HandleBuffer);
+  if (!EFI_ERROR (Status))
+    gBS->FreePool (HandleBuffer);
+  else
+    HandleCount = 0;
+
+  Count = (UINT32)HandleCount + 3;
+
+  return Count;
+}
+
 
 /**
   @brief  Check if the memory type is reserved for UEFI
@@ -202,12 +255,13 @@ IsDeviceMemory(EFI_MEMORY_TYPE type)
   @brief  This API fills in the MEMORY_INFO_TABLE with information about memory in the
           system. This is achieved by parsing the UEFI memory map.
 
-  @param  peripheralInfoTable  - Address where the Peripheral information needs to be filled.
+  @param  memoryInfoTable  - Address where the memory information needs to be filled.
+  @param  MaxEntries       - Number of entries the table has room for, end marker included.
 
   @return  None
 **/
 VOID
-pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable)
+pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable, UINT32 MaxEntries)
 {
 
   UINTN                 MemoryMapSize;
@@ -248,6 +302,10 @@ pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable)
   if (!EFI_ERROR (Status)) {
     MemoryMapPtr = MemoryMap;
     for (Index = 0; Index < (MemoryMapSize / DescriptorSize); Index++) {
+      if (i + 1 >= MaxEntries) {
+        bsa_print(ACS_PRINT_WARN, L" MEMORY_INFO: Table full at %d entries \n", MaxEntries);
+        break;
+      }
           bsa_print(ACS_PRINT_INFO, L"Reserved region of type %d [0x%lX, 0x%lX]\n",
             MemoryMapPtr->Type, (UINTN)MemoryMapPtr->PhysicalStart,
             (UINTN)(MemoryMapPtr->PhysicalStart + MemoryMapPtr->NumberOfPages * EFI_PAGE_SIZE));
@@ -271,9 +329,34 @@ pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable)
 
       MemoryMapPtr = (EFI_MEMORY_DESCRIPTOR*)((UINTN)MemoryMapPtr + DescriptorSize);
     }
-    memoryInfoTable->info[i].type      = MEMORY_TYPE_LAST_ENTRY;
   }
+  memoryInfoTable->info[i].type      = MEMORY_TYPE_LAST_ENTRY;
+
+}
+
+/**
+  @brief  Return the number of MEM_INFO entries pal_memory_create_info_table may
+          fill: one per UEFI memory map descriptor and the end marker, with slack
+          for descriptors added by allocations made before the table is filled.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_memory_info_table_entries()
+{
+  UINTN                 MemoryMapSize = 0;
+  UINTN                 MapKey;
+  UINTN                 DescriptorSize = 0;
+  UINT32                DescriptorVersion;
+  EFI_STATUS            Status;
+
+  Status = gBS->GetMemoryMap (&MemoryMapSize, NULL, &MapKey, &DescriptorSize, &DescriptorVersion);
+  if ((Status != EFI_BUFFER_TOO_SMALL) || (DescriptorSize == 0))
+    return 1;  /* the end marker alone */
 
+  return (UINT32)(MemoryMapSize / DescriptorSize) + MEM_INFO_TABLE_SLACK + 1;
 }
 
 UINT64
@@ -137,12 +137,30 @@ pal_timer_create_info_table(TIMER_INFO_TABLE *TimerTable)
 
 }
 
+/**
+  @brief  Return the number of GT block entries pal_timer_create_info_table may
+          fill: at most one per GTDT platform timer structure, plus the override.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_timer_info_table_entries()
+{
+  gGtdtHdr = (EFI_ACPI_6_1_GENERIC_TIMER_DESCRIPTION_TABLE *) pal_get_gtdt_ptr();
+  if (gGtdtHdr == NULL)
+    return 0;
+
+  return gGtdtHdr->PlatformTimerCount + 1;
+}
+
 /* Only one watchdog information can be assigned as an override */
 VOID
-pal_wd_platform_override(WD_INFO_TABLE *WdTable)
+pal_wd_platform_override(WD_INFO_TABLE *WdTable, UINT32 MaxEntries)
 {
 
-  if (PLATFORM_OVERRIDE_WD == 1) {
+  if ((PLATFORM_OVERRIDE_WD == 1) && (MaxEntries > 0)) {
       WdTable->header.num_wd              = 1;
       WdTable->wd_info[0].wd_refresh_base = PLATFORM_OVERRIDE_WD_REFRESH_BASE;
       WdTable->wd_info[0].wd_ctrl_base    = PLATFORM_OVERRIDE_WD_CTRL_BASE;
@@ -157,13 +175,14 @@ pal_wd_platform_override(WD_INFO_TABLE *WdTable)
   @brief  This API fills in the WD_INFO_TABLE with information about Watchdogs
           in the system. This is achieved by parsing the ACPI - GTDT table.
 
-  @param  WdTable  - Address where the Timer information needs to be filled.
+  @param  WdTable    - Address where the Timer information needs to be filled.
+  @param  MaxEntries - Number of WD_INFO_BLOCK entries the table has room for.
 
   @return  None
 **/
 
 VOID
-pal_wd_create_info_table(WD_INFO_TABLE *WdTable)
+pal_wd_create_info_table(WD_INFO_TABLE *WdTable, UINT32 MaxEntries)
 {
 
   EFI_ACPI_6_1_GTDT_SBSA_GENERIC_WATCHDOG_STRUCTURE    *Entry = NULL;
@@ -198,6 +217,10 @@ pal_wd_create_info_table(WD_INFO_TABLE *WdTable)
     }
 
     if (Entry->Type == EFI_ACPI_6_1_GTDT_SBSA_GENERIC_WATCHDOG) {
+      if (WdTable->header.num_wd >= MaxEntries) {
+        bsa_print(ACS_PRINT_WARN, L" WD_INFO: Table full at %d entries \n", MaxEntries);
+        break;
+      }
       WdEntry->wd_refresh_base = Entry->RefreshFramePhysicalAddress;
       WdEntry->wd_ctrl_base    = Entry->WatchdogControlFramePhysicalAddress;
       WdEntry->wd_gsiv         = Entry->WatchdogTimerGSIV;
@@ -211,6 +234,24 @@ pal_wd_create_info_table(WD_INFO_TABLE *WdTable)
 
   }
 
-  pal_wd_platform_override(WdTable);
+  pal_wd_platform_override(WdTable, MaxEntries);
+
+}
+
+/**
+  @brief  Return the number of WD_INFO entries pal_wd_create_info_table may
+          fill: at most one per GTDT platform timer structure, plus the override.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_wd_info_table_entries()
+{
+  gGtdtHdr = (EFI_ACPI_6_1_GENERIC_TIMER_DESCRIPTION_TABLE *) pal_get_gtdt_ptr();
+  if (gGtdtHdr == NULL)
+    return 0;
 
+  return gGtdtHdr->PlatformTimerCount + 1;
 }
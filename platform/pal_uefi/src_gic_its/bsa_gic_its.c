@@ -24,6 +24,7 @@
 #include <Library/UefiLib.h>
 #include <Library/IoLib.h>
 #include <Library/DebugLib.h>
+#include <Library/TimerLib.h>
 
 #include "Include/IndustryStandard/Acpi61.h"
 #include <Protocol/AcpiTable.h>
@@ -38,6 +39,7 @@ UINT64 ArmReadMpidr(VOID);
 extern GIC_ITS_INFO    *g_gic_its_info;
 static UINT32          *g_cwriter_ptr;
 static UINT32           g_its_setup_done = 0;
+static GIC_ITS_CMDQ_STATS *g_cmdq_stats;
 
 UINT64
 GetCurrentCpuRDBase (
@@ -47,6 +49,7 @@ GetCurrentCpuRDBase (
 {
   UINT64     Mpidr;
   UINT32     Affinity, CpuAffinity;
+  UINT32     Typer;
   UINT32     GicRedistributorGranularity;
   UINT64     GicCpuRedistributorBase;
 
@@ -78,10 +81,19 @@ GetCurrentCpuRDBase (
       return GicCpuRedistributorBase;
     }
 
+    Typer = MmioRead32(GicCpuRedistributorBase + ARM_GICR_TYPER);
+
+    /* GICR_TYPER.Last marks the final frame of this region */
+    if (Typer & ARM_GICR_TYPER_LAST)
+      return 0;
+
     /* Move to the next GIC Redistributor frame */
     GicCpuRedistributorBase += GicRedistributorGranularity;
+    if (Typer & ARM_GICR_TYPER_VLPIS)
+      GicCpuRedistributorBase += ARM_GICR_VLPI_FRAMES_SIZE;
   }
 
+  DEBUG((DEBUG_INFO, "\n GICR_TYPER.Last not set in region 0x%lx", mGicRedistributorBase));
   return 0;
 }
 
@@ -127,8 +139,10 @@ ArmGicSetItsCommandQueueBase (
   g_gic_its_info->GicIts[ItsIndex].CommandQBase = Address;
   DEBUG((DEBUG_INFO, "%a Address Allocated : %x\n", __func__, Address));
 
-  write_value = MmioRead64(ItsBase + ARM_GITS_CBASER) & (~ARM_GITS_CBASER_PA_MASK);
+  /* Size the queue as allocated, the commands written by the driver go up to its end */
+  write_value = MmioRead64(ItsBase + ARM_GITS_CBASER) & ~(ARM_GITS_CBASER_PA_MASK | ARM_GITS_CBASER_SIZE_MASK);
   write_value = write_value | (Address & ARM_GITS_CBASER_PA_MASK);
+  write_value = write_value | (NUM_PAGES_8 - 1);
   write_value = write_value | ARM_GITS_CBASER_VALID;
   MmioWrite64(ItsBase + ARM_GITS_CBASER, write_value);
 
@@ -147,6 +161,7 @@ ArmGicSetItsTables (
   UINT8                 it, table_type;
   UINT64                write_value;
   UINT32                DevBits, CIDBits;
+  UINT32                ITTEntries;
   EFI_PHYSICAL_ADDRESS  Address;
   UINT64                ItsBase;
 
@@ -202,6 +217,14 @@ ArmGicSetItsTables (
 
   g_gic_its_info->GicIts[ItsIndex].ITTBase = Address;
 
+  /* MAPD gives every device an ITT of 2^(Size+1) entries, which has to fit in the allocation */
+  its_typer  = MmioRead64(ItsBase + ARM_GITS_TYPER);
+  ITTEntries = (NUM_PAGES_8 * SIZE_4KB) / (ARM_GITS_TYPER_ITTEntrySize(its_typer) + 1);
+  g_gic_its_info->GicIts[ItsIndex].EventIDBits = 0;
+  while (((4u << g_gic_its_info->GicIts[ItsIndex].EventIDBits) <= ITTEntries) &&
+         (g_gic_its_info->GicIts[ItsIndex].EventIDBits < g_gic_its_info->GicIts[ItsIndex].IDBits))
+    g_gic_its_info->GicIts[ItsIndex].EventIDBits++;
+
   return EFI_SUCCESS;
 }
 
@@ -253,16 +276,31 @@ WriteCmdQMAPC (
 }
 
 VOID
-WriteCmdQMAPI (
+WriteCmdQMAPTI (
   IN UINT32     ItsIndex,
   IN UINT64     *CMDQ_BASE,
   IN UINT64     DevID,
-  IN UINT32     IntID,
+  IN UINT32     EventID,
+  IN UINT64     IntID,
+  IN UINT32     Clctn_ID
+  )
+{
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex]), (UINT64)((DevID << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPTI));
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 1), (UINT64)((IntID << ITS_CMD_SHIFT_PINTID) | EventID));
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 2), (UINT64)(Clctn_ID));
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 3), (UINT64)(0x0));
+    g_cwriter_ptr[ItsIndex] = g_cwriter_ptr[ItsIndex] + ITS_NEXT_CMD_PTR;
+}
+
+VOID
+WriteCmdQINVALL (
+  IN UINT32     ItsIndex,
+  IN UINT64     *CMDQ_BASE,
   IN UINT32     Clctn_ID
   )
 {
-    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex]), (UINT64)((DevID << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_MAPI));
-    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 1), (UINT64)(IntID));
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex]), (UINT64)(ARM_ITS_CMD_INVALL));
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 1), (UINT64)(0x0));
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 2), (UINT64)(Clctn_ID));
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 3), (UINT64)(0x0));
     g_cwriter_ptr[ItsIndex] = g_cwriter_ptr[ItsIndex] + ITS_NEXT_CMD_PTR;
@@ -273,11 +311,11 @@ WriteCmdQINV (
   IN UINT32     ItsIndex,
   IN UINT64     *CMDQ_BASE,
   IN UINT64     DevID,
-  IN UINT32     IntID
+  IN UINT32     EventID
   )
 {
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex]), (UINT64)((DevID << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_INV));
-    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 1), (UINT64)(IntID));
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 1), (UINT64)(EventID));
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 2), (UINT64)(0x0));
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 3), (UINT64)(0x0));
     g_cwriter_ptr[ItsIndex] = g_cwriter_ptr[ItsIndex] + ITS_NEXT_CMD_PTR;
@@ -288,11 +326,11 @@ WriteCmdQDISCARD (
   IN UINT32     ItsIndex,
   IN UINT64     *CMDQ_BASE,
   IN UINT64     DevID,
-  IN UINT32     IntID
+  IN UINT32     EventID
   )
 {
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex]), (UINT64)((DevID << ITS_CMD_SHIFT_DEVID) | ARM_ITS_CMD_DISCARD));
-    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 1), (UINT64)(IntID));
+    MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 1), (UINT64)(EventID));
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 2), (UINT64)(0x0));
     MmioWrite64((UINT64)(CMDQ_BASE + g_cwriter_ptr[ItsIndex] + 3), (UINT64)(0x0));
     g_cwriter_ptr[ItsIndex] = g_cwriter_ptr[ItsIndex] + ITS_NEXT_CMD_PTR;
@@ -351,6 +389,99 @@ PollTillCommandQueueDone (
 
 }
 
+/**
+  Decode the commands queued since CmdStart the same way the ITS will consume
+  them, count them by opcode and flag SYNC or INV commands that have no effect.
+**/
+VOID
+CheckCmdQBatch (
+  IN UINT32     ItsIndex,
+  IN UINT32     CmdStart
+  )
+{
+  UINT64              *CmdQ;
+  UINT64              Dw0;
+  UINT32              Opcode;
+  UINT32              index;
+  UINT32              HasInvAll;
+  UINT32              NumCmds;
+  GIC_ITS_CMDQ_STATS  *Stats;
+
+  if (g_cmdq_stats == NULL)
+    return;
+
+  Stats     = &g_cmdq_stats[ItsIndex];
+  CmdQ      = (UINT64 *)g_gic_its_info->GicIts[ItsIndex].CommandQBase;
+  HasInvAll = 0;
+  NumCmds   = 0;
+
+  for (index = CmdStart; index < g_cwriter_ptr[ItsIndex]; index += ITS_NEXT_CMD_PTR) {
+    if ((MmioRead64((UINT64)(CmdQ + index)) & ARM_ITS_CMD_OPCODE_MASK) == ARM_ITS_CMD_INVALL)
+      HasInvAll = 1;
+  }
+
+  for (index = CmdStart; index < g_cwriter_ptr[ItsIndex]; index += ITS_NEXT_CMD_PTR) {
+    Dw0    = MmioRead64((UINT64)(CmdQ + index));
+    Opcode = Dw0 & ARM_ITS_CMD_OPCODE_MASK;
+    NumCmds++;
+
+    Stats->NumCmds[(Opcode < ARM_ITS_CMD_NUM_OPCODES) ? Opcode : 0]++;
+
+    switch (Opcode) {
+    case ARM_ITS_CMD_SYNC:
+      if (Stats->CmdsSinceSync == 0) {
+        Stats->RedundantSync++;
+        DEBUG ((DEBUG_INFO, "\n       ITS : Redundant SYNC at command %d", index / ITS_NEXT_CMD_PTR));
+      }
+      Stats->CmdsSinceSync = 0;
+      continue;
+    case ARM_ITS_CMD_INV:
+      if (HasInvAll) {
+        Stats->RedundantInv++;
+        DEBUG ((DEBUG_INFO, "\n       ITS : INV for DevID 0x%x EventID 0x%x covered by INVALL",
+                (UINT32)(Dw0 >> ITS_CMD_SHIFT_DEVID), (UINT32)MmioRead64((UINT64)(CmdQ + index + 1))));
+      }
+      break;
+    case ARM_ITS_CMD_MAPI:
+    case ARM_ITS_CMD_MAPTI:
+      Stats->MappedEvents++;
+      break;
+    case ARM_ITS_CMD_DISCARD:
+      if (Stats->MappedEvents)
+        Stats->MappedEvents--;
+      break;
+    default:
+      break;
+    }
+    Stats->CmdsSinceSync++;
+  }
+
+  DEBUG ((DEBUG_INFO, "\n       ITS : Index %d batch of %d commands, %d events mapped",
+          ItsIndex, NumCmds, Stats->MappedEvents));
+}
+
+/**
+  Hand the commands queued since CmdStart to the ITS and wait for them to be consumed.
+**/
+VOID
+SubmitCmdQ (
+  IN UINT32     ItsIndex,
+  IN UINT32     CmdStart
+  )
+{
+  UINT64    ItsBase;
+
+  ItsBase = g_gic_its_info->GicIts[ItsIndex].Base;
+
+  CheckCmdQBatch(ItsIndex, CmdStart);
+
+  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
+  MmioWrite64((ItsBase + ARM_GITS_CWRITER), (g_cwriter_ptr[ItsIndex] * NUM_BYTES_IN_DW));
+
+  /* Check CREADR value which ensures Command Queue is processed */
+  PollTillCommandQueueDone(ItsIndex);
+}
+
 UINT64
 GetRDBaseFormat (
   IN UINT32     ItsIndex
@@ -379,19 +510,19 @@ VOID
 ArmGicItsClearLpiMappings (
   IN UINT32     ItsIndex,
   IN UINT32     DevID,
+  IN UINT32     EventID,
   IN UINT32     IntID
   )
 {
-  UINT64    value;
+  UINT32    CmdStart;
   UINT64    RDBase;
-  UINT64    ItsBase;
   UINT64    ItsCommandBase;
 
   if (!g_its_setup_done)
     return;
 
-  ItsBase        = g_gic_its_info->GicIts[ItsIndex].Base;
   ItsCommandBase = g_gic_its_info->GicIts[ItsIndex].CommandQBase;
+  CmdStart       = g_cwriter_ptr[ItsIndex];
 
   /* Clear Config table for LPI=IntID */
   ClearConfigTable(IntID);
@@ -400,38 +531,40 @@ ArmGicItsClearLpiMappings (
   RDBase = GetRDBaseFormat(ItsIndex);
 
   /* Discard Mappings */
-  WriteCmdQDISCARD(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, IntID);
+  WriteCmdQDISCARD(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, EventID);
   /* ITS SYNC Command */
   WriteCmdQSYNC(ItsIndex, (UINT64 *)(ItsCommandBase), RDBase);
 
-  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[ItsIndex] * NUM_BYTES_IN_DW));
-  MmioWrite64((ItsBase + ARM_GITS_CWRITER), value);
-
-  /* Check CREADR value which ensures Command Queue is processed */
-  PollTillCommandQueueDone(ItsIndex);
+  SubmitCmdQ(ItsIndex, CmdStart);
 
 }
 
 EFIAPI
-VOID
+EFI_STATUS
 ArmGicItsCreateLpiMap (
   IN UINT32     ItsIndex,
   IN UINT32     DevID,
+  IN UINT32     EventID,
   IN UINT32     IntID,
   IN UINT32     Priority
   )
 {
-  UINT64    value;
+  UINT32    CmdStart;
   UINT64    RDBase;
   UINT64    ItsBase;
   UINT64    ItsCommandBase;
 
   if (!g_its_setup_done)
-    return;
+    return EFI_NOT_READY;
+
+  if (EventID >> (g_gic_its_info->GicIts[ItsIndex].EventIDBits + 1)) {
+    DEBUG ((DEBUG_ERROR, "\n       ITS : EventID 0x%x does not fit in the ITT", EventID));
+    return EFI_OUT_OF_RESOURCES;
+  }
 
   ItsBase        = g_gic_its_info->GicIts[ItsIndex].Base;
   ItsCommandBase = g_gic_its_info->GicIts[ItsIndex].CommandQBase;
+  CmdStart       = g_cwriter_ptr[ItsIndex];
 
   /* Set Config table with enable the LPI = IntID, Priority. */
   SetConfigTable(IntID, Priority);
@@ -448,23 +581,96 @@ ArmGicItsCreateLpiMap (
   /* Map Device using MAPD */
   WriteCmdQMAPD(ItsIndex, (UINT64 *)(ItsCommandBase), DevID,
                 g_gic_its_info->GicIts[ItsIndex].ITTBase,
-                g_gic_its_info->GicIts[ItsIndex].IDBits, 0x1 /*Valid*/);
+                g_gic_its_info->GicIts[ItsIndex].EventIDBits, 0x1 /*Valid*/);
   /* Map Collection using MAPC */
   WriteCmdQMAPC(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, 0x1 /*Clctn_ID*/, RDBase, 0x1 /*Valid*/);
-  /* Map Interrupt using MAPI */
-  WriteCmdQMAPI(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, IntID, 0x1 /*Clctn_ID*/);
+  /* Map Interrupt using MAPTI */
+  WriteCmdQMAPTI(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, EventID, IntID, 0x1 /*Clctn_ID*/);
   /* Invalid Entry */
-  WriteCmdQINV(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, IntID);
+  WriteCmdQINV(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, EventID);
   /* ITS SYNC Command */
   WriteCmdQSYNC(ItsIndex, (UINT64 *)(ItsCommandBase), RDBase);
 
-  /* Update the CWRITER Register so that all the commands from Command queue gets executed.*/
-  value = ((g_cwriter_ptr[ItsIndex] * NUM_BYTES_IN_DW));
-  MmioWrite64((ItsBase + ARM_GITS_CWRITER), value);
+  SubmitCmdQ(ItsIndex, CmdStart);
 
-  /* Check CREADR value which ensures Command Queue is processed */
-  PollTillCommandQueueDone(ItsIndex);
+  return EFI_SUCCESS;
+}
+
+EFIAPI
+EFI_STATUS
+ArmGicItsCreateLpiMapRange (
+  IN UINT32     ItsIndex,
+  IN UINT32     DevID,
+  IN UINT32     EventID,
+  IN UINT32     IntID,
+  IN UINT32     NumVectors,
+  IN UINT32     Priority
+  )
+{
+  UINT64    RDBase;
+  UINT64    ItsBase;
+  UINT64    ItsCommandBase;
+  UINT32    CmdStart;
+  UINT32    index;
+  UINT64    StartTime;
+  UINT64    ElapsedNs;
+
+  if (!g_its_setup_done || (NumVectors == 0))
+    return EFI_NOT_READY;
 
+  StartTime      = GetPerformanceCounter();
+  ItsBase        = g_gic_its_info->GicIts[ItsIndex].Base;
+  ItsCommandBase = g_gic_its_info->GicIts[ItsIndex].CommandQBase;
+  CmdStart       = g_cwriter_ptr[ItsIndex];
+
+  /* The whole batch has to fit in what is left of the command queue */
+  if ((CmdStart / ITS_NEXT_CMD_PTR + ITS_RANGE_MAP_CMDS > ITS_CMDQ_NUM_CMDS) ||
+      (NumVectors > ITS_CMDQ_NUM_CMDS - ITS_RANGE_MAP_CMDS - CmdStart / ITS_NEXT_CMD_PTR)) {
+    DEBUG ((DEBUG_ERROR, "\n       ITS : No room in the command queue for %d vectors", NumVectors));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if ((EventID >> (g_gic_its_info->GicIts[ItsIndex].EventIDBits + 1)) ||
+      (NumVectors > (2u << g_gic_its_info->GicIts[ItsIndex].EventIDBits) - EventID)) {
+    DEBUG ((DEBUG_ERROR, "\n       ITS : EventIDs 0x%x + %d do not fit in the ITT", EventID, NumVectors));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  /* Set Config table for every LPI in the range before any command is queued. */
+  for (index = 0; index < NumVectors; index++)
+    SetConfigTable(IntID + index, Priority);
+
+  /* Enable Redistributor */
+  EnableLPIsRD(g_gic_its_info->GicRdBase);
+
+  /* Enable ITS */
+  EnableITS(ItsBase);
+
+  /* Get RDBase Depending on GITS_TYPER.PTA */
+  RDBase = GetRDBaseFormat(ItsIndex);
+
+  /* One MAPD and MAPC for the device, then one MAPTI per vector */
+  WriteCmdQMAPD(ItsIndex, (UINT64 *)(ItsCommandBase), DevID,
+                g_gic_its_info->GicIts[ItsIndex].ITTBase,
+                g_gic_its_info->GicIts[ItsIndex].EventIDBits, 0x1 /*Valid*/);
+  WriteCmdQMAPC(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, 0x1 /*Clctn_ID*/, RDBase, 0x1 /*Valid*/);
+  for (index = 0; index < NumVectors; index++)
+    WriteCmdQMAPTI(ItsIndex, (UINT64 *)(ItsCommandBase), DevID, EventID + index,
+                   IntID + index, 0x1 /*Clctn_ID*/);
+
+  /* A single INVALL on the collection picks up all the new config table entries */
+  WriteCmdQINVALL(ItsIndex, (UINT64 *)(ItsCommandBase), 0x1 /*Clctn_ID*/);
+  WriteCmdQSYNC(ItsIndex, (UINT64 *)(ItsCommandBase), RDBase);
+
+  /* Update the CWRITER Register once for the whole batch */
+  SubmitCmdQ(ItsIndex, CmdStart);
+
+  ElapsedNs = GetTimeInNanoSecond(GetPerformanceCounter() - StartTime);
+  DEBUG ((DEBUG_INFO, "\n       ITS : Mapped %d vectors with %d commands, %ld ns per vector",
+          NumVectors, (g_cwriter_ptr[ItsIndex] - CmdStart) / ITS_NEXT_CMD_PTR,
+          ElapsedNs / NumVectors));
+
+  return EFI_SUCCESS;
 }
 
 EFIAPI
@@ -547,6 +753,9 @@ ArmGicItsConfiguration (
   for (index=0; index<g_gic_its_info->GicNumIts; index++)
     g_cwriter_ptr[index] = 0;
 
+  /* Command queue statistics are diagnostic only, carry on without them */
+  g_cmdq_stats = AllocateZeroPool(sizeof(GIC_ITS_CMDQ_STATS) * (g_gic_its_info->GicNumIts));
+
   for (index=0; index<g_gic_its_info->GicNumIts; index++)
   {
     /* Set Initial configuration */
@@ -47,6 +47,9 @@
 #define ARM_GICR_TYPER_PLPIS    (1 << 0)
 #define ARM_GICR_TYPER_VLPIS    (1 << 1)
 #define ARM_GICR_TYPER_PN_MASK  (0xFFFF00)
+#define ARM_GICR_TYPER_LAST     (1 << 4)
+
+#define ARM_GICR_VLPI_FRAMES_SIZE  0x20000 /* VLPI + reserved frames of a GICv4 RD */
 
 /* GICR_PROPBASER Bits */
 #define ARM_GICR_PROPBASER_IDbits(Propbaser)    (Propbaser & 0x1F) /* IDBits implemented */
@@ -89,6 +92,7 @@
 #define ARM_GITS_TYPER_DevBits(its_typer)           ((its_typer >> 13) & 0x1F)
 #define ARM_GITS_TYPER_CIDBits(its_typer)           ((its_typer >> 32) & 0xF)
 #define ARM_GITS_TYPER_IDbits(its_typer)            ((its_typer >> 8) & 0x1F)
+#define ARM_GITS_TYPER_ITTEntrySize(its_typer)      ((its_typer >> 4) & 0xF)
 #define ARM_GITS_TYPER_PTA                          (1 << 19)
 
 /* GITS_CREADR Bits */
@@ -99,6 +103,7 @@
 
 /* GITS_CBASER Bits */
 #define ARM_GITS_CBASER_VALID           (1ul << 63)
+#define ARM_GITS_CBASER_SIZE_MASK       0xFFul      /* Number of 4KB pages - 1 */
 #define CBASER_PA_SHIFT                 12
 #define CBASER_PA_LEN                   40
 #define ARM_GITS_CBASER_PA_MASK         (((1ul << CBASER_PA_LEN) - 1) << CBASER_PA_SHIFT)
@@ -125,17 +130,26 @@
 
 #define ARM_ITS_CMD_MAPD    0x8
 #define ARM_ITS_CMD_MAPC    0x9
+#define ARM_ITS_CMD_MAPTI   0xA
 #define ARM_ITS_CMD_MAPI    0xB
 #define ARM_ITS_CMD_INV     0xC
+#define ARM_ITS_CMD_INVALL  0xD
 #define ARM_ITS_CMD_DISCARD 0xF
 #define ARM_ITS_CMD_SYNC    0x5
+#define ARM_ITS_CMD_OPCODE_MASK 0xFF
+#define ARM_ITS_CMD_NUM_OPCODES 0x10 /* Physical LPI commands, others are counted as 0 */
 
 #define NUM_PAGES_8         8
 
 #define ITS_CMD_SHIFT_DEVID 32
 #define ITS_CMD_SHIFT_VALID 63
+#define ITS_CMD_SHIFT_PINTID 32
 #define ITS_NEXT_CMD_PTR    4
 #define NUM_BYTES_IN_DW     8
+/* Commands the NUM_PAGES_8 command queue holds; CWRITER is never wrapped */
+#define ITS_CMDQ_NUM_CMDS   ((NUM_PAGES_8 * SIZE_4KB) / (ITS_NEXT_CMD_PTR * NUM_BYTES_IN_DW))
+/* Commands ArmGicItsCreateLpiMapRange queues besides one MAPTI per vector */
+#define ITS_RANGE_MAP_CMDS  4
 
 EFIAPI
 EFI_STATUS
@@ -174,18 +188,31 @@ VOID
 ArmGicItsClearLpiMappings (
   IN UINT32     ItsIndex,
   IN UINT32     DevID,
+  IN UINT32     EventID,
   IN UINT32     IntID
   );
 
 EFIAPI
-VOID
+EFI_STATUS
 ArmGicItsCreateLpiMap (
   IN UINT32     ItsIndex,
   IN UINT32     DevID,
+  IN UINT32     EventID,
   IN UINT32     IntID,
   IN UINT32     Priority
   );
 
+EFIAPI
+EFI_STATUS
+ArmGicItsCreateLpiMapRange (
+  IN UINT32     ItsIndex,
+  IN UINT32     DevID,
+  IN UINT32     EventID,
+  IN UINT32     IntID,
+  IN UINT32     NumVectors,
+  IN UINT32     Priority
+  );
+
 EFIAPI
 UINT64
 ArmGicItsGetGITSTranslatorAddress (
@@ -220,6 +247,7 @@ typedef struct {
  UINT64     CommandQBase;
  UINT32     IDBits;
  UINT64     ITTBase;
+ UINT32     EventIDBits;   /* MAPD Size, EventIDs the ITT holds */
 } GIC_ITS_BLOCK;
 
 typedef struct {
@@ -229,4 +257,12 @@ typedef struct {
  GIC_ITS_BLOCK  GicIts[];
 } GIC_ITS_INFO;
 
+typedef struct {
+ UINT32     NumCmds[ARM_ITS_CMD_NUM_OPCODES]; /* Commands issued, by opcode          */
+ UINT32     CmdsSinceSync;                    /* Commands queued after the last SYNC */
+ UINT32     RedundantSync;                    /* SYNC with nothing to synchronise    */
+ UINT32     RedundantInv;                     /* INV covered by an INVALL in a batch */
+ UINT32     MappedEvents;                     /* MAPI/MAPTI not yet DISCARDed        */
+} GIC_ITS_CMDQ_STATS;
+
 #endif
@@ -22,31 +22,31 @@ UINT64
 pal_get_dt_ptr();
 
 VOID
-pal_pe_create_info_table_dt(PE_INFO_TABLE *PeTable);
+pal_pe_create_info_table_dt(PE_INFO_TABLE *PeTable, UINT32 MaxEntries);
 
 VOID
-pal_wd_create_info_table_dt(WD_INFO_TABLE *WdTable);
+pal_wd_create_info_table_dt(WD_INFO_TABLE *WdTable, UINT32 MaxEntries);
 
 VOID
 pal_timer_create_info_table_dt(TIMER_INFO_TABLE *TimerTable);
 
 VOID
-pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable);
+pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable, UINT32 MaxEntries);
 
 VOID
-pal_pcie_create_info_table_dt(PCIE_INFO_TABLE *PcieTable);
+pal_pcie_create_info_table_dt(PCIE_INFO_TABLE *PcieTable, UINT32 MaxEntries);
 
 VOID
-pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable);
+pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable, UINT32 MaxSize);
 
 VOID
-pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable);
+pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries);
 
 VOID
-pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable);
+pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries);
 
 VOID
-pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable);
+pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries);
 
 int
 fdt_node_offset_by_prop_name(const void *fdt, int startoffset, const char *p_name, int p_len);
@@ -57,6 +57,24 @@ fdt_frame_number(const void *fdt, int nodeoffset);
 int
 fdt_interrupt_cells(const void *fdt, int nodeoffset);
 
+UINT32
+pal_dt_info_table_entries(VOID);
+
+int
+fdt_index_node_offset_by_compatible(const void *fdt, int startoffset, const char *compatible);
+
+int
+fdt_index_parent_offset(const void *fdt, int nodeoffset);
+
+int
+fdt_index_address_cells(const void *fdt, int nodeoffset);
+
+int
+fdt_index_size_cells(const void *fdt, int nodeoffset);
+
+int
+fdt_index_node_offset_by_phandle(const void *fdt, uint32_t phandle);
+
 
 
 /*-----------------DEBUG FUNCTION----------------*/
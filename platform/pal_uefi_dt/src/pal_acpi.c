@@ -20,13 +20,13 @@
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/ShellLib.h>
+#include <Library/TimerLib.h>
 
 #include "Include/Guid/Acpi.h"
 #include <Protocol/AcpiTable.h>
 #include "Include/IndustryStandard/Acpi61.h"
 
 #include "include/pal_uefi.h"
-
 /**
   @brief   Use UEFI System Table to look up Acpi20TableGuid and returns the Xsdt Address
 
@@ -57,142 +57,147 @@ pal_get_xsdt_ptr()
 
 }
 
+typedef struct {
+  UINT32  Signature;
+  UINT64  Table;
+} ACPI_TABLE_DIR_ENTRY;
+
+static ACPI_TABLE_DIR_ENTRY  *gAcpiTableDir;
+static UINT32                gAcpiTableDirNum;
+
 /**
-  @brief  Iterate through the tables pointed by XSDT and return MADT address
+  @brief  Walk the XSDT once and record the signature and address of every table
+          it points to, in XSDT order so repeated signatures keep their instance order.
 
   @param  None
 
-  @return 64-bit MADT address
+  @return None
 **/
-UINT64
-pal_get_madt_ptr()
+STATIC
+VOID
+pal_acpi_build_table_dir()
 {
-
   EFI_ACPI_DESCRIPTION_HEADER   *Xsdt;
   UINT64                        *Entry64;
   UINT32                        Entry64Num;
   UINT32                        Idx;
+  UINT64                        StartTime;
+  EFI_STATUS                    Status;
+
+  StartTime = GetPerformanceCounter();
 
   Xsdt = (EFI_ACPI_DESCRIPTION_HEADER *) pal_get_xsdt_ptr();
   if (Xsdt == NULL) {
       bsa_print(ACS_PRINT_DEBUG, L"XSDT not found \n");
-      return 0;
+      return;
   }
 
   Entry64  = (UINT64 *)(Xsdt + 1);
   Entry64Num = (Xsdt->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) >> 3;
-  for (Idx = 0; Idx < Entry64Num; Idx++) {
-    if (*(UINT32 *)(UINTN)(Entry64[Idx]) == EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_SIGNATURE) {
-        return(UINT64)(Entry64[Idx]);
-    }
+
+  Status = gBS->AllocatePool(EfiBootServicesData,
+                             Entry64Num * sizeof(ACPI_TABLE_DIR_ENTRY),
+                             (VOID **) &gAcpiTableDir);
+  if (EFI_ERROR(Status)) {
+      gAcpiTableDir = NULL;
+      bsa_print(ACS_PRINT_ERR, L"ACPI table directory allocation failed \n");
+      return;
   }
 
-  return 0;
+  for (Idx = 0; Idx < Entry64Num; Idx++) {
+    if (Entry64[Idx] == 0)
+        continue;
+    gAcpiTableDir[gAcpiTableDirNum].Signature = *(UINT32 *)(UINTN)(Entry64[Idx]);
+    gAcpiTableDir[gAcpiTableDirNum].Table     = Entry64[Idx];
+    gAcpiTableDirNum++;
+  }
 
+  bsa_print(ACS_PRINT_INFO, L" ACPI: %d tables located in %ld us\n", gAcpiTableDirNum,
+            GetTimeInNanoSecond(GetPerformanceCounter() - StartTime) / 1000);
 }
 
 /**
-  @brief  Iterate through the tables pointed by XSDT and return GTDT address
+  @brief  Return the address of an ACPI table from the directory built on first use
 
-  @param  None
+  @param  Signature - ACPI table signature
+  @param  Instance  - 0 based instance for tables that appear more than once
 
-  @return 64-bit GTDT address
+  @return 64-bit table address, 0 if not present
 **/
 UINT64
-pal_get_gtdt_ptr()
+pal_get_acpi_table_ptr(UINT32 Signature, UINT32 Instance)
 {
+  UINT32  Idx;
 
-  EFI_ACPI_DESCRIPTION_HEADER   *Xsdt;
-  UINT64                        *Entry64;
-  UINT32                        Entry64Num;
-  UINT32                        Idx;
-
-  Xsdt = (EFI_ACPI_DESCRIPTION_HEADER *) pal_get_xsdt_ptr();
-  if (Xsdt == NULL) {
-      bsa_print(ACS_PRINT_DEBUG, L"XSDT not found \n");
-      return 0;
-  }
+  if (gAcpiTableDir == NULL)
+      pal_acpi_build_table_dir();
 
-  Entry64  = (UINT64 *)(Xsdt + 1);
-  Entry64Num = (Xsdt->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) >> 3;
-  for (Idx = 0; Idx < Entry64Num; Idx++) {
-    if (*(UINT32 *)(UINTN)(Entry64[Idx]) == EFI_ACPI_6_1_GENERIC_TIMER_DESCRIPTION_TABLE_SIGNATURE) {
-        return(UINT64)(Entry64[Idx]);
+  for (Idx = 0; Idx < gAcpiTableDirNum; Idx++) {
+    if (gAcpiTableDir[Idx].Signature == Signature) {
+        if (Instance == 0)
+            return gAcpiTableDir[Idx].Table;
+        Instance--;
     }
   }
 
   return 0;
-
 }
 
 /**
-  @brief  Iterate through the tables pointed by XSDT and return MCFG Table address
+  @brief  Return MADT address from the ACPI table directory
 
   @param  None
 
-  @return 64-bit MCFG address
+  @return 64-bit MADT address
 **/
 UINT64
-pal_get_mcfg_ptr()
+pal_get_madt_ptr()
 {
-  EFI_ACPI_DESCRIPTION_HEADER   *Xsdt;
-  UINT64                        *Entry64;
-  UINT32                        Entry64Num;
-  UINT32                        Idx;
-
-  Xsdt = (EFI_ACPI_DESCRIPTION_HEADER *) pal_get_xsdt_ptr();
-  if (Xsdt == NULL) {
-      bsa_print(ACS_PRINT_DEBUG, L"XSDT not found \n");
-      return 0;
-  }
+  return pal_get_acpi_table_ptr(EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_SIGNATURE, 0);
+}
 
-  Entry64  = (UINT64 *)(Xsdt + 1);
-  Entry64Num = (Xsdt->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) >> 3;
-  for (Idx = 0; Idx < Entry64Num; Idx++) {
-    if (*(UINT32 *)(UINTN)(Entry64[Idx]) == EFI_ACPI_6_1_PCI_EXPRESS_MEMORY_MAPPED_CONFIGURATION_SPACE_BASE_ADDRESS_DESCRIPTION_TABLE_SIGNATURE) {
-        return(UINT64)(Entry64[Idx]);
-    }
-  }
+/**
+  @brief  Return GTDT address from the ACPI table directory
 
-  return 0;
+  @param  None
 
+  @return 64-bit GTDT address
+**/
+UINT64
+pal_get_gtdt_ptr()
+{
+  return pal_get_acpi_table_ptr(EFI_ACPI_6_1_GENERIC_TIMER_DESCRIPTION_TABLE_SIGNATURE, 0);
 }
 
 /**
-  @brief  Iterate through the tables pointed by XSDT and return SPCR Table address
+  @brief  Return MCFG Table address from the ACPI table directory
 
   @param  None
 
-  @return 64-bit SPCR address
+  @return 64-bit MCFG address
 **/
 UINT64
-pal_get_spcr_ptr()
+pal_get_mcfg_ptr()
 {
-  EFI_ACPI_DESCRIPTION_HEADER   *Xsdt;
-  UINT64                        *Entry64;
-  UINT32                        Entry64Num;
-  UINT32                        Idx;
-
-  Xsdt = (EFI_ACPI_DESCRIPTION_HEADER *) pal_get_xsdt_ptr();
-  if (Xsdt == NULL) {
-      bsa_print(ACS_PRINT_DEBUG, L"XSDT not found \n");
-      return 0;
-  }
+  return pal_get_acpi_table_ptr(
+           EFI_ACPI_6_1_PCI_EXPRESS_MEMORY_MAPPED_CONFIGURATION_SPACE_BASE_ADDRESS_DESCRIPTION_TABLE_SIGNATURE, 0);
+}
 
-  Entry64  = (UINT64 *)(Xsdt + 1);
-  Entry64Num = (Xsdt->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) >> 3;
-  for (Idx = 0; Idx < Entry64Num; Idx++) {
-    if (*(UINT32 *)(UINTN)(Entry64[Idx]) == EFI_ACPI_2_0_SERIAL_PORT_CONSOLE_REDIRECTION_TABLE_SIGNATURE) {
-        return(UINT64)(Entry64[Idx]);
-    }
-  }
+/**
+  @brief  Return SPCR Table address from the ACPI table directory
 
-  return 0;
+  @param  None
 
+  @return 64-bit SPCR address
+**/
+UINT64
+pal_get_spcr_ptr()
+{
+  return pal_get_acpi_table_ptr(EFI_ACPI_2_0_SERIAL_PORT_CONSOLE_REDIRECTION_TABLE_SIGNATURE, 0);
 }
 
 /**
-  @brief  Iterate through the tables pointed by XSDT and return IORT Table address
+  @brief  Return IORT Table address from the ACPI table directory
 
   @param  None
 
@@ -201,29 +206,9 @@ pal_get_spcr_ptr()
 UINT64
 pal_get_iort_ptr()
 {
-  EFI_ACPI_DESCRIPTION_HEADER   *Xsdt;
-  UINT64                        *Entry64;
-  UINT32                        Entry64Num;
-  UINT32                        Idx;
-
-  Xsdt = (EFI_ACPI_DESCRIPTION_HEADER *) pal_get_xsdt_ptr();
-  if (Xsdt == NULL) {
-      bsa_print(ACS_PRINT_DEBUG, L"XSDT not found \n");
-      return 0;
-  }
-
-  Entry64  = (UINT64 *)(Xsdt + 1);
-  Entry64Num = (Xsdt->Length - sizeof(EFI_ACPI_DESCRIPTION_HEADER)) >> 3;
-  for (Idx = 0; Idx < Entry64Num; Idx++) {
 #ifdef EFI_ACPI_6_1_IO_REMAPPING_TABLE_SIGNATURE
-    if (*(UINT32 *)(UINTN)(Entry64[Idx]) == EFI_ACPI_6_1_IO_REMAPPING_TABLE_SIGNATURE) {
+  return pal_get_acpi_table_ptr(EFI_ACPI_6_1_IO_REMAPPING_TABLE_SIGNATURE, 0);
 #else
-    if (*(UINT32 *)(UINTN)(Entry64[Idx]) == EFI_ACPI_6_1_INTERRUPT_SOURCE_OVERRIDE_SIGNATURE) {
+  return pal_get_acpi_table_ptr(EFI_ACPI_6_1_INTERRUPT_SOURCE_OVERRIDE_SIGNATURE, 0);
 #endif
-        return(UINT64)(Entry64[Idx]);
-    }
-  }
-
-  return 0;
-
 }
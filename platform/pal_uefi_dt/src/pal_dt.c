@@ -21,6 +21,7 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/ShellLib.h>
 #include <Library/DtPlatformDtbLoaderLib.h>
+#include <Library/TimerLib.h>
 
 #include <Include/libfdt.h>
 #include "Include/Guid/Acpi.h"
@@ -42,6 +43,212 @@ pal_bsa_gic_imp()
   return 1;
 }
 
+typedef struct {
+  INT32   Offset;         /* Node offset in the blob */
+  INT32   Parent;         /* Index of the parent node, -1 for the root */
+  UINT32  Phandle;
+  INT32   AddrCells;      /* fdt_address_cells() of this node */
+  INT32   SizeCells;      /* fdt_size_cells() of this node */
+  INT32   IntCells;       /* Resolved #interrupt-cells, 0 until first asked */
+} DT_NODE_ENTRY;
+
+typedef struct {
+  UINT32  Key;            /* Hash of a compatible string, or a phandle */
+  UINT32  Node;           /* Index into the node array */
+} DT_KEY_ENTRY;
+
+typedef struct {
+  const VOID     *Fdt;
+  UINT32         NumNodes;
+  UINT32         NumCompat;
+  UINT32         NumPhandle;
+  UINT32         NumRegs;   /* reg tuples across the blob */
+  UINT32         NumMaps;   /* iommu-map and msi-map tuples across the blob */
+  DT_NODE_ENTRY  *Node;
+  DT_KEY_ENTRY   *Compat;   /* Sorted by hash, then by node */
+  DT_KEY_ENTRY   *Phandle;  /* Sorted by phandle */
+} DT_INDEX;
+
+static DT_INDEX gDtIndex;
+
+#define DT_INDEX_MAX_DEPTH 32
+
+STATIC
+UINT32
+dt_index_hash(const char *Str, int Len)
+{
+  UINT32 Hash = 2166136261u;
+
+  while (Len-- > 0 && *Str)
+    Hash = (Hash ^ (UINT8)*Str++) * 16777619u;
+
+  return Hash;
+}
+
+STATIC
+VOID
+dt_index_sort(DT_KEY_ENTRY *Entry, UINT32 Num)
+{
+  DT_KEY_ENTRY  Tmp;
+  UINT32        Gap, i, j;
+
+  for (Gap = Num / 2; Gap > 0; Gap /= 2) {
+    for (i = Gap; i < Num; i++) {
+      Tmp = Entry[i];
+      for (j = i; (j >= Gap) &&
+           ((Entry[j - Gap].Key > Tmp.Key) ||
+            ((Entry[j - Gap].Key == Tmp.Key) && (Entry[j - Gap].Node > Tmp.Node))); j -= Gap)
+        Entry[j] = Entry[j - Gap];
+      Entry[j] = Tmp;
+    }
+  }
+}
+
+/* Index of the first entry whose key is not below Key */
+STATIC
+UINT32
+dt_index_lower_bound(DT_KEY_ENTRY *Entry, UINT32 Num, UINT32 Key)
+{
+  UINT32 Low = 0, High = Num, Mid;
+
+  while (Low < High) {
+    Mid = Low + (High - Low) / 2;
+    if (Entry[Mid].Key < Key)
+      Low = Mid + 1;
+    else
+      High = Mid;
+  }
+  return Low;
+}
+
+/* Index of the node at Offset, -1 if the index does not cover it */
+STATIC
+INT32
+dt_index_node(const VOID *Fdt, INT32 Offset)
+{
+  UINT32 Low = 0, High, Mid;
+
+  if ((Fdt != gDtIndex.Fdt) || (gDtIndex.Node == NULL))
+    return -1;
+
+  High = gDtIndex.NumNodes;
+  while (Low < High) {
+    Mid = Low + (High - Low) / 2;
+    if (gDtIndex.Node[Mid].Offset < Offset)
+      Low = Mid + 1;
+    else
+      High = Mid;
+  }
+  if ((Low < gDtIndex.NumNodes) && (gDtIndex.Node[Low].Offset == Offset))
+    return Low;
+  return -1;
+}
+
+/**
+  @brief  Walk the DTB once and index every node: parent links, phandles, cell sizes
+          and compatible strings, so that the info table builders need not re-walk it.
+
+  @param  Fdt - FDT blob address
+
+  @return None
+**/
+STATIC
+VOID
+dt_index_build(const VOID *Fdt)
+{
+  INT32          Offset, Depth, Len, StrLen;
+  INT32          Stack[DT_INDEX_MAX_DEPTH];
+  UINT32         NumNodes = 0, NumCompat = 0, NumPhandle = 0;
+  const char     *Compat;
+  DT_NODE_ENTRY  *Node;
+  UINT64         StartTime;
+  EFI_STATUS     Status;
+
+  StartTime = GetPerformanceCounter();
+
+  /* First pass sizes the arrays */
+  for (Offset = fdt_next_node(Fdt, -1, NULL); Offset >= 0; Offset = fdt_next_node(Fdt, Offset, NULL)) {
+    NumNodes++;
+    if (fdt_get_phandle(Fdt, Offset))
+      NumPhandle++;
+    Compat = fdt_getprop(Fdt, Offset, "compatible", &Len);
+    for (; Compat && Len > 0; Len -= StrLen, Compat += StrLen) {
+      StrLen = AsciiStrnLenS(Compat, Len) + 1;
+      NumCompat++;
+    }
+  }
+
+  Status = gBS->AllocatePool(EfiBootServicesData,
+                             NumNodes * sizeof(DT_NODE_ENTRY) +
+                             (NumCompat + NumPhandle) * sizeof(DT_KEY_ENTRY),
+                             (VOID **) &gDtIndex.Node);
+  if (EFI_ERROR(Status)) {
+    gDtIndex.Node = NULL;
+    bsa_print(ACS_PRINT_WARN, L" DT index allocation failed, walking the DTB instead \n");
+    return;
+  }
+  gDtIndex.Compat  = (DT_KEY_ENTRY *)(gDtIndex.Node + NumNodes);
+  gDtIndex.Phandle = gDtIndex.Compat + NumCompat;
+  gDtIndex.NumNodes = gDtIndex.NumCompat = gDtIndex.NumPhandle = 0;
+  gDtIndex.NumRegs = gDtIndex.NumMaps = 0;
+
+  /* libfdt reports the root at depth 1, Stack[Depth - 1] holds the node at Depth */
+  Depth = 0;
+  for (Offset = fdt_next_node(Fdt, -1, &Depth); (Offset >= 0) && (gDtIndex.NumNodes < NumNodes);
+       Offset = fdt_next_node(Fdt, Offset, &Depth)) {
+    if ((Depth < 1) || (Depth > DT_INDEX_MAX_DEPTH)) {
+      /* A partial index would hide nodes, so leave every lookup to libfdt */
+      bsa_print(ACS_PRINT_WARN, L" DT deeper than %d levels, walking the DTB instead \n",
+                DT_INDEX_MAX_DEPTH);
+      gBS->FreePool(gDtIndex.Node);
+      gDtIndex.Node = NULL;
+      gDtIndex.Fdt = Fdt;
+      return;
+    }
+
+    Stack[Depth - 1] = gDtIndex.NumNodes;
+    Node = &gDtIndex.Node[gDtIndex.NumNodes];
+    Node->Offset    = Offset;
+    Node->Parent    = (Depth > 1) ? Stack[Depth - 2] : -1;
+    Node->Phandle   = fdt_get_phandle(Fdt, Offset);
+    Node->AddrCells = fdt_address_cells(Fdt, Offset);
+    Node->SizeCells = fdt_size_cells(Fdt, Offset);
+    Node->IntCells  = 0;
+
+    if (Node->Phandle && (gDtIndex.NumPhandle < NumPhandle)) {
+      gDtIndex.Phandle[gDtIndex.NumPhandle].Key  = Node->Phandle;
+      gDtIndex.Phandle[gDtIndex.NumPhandle].Node = gDtIndex.NumNodes;
+      gDtIndex.NumPhandle++;
+    }
+
+    /* A reg tuple is sized by the parent's #address-cells and #size-cells */
+    if ((Node->Parent >= 0) && fdt_getprop(Fdt, Offset, "reg", &Len) &&
+        (gDtIndex.Node[Node->Parent].AddrCells + gDtIndex.Node[Node->Parent].SizeCells > 0))
+      gDtIndex.NumRegs += Len / (4 * (gDtIndex.Node[Node->Parent].AddrCells +
+                                      gDtIndex.Node[Node->Parent].SizeCells));
+    if (fdt_getprop(Fdt, Offset, "iommu-map", &Len))
+      gDtIndex.NumMaps += Len / 16;
+    if (fdt_getprop(Fdt, Offset, "msi-map", &Len))
+      gDtIndex.NumMaps += Len / 16;
+
+    Compat = fdt_getprop(Fdt, Offset, "compatible", &Len);
+    for (; Compat && Len > 0 && (gDtIndex.NumCompat < NumCompat); Len -= StrLen, Compat += StrLen) {
+      StrLen = AsciiStrnLenS(Compat, Len) + 1;
+      gDtIndex.Compat[gDtIndex.NumCompat].Key  = dt_index_hash(Compat, StrLen);
+      gDtIndex.Compat[gDtIndex.NumCompat].Node = gDtIndex.NumNodes;
+      gDtIndex.NumCompat++;
+    }
+    gDtIndex.NumNodes++;
+  }
+
+  dt_index_sort(gDtIndex.Compat, gDtIndex.NumCompat);
+  dt_index_sort(gDtIndex.Phandle, gDtIndex.NumPhandle);
+  gDtIndex.Fdt = Fdt;
+
+  bsa_print(ACS_PRINT_INFO, L" DT: Indexed %d nodes in %ld us\n", gDtIndex.NumNodes,
+            GetTimeInNanoSecond(GetPerformanceCounter() - StartTime) / 1000);
+}
+
 /**
   @brief   Use UEFI System Table to look up FdtTableGuid and returns the FDT Blob Address
 
@@ -73,9 +280,37 @@ pal_get_dt_ptr()
     return 0;
   }
 
+  if (gDtIndex.Fdt != DTB)
+    dt_index_build(DTB);
+
   return (UINT64) DTB;
 }
 
+/**
+  @brief  Checksum the DTB, so that a saved copy of the info tables can be
+          matched to the firmware that produced it.
+
+  @param  None
+
+  @return 64-bit FNV-1a hash of the blob, 0 if no DTB is present
+**/
+UINT64
+pal_get_fw_table_checksum()
+{
+  const UINT8  *Byte;
+  UINT64       Hash = 0xCBF29CE484222325ULL;
+  UINT32       Len;
+
+  Byte = (const UINT8 *) pal_get_dt_ptr();
+  if (Byte == NULL)
+      return 0;
+
+  for (Len = fdt_totalsize(Byte); Len; Len--)
+      Hash = (Hash ^ *Byte++) * 0x100000001B3ULL;
+
+  return Hash;
+}
+
 /**
   @brief   Get frame number from given node
   @param  fdt - 64-bit FDT blob address
@@ -113,6 +348,42 @@ int fdt_interrupt_cells(const void *fdt, int nodeoffset)
 {
   const fdt32_t *ic;
   int len;
+  INT32 Start, Idx;
+  UINT32 Key, Steps;
+
+  /* Follow interrupt-parent and parent links through the index, remembering the answer */
+  Start = dt_index_node(fdt, nodeoffset);
+  if (Start >= 0) {
+    if (gDtIndex.Node[Start].IntCells)
+      return gDtIndex.Node[Start].IntCells;
+
+    /* Bounded, so a malformed interrupt-parent cycle cannot hang the walk */
+    for (Idx = Start, Steps = 0; (Idx >= 0) && (Steps < gDtIndex.NumNodes); Steps++) {
+      ic = fdt_getprop(fdt, gDtIndex.Node[Idx].Offset, "#interrupt-cells", &len);
+      if (ic > 0) {
+        gDtIndex.Node[Start].IntCells = fdt32_to_cpu(*ic);
+        return gDtIndex.Node[Start].IntCells;
+      }
+      if (gDtIndex.Node[Idx].IntCells) {
+        gDtIndex.Node[Start].IntCells = gDtIndex.Node[Idx].IntCells;
+        return gDtIndex.Node[Start].IntCells;
+      }
+
+      ic = fdt_getprop(fdt, gDtIndex.Node[Idx].Offset, "interrupt-parent", &len);
+      if (ic > 0) {
+        Key = fdt32_to_cpu(*ic);
+        Idx = dt_index_lower_bound(gDtIndex.Phandle, gDtIndex.NumPhandle, Key);
+        if ((Idx == (INT32)gDtIndex.NumPhandle) || (gDtIndex.Phandle[Idx].Key != Key))
+          break;
+        Idx = gDtIndex.Phandle[Idx].Node;
+      } else {
+        Idx = gDtIndex.Node[Idx].Parent;
+      }
+    }
+
+    bsa_print(ACS_PRINT_DEBUG, L"No interrupt cell found \n");
+    return 3; /* default value 3*/
+  }
 
   do {
       ic = fdt_getprop(fdt, nodeoffset, "#interrupt-cells", &len);
@@ -160,3 +431,112 @@ int fdt_node_offset_by_prop_name(const void *fdt, int startoffset, const char *p
   }
   return offset;
 }
+
+/**
+  @brief  Indexed equivalent of fdt_node_offset_by_compatible
+
+  @param  fdt          Address of fdt blob
+  @param  startoffset  Offset after which to search, -1 for the whole tree
+  @param  compatible   Compatible string to be searched
+
+  @return Offset of the next matching node or -FDT_ERR_NOTFOUND
+**/
+int fdt_index_node_offset_by_compatible(const void *fdt, int startoffset, const char *compatible)
+{
+  UINT32  Key, Idx;
+  INT32   Node;
+
+  if ((fdt != gDtIndex.Fdt) || (gDtIndex.Node == NULL))
+    return fdt_node_offset_by_compatible(fdt, startoffset, compatible);
+
+  Key = dt_index_hash(compatible, AsciiStrLen(compatible) + 1);
+  for (Idx = dt_index_lower_bound(gDtIndex.Compat, gDtIndex.NumCompat, Key);
+       (Idx < gDtIndex.NumCompat) && (gDtIndex.Compat[Idx].Key == Key); Idx++) {
+    Node = gDtIndex.Compat[Idx].Node;
+    if (gDtIndex.Node[Node].Offset <= startoffset)
+      continue;
+    /* Rule out hash collisions */
+    if (fdt_node_check_compatible(fdt, gDtIndex.Node[Node].Offset, compatible) == 0)
+      return gDtIndex.Node[Node].Offset;
+  }
+
+  return -FDT_ERR_NOTFOUND;
+}
+
+/**
+  @brief  Indexed equivalent of fdt_parent_offset
+**/
+int fdt_index_parent_offset(const void *fdt, int nodeoffset)
+{
+  INT32 Node = dt_index_node(fdt, nodeoffset);
+
+  if (Node < 0)
+    return fdt_parent_offset(fdt, nodeoffset);
+  if (gDtIndex.Node[Node].Parent < 0)
+    return -FDT_ERR_NOTFOUND;
+  return gDtIndex.Node[gDtIndex.Node[Node].Parent].Offset;
+}
+
+/**
+  @brief  Indexed equivalent of fdt_address_cells
+**/
+int fdt_index_address_cells(const void *fdt, int nodeoffset)
+{
+  INT32 Node = dt_index_node(fdt, nodeoffset);
+
+  if (Node < 0)
+    return fdt_address_cells(fdt, nodeoffset);
+  return gDtIndex.Node[Node].AddrCells;
+}
+
+/**
+  @brief  Indexed equivalent of fdt_size_cells
+**/
+int fdt_index_size_cells(const void *fdt, int nodeoffset)
+{
+  INT32 Node = dt_index_node(fdt, nodeoffset);
+
+  if (Node < 0)
+    return fdt_size_cells(fdt, nodeoffset);
+  return gDtIndex.Node[Node].SizeCells;
+}
+
+/**
+  @brief  Indexed equivalent of fdt_node_offset_by_phandle
+**/
+int fdt_index_node_offset_by_phandle(const void *fdt, uint32_t phandle)
+{
+  UINT32 Idx;
+
+  if ((fdt != gDtIndex.Fdt) || (gDtIndex.Node == NULL))
+    return fdt_node_offset_by_phandle(fdt, phandle);
+
+  Idx = dt_index_lower_bound(gDtIndex.Phandle, gDtIndex.NumPhandle, phandle);
+  if ((Idx == gDtIndex.NumPhandle) || (gDtIndex.Phandle[Idx].Key != phandle))
+    return -FDT_ERR_NOTFOUND;
+  return gDtIndex.Node[gDtIndex.Phandle[Idx].Node].Offset;
+}
+
+/**
+  @brief  Bound on the entries any info table built from the DT can need. Each
+          entry comes from a node, a reg tuple or an iommu-map/msi-map tuple,
+          and a node may yield up to three (e.g. GICC, GICR and GICH per CPU).
+
+  @param  None
+
+  @return Number of entries, 0 if there is no DTB
+**/
+UINT32
+pal_dt_info_table_entries()
+{
+  const VOID *Fdt = (const VOID *) pal_get_dt_ptr();
+
+  if (Fdt == NULL)
+    return 0;
+
+  /* Without the index, a node or tuple is never smaller than 8 bytes of blob */
+  if ((Fdt != gDtIndex.Fdt) || (gDtIndex.Node == NULL))
+    return fdt_totalsize(Fdt) / 8;
+
+  return 3 * gDtIndex.NumNodes + gDtIndex.NumRegs + gDtIndex.NumMaps + 2;
+}
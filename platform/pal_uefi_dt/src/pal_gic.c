@@ -96,7 +96,7 @@ pal_pe_info_table_gmaint_gsiv_dt(PE_INFO_TABLE *PeTable)
   Ptr = PeTable->pe_info;
   for (i = 0; i < (sizeof(gicv3_dt_arr)/GIC_COMPATIBLE_STR_LEN); i++) {
       /* Search for GICv3 nodes*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, gicv3_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, gicv3_dt_arr[i]);
       if (offset < 0) {
         bsa_print(ACS_PRINT_DEBUG, L"GICv3 compatible value not found for index : %d\n", i);
         continue; /* Search for next compatible item*/
@@ -110,7 +110,7 @@ pal_pe_info_table_gmaint_gsiv_dt(PE_INFO_TABLE *PeTable)
   if (offset < 0) {
       for (i = 0; i < (sizeof(gicv2_dt_arr)/GIC_COMPATIBLE_STR_LEN); i++) {
           /* Search for GICv2 nodes*/
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, gicv2_dt_arr[i]);
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, gicv2_dt_arr[i]);
           if (offset < 0) {
               bsa_print(ACS_PRINT_DEBUG, L"GICv2 compatible value not found for index : %d\n", i);
               continue; /* Search for next compatible item*/
@@ -154,16 +154,33 @@ pal_pe_info_table_gmaint_gsiv_dt(PE_INFO_TABLE *PeTable)
   }
 }
 
+/**
+  @brief  Check whether Needed more entries, and the end marker after them, fit in
+          a GIC info table sized for MaxEntries entries. Warns when they do not.
+**/
+STATIC
+BOOLEAN
+pal_gic_table_full(GIC_INFO_TABLE *GicTable, GIC_INFO_ENTRY *GicEntry, UINT32 Needed,
+                   UINT32 MaxEntries)
+{
+  if ((UINT32)(GicEntry - GicTable->gic_info) + Needed < MaxEntries)
+    return FALSE;
+
+  bsa_print(ACS_PRINT_WARN, L" GIC_INFO: Table full at %d entries \n", MaxEntries);
+  return TRUE;
+}
+
 /**
   @brief  Populate information about the GIC sub-system at the input address.
           In a UEFI-ACPI framework, this information is part of the MADT table.
 
-  @param  GicTable  Address of the memory region where this information is to be filled in
+  @param  GicTable    Address of the memory region where this information is to be filled in
+  @param  MaxEntries  Number of entries the table has room for, end marker included
 
   @return None
 **/
 VOID
-pal_gic_create_info_table(GIC_INFO_TABLE *GicTable)
+pal_gic_create_info_table(GIC_INFO_TABLE *GicTable, UINT32 MaxEntries)
 {
   EFI_ACPI_6_1_GIC_STRUCTURE    *Entry = NULL;
   GIC_INFO_ENTRY                *GicEntry = NULL;
@@ -190,7 +207,7 @@ pal_gic_create_info_table(GIC_INFO_TABLE *GicTable)
     bsa_print(ACS_PRINT_INFO, L" MADT is at %x and length is %x \n", gMadtHdr, TableLength);
   } else {
     bsa_print(ACS_PRINT_DEBUG, L" MADT not found. Checking DT table \n");
-    pal_gic_create_info_table_dt(GicTable);
+    pal_gic_create_info_table_dt(GicTable, MaxEntries);
     dt_dump_gic_table(GicTable);
     return;
   }
@@ -201,6 +218,10 @@ pal_gic_create_info_table(GIC_INFO_TABLE *GicTable)
 
   do {
 
+    /* A GICC structure adds up to three entries, the others one */
+    if (pal_gic_table_full(GicTable, GicEntry, (Entry->Type == EFI_ACPI_6_1_GIC) ? 3 : 1, MaxEntries))
+      break;
+
     if (Entry->Type == EFI_ACPI_6_1_GIC) {
       if (Entry->PhysicalBaseAddress != 0) {
         GicEntry->type = ENTRY_TYPE_CPUIF;
@@ -256,6 +277,38 @@ pal_gic_create_info_table(GIC_INFO_TABLE *GicTable)
 
 }
 
+/**
+  @brief  Return the number of GIC_INFO entries pal_gic_create_info_table may fill:
+          up to three for each GICC structure (CPU interface, redistributor, GICH),
+          one for every other MADT structure, and the end marker.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_gic_info_table_entries()
+{
+  EFI_ACPI_6_1_GIC_STRUCTURE    *Entry;
+  UINT32                        Length;
+  UINT32                        Count = 1;
+
+  gMadtHdr = (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER *) pal_get_madt_ptr();
+  if (gMadtHdr == NULL)
+    return pal_dt_info_table_entries();
+
+  Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) (gMadtHdr + 1);
+  Length = sizeof (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER);
+
+  while ((Length < gMadtHdr->Header.Length) && Entry->Length) {
+    Count += (Entry->Type == EFI_ACPI_6_1_GIC) ? 3 : 1;
+    Length += Entry->Length;
+    Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) ((UINT8 *)Entry + (Entry->Length));
+  }
+
+  return Count;
+}
+
 /**
   @brief  Enable the interrupt in the GIC Distributor and GIC CPU Interface and hook
           the interrupt service routine for the IRQ to the UEFI Framework
@@ -506,10 +559,64 @@ pal_gic_request_msi (
     return 0xFFFFFFFF;
   }
 
-  ArmGicItsCreateLpiMap(ItsIndex, DevID, IntID, LPI_PRIORITY1);
+  /* The MSI-X vector index is the EventID, as for a range */
+  if (EFI_ERROR(ArmGicItsCreateLpiMap(ItsIndex, DevID, msi_index, IntID, LPI_PRIORITY1)))
+    return 0xFFFFFFFF;
 
   *msi_addr = ArmGicItsGetGITSTranslatorAddress(ItsIndex);
-  *msi_data = IntID;
+  *msi_data = msi_index;
+
+  return 0;
+}
+
+/**
+  @brief  Map a block of consecutive MSI vectors of a device to consecutive LPIs
+          with one batch of ITS commands.
+
+  @param  ItsID       ITS block ID
+  @param  DevID       Device ID as seen by the ITS
+  @param  IntID       First LPI of the range
+  @param  msi_index   First event ID (MSI-X table index) of the range
+  @param  num_vectors Number of vectors to map
+  @param  msi_addr    Doorbell address to be programmed in the MSI-X table
+  @param  msi_data    Data of the first vector, incremented by one per vector
+
+  @return 0 on success, 0xFFFFFFFF on failure
+**/
+UINT32
+pal_gic_request_msi_range (
+  UINT32    ItsID,
+  UINT32    DevID,
+  UINT32    IntID,
+  UINT32    msi_index,
+  UINT32    num_vectors,
+  UINT32    *msi_addr,
+  UINT32    *msi_data
+  )
+{
+  UINT32  ItsIndex;
+
+  if ((g_gic_its_info == NULL) || (g_gic_its_info->GicNumIts == 0))
+    return 0xFFFFFFFF;
+
+  ItsIndex = getItsIndex(ItsID);
+  if (ItsIndex > g_gic_its_info->GicNumIts) {
+    bsa_print(ACS_PRINT_ERR, L"\n       Could not find ITS block in MADT", 0);
+    return 0xFFFFFFFF;
+  }
+
+  if ((g_gic_its_info->GicRdBase == 0) || (g_gic_its_info->GicDBase == 0))
+  {
+    bsa_print(ACS_PRINT_DEBUG, L"GICD/GICRD Base Invalid value.\n", 0);
+    return 0xFFFFFFFF;
+  }
+
+  if (EFI_ERROR(ArmGicItsCreateLpiMapRange(ItsIndex, DevID, msi_index, IntID, num_vectors,
+                                           LPI_PRIORITY1)))
+    return 0xFFFFFFFF;
+
+  *msi_addr = ArmGicItsGetGITSTranslatorAddress(ItsIndex);
+  *msi_data = msi_index;
 
   return 0;
 }
@@ -539,17 +646,18 @@ pal_gic_free_msi (
     return;
   }
 
-  ArmGicItsClearLpiMappings(ItsIndex, DevID, IntID);
+  ArmGicItsClearLpiMappings(ItsIndex, DevID, msi_index, IntID);
 }
 
 /**
   @brief  This API fills in the GIC_INFO Table with information about the GIC in the
           system. This is achieved by parsing the DT blob.
-  @param  PeTable  - Address where the GIC information needs to be filled.
+  @param  PeTable    - Address where the GIC information needs to be filled.
+  @param  MaxEntries - Number of entries the table has room for, end marker included.
   @return  None
 **/
 VOID
-pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
+pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable, UINT32 MaxEntries)
 {
   GIC_INFO_ENTRY           *GicEntry = NULL;
   UINT64 dt_ptr, cpuif_base, cpuif_length;
@@ -567,10 +675,12 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
 
   GicEntry = GicTable->gic_info;
   GicEntry->type = 0xFF;
+  if (pal_gic_table_full(GicTable, GicEntry, 1, MaxEntries))
+    return;
 
   for (i = 0; i < (sizeof(gicv3_dt_arr)/GIC_COMPATIBLE_STR_LEN); i++) {
       /* Search for GICv3 nodes*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, gicv3_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, gicv3_dt_arr[i]);
       if (offset < 0) {
         bsa_print(ACS_PRINT_DEBUG, L"GICv3 compatible value not found for index : %d\n", i);
         continue; /* Search for next compatible item*/
@@ -586,7 +696,7 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
       bsa_print(ACS_PRINT_DEBUG, L"GIC v3 compatible node not found\n");
       for (i = 0; i < (sizeof(gicv2_dt_arr)/GIC_COMPATIBLE_STR_LEN); i++) {
           /* Search for GICv2 nodes*/
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, gicv2_dt_arr[i]);
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, gicv2_dt_arr[i]);
           if (offset < 0) {
             bsa_print(ACS_PRINT_DEBUG, L"GICv2 compatible value not found for index : %d\n", i);
             continue; /* Search for next compatible item*/
@@ -605,16 +715,16 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
   }
 
   /* Read the address and size cell for decoding reg property */
-  parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+  parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
 
-  size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+  size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
   bsa_print(ACS_PRINT_DEBUG, L" NODE gic size cell %d\n", size_cell);
   if (size_cell < 0) {
       bsa_print(ACS_PRINT_ERR, L" Invalid size cell for node gic\n");
       return;
   }
 
-  addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+  addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
   bsa_print(ACS_PRINT_DEBUG, L" NODE gic addr cell %d\n", addr_cell);
   if (addr_cell < 0) {
       bsa_print(ACS_PRINT_ERR, L" Invalid address cell for node gic\n");
@@ -663,6 +773,10 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
       i = num_of_rd;
       /* Fill details for Redistributor */
       while (i--) {
+          if (pal_gic_table_full(GicTable, GicEntry, 1, MaxEntries)) {
+              GicEntry->type = 0xFF;
+              return;
+          }
           GicEntry->type = ENTRY_TYPE_GICR_GICRD;
           if (addr_cell == 2) {
               GicEntry->base = fdt32_to_cpu(Preg_val[Index++]);
@@ -698,6 +812,10 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
 
       num_of_pe = pal_pe_get_num();
       while (num_of_pe--) {
+        if (pal_gic_table_full(GicTable, GicEntry, 1, MaxEntries)) {
+          GicEntry->type = 0xFF;
+          return;
+        }
         GicEntry->type = ENTRY_TYPE_CPUIF;
         GicEntry->base = cpuif_base;
         GicEntry->length = cpuif_length;
@@ -712,7 +830,7 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
 
   if (GicTable->header.gic_version == 2) { /* parse v2m frame if present */
       /* fill details of GICH needed for gic v2 */
-      if (num_gic_interfaces > 1) {
+      if ((num_gic_interfaces > 1) && !pal_gic_table_full(GicTable, GicEntry, 1, MaxEntries)) {
           GicEntry->type = ENTRY_TYPE_GICH;
           if (addr_cell == 2) {
             GicEntry->base = fdt32_to_cpu(Preg_val[Index++]);
@@ -730,7 +848,7 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
       }
 
       /* Search for GICv2m-frame nodes*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, gicv2m_frame_dt_arr[0]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, gicv2m_frame_dt_arr[0]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L" No v2m-frame present\n", 0);
           GicEntry->type = 0xFF;
@@ -738,16 +856,16 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
       }
 
       /* Read the address and size cell for decoding reg property */
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE gic size cell %d\n", size_cell);
       if (size_cell < 0) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell for node gic\n");
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE gic addr cell %d\n", addr_cell);
       if (addr_cell < 0) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell for node gic\n");
@@ -765,6 +883,8 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
           }
 
           /* Fill details for msi frame */
+          if (pal_gic_table_full(GicTable, GicEntry, 1, MaxEntries))
+              break;
           GicEntry->type = ENTRY_TYPE_GIC_MSI_FRAME;
           GicTable->header.num_msi_frame++;
 
@@ -801,7 +921,7 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
               GicEntry->spi_count = fdt32_to_cpu(Preg_val[0]);
 
           GicEntry++;
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset,
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset,
                                                  gicv2m_frame_dt_arr[0]);
       }
       bsa_print(ACS_PRINT_DEBUG, L" Num of v2m frame %x \n", GicTable->header.num_msi_frame);
@@ -809,7 +929,7 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
 
   if (GicTable->header.gic_version == 3) { /* Check if ITS sub-node present */
       /* Search for its nodes*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, its_dt_arr[0]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, its_dt_arr[0]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L" No its present\n", 0);
           GicEntry->type = 0xFF;
@@ -817,7 +937,7 @@ pal_gic_create_info_table_dt(GIC_INFO_TABLE *GicTable)
       }
       while (offset != -FDT_ERR_NOTFOUND) {
           GicTable->header.num_its++;
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset, its_dt_arr[0]);
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, its_dt_arr[0]);
       }
       bsa_print(ACS_PRINT_DEBUG, L" Num of its frame %x \n", GicTable->header.num_its);
   }
@@ -19,6 +19,7 @@
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/TimerLib.h>
 
 #include <Protocol/AcpiTable.h>
 #include <Protocol/HardwareInterrupt.h>
@@ -33,6 +34,29 @@
 
 #define ADD_PTR(t, p, l) ((t*)((UINT8*)p + l))
 
+/* Maps IORT node offsets and block contents to IOVIRT block offsets, so that
+   node references resolve without rescanning the blocks added so far */
+typedef struct {
+  UINT32  Key;            /* IORT node offset, or hash of the block contents */
+  UINT32  Offset;         /* IOVIRT block offset, 0 for a free slot */
+} IORT_INDEX_SLOT;
+
+typedef struct {
+  UINT32           Mask;      /* Slots per table - 1, 0 when there is no index */
+  IORT_INDEX_SLOT  *Node;     /* Keyed by IORT node offset */
+  IORT_INDEX_SLOT  *Content;  /* Keyed by block content hash */
+} IORT_BLOCK_INDEX;
+
+/* One ID mapping, as seen by the overlap sweep */
+typedef struct {
+  UINT32        OutputRef;
+  UINT32        Start;
+  UINT32        End;
+  IOVIRT_BLOCK  *Block;
+} IORT_MAP_RANGE;
+
+STATIC IORT_BLOCK_INDEX gIortIndex;
+
 static char smmu_dt_arr[][SMMU_COMPATIBLE_STR_LEN] = {
     "arm,smmu-v1",
 };
@@ -43,6 +67,26 @@ static char smmu3_dt_arr[][SMMU_COMPATIBLE_STR_LEN] = {
 
 UINT64 pal_get_iort_ptr();
 
+/* End of the memory the caller sized the table being filled for */
+STATIC UINT8   *gIoVirtTableEnd;
+STATIC BOOLEAN gIoVirtTableFull;
+
+/**
+  @brief  Check whether a block carrying NumMaps data maps fits at Block.
+          Warns once when the table runs out of room.
+**/
+STATIC BOOLEAN
+iovirt_block_fits(IOVIRT_BLOCK *Block, UINT32 NumMaps)
+{
+  if (ADD_PTR(UINT8, &Block->data_map[0], NumMaps * sizeof(NODE_DATA_MAP)) <= gIoVirtTableEnd)
+    return TRUE;
+
+  if (!gIoVirtTableFull)
+    bsa_print(ACS_PRINT_WARN, L" IOVIRT_INFO: Table full, remaining nodes dropped \n");
+  gIoVirtTableFull = TRUE;
+  return FALSE;
+}
+
 STATIC VOID
 iovirt_create_override_table(IOVIRT_INFO_TABLE *table) {
   IOVIRT_BLOCK *block;
@@ -118,13 +162,37 @@ dump_iort_table(IOVIRT_INFO_TABLE *iovirt)
 }
 
 /**
-  @brief  Check ID mappings in all blocks for any overlap of ID ranges
+  @brief  Flag both blocks of an overlapping pair of ID mappings
+**/
+STATIC VOID
+flag_mapping_overlap(IOVIRT_INFO_TABLE *iovirt, IOVIRT_BLOCK *key_block, IOVIRT_BLOCK *block,
+                     UINT32 output_ref, UINT32 key_start, UINT32 key_end, UINT32 start, UINT32 end)
+{
+  IOVIRT_BLOCK *tmp = ADD_PTR(IOVIRT_BLOCK, iovirt, output_ref);
+
+  if(tmp->type == IOVIRT_NODE_ITS_GROUP) {
+     key_block->flags |= (1 << IOVIRT_FLAG_DEVID_OVERLAP_SHIFT);
+     block->flags |= (1 << IOVIRT_FLAG_DEVID_OVERLAP_SHIFT);
+     bsa_print(ACS_PRINT_INFO, L"\nOverlapping device ids %x-%x and %x-%x \n",
+                key_start, key_end, start, end);
+  }
+  else {
+     key_block->flags |= (1 << IOVIRT_FLAG_STRID_OVERLAP_SHIFT);
+     block->flags |= (1 << IOVIRT_FLAG_STRID_OVERLAP_SHIFT);
+     bsa_print(ACS_PRINT_INFO, L"\nOverlapping stream ids %x-%x and %x-%x \n",
+                key_start, key_end, start, end);
+  }
+}
+
+/**
+  @brief  Check ID mappings in all blocks for any overlap of ID ranges by comparing
+          every pair. Used when there is no memory for the sorted sweep.
   @param iort IoVirt table
 **/
 STATIC VOID
-check_mapping_overlap(IOVIRT_INFO_TABLE *iovirt)
+check_mapping_overlap_pairwise(IOVIRT_INFO_TABLE *iovirt)
 {
-  IOVIRT_BLOCK *key_block = &iovirt->blocks[0], *block, *tmp;
+  IOVIRT_BLOCK *key_block = &iovirt->blocks[0], *block;
   NODE_DATA_MAP *key_map = &key_block->data_map[0], *map;
   UINT32 n_key_blocks, n_blocks, n_key_maps, n_maps;
   UINT32 key_start, key_end, start, end;
@@ -164,19 +232,8 @@ check_mapping_overlap(IOVIRT_INFO_TABLE *iovirt)
              (key_end >= start && key_end <= end) ||
              (key_start < start && key_end > end))
           {
-            tmp = ADD_PTR(IOVIRT_BLOCK, iovirt, (*map).map.output_ref);
-            if(tmp->type == IOVIRT_NODE_ITS_GROUP) {
-               key_block->flags |= (1 << IOVIRT_FLAG_DEVID_OVERLAP_SHIFT);
-               block->flags |= (1 << IOVIRT_FLAG_DEVID_OVERLAP_SHIFT);
-               bsa_print(ACS_PRINT_INFO, L"\nOverlapping device ids %x-%x and %x-%x \n",
-                          key_start, key_end, start, end);
-            }
-            else {
-               key_block->flags |= (1 << IOVIRT_FLAG_STRID_OVERLAP_SHIFT);
-               block->flags |= (1 << IOVIRT_FLAG_STRID_OVERLAP_SHIFT);
-               bsa_print(ACS_PRINT_INFO, L"\nOverlapping stream ids %x-%x and %x-%x \n",
-                          key_start, key_end, start, end);
-            }
+            flag_mapping_overlap(iovirt, key_block, block, (*map).map.output_ref,
+                                 key_start, key_end, start, end);
           }
         }
       }
@@ -184,6 +241,167 @@ check_mapping_overlap(IOVIRT_INFO_TABLE *iovirt)
   }
 }
 
+STATIC VOID
+sort_map_ranges(IORT_MAP_RANGE *range, UINT32 num)
+{
+  IORT_MAP_RANGE tmp;
+  UINT32 gap, i, j;
+
+  for(gap = num / 2; gap > 0; gap /= 2) {
+    for(i = gap; i < num; i++) {
+      tmp = range[i];
+      for(j = i; (j >= gap) &&
+          ((range[j - gap].OutputRef > tmp.OutputRef) ||
+           ((range[j - gap].OutputRef == tmp.OutputRef) && (range[j - gap].Start > tmp.Start))); j -= gap)
+        range[j] = range[j - gap];
+      range[j] = tmp;
+    }
+  }
+}
+
+/**
+  @brief  Check ID mappings in all blocks for any overlap of ID ranges. The mappings
+          are sorted by output reference and base, so each one only needs comparing
+          with those that start before it ends.
+  @param iort IoVirt table
+  @return Number of ID mappings checked
+**/
+STATIC UINT32
+check_mapping_overlap(IOVIRT_INFO_TABLE *iovirt)
+{
+  IOVIRT_BLOCK *block;
+  NODE_DATA_MAP *map;
+  IORT_MAP_RANGE *range;
+  UINT32 i, j, n_maps, num = 0;
+  EFI_STATUS Status;
+
+  for(block = &iovirt->blocks[0], i = 0; i < iovirt->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block))
+    if(block->type != IOVIRT_NODE_ITS_GROUP)
+      num += block->num_data_map;
+
+  if(num < 2)
+    return num;
+
+  Status = gBS->AllocatePool(EfiBootServicesData, num * sizeof(IORT_MAP_RANGE), (VOID **) &range);
+  if(EFI_ERROR(Status)) {
+    check_mapping_overlap_pairwise(iovirt);
+    return num;
+  }
+
+  num = 0;
+  for(block = &iovirt->blocks[0], i = 0; i < iovirt->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block)) {
+    if(block->type == IOVIRT_NODE_ITS_GROUP)
+      continue;
+    for(map = &block->data_map[0], n_maps = block->num_data_map; n_maps > 0; map++, n_maps--) {
+      range[num].OutputRef = (*map).map.output_ref;
+      range[num].Start = (*map).map.output_base;
+      range[num].End = range[num].Start + (*map).map.id_count - 1;
+      range[num++].Block = block;
+    }
+  }
+
+  sort_map_ranges(range, num);
+
+  for(i = 0; i < num; i++) {
+    for(j = i + 1; (j < num) && (range[j].OutputRef == range[i].OutputRef) &&
+        (range[j].Start <= range[i].End); j++)
+      flag_mapping_overlap(iovirt, range[i].Block, range[j].Block, range[i].OutputRef,
+                           range[i].Start, range[i].End, range[j].Start, range[j].End);
+  }
+
+  gBS->FreePool(range);
+  return num;
+}
+
+/**
+  @brief  Number of leading bytes that identify a block: everything before the
+          flags, plus the identifiers array in case of ITS group
+**/
+STATIC UINT32
+block_cmp_size(IOVIRT_BLOCK *block) {
+  UINT32 cmp_size = (UINT8*) &block->flags - (UINT8*)block;
+
+  if(block->type == IOVIRT_NODE_ITS_GROUP)
+    cmp_size += (block->data.its_count * sizeof(UINT32) + sizeof(block->flags));
+  return cmp_size;
+}
+
+STATIC UINT32
+iort_index_block_hash(IOVIRT_BLOCK *block) {
+  UINT8 *byte = (UINT8*)block;
+  UINT32 n, hash = 2166136261u;
+
+  for(n = block_cmp_size(block); n > 0; n--)
+    hash = (hash ^ *byte++) * 16777619u;
+  return hash;
+}
+
+STATIC UINT32
+iort_index_slot(UINT32 key) {
+  return (key * 2654435761u) & gIortIndex.Mask;
+}
+
+/**
+  @brief  Allocate the block index for an IORT with node_count nodes. Without
+          it, block lookups fall back to scanning the table.
+**/
+STATIC VOID
+iort_index_init(UINT32 node_count) {
+  UINT32 slots = 16;
+  EFI_STATUS Status;
+
+  gIortIndex.Mask = 0;
+  /* Keep the load factor at or below one half */
+  while(slots < 2 * node_count)
+    slots <<= 1;
+
+  Status = gBS->AllocatePool(EfiBootServicesData, 2 * slots * sizeof(IORT_INDEX_SLOT),
+                             (VOID **) &gIortIndex.Node);
+  if(EFI_ERROR(Status)) {
+    bsa_print(ACS_PRINT_WARN, L"IORT index allocation failed, using linear lookup\n");
+    return;
+  }
+  SetMem(gIortIndex.Node, 2 * slots * sizeof(IORT_INDEX_SLOT), 0);
+  gIortIndex.Content = gIortIndex.Node + slots;
+  gIortIndex.Mask = slots - 1;
+}
+
+STATIC VOID
+iort_index_free(VOID) {
+  if(gIortIndex.Mask)
+    gBS->FreePool(gIortIndex.Node);
+  gIortIndex.Mask = 0;
+}
+
+STATIC VOID
+iort_index_insert(IORT_INDEX_SLOT *table, UINT32 key, UINT32 offset) {
+  UINT32 i;
+
+  if(!gIortIndex.Mask)
+    return;
+  for(i = iort_index_slot(key); table[i].Offset; i = (i + 1) & gIortIndex.Mask)
+    if(table == gIortIndex.Node && table[i].Key == key)
+      return;
+  table[i].Key = key;
+  table[i].Offset = offset;
+}
+
+/**
+  @brief  Offset of the block already created for the IORT node at node_offset
+  @return Block offset, 0 if the node has not been added
+**/
+STATIC UINT32
+iort_index_find_node(UINT32 node_offset) {
+  UINT32 i;
+
+  if(!gIortIndex.Mask)
+    return 0;
+  for(i = iort_index_slot(node_offset); gIortIndex.Node[i].Offset; i = (i + 1) & gIortIndex.Mask)
+    if(gIortIndex.Node[i].Key == node_offset)
+      return gIortIndex.Node[i].Offset;
+  return 0;
+}
+
 /**
   @brief Find block in IovirtTable
   @param key Block to search
@@ -194,16 +412,22 @@ check_mapping_overlap(IOVIRT_INFO_TABLE *iovirt)
 STATIC UINT32
 find_block(IOVIRT_BLOCK *key, IOVIRT_INFO_TABLE *IoVirtTable) {
   IOVIRT_BLOCK *block = &IoVirtTable->blocks[0];
-  UINT8 *cmp_end;
-  UINT32 i, cmp_size;
+  UINT32 i, hash;
+
+  if(gIortIndex.Mask) {
+    hash = iort_index_block_hash(key);
+    for(i = iort_index_slot(hash); gIortIndex.Content[i].Offset; i = (i + 1) & gIortIndex.Mask) {
+      block = ADD_PTR(IOVIRT_BLOCK, IoVirtTable, gIortIndex.Content[i].Offset);
+      if((gIortIndex.Content[i].Key == hash) && (key->type == block->type) &&
+         !CompareMem(key, block, block_cmp_size(block)))
+        return gIortIndex.Content[i].Offset;
+    }
+    return 0;
+  }
+
   for(i = 0; i < IoVirtTable->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block)) {
-    cmp_end = (UINT8*) &block->flags;
-    cmp_size = cmp_end - (UINT8*)block;
     if(key->type == block->type) {
-       /* Compare identfiers array as well in case of ITS group */
-       if(block->type == IOVIRT_NODE_ITS_GROUP)
-          cmp_size += (block->data.its_count * sizeof(UINT32) + sizeof(block->flags));
-       if(!CompareMem(key, block, cmp_size))
+       if(!CompareMem(key, block, block_cmp_size(block)))
           return (UINT8*)block - (UINT8*)IoVirtTable;
     }
   }
@@ -237,8 +461,18 @@ iort_add_block(IORT_TABLE *iort, IORT_NODE *iort_node, IOVIRT_INFO_TABLE *IoVirt
   NODE_DATA_MAP *data_map = &((*block)->data_map[0]);
   NODE_DATA *data = &((*block)->data);
   VOID *node_data = &(iort_node->node_data[0]);
+  UINT32 node_offset = (UINT8*)iort_node - (UINT8*)iort;
+
+  /* A node referenced again resolves straight to the block created for it */
+  offset = iort_index_find_node(node_offset);
+  if(offset)
+    return offset;
 
-  bsa_print(ACS_PRINT_INFO, L"IORT node offset:%x, type: %d\n", (UINT8*)iort_node - (UINT8*)iort, iort_node->type);
+  bsa_print(ACS_PRINT_INFO, L"IORT node offset:%x, type: %d\n", node_offset, iort_node->type);
+
+  if (!iovirt_block_fits(*block, (iort_node->type == IOVIRT_NODE_ITS_GROUP) ?
+                         (((IORT_ITS_GROUP *)node_data)->its_count + 3) / 4 : iort_node->mapping_count))
+    return (UINT32) -1;
 
   SetMem(data, sizeof(NODE_DATA), 0);
 
@@ -297,8 +531,10 @@ iort_add_block(IORT_TABLE *iort, IORT_NODE *iort_node, IOVIRT_INFO_TABLE *IoVirt
   /* Have we already added this block? */
   /* If so, return the block offset */
   offset = find_block(*block, IoVirtTable);
-  if(offset)
+  if(offset) {
+    iort_index_insert(gIortIndex.Node, node_offset, offset);
     return offset;
+  }
 
   /* Calculate the position where next block should be added */
   next_block = ADD_PTR(IOVIRT_BLOCK, data_map, (*block)->num_data_map * sizeof(NODE_DATA_MAP));
@@ -330,6 +566,8 @@ iort_add_block(IORT_TABLE *iort, IORT_NODE *iort_node, IOVIRT_INFO_TABLE *IoVirt
       (*data_map).map.output_ref = offset;
       data_map++;
       map++;
+      if (offset == (UINT32) -1)
+        continue;
 
       /* Derive the smmu base to which this RC node is connected.
        * If the RC is behind a SMMU, save SMMU base to RC structure.
@@ -348,6 +586,8 @@ iort_add_block(IORT_TABLE *iort, IORT_NODE *iort_node, IOVIRT_INFO_TABLE *IoVirt
   }
   /* So we successfully added a new block. Calculate its offset */
   offset = (UINT8*)(*block) - (UINT8*)IoVirtTable;
+  iort_index_insert(gIortIndex.Node, node_offset, offset);
+  iort_index_insert(gIortIndex.Content, iort_index_block_hash(*block), offset);
   /* Inform the caller about the address at which next block must be added */
   *block = next_block;
   /* Increment the general and type specific block counters */
@@ -358,14 +598,18 @@ iort_add_block(IORT_TABLE *iort, IORT_NODE *iort_node, IOVIRT_INFO_TABLE *IoVirt
 
 /**
   @brief  Parses ACPI IORT table and populates the local iovirt table
+
+  @param  IoVirtTable - Address where the IO virtualization information needs to be filled.
+  @param  MaxSize     - Number of bytes the table has room for.
 **/
 VOID
-pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *IoVirtTable)
+pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *IoVirtTable, UINT32 MaxSize)
 {
   IORT_TABLE  *iort;
   IORT_NODE   *iort_node, *iort_end;
   IOVIRT_BLOCK  *next_block;
-  UINT32 i;
+  UINT32 i, num_maps;
+  UINT64 start_time;
 
   if (IoVirtTable == NULL)
     return;
@@ -377,6 +621,8 @@ pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *IoVirtTable)
   IoVirtTable->num_named_components = 0;
   IoVirtTable->num_its_groups = 0;
   IoVirtTable->num_pmcgs = 0;
+  gIoVirtTableEnd = (UINT8 *)IoVirtTable + MaxSize;
+  gIoVirtTableFull = FALSE;
 
   if(PLATFORM_OVERRIDE_SMMU_BASE) {
     iovirt_create_override_table(IoVirtTable);
@@ -387,12 +633,15 @@ pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *IoVirtTable)
 
   if (iort == NULL) {
     bsa_print(ACS_PRINT_DEBUG, L"No IORT table found. Check DT table \n");
-    pal_iovirt_create_info_table_dt(IoVirtTable);
+    pal_iovirt_create_info_table_dt(IoVirtTable, MaxSize);
     return;
   }
 
+  start_time = GetPerformanceCounter();
+
   /* Point to the first Iovirt table block */
   next_block = &(IoVirtTable->blocks[0]);
+  iort_index_init(iort->node_count);
 
   /* Point to the first IORT node */
   iort_node = ADD_PTR(IORT_NODE, iort, iort->node_offset);
@@ -402,13 +651,60 @@ pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *IoVirtTable)
   for (i = 0; i < iort->node_count; i++) {
     if (iort_node >= iort_end) {
       bsa_print(ACS_PRINT_ERR, L"Bad IORT table \n");
+      iort_index_free();
       return;
     }
+    if (gIoVirtTableFull)
+      break;
     iort_add_block(iort, iort_node, IoVirtTable, &next_block);
     iort_node = ADD_PTR(IORT_NODE, iort_node, iort_node->length);
   }
+  iort_index_free();
   dump_iort_table(IoVirtTable);
-  check_mapping_overlap(IoVirtTable);
+  num_maps = check_mapping_overlap(IoVirtTable);
+
+  bsa_print(ACS_PRINT_INFO, L" IORT: %d nodes, %d blocks, %d ID mappings parsed in %ld us\n",
+            iort->node_count, IoVirtTable->num_blocks, num_maps,
+            GetTimeInNanoSecond(GetPerformanceCounter() - start_time) / 1000);
+}
+
+/**
+  @brief  Return the number of IOVIRT blocks pal_iovirt_create_info_table fills,
+          one per IORT node, and the number of data maps they carry.
+
+  @param  NumDataMaps - Filled with the total number of ID mappings and ITS identifier groups
+
+  @return Number of blocks
+**/
+UINT32
+pal_iovirt_info_table_entries(UINT32 *NumDataMaps)
+{
+  IORT_TABLE  *iort;
+  IORT_NODE   *iort_node, *iort_end;
+  UINT32      i;
+
+  *NumDataMaps = 0;
+  if (PLATFORM_OVERRIDE_SMMU_BASE)
+    return 1;
+
+  iort = (IORT_TABLE *)pal_get_iort_ptr();
+  if (iort == NULL) {
+    *NumDataMaps = pal_dt_info_table_entries();
+    return pal_dt_info_table_entries();
+  }
+
+  iort_node = ADD_PTR(IORT_NODE, iort, iort->node_offset);
+  iort_end = ADD_PTR(IORT_NODE, iort, iort->header.Length);
+
+  for (i = 0; (i < iort->node_count) && (iort_node < iort_end); i++) {
+    if (iort_node->type == IOVIRT_NODE_ITS_GROUP)
+      *NumDataMaps += (((IORT_ITS_GROUP *)&iort_node->node_data[0])->its_count + 3) / 4;
+    else
+      *NumDataMaps += iort_node->mapping_count;
+    iort_node = ADD_PTR(IORT_NODE, iort_node, iort_node->length);
+  }
+
+  return iort->node_count;
 }
 
 /**
@@ -475,20 +771,25 @@ pal_iovirt_get_rc_smmu_base (
 
 /**
   @brief  Parses DT SMMU table and populates the local iovirt table
+
+  @param  IoVirtTable - Address where the IO virtualization information needs to be filled.
+  @param  MaxSize     - Number of bytes the table has room for.
 **/
 VOID
-pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
+pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable, UINT32 MaxSize)
 {
   IOVIRT_BLOCK  *next_block;
   UINT64 dt_ptr = 0;
   NODE_DATA *data;
   NODE_DATA_MAP *data_map;
-  UINT32 i, iommu_node;
+  UINT32 i;
+  int iommu_node;
   UINT32 *Preg_val;
   int offset, parent_offset;
   int prop_len, addr_cell, size_cell;
   const struct fdt_property *P_dma;
   const struct fdt_property *P_ats;
+  UINT64 start_time;
 
 
   if (IoVirtTable == NULL)
@@ -498,6 +799,7 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
     bsa_print(ACS_PRINT_ERR, L" dt_ptr is NULL\n");
     return;
   }
+  start_time = GetPerformanceCounter();
 
   /* Initialize counters */
   IoVirtTable->num_blocks = 0;
@@ -506,6 +808,8 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
   IoVirtTable->num_named_components = 0;
   IoVirtTable->num_its_groups = 0;
   IoVirtTable->num_pmcgs = 0;
+  gIoVirtTableEnd = (UINT8 *)IoVirtTable + MaxSize;
+  gIoVirtTableFull = FALSE;
 
   /* Point to the first Iovirt table block */
   next_block = &(IoVirtTable->blocks[0]);
@@ -513,21 +817,21 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
   /* Add SMMUv3 nodes if present */
   offset = -1;
   for (i = 0; i < sizeof(smmu3_dt_arr)/SMMU_COMPATIBLE_STR_LEN; i++) {
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset, smmu3_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, smmu3_dt_arr[i]);
       if (offset < 0)
           continue; /* Search for next compatible smmuv3*/
 
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" Parent Node offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
       if (size_cell < 1) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell :%d\n", size_cell);
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
       if (addr_cell < 1) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell : %d \n", addr_cell);
@@ -544,6 +848,9 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
               return;
           }
 
+          if (!iovirt_block_fits(next_block, 0))
+              break;
+
           IoVirtTable->num_smmus++;
           IoVirtTable->num_blocks++;
           next_block->type = IOVIRT_NODE_SMMU_V3;
@@ -561,28 +868,28 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
               (*data).smmu.base    = ((*data).smmu.base << 32) | fdt32_to_cpu(Preg_val[1]);
           }
           next_block = ADD_PTR(IOVIRT_BLOCK, data_map, 0);
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset, smmu3_dt_arr[i]);
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, smmu3_dt_arr[i]);
       }
   }
 
   /* Add SMMUv2 nodes if present */
   offset = -1;
   for (i = 0; i < sizeof(smmu_dt_arr)/SMMU_COMPATIBLE_STR_LEN; i++) {
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset, smmu_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, smmu_dt_arr[i]);
       if (offset < 0)
           continue; /* Search for next compatible smmuv2*/
 
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" Parent Node offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
       if (size_cell < 1) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell :%d\n", size_cell);
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
       if (addr_cell < 1) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell : %d \n", addr_cell);
@@ -599,6 +906,9 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
               return;
           }
 
+          if (!iovirt_block_fits(next_block, 0))
+              break;
+
           IoVirtTable->num_smmus++;
           IoVirtTable->num_blocks++;
           next_block->type = IOVIRT_NODE_SMMU;
@@ -616,7 +926,7 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
               (*data).smmu.base    = ((*data).smmu.base << 32) | fdt32_to_cpu(Preg_val[1]);
           }
           next_block = ADD_PTR(IOVIRT_BLOCK, data_map, 0);
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset, smmu_dt_arr[i]);
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, smmu_dt_arr[i]);
       }
   }
 
@@ -627,17 +937,17 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
     return;
   }
 
-  parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+  parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
   bsa_print(ACS_PRINT_DEBUG, L" NODE pcie offset %d\n", offset);
 
-  size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+  size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
   bsa_print(ACS_PRINT_DEBUG, L" NODE pcie size cell %d\n", size_cell);
   if (size_cell < 0) {
     bsa_print(ACS_PRINT_ERR, L" Invalid size cell \n");
     return;
   }
 
-  addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+  addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
   bsa_print(ACS_PRINT_DEBUG, L" NODE pcie addr cell %d\n", addr_cell);
   if (addr_cell <= 0 || addr_cell > 2) {
     bsa_print(ACS_PRINT_ERR, L" Invalid address cell \n");
@@ -651,6 +961,9 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
       /* parse iommu-map is present */
       Preg_val = (UINT32 *)fdt_getprop_namelen((void *)dt_ptr, offset, "iommu-map", 9, &prop_len);
       if (!((Preg_val == NULL) || prop_len < 0)) {
+          if (!iovirt_block_fits(next_block, 0))
+              break;
+
           IoVirtTable->num_pci_rcs++;
           IoVirtTable->num_blocks++;
           next_block->type = IOVIRT_NODE_PCI_ROOT_COMPLEX;
@@ -661,10 +974,16 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
           SetMem(data, sizeof(NODE_DATA), 0);
 
           (*data).rc.segment = 0;
-          iommu_node =  fdt32_to_cpu(Preg_val[1]);
-         Preg_val = (UINT32 *)fdt_getprop_namelen((void *)dt_ptr, iommu_node, "reg", 3, &prop_len);
-          (*data).rc.smmu_base    = fdt32_to_cpu(Preg_val[0]);
-          (*data).rc.smmu_base    = ((*data).rc.smmu_base << 32) | fdt32_to_cpu(Preg_val[1]);
+          /* iommu-map = <rid-base iommu-phandle iommu-base length> */
+          iommu_node = fdt_index_node_offset_by_phandle((const void *)dt_ptr,
+                                                        fdt32_to_cpu(Preg_val[1]));
+          Preg_val = (UINT32 *)fdt_getprop_namelen((void *)dt_ptr, iommu_node, "reg", 3, &prop_len);
+          if ((prop_len < 0) || (Preg_val == NULL)) {
+              bsa_print(ACS_PRINT_ERR, L" iommu-map target reg not found, Error %d\n", prop_len);
+          } else {
+              (*data).rc.smmu_base    = fdt32_to_cpu(Preg_val[0]);
+              (*data).rc.smmu_base    = ((*data).rc.smmu_base << 32) | fdt32_to_cpu(Preg_val[1]);
+          }
       } else {
         offset = fdt_node_offset_by_prop_value((const void *) dt_ptr, offset, "device_type",
                                                 "pci", 4);
@@ -689,4 +1008,8 @@ pal_iovirt_create_info_table_dt(IOVIRT_INFO_TABLE *IoVirtTable)
   }
   dump_iort_table(IoVirtTable);
   check_mapping_overlap(IoVirtTable);
+
+  bsa_print(ACS_PRINT_INFO, L" DT IOVIRT: %d SMMUs, %d root complexes parsed in %ld us\n",
+            IoVirtTable->num_smmus, IoVirtTable->num_pci_rcs,
+            GetTimeInNanoSecond(GetPerformanceCounter() - start_time) / 1000);
 }
@@ -67,12 +67,13 @@ pal_pcie_get_mcfg_ecam()
 /**
   @brief  Fill the PCIE Info table with the details of the PCIe sub-system
 
-  @param  PcieTable - Address where the PCIe information needs to be filled.
+  @param  PcieTable  - Address where the PCIe information needs to be filled.
+  @param  MaxEntries - Number of PCIE_INFO_BLOCK entries the table has room for.
 
   @return  None
  **/
 VOID
-pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
+pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable, UINT32 MaxEntries)
 {
 
   EFI_ACPI_MEMORY_MAPPED_ENHANCED_CONFIGURATION_SPACE_BASE_ADDRESS_ALLOCATION_STRUCTURE  *Entry = NULL;
@@ -91,7 +92,7 @@ pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
 
   if (gMcfgHdr == NULL) {
       bsa_print(ACS_PRINT_DEBUG, L"ACPI - MCFG Table not found. Check DT \n");
-      pal_pcie_create_info_table_dt(PcieTable);
+      pal_pcie_create_info_table_dt(PcieTable, MaxEntries);
       return;
   }
 
@@ -108,6 +109,10 @@ pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
   do{
       if (Entry == NULL)  //Due to a buggy MCFG - first entry is null, then exit
           break;
+      if (i >= MaxEntries) {
+          bsa_print(ACS_PRINT_WARN, L" PCIE_INFO: Table full at %d entries \n", MaxEntries);
+          break;
+      }
       PcieTable->block[i].ecam_base     = Entry->BaseAddress;
       PcieTable->block[i].segment_num   = Entry->PciSegmentGroupNumber;
       PcieTable->block[i].start_bus_num = Entry->StartBusNumber;
@@ -121,6 +126,30 @@ pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable)
   return;
 }
 
+/**
+  @brief  Return the number of PCIE_INFO entries pal_pcie_create_info_table
+          fills, one per MCFG allocation structure.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_pcie_info_table_entries()
+{
+  UINT32 Count;
+
+  gMcfgHdr = (EFI_ACPI_MEMORY_MAPPED_CONFIGURATION_BASE_ADDRESS_TABLE_HEADER *) pal_get_mcfg_ptr();
+  if (gMcfgHdr == NULL)
+    return pal_dt_info_table_entries();
+
+  Count = (gMcfgHdr->Header.Length - sizeof(EFI_ACPI_MEMORY_MAPPED_CONFIGURATION_BASE_ADDRESS_TABLE_HEADER)) /
+          sizeof(EFI_ACPI_MEMORY_MAPPED_ENHANCED_CONFIGURATION_SPACE_BASE_ADDRESS_ALLOCATION_STRUCTURE);
+
+  /* The table is always written at least once, even from an empty MCFG */
+  return (Count == 0) ? 1 : Count;
+}
+
 /**
     @brief   Reads 32-bit data from PCIe config space pointed by Bus,
            Device, Function and register offset, using UEFI PciIoProtocol
@@ -382,11 +411,12 @@ pal_pcie_get_device_type(UINT32 seg, UINT32 bus, UINT32 dev, UINT32 fn)
           system. This is achieved by parsing the DT blob.
 
   @param  PcieTable  - Address where the PcieTable information needs to be filled.
+  @param  MaxEntries - Number of PCIE_INFO_BLOCK entries the table has room for.
 
   @return  None
 **/
 VOID
-pal_pcie_create_info_table_dt(PCIE_INFO_TABLE *PcieTable)
+pal_pcie_create_info_table_dt(PCIE_INFO_TABLE *PcieTable, UINT32 MaxEntries)
 {
   UINT64 dt_ptr;
   UINT32 *Preg_val, *Pbus_val;
@@ -405,23 +435,23 @@ pal_pcie_create_info_table_dt(PCIE_INFO_TABLE *PcieTable)
   PcieTable->num_entries = 0;
 
   for (i = 0; i < sizeof(pci_dt_arr)/PCI_COMPATIBLE_STR_LEN ; i++) {
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, pci_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, pci_dt_arr[i]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L" PCI node offset not found %d \n", offset);
           continue; /* Search for next compatible node*/
       }
 
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE pcie offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE pcie size cell %d\n", size_cell);
       if (size_cell < 0) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell \n");
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE pcie addr cell %d\n", addr_cell);
       if (addr_cell <= 0 || addr_cell > 2) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell \n");
@@ -431,6 +461,11 @@ pal_pcie_create_info_table_dt(PCIE_INFO_TABLE *PcieTable)
       /* Perform a DT traversal till all pcie node are parsed */
       while (offset != -FDT_ERR_NOTFOUND) {
 
+          if (PcieTable->num_entries >= MaxEntries) {
+              bsa_print(ACS_PRINT_WARN, L" PCIE_INFO: Table full at %d entries \n", MaxEntries);
+              break;
+          }
+
           Preg_val = (UINT32 *)fdt_getprop_namelen((void *)dt_ptr, offset, "reg", 3, &prop_len);
           if ((Preg_val == NULL) || prop_len < 0) {
               bsa_print(ACS_PRINT_ERR, L" PROPERTY reg offset %x, Error %d\n", offset, prop_len);
@@ -451,7 +486,7 @@ pal_pcie_create_info_table_dt(PCIE_INFO_TABLE *PcieTable)
           PcieTable->block[PcieTable->num_entries].segment_num = 0;
           PcieTable->block[PcieTable->num_entries].start_bus_num = fdt32_to_cpu(Pbus_val[0]);
           PcieTable->block[PcieTable->num_entries].end_bus_num = fdt32_to_cpu(Pbus_val[1]);
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset, pci_dt_arr[i]);
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, pci_dt_arr[i]);
 
           PcieTable->num_entries++;
       }
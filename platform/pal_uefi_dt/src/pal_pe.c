@@ -132,12 +132,13 @@ PalAllocateSecondaryStack(UINT64 mpidr)
   @brief  This API fills in the PE_INFO Table with information about the PEs in the
           system. This is achieved by parsing the ACPI - MADT table.
 
-  @param  PeTable  - Address where the PE information needs to be filled.
+  @param  PeTable    - Address where the PE information needs to be filled.
+  @param  MaxEntries - Number of PE entries the table has room for.
 
   @return  None
 **/
 VOID
-pal_pe_create_info_table(PE_INFO_TABLE *PeTable)
+pal_pe_create_info_table(PE_INFO_TABLE *PeTable, UINT32 MaxEntries)
 {
   EFI_ACPI_6_1_GIC_STRUCTURE    *Entry = NULL;
   PE_INFO_ENTRY                 *Ptr = NULL;
@@ -158,7 +159,7 @@ pal_pe_create_info_table(PE_INFO_TABLE *PeTable)
     bsa_print(ACS_PRINT_INFO, L" MADT is at %x and length is %x \n", gMadtHdr, TableLength);
   } else {
     bsa_print(ACS_PRINT_DEBUG, L"MADT not found..Checking DT \n");
-    pal_pe_create_info_table_dt(PeTable);
+    pal_pe_create_info_table_dt(PeTable, MaxEntries);
     return;
   }
 
@@ -171,6 +172,10 @@ pal_pe_create_info_table(PE_INFO_TABLE *PeTable)
   do {
 
     if (Entry->Type == EFI_ACPI_6_1_GIC) {
+      if (PeTable->header.num_of_pe >= MaxEntries) {
+        bsa_print(ACS_PRINT_WARN, L" PE_INFO: Table full at %d entries \n", MaxEntries);
+        break;
+      }
       //Fill in the cpu num and the mpidr in pe info table
       Ptr->mpidr    = Entry->MPIDR;
       Ptr->pe_num   = PeTable->header.num_of_pe;
@@ -199,6 +204,38 @@ pal_pe_create_info_table(PE_INFO_TABLE *PeTable)
 
 }
 
+/**
+  @brief  Return the number of PE_INFO entries pal_pe_create_info_table fills,
+          one for each GICC structure in the MADT.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_pe_info_table_entries()
+{
+  EFI_ACPI_6_1_GIC_STRUCTURE    *Entry;
+  UINT32                        Length;
+  UINT32                        Count = 0;
+
+  gMadtHdr = (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER *) pal_get_madt_ptr();
+  if (gMadtHdr == NULL)
+    return pal_dt_info_table_entries();
+
+  Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) (gMadtHdr + 1);
+  Length = sizeof (EFI_ACPI_6_1_MULTIPLE_APIC_DESCRIPTION_TABLE_HEADER);
+
+  while ((Length < gMadtHdr->Header.Length) && Entry->Length) {
+    if (Entry->Type == EFI_ACPI_6_1_GIC)
+      Count++;
+    Length += Entry->Length;
+    Entry = (EFI_ACPI_6_1_GIC_STRUCTURE *) ((UINT8 *)Entry + (Entry->Length));
+  }
+
+  return Count;
+}
+
 /**
   @brief  Install Exception Handler using UEFI CPU Architecture protocol's
           Register Interrupt Handler API
@@ -379,7 +416,7 @@ pal_pe_info_table_pmu_gsiv_dt(PE_INFO_TABLE *PeTable)
   for (i = 0; i < (sizeof(pmu_dt_arr)/PMU_COMPATIBLE_STR_LEN); i++) {
 
       /* Search for pmu nodes*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, pmu_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, pmu_dt_arr[i]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L"PMU compatible value not found for index:%d\n", i);
           continue; /* Search for next compatible item*/
@@ -444,7 +481,7 @@ pal_pe_info_table_pmu_gsiv_dt(PE_INFO_TABLE *PeTable)
           }
 
           offset =
-              fdt_node_offset_by_compatible((const void *)dt_ptr, offset, pmu_dt_arr[i]);
+              fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, pmu_dt_arr[i]);
       }
   }
 }
@@ -453,12 +490,13 @@ pal_pe_info_table_pmu_gsiv_dt(PE_INFO_TABLE *PeTable)
   @brief  This API fills in the PE_INFO Table with information about the PEs in the
           system. This is achieved by parsing the DT blob.
 
-  @param  PeTable  - Address where the PE information needs to be filled.
+  @param  PeTable    - Address where the PE information needs to be filled.
+  @param  MaxEntries - Number of PE entries the table has room for.
 
   @return  None
 **/
 VOID
-pal_pe_create_info_table_dt(PE_INFO_TABLE *PeTable)
+pal_pe_create_info_table_dt(PE_INFO_TABLE *PeTable, UINT32 MaxEntries)
 {
   PE_INFO_ENTRY *Ptr = NULL;
   UINT64 dt_ptr;
@@ -481,17 +519,17 @@ pal_pe_create_info_table_dt(PE_INFO_TABLE *PeTable)
   offset = fdt_node_offset_by_prop_value((const void *) dt_ptr, -1, "device_type", "cpu", 4);
 
   if (offset != -FDT_ERR_NOTFOUND) {
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE cpu offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE cpu size cell %d\n", size_cell);
       if (size_cell != 0) {
         bsa_print(ACS_PRINT_ERR, L" Invalid size cell for node cpu\n");
         return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" NODE cpu  addr cell %d\n", addr_cell);
       if (addr_cell <= 0 || addr_cell > 2) {
         bsa_print(ACS_PRINT_ERR, L" Invalid address cell for node cpu\n");
@@ -506,6 +544,10 @@ pal_pe_create_info_table_dt(PE_INFO_TABLE *PeTable)
 
   /* Perform a DT traversal till all cpu node are parsed */
   while (offset != -FDT_ERR_NOTFOUND) {
+      if (PeTable->header.num_of_pe >= MaxEntries) {
+        bsa_print(ACS_PRINT_WARN, L" PE_INFO: Table full at %d entries \n", MaxEntries);
+        break;
+      }
       bsa_print(ACS_PRINT_DEBUG, L" SUBNODE cpu%d offset %x\n", PeTable->header.num_of_pe, offset);
 
       prop_val = (UINT32 *)fdt_getprop_namelen((void *)dt_ptr, offset, "reg", 3, &prop_len);
@@ -26,6 +26,7 @@
 #include <Include/libfdt.h>
 
 #include <Protocol/AcpiTable.h>
+#include <Protocol/PciIo.h>
 #include "Include/IndustryStandard/Acpi61.h"
 #include "Include/IndustryStandard/SerialPortConsoleRedirectionTable.h"
 
@@ -41,6 +42,9 @@
 #define BAR1            1
 #define BAR2            2
 
+/* Descriptors UEFI may add to the memory map between sizing and filling the memory table */
+#define MEM_INFO_TABLE_SLACK  8
+
 UINT64
 pal_get_spcr_ptr();
 
@@ -61,16 +65,33 @@ static char uart_dt_compatible[][UART_COMPATIBLE_STR_LEN] = {
     "arm,pl011"
 };
 
+/**
+  @brief  Check whether one more entry, and the end marker after it, fit in a
+          peripheral info table sized for MaxEntries entries. Warns when they do not.
+**/
+STATIC
+BOOLEAN
+pal_peripheral_table_full(PERIPHERAL_INFO_TABLE *peripheralInfoTable, PERIPHERAL_INFO_BLOCK *per_info,
+                          UINT32 MaxEntries)
+{
+  if ((UINT32)(per_info - peripheralInfoTable->info) + 1 < MaxEntries)
+    return FALSE;
+
+  bsa_print(ACS_PRINT_WARN, L" PERIPHERAL_INFO: Table full at %d entries \n", MaxEntries);
+  return TRUE;
+}
+
 /**
   @brief  This API fills in the PERIPHERAL_INFO_TABLE with information about USB
           in the system. This is achieved by parsing the DT.
 
   @param  peripheralInfoTable  - Address where the Peripheral information needs to be filled.
+  @param  MaxEntries           - Number of entries the table has room for, end marker included.
 
   @return  None
 **/
 VOID
-pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
+pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries)
 {
   PERIPHERAL_INFO_BLOCK *per_info = NULL;
   int i, offset, parent_offset, prop_len;
@@ -94,24 +115,24 @@ pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTab
   for (i = 0; i < (sizeof(usb_dt_compatible)/USB_COMPATIBLE_STR_LEN); i++) {
 
       /* Search for USB nodes*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, usb_dt_compatible[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, usb_dt_compatible[i]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L"USB compatible value not found for index:%d\n", i);
           continue; /* Search for next compatible item*/
       }
 
       /* Get Address_cell & Size_cell length to parse reg property of timer*/
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" Parent Node offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
       if (size_cell < 0) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell :%d\n", size_cell);
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
       if (addr_cell < 1 || addr_cell > 2) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell : %d \n", addr_cell);
@@ -119,6 +140,9 @@ pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTab
       }
       while (offset != -FDT_ERR_NOTFOUND) {
 
+          if (pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries))
+              return;
+
           per_info->type  = PERIPHERAL_TYPE_USB;
 
           /* Get reg property to update base */
@@ -167,7 +191,7 @@ pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTab
           peripheralInfoTable->header.num_usb++;
           per_info++;
           offset =
-              fdt_node_offset_by_compatible((const void *)dt_ptr, offset, usb_dt_compatible[i]);
+              fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, usb_dt_compatible[i]);
       }
   }
 }
@@ -177,11 +201,12 @@ pal_peripheral_usb_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTab
           in the system. This is achieved by parsing the DT.
 
   @param  peripheralInfoTable  - Address where the Peripheral information needs to be filled.
+  @param  MaxEntries           - Number of entries the table has room for, end marker included.
 
   @return  None
 **/
 VOID
-pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
+pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries)
 {
   PERIPHERAL_INFO_BLOCK *per_info = NULL;
   int i, offset, parent_offset, prop_len;
@@ -206,24 +231,24 @@ pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
   for (i = 0; i < (sizeof(sata_dt_compatible)/SATA_COMPATIBLE_STR_LEN); i++) {
 
       /* Search for sata node*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, sata_dt_compatible[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, sata_dt_compatible[i]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L"SATA compatible value not found for index:%d\n", i);
           continue; /* Search for next compatible item*/
       }
 
       /* Get Address_cell & Size_cell length to parse reg property of timer*/
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" Parent Node offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
       if (size_cell < 0) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell :%d\n", size_cell);
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
       if (addr_cell < 1 || addr_cell > 2) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell : %d \n", addr_cell);
@@ -231,6 +256,9 @@ pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
       }
       while (offset != -FDT_ERR_NOTFOUND) {
 
+          if (pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries))
+              return;
+
           per_info->type  = PERIPHERAL_TYPE_SATA;
 
           /* Get reg property to update base */
@@ -279,7 +307,7 @@ pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
           peripheralInfoTable->header.num_sata++;
           per_info++;
           offset =
-              fdt_node_offset_by_compatible((const void *)dt_ptr, offset, sata_dt_compatible[i]);
+              fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, sata_dt_compatible[i]);
       }
   }
 }
@@ -289,11 +317,12 @@ pal_peripheral_sata_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
           in the system. This is achieved by parsing the DT.
 
   @param  peripheralInfoTable  - Address where the Peripheral information needs to be filled.
+  @param  MaxEntries           - Number of entries the table has room for, end marker included.
 
   @return  None
 **/
 VOID
-pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
+pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries)
 {
   PERIPHERAL_INFO_BLOCK *per_info = NULL;
   int i, offset, parent_offset, prop_len;
@@ -326,24 +355,24 @@ pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
   for (i = 0; i < (sizeof(uart_dt_compatible)/UART_COMPATIBLE_STR_LEN); i++) {
 
       /* Search for uart nodes*/
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, uart_dt_compatible[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, uart_dt_compatible[i]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L"UART compatible value not found for index:%d\n", i);
           continue; /* Search for next compatible item*/
       }
 
       /* Get Address_cell & Size_cell length to parse reg property of uart*/
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" Parent Node offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
       if (size_cell < 0) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell :%d\n", size_cell);
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
       if (addr_cell < 1 || addr_cell > 2) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell : %d \n", addr_cell);
@@ -351,6 +380,9 @@ pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
       }
       while (offset != -FDT_ERR_NOTFOUND) {
 
+          if (pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries))
+              return;
+
           /* Consider only that UART which is visible in non-secure world
              Status fields either not present or if present should not be disabled */
           Pstatus = (CHAR8 *)fdt_getprop_namelen((void *)dt_ptr, offset, "status", 6, &prop_len);
@@ -358,7 +390,7 @@ pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
               bsa_print(ACS_PRINT_DEBUG, L" Status field length %d\n", prop_len);
               if (pal_strncmp(Pstatus, "disabled", 9) == 0) {
                   bsa_print(ACS_PRINT_DEBUG, L" UART access is secure \n");
-                  offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset,
+                  offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset,
                                                           uart_dt_compatible[i]);
                   continue;
               }
@@ -388,7 +420,7 @@ pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
   /* Start with searching current node address in parent ranges, so treat current node as child */
           range_node_offset = offset;
           range_node_addr = per_info->base0;
-          range_parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+          range_parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
           parent_offset_addr = 0;
           range_node_left = 3; /* how many parent nodes will search */
           while (range_node_left > 0) {
@@ -403,15 +435,15 @@ pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
               range_node_left--;
               if ((Pranges != NULL) && (prop_len == 0)) {// Empty ranges
                   bsa_print(ACS_PRINT_DEBUG, L" Empty ranges is present \n");
-                  range_parent_offset = fdt_parent_offset((const void *) dt_ptr,
+                  range_parent_offset = fdt_index_parent_offset((const void *) dt_ptr,
                                                                              range_parent_offset);
               } else {
                   range_node_offset = range_parent_offset;
-                 range_parent_offset = fdt_parent_offset((const void *) dt_ptr, range_node_offset);
+                 range_parent_offset = fdt_index_parent_offset((const void *) dt_ptr, range_node_offset);
                   /* ranges = <child addr cell  parent addr cell   child size cell> */
-                  child_addr_cell = fdt_address_cells((const void *) dt_ptr, range_node_offset);
-                  parent_addr_cell = fdt_address_cells((const void *) dt_ptr, range_parent_offset);
-                  child_size_cell = fdt_size_cells((const void *) dt_ptr, range_node_offset);
+                  child_addr_cell = fdt_index_address_cells((const void *) dt_ptr, range_node_offset);
+                  parent_addr_cell = fdt_index_address_cells((const void *) dt_ptr, range_parent_offset);
+                  child_size_cell = fdt_index_size_cells((const void *) dt_ptr, range_node_offset);
 
                   bsa_print(ACS_PRINT_DEBUG, L" child addr cell %d\n", child_addr_cell);
                   bsa_print(ACS_PRINT_DEBUG, L" parent addr cell %d\n", parent_addr_cell);
@@ -490,7 +522,7 @@ pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
           peripheralInfoTable->header.num_uart++;
           per_info++;
           offset =
-              fdt_node_offset_by_compatible((const void *)dt_ptr, offset, uart_dt_compatible[i]);
+              fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, uart_dt_compatible[i]);
       }
   }
 }
@@ -499,11 +531,12 @@ pal_peripheral_uart_create_info_table_dt(PERIPHERAL_INFO_TABLE *peripheralInfoTa
           in the system. This is achieved by parsing the ACPI - SPCR table and PCIe config space.
 
   @param  peripheralInfoTable  - Address where the Peripheral information needs to be filled.
+  @param  MaxEntries           - Number of entries the table has room for, end marker included.
 
   @return  None
 **/
 VOID
-pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
+pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable, UINT32 MaxEntries)
 {
   UINT32   DeviceBdf = 0;
   UINT32   StartBdf  = 0;
@@ -526,6 +559,8 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
 
        DeviceBdf = palPcieGetBdf(USB_CLASSCODE, StartBdf);
        if (DeviceBdf != 0) {
+          if (pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries))
+            break;
           per_info->type  = PERIPHERAL_TYPE_USB;
           per_info->base0 = palPcieGetBase(DeviceBdf, BAR0);
           per_info->bdf   = DeviceBdf;
@@ -538,7 +573,7 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
   } while (DeviceBdf != 0);
 
   if (peripheralInfoTable->header.num_usb == 0) { /* Search for USB in Device tree*/
-    pal_peripheral_usb_create_info_table_dt(peripheralInfoTable);
+    pal_peripheral_usb_create_info_table_dt(peripheralInfoTable, MaxEntries);
     per_info += peripheralInfoTable->header.num_usb;
   }
 
@@ -548,6 +583,8 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
 
        DeviceBdf = palPcieGetBdf(SATA_CLASSCODE, StartBdf);
        if (DeviceBdf != 0) {
+          if (pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries))
+            break;
           per_info->type  = PERIPHERAL_TYPE_SATA;
           per_info->base0 = palPcieGetBase(DeviceBdf, BAR0);
           per_info->bdf   = DeviceBdf;
@@ -561,14 +598,14 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
   } while (DeviceBdf != 0);
 
   if (peripheralInfoTable->header.num_sata == 0) { /* Search for SATA in Device tree*/
-    pal_peripheral_sata_create_info_table_dt(peripheralInfoTable);
+    pal_peripheral_sata_create_info_table_dt(peripheralInfoTable, MaxEntries);
     per_info += peripheralInfoTable->header.num_sata;
   }
 
   /* Search for a SPCR table in the system to get the UART details */
   spcr = (EFI_ACPI_SERIAL_PORT_CONSOLE_REDIRECTION_TABLE *)pal_get_spcr_ptr();
 
-  if (spcr) {
+  if (spcr && !pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries)) {
     peripheralInfoTable->header.num_uart++;
     per_info->base0 = spcr->BaseAddress.Address;
     per_info->irq   = spcr->GlobalSystemInterrupt;
@@ -577,11 +614,11 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
   }
 
   if (peripheralInfoTable->header.num_uart == 0) { /* Search for UART in Device tree*/
-    pal_peripheral_uart_create_info_table_dt(peripheralInfoTable);
+    pal_peripheral_uart_create_info_table_dt(peripheralInfoTable, MaxEntries);
     per_info += peripheralInfoTable->header.num_uart;
   }
 
-  if (PLATFORM_GENERIC_UART_BASE) {
+  if (PLATFORM_GENERIC_UART_BASE && !pal_peripheral_table_full(peripheralInfoTable, per_info, MaxEntries)) {
     peripheralInfoTable->header.num_uart++;
     per_info->base0 = PLATFORM_GENERIC_UART_BASE;
     per_info->irq   = PLATFORM_GENERIC_UART_INTID;
@@ -593,6 +630,38 @@ pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *peripheralInfoTable)
   dt_dump_peripheral_table(peripheralInfoTable);
 }
 
+/**
+  @brief  Return the number of PERIPHERAL_INFO entries pal_peripheral_create_info_table
+          may fill: every PCI function could be a USB or SATA controller, plus the
+          SPCR and override UARTs and the end marker.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_peripheral_info_table_entries()
+{
+  EFI_STATUS  Status;
+  EFI_HANDLE  *HandleBuffer;
+  UINTN       HandleCount = 0;
+  UINT32      Count;
+
+  Status = gBS->LocateHandleBuffer (ByProtocol, &gEfiPciIoProtocolGuid, NULL, &HandleCount, &HandleBuffer);
+  if (!EFI_ERROR (Status))
+    gBS->FreePool (HandleBuffer);
+  else
+    HandleCount = 0;
+
+  Count = (UINT32)HandleCount + 3;
+
+  /* Controllers may also come from the device tree */
+  if (pal_get_dt_ptr())
+    Count += pal_dt_info_table_entries();
+
+  return Count;
+}
+
 
 /**
   @brief  Check if the memory type is reserved for UEFI
@@ -671,12 +740,13 @@ IsDeviceMemory(EFI_MEMORY_TYPE type)
   @brief  This API fills in the MEMORY_INFO_TABLE with information about memory in the
           system. This is achieved by parsing the UEFI memory map.
 
-  @param  peripheralInfoTable  - Address where the Peripheral information needs to be filled.
+  @param  memoryInfoTable  - Address where the memory information needs to be filled.
+  @param  MaxEntries       - Number of entries the table has room for, end marker included.
 
   @return  None
 **/
 VOID
-pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable)
+pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable, UINT32 MaxEntries)
 {
 
   UINTN                 MemoryMapSize;
@@ -717,6 +787,10 @@ pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable)
   if (!EFI_ERROR (Status)) {
     MemoryMapPtr = MemoryMap;
     for (Index = 0; Index < (MemoryMapSize / DescriptorSize); Index++) {
+      if (i + 1 >= MaxEntries) {
+        bsa_print(ACS_PRINT_WARN, L" MEMORY_INFO: Table full at %d entries \n", MaxEntries);
+        break;
+      }
           bsa_print(ACS_PRINT_INFO, L"Reserved region of type %d [0x%lX, 0x%lX]\n",
             MemoryMapPtr->Type, (UINTN)MemoryMapPtr->PhysicalStart,
             (UINTN)(MemoryMapPtr->PhysicalStart + MemoryMapPtr->NumberOfPages * EFI_PAGE_SIZE));
@@ -740,9 +814,34 @@ pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable)
 
       MemoryMapPtr = (EFI_MEMORY_DESCRIPTOR*)((UINTN)MemoryMapPtr + DescriptorSize);
     }
-    memoryInfoTable->info[i].type      = MEMORY_TYPE_LAST_ENTRY;
   }
+  memoryInfoTable->info[i].type      = MEMORY_TYPE_LAST_ENTRY;
+
+}
+
+/**
+  @brief  Return the number of MEM_INFO entries pal_memory_create_info_table may
+          fill: one per UEFI memory map descriptor and the end marker, with slack
+          for descriptors added by allocations made before the table is filled.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_memory_info_table_entries()
+{
+  UINTN                 MemoryMapSize = 0;
+  UINTN                 MapKey;
+  UINTN                 DescriptorSize = 0;
+  UINT32                DescriptorVersion;
+  EFI_STATUS            Status;
+
+  Status = gBS->GetMemoryMap (&MemoryMapSize, NULL, &MapKey, &DescriptorSize, &DescriptorVersion);
+  if ((Status != EFI_BUFFER_TOO_SMALL) || (DescriptorSize == 0))
+    return 1;  /* the end marker alone */
 
+  return (UINT32)(MemoryMapSize / DescriptorSize) + MEM_INFO_TABLE_SLACK + 1;
 }
 
 UINT64
@@ -155,12 +155,30 @@ pal_timer_create_info_table(TIMER_INFO_TABLE *TimerTable)
 
 }
 
+/**
+  @brief  Return the number of GT block entries pal_timer_create_info_table may
+          fill: at most one per GTDT platform timer structure, plus the override.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_timer_info_table_entries()
+{
+  gGtdtHdr = (EFI_ACPI_6_1_GENERIC_TIMER_DESCRIPTION_TABLE *) pal_get_gtdt_ptr();
+  if (gGtdtHdr == NULL)
+    return pal_dt_info_table_entries();
+
+  return gGtdtHdr->PlatformTimerCount + 1;
+}
+
 /* Only one watchdog information can be assigned as an override */
 VOID
-pal_wd_platform_override(WD_INFO_TABLE *WdTable)
+pal_wd_platform_override(WD_INFO_TABLE *WdTable, UINT32 MaxEntries)
 {
 
-  if (PLATFORM_OVERRIDE_WD == 1) {
+  if ((PLATFORM_OVERRIDE_WD == 1) && (MaxEntries > 0)) {
       WdTable->header.num_wd              = 1;
       WdTable->wd_info[0].wd_refresh_base = PLATFORM_OVERRIDE_WD_REFRESH_BASE;
       WdTable->wd_info[0].wd_ctrl_base    = PLATFORM_OVERRIDE_WD_CTRL_BASE;
@@ -175,13 +193,14 @@ pal_wd_platform_override(WD_INFO_TABLE *WdTable)
   @brief  This API fills in the WD_INFO_TABLE with information about Watchdogs
           in the system. This is achieved by parsing the ACPI - GTDT table.
 
-  @param  WdTable  - Address where the Timer information needs to be filled.
+  @param  WdTable    - Address where the Timer information needs to be filled.
+  @param  MaxEntries - Number of WD_INFO_BLOCK entries the table has room for.
 
   @return  None
 **/
 
 VOID
-pal_wd_create_info_table(WD_INFO_TABLE *WdTable)
+pal_wd_create_info_table(WD_INFO_TABLE *WdTable, UINT32 MaxEntries)
 {
 
   EFI_ACPI_6_1_GTDT_SBSA_GENERIC_WATCHDOG_STRUCTURE    *Entry = NULL;
@@ -200,7 +219,7 @@ pal_wd_create_info_table(WD_INFO_TABLE *WdTable)
 
   if (gGtdtHdr == NULL) {
     bsa_print(ACS_PRINT_DEBUG, L"GTDT not found & Searching for DT\n");
-    pal_wd_create_info_table_dt(WdTable);
+    pal_wd_create_info_table_dt(WdTable, MaxEntries);
     return;
   }
 
@@ -217,6 +236,10 @@ pal_wd_create_info_table(WD_INFO_TABLE *WdTable)
     }
 
     if (Entry->Type == EFI_ACPI_6_1_GTDT_SBSA_GENERIC_WATCHDOG) {
+      if (WdTable->header.num_wd >= MaxEntries) {
+        bsa_print(ACS_PRINT_WARN, L" WD_INFO: Table full at %d entries \n", MaxEntries);
+        break;
+      }
       WdEntry->wd_refresh_base = Entry->RefreshFramePhysicalAddress;
       WdEntry->wd_ctrl_base    = Entry->WatchdogControlFramePhysicalAddress;
       WdEntry->wd_gsiv         = Entry->WatchdogTimerGSIV;
@@ -230,21 +253,40 @@ pal_wd_create_info_table(WD_INFO_TABLE *WdTable)
 
   }
 
-  pal_wd_platform_override(WdTable);
+  pal_wd_platform_override(WdTable, MaxEntries);
 
 }
 
+/**
+  @brief  Return the number of WD_INFO entries pal_wd_create_info_table may
+          fill: at most one per GTDT platform timer structure, plus the override.
+
+  @param  None
+
+  @return Number of entries
+**/
+UINT32
+pal_wd_info_table_entries()
+{
+  gGtdtHdr = (EFI_ACPI_6_1_GENERIC_TIMER_DESCRIPTION_TABLE *) pal_get_gtdt_ptr();
+  if (gGtdtHdr == NULL)
+    return pal_dt_info_table_entries();
+
+  return gGtdtHdr->PlatformTimerCount + 1;
+}
+
 
 /**
   @brief  This API fills in the WD_INFO Table with information about the WDs in the
           system. This is achieved by parsing the DT blob.
 
-  @param  WdTable  - Address where the WD information needs to be filled.
+  @param  WdTable    - Address where the WD information needs to be filled.
+  @param  MaxEntries - Number of WD_INFO_BLOCK entries the table has room for.
 
   @return  None
 **/
 VOID
-pal_wd_create_info_table_dt(WD_INFO_TABLE *WdTable)
+pal_wd_create_info_table_dt(WD_INFO_TABLE *WdTable, UINT32 MaxEntries)
 {
   WD_INFO_BLOCK *WdEntry = NULL;
   UINT64 dt_ptr = 0;
@@ -267,23 +309,23 @@ pal_wd_create_info_table_dt(WD_INFO_TABLE *WdTable)
   }
 
   for (i = 0; i < sizeof(wd_dt_arr)/WD_COMPATIBLE_STR_LEN ; i++) {
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, wd_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, wd_dt_arr[i]);
       if (offset < 0) {
           bsa_print(ACS_PRINT_DEBUG, L" WD node offset not found %d \n", offset);
           continue; /* Search for next compatible wd*/
       }
 
-      parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+      parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
       bsa_print(ACS_PRINT_DEBUG, L" Parent Node offset %d\n", offset);
 
-      size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+      size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
       if (size_cell < 1 || size_cell > 2) {
           bsa_print(ACS_PRINT_ERR, L" Invalid size cell :%d\n", size_cell);
           return;
       }
 
-      addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+      addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
       bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
       if (addr_cell < 1 || addr_cell > 2) {
           bsa_print(ACS_PRINT_ERR, L" Invalid address cell : %d \n", addr_cell);
@@ -292,6 +334,10 @@ pal_wd_create_info_table_dt(WD_INFO_TABLE *WdTable)
 
       while (offset != -FDT_ERR_NOTFOUND) {
           bsa_print(ACS_PRINT_DEBUG, L" WD node:%d offset:%d \n", WdTable->header.num_wd, offset);
+          if (WdTable->header.num_wd >= MaxEntries) {
+              bsa_print(ACS_PRINT_WARN, L" WD_INFO: Table full at %d entries \n", MaxEntries);
+              break;
+          }
 
           Preg_val = (UINT32 *)fdt_getprop_namelen((void *)dt_ptr, offset, "reg", 3, &prop_len);
           if ((prop_len < 0) || (Preg_val == NULL)) {
@@ -374,10 +420,10 @@ pal_wd_create_info_table_dt(WD_INFO_TABLE *WdTable)
           }
           WdEntry->wd_flags = ((wd_polarity << 1) | (wd_mode << 0));
           WdEntry++;
-          offset = fdt_node_offset_by_compatible((const void *)dt_ptr, offset, wd_dt_arr[i]);
+          offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, offset, wd_dt_arr[i]);
       }
   }
-  pal_wd_platform_override(WdTable);
+  pal_wd_platform_override(WdTable, MaxEntries);
   dt_dump_wd_table(WdTable);
 }
 
@@ -429,7 +475,7 @@ pal_timer_create_info_table_dt(TIMER_INFO_TABLE *TimerTable)
 
   /* Search for system timer , either V8 or V7 available*/
   for (i = 0; i < sizeof(systimer_dt_arr)/SYSTIMER_COMPATIBLE_STR_LEN ; i++) {
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, systimer_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, systimer_dt_arr[i]);
       if (offset >= 0)
         break;
   }
@@ -488,7 +534,7 @@ pal_timer_create_info_table_dt(TIMER_INFO_TABLE *TimerTable)
 
   /* Search for mem mapped timers*/
   for (i = 0; i < sizeof(memtimer_dt_arr)/MEMTIMER_COMPATIBLE_STR_LEN ; i++) {
-      offset = fdt_node_offset_by_compatible((const void *)dt_ptr, -1, memtimer_dt_arr[i]);
+      offset = fdt_index_node_offset_by_compatible((const void *)dt_ptr, -1, memtimer_dt_arr[i]);
       if (offset >= 0)
         break;
   }
@@ -498,17 +544,17 @@ pal_timer_create_info_table_dt(TIMER_INFO_TABLE *TimerTable)
   }
 
   /* Get Address_cell & Size_cell length to parse reg property of timer*/
-  parent_offset = fdt_parent_offset((const void *) dt_ptr, offset);
+  parent_offset = fdt_index_parent_offset((const void *) dt_ptr, offset);
   bsa_print(ACS_PRINT_DEBUG, L" Parent Node offset %d\n", offset);
 
-  size_cell = fdt_size_cells((const void *) dt_ptr, parent_offset);
+  size_cell = fdt_index_size_cells((const void *) dt_ptr, parent_offset);
   bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
   if (size_cell < 0) {
       bsa_print(ACS_PRINT_ERR, L" Invalid size cell :%d\n", size_cell);
       return;
   }
 
-  addr_cell = fdt_address_cells((const void *) dt_ptr, parent_offset);
+  addr_cell = fdt_index_address_cells((const void *) dt_ptr, parent_offset);
   bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
   if (addr_cell < 1 || addr_cell > 2) {
       bsa_print(ACS_PRINT_ERR, L" Invalid address cell : %d \n", addr_cell);
@@ -530,14 +576,14 @@ pal_timer_create_info_table_dt(TIMER_INFO_TABLE *TimerTable)
                                 fdt32_to_cpu(Preg[1]);
 
   /* Get Address_cell & Size_cell length to parse reg property of frame*/
-  size_cell = fdt_size_cells((const void *) dt_ptr, offset);
+  size_cell = fdt_index_size_cells((const void *) dt_ptr, offset);
   bsa_print(ACS_PRINT_DEBUG, L" size cell %d\n", size_cell);
   if (size_cell < 0) {
       bsa_print(ACS_PRINT_ERR, L" Invalid size cell for timer node :%d\n", size_cell);
       return;
   }
 
-  addr_cell = fdt_address_cells((const void *) dt_ptr, offset);
+  addr_cell = fdt_index_address_cells((const void *) dt_ptr, offset);
   bsa_print(ACS_PRINT_DEBUG, L" addr cell %d\n", addr_cell);
   if (addr_cell < 1 || addr_cell > 2) {
       bsa_print(ACS_PRINT_ERR, L" Invalid address cell for timer node: %d \n", addr_cell);
@@ -55,6 +55,7 @@ payload (void)
   uint32_t num_cards;
   uint32_t num_smmus;
   uint32_t msi_index = 0;
+  uint64_t count;
 
   index = val_pe_get_index_mpid (val_pe_get_mpid());
 
@@ -115,6 +116,13 @@ payload (void)
         return;
     }
 
+    /* One MSI write must raise the LPI once, the count reads 0 when the PAL owns interrupts */
+    count = val_gic_get_intr_stats(lpi_int_id, GIC_INTR_STATS_COUNT);
+    if (count > 1)
+        val_print(ACS_PRINT_WARN, "\n       MSI delivered %d times", count);
+    val_print(ACS_PRINT_DEBUG, "\n       MSI handler latency %d ticks",
+              val_gic_get_intr_stats(lpi_int_id, GIC_INTR_STATS_LATENCY_MAX));
+
     /* Clear Interrupt and Mappings */
     val_gic_free_msi(e_bdf, lpi_int_id, msi_index);
 
@@ -126,13 +134,10 @@ payload (void)
 }
 
 uint32_t
-os_e004_entry(void)
+os_e004_entry(uint32_t num_pe)
 {
-
   uint32_t status = ACS_STATUS_FAIL;
 
-  uint32_t num_pe = 1;  //This test is run on single processor
-
   status = val_initialize_test(TEST_NUM, TEST_DESC, num_pe);
   if (status != ACS_STATUS_SKIP)
       val_run_test_payload(TEST_NUM, num_pe, payload, 0);
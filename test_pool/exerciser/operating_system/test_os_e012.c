@@ -275,9 +275,8 @@ payload(void)
 }
 
 uint32_t
-os_e012_entry(void)
+os_e012_entry(uint32_t num_pe)
 {
-  uint32_t num_pe = 1;
   uint32_t status = ACS_STATUS_FAIL;
 
   status = val_initialize_test(TEST_NUM, TEST_DESC, num_pe);
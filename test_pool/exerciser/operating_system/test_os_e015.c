@@ -332,9 +332,8 @@ payload(void)
 }
 
 uint32_t
-os_e015_entry(void)
+os_e015_entry(uint32_t num_pe)
 {
-  uint32_t num_pe = 1;
   uint32_t status = ACS_STATUS_FAIL;
 
   status = val_initialize_test(TEST_NUM, TEST_DESC, num_pe);
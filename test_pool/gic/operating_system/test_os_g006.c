@@ -67,7 +67,12 @@ payload()
       val_print(ACS_PRINT_WARN,
           "\n       EL0-Phy timer not mapped to PPI recommended range, INTID: %d   ", intid);
 
-  val_gic_install_isr(intid, isr_phy);
+  if (val_gic_install_isr(intid, isr_phy)) {
+    val_print(ACS_PRINT_ERR,
+        "\n       GIC Install Handler Failed for EL0-Phy timer INTID: %d   ", intid);
+    val_set_status(index, RESULT_FAIL(TEST_NUM, 02));
+    return;
+  }
   val_timer_set_phy_el1(timer_expire_val);
 
   while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
@@ -88,7 +93,12 @@ payload()
       val_print(ACS_PRINT_WARN,
           "\n       EL0-Virtual timer not mapped to PPI recommended range, INTID: %d   ", intid);
 
-  val_gic_install_isr(intid, isr_vir);
+  if (val_gic_install_isr(intid, isr_vir)) {
+    val_print(ACS_PRINT_ERR,
+        "\n       GIC Install Handler Failed for EL0-Virtual timer INTID: %d   ", intid);
+    val_set_status(index, RESULT_FAIL(TEST_NUM, 03));
+    return;
+  }
   val_timer_set_vir_el1(timer_expire_val);
 
   while ((--timeout > 0) && (IS_RESULT_PENDING(val_get_status(index)))) {
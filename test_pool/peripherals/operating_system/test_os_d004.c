@@ -55,6 +55,7 @@ payload(void)
       {
           dma_addr = val_dma_mem_alloc(&buffer, 512, target_dev_index, DMA_COHERENT);
           ret = val_dma_mem_get_attrs(buffer, &attr, &sh);
+          val_dma_mem_free(buffer, dma_addr, 512, target_dev_index, DMA_COHERENT);
           if (ret)
           {
               val_print(ACS_PRINT_ERR, "\n     DMA controller %d: Failed to get"
@@ -72,6 +73,7 @@ payload(void)
       } else {
           dma_addr = val_dma_mem_alloc(&buffer, 512, target_dev_index, DMA_NOT_COHERENT);
           ret = val_dma_mem_get_attrs(buffer, &attr, &sh);
+          val_dma_mem_free(buffer, dma_addr, 512, target_dev_index, DMA_NOT_COHERENT);
           if (ret)
           {
               val_print(ACS_PRINT_ERR, "\n     DMA controller %d: Failed to get"
@@ -119,7 +119,11 @@ wakeup_set_failsafe()
   uint64_t timer_expire_val = TIMEOUT_LARGE * 10;
 
   intid = val_timer_get_info(TIMER_INFO_PHY_EL1_INTID, 0);
-  val_gic_install_isr(intid, isr_failsafe);
+  /* Without a handler the failsafe would fire as an unregistered interrupt */
+  if (val_gic_install_isr(intid, isr_failsafe)) {
+      val_print(ACS_PRINT_WARN, "\n       GIC Install Handler Failed for failsafe timer", 0);
+      return;
+  }
   val_timer_set_phy_el1(timer_expire_val);
 }
 
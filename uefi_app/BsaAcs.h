@@ -29,14 +29,27 @@
   #define G_SW_HYP           1
   #define G_SW_PS            2
 
-  #define PE_INFO_TBL_SZ         8192 /*Supports maximum 400 PEs*/
-  #define GIC_INFO_TBL_SZ        8192 /*Supports maximum 256 redistributors, 256 ITS blocks & 4 distributors*/
-  #define TIMER_INFO_TBL_SZ      1024 /*Supports maximum 2 system timers*/
-  #define WD_INFO_TBL_SZ         512  /*Supports maximum 20 Watchdogs*/
-  #define MEM_INFO_TBL_SZ        4096 /*Supports maximum 110 memory regions*/
-  #define IOVIRT_INFO_TBL_SZ     32768/*Supports maximum 240 nodes of a typical iort table*/
-  #define PERIPHERAL_INFO_TBL_SZ 1024 /*Supports maximum 20 PCIe EPs (USB and SATA controllers only) */
-  #define PCIE_INFO_TBL_SZ       512  /*Supports maximum 20 RC's*/
+  /* Info tables are sized at runtime from the entry counts the PAL reports */
+  #define INFO_FOOTPRINT_MAX     10
+
+  typedef struct {
+    CONST CHAR16  *Name;
+    UINT32        Size;               /* bytes allocated */
+  } INFO_TABLE_FOOTPRINT;
+
+  #define INFO_SNAPSHOT_SIGNATURE  SIGNATURE_32('B', 'S', 'A', 'I')
+  #define INFO_SNAPSHOT_REVISION   ((BSA_ACS_MAJOR_VER << 16) | (BSA_ACS_MINOR_VER << 8) | 3)
+
+  /* File layout: this header, then each present info table in INFO_TABLE_e order */
+  typedef struct {
+    UINT32  Signature;
+    UINT32  Revision;
+    UINT64  FwChecksum;                 /* val_get_fw_table_checksum() when saved */
+    UINT32  NumTables;
+    UINT32  DataCrc;                    /* CRC32 of the tables following the header */
+    UINT32  Present;                    /* (1 << INFO_TABLE_e) of the tables built when saved */
+    UINT32  TableSize[INFO_TABLE_MAX];
+  } INFO_TABLE_SNAPSHOT_HEADER;
 
   #ifdef _AARCH64_BUILD_
   unsigned long __stack_chk_guard = 0xBAAAAAAD;
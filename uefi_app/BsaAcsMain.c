@@ -26,13 +26,14 @@
 #include "val/include/val_interface.h"
 #include "val/include/bsa_acs_pe.h"
 #include "val/include/bsa_acs_val.h"
+#include "val/include/bsa_acs_pcie.h"
 
 #include "BsaAcs.h"
 
 
 UINT32  g_print_level;
 UINT32  g_sw_view[3] = {1, 1, 1}; //Operating System, Hypervisor, Platform Security
-UINT32  g_skip_test_num[9] = {10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000, 10000};
+UINT32  g_skip_test_num[MAX_TEST_SKIP_NUM] = {10000};
 UINT32  g_bsa_tests_total;
 UINT32  g_bsa_tests_pass;
 UINT32  g_bsa_tests_fail;
@@ -41,6 +42,13 @@ UINT64  g_exception_ret_addr;
 UINT64  g_ret_addr;
 SHELL_FILE_HANDLE g_bsa_log_file_handle;
 
+STATIC CONST CHAR16  *gSnapshotFile;
+STATIC UINT8         *gSnapshotData;    /* Tables of a validated snapshot, NULL when discovering */
+STATIC VOID          *gInfoTable[INFO_TABLE_MAX];
+STATIC UINT32        gInfoTableSize[INFO_TABLE_MAX];
+STATIC INFO_TABLE_FOOTPRINT  gFootprint[INFO_FOOTPRINT_MAX];
+STATIC UINT32        gNumFootprint;
+
 STATIC VOID FlushImage (VOID)
 {
   EFI_LOADED_IMAGE_PROTOCOL   *ImageInfo;
@@ -55,19 +63,212 @@ STATIC VOID FlushImage (VOID)
 
 }
 
+/**
+  Read the info table snapshot and keep its tables if it was produced by this
+  build from the same firmware tables. Any mismatch falls back to discovery.
+**/
 EFI_STATUS
-createPeInfoTable (
-)
+loadInfoTableSnapshot (
+  UINT64 FwChecksum
+  )
 {
+  SHELL_FILE_HANDLE           Handle;
+  INFO_TABLE_SNAPSHOT_HEADER  Header;
+  EFI_STATUS                  Status;
+  UINTN                       Size;
+  UINTN                       DataSize;
+  UINT32                      Crc;
+  UINT32                      Index;
+  UINT8                       *Data;
+
+  Status = ShellOpenFileByName(gSnapshotFile, &Handle, EFI_FILE_MODE_READ, 0x0);
+  if (EFI_ERROR(Status))
+    return Status;
 
-  EFI_STATUS Status;
+  Size = sizeof(Header);
+  Status = ShellReadFile(Handle, &Size, &Header);
+  if (EFI_ERROR(Status) || (Size != sizeof(Header)) ||
+      (Header.Signature != INFO_SNAPSHOT_SIGNATURE) ||
+      (Header.Revision != INFO_SNAPSHOT_REVISION) ||
+      (Header.NumTables != INFO_TABLE_MAX) ||
+      (Header.FwChecksum != FwChecksum)) {
+    Status = EFI_INCOMPATIBLE_VERSION;
+    goto close_file;
+  }
 
-  UINT64   *PeInfoTable;
+  /* Table sizes follow the platform; only the BDF table has a fixed size */
+  if ((Header.Present & (1 << INFO_TABLE_PCIE_BDF)) &&
+      (Header.TableSize[INFO_TABLE_PCIE_BDF] != PCIE_DEVICE_BDF_TABLE_SZ)) {
+    Status = EFI_INCOMPATIBLE_VERSION;
+    goto close_file;
+  }
 
-/* allowing room for growth, at present each entry is 16 bytes, so we can support upto 511 PEs with 8192 bytes*/
-  Status = gBS->AllocatePool ( EfiBootServicesData,
-                               PE_INFO_TBL_SZ,
-                               (VOID **) &PeInfoTable );
+  /* A table that was not built when saving has no data and is discovered again */
+  DataSize = 0;
+  for (Index = 0; Index < INFO_TABLE_MAX; Index++) {
+    if (!(Header.Present & (1 << Index)))
+      Header.TableSize[Index] = 0;
+    DataSize += Header.TableSize[Index];
+  }
+
+  Status = gBS->AllocatePool(EfiBootServicesData, DataSize, (VOID **) &Data);
+  if (EFI_ERROR(Status))
+    goto close_file;
+
+  Size = DataSize;
+  Status = ShellReadFile(Handle, &Size, Data);
+  if (!EFI_ERROR(Status) && (Size == DataSize))
+    Status = gBS->CalculateCrc32(Data, DataSize, &Crc);
+  else
+    Status = EFI_END_OF_FILE;
+
+  if (EFI_ERROR(Status) || (Crc != Header.DataCrc)) {
+    gBS->FreePool(Data);
+    Status = EFI_CRC_ERROR;
+    goto close_file;
+  }
+
+  gSnapshotData = Data;
+  CopyMem(gInfoTableSize, Header.TableSize, sizeof(gInfoTableSize));
+  val_info_table_set_restored(Header.Present & ((1 << INFO_TABLE_MAX) - 1));
+
+close_file:
+  ShellCloseFile(&Handle);
+  return Status;
+}
+
+/**
+  Write the discovered info tables to the snapshot file, replacing any stale copy.
+**/
+EFI_STATUS
+saveInfoTableSnapshot (
+  UINT64 FwChecksum
+  )
+{
+  SHELL_FILE_HANDLE           Handle;
+  INFO_TABLE_SNAPSHOT_HEADER  Header;
+  EFI_STATUS                  Status;
+  UINTN                       Size;
+  UINTN                       DataSize;
+  UINT32                      Index;
+  UINT8                       *Data;
+
+  /* Tables that were not built in this run, e.g. after an allocation failure, are left out */
+  DataSize = 0;
+  Header.Present = 0;
+  for (Index = 0; Index < INFO_TABLE_MAX; Index++) {
+    Header.TableSize[Index] = gInfoTable[Index] ? gInfoTableSize[Index] : 0;
+    if (gInfoTable[Index])
+      Header.Present |= (1 << Index);
+    DataSize += Header.TableSize[Index];
+  }
+
+  Status = gBS->AllocatePool(EfiBootServicesData, DataSize, (VOID **) &Data);
+  if (EFI_ERROR(Status))
+    return Status;
+
+  for (Size = 0, Index = 0; Index < INFO_TABLE_MAX; Size += Header.TableSize[Index++]) {
+    if (gInfoTable[Index])
+      CopyMem(Data + Size, gInfoTable[Index], Header.TableSize[Index]);
+  }
+
+  Header.Signature  = INFO_SNAPSHOT_SIGNATURE;
+  Header.Revision   = INFO_SNAPSHOT_REVISION;
+  Header.FwChecksum = FwChecksum;
+  Header.NumTables  = INFO_TABLE_MAX;
+  gBS->CalculateCrc32(Data, DataSize, &Header.DataCrc);
+
+  if (!EFI_ERROR(ShellOpenFileByName(gSnapshotFile, &Handle, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0x0)))
+    ShellDeleteFile(&Handle);
+
+  Status = ShellOpenFileByName(gSnapshotFile, &Handle,
+             EFI_FILE_MODE_WRITE | EFI_FILE_MODE_READ | EFI_FILE_MODE_CREATE, 0x0);
+  if (!EFI_ERROR(Status)) {
+    Size = sizeof(Header);
+    Status = ShellWriteFile(Handle, &Size, &Header);
+    if (!EFI_ERROR(Status)) {
+      Size = DataSize;
+      Status = ShellWriteFile(Handle, &Size, Data);
+    }
+    ShellCloseFile(&Handle);
+  }
+
+  gBS->FreePool(Data);
+  return Status;
+}
+
+/**
+  Remember where an info table lives and, when a snapshot was loaded, fill it
+  from the snapshot so the VAL adopts it without asking the PAL.
+**/
+VOID
+restoreInfoTable (
+  INFO_TABLE_e  Table,
+  VOID          *Buffer
+  )
+{
+  UINTN  Offset;
+  UINT32 Index;
+
+  gInfoTable[Table] = Buffer;
+  if ((gSnapshotData == NULL) || !val_info_table_is_restored(Table))
+    return;
+
+  for (Offset = 0, Index = 0; Index < Table; Index++)
+    Offset += gInfoTableSize[Index];
+
+  CopyMem(Buffer, gSnapshotData + Offset, gInfoTableSize[Table]);
+}
+
+/**
+  Check whether every info table built in this run came from the snapshot.
+**/
+BOOLEAN
+snapshotIsCurrent (
+  VOID
+  )
+{
+  UINT32 Index;
+
+  for (Index = 0; Index < INFO_TABLE_MAX; Index++) {
+    if (gInfoTable[Index] && !val_info_table_is_restored(Index))
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Size of a snapshot-backed info table: taken from the snapshot when one was
+  loaded, otherwise from the entry count the PAL reports through the VAL.
+**/
+UINT32
+infoTableSize (
+  INFO_TABLE_e  Table,
+  UINT32        (*GetSize)(VOID)
+  )
+{
+  if ((gSnapshotData == NULL) || !val_info_table_is_restored(Table))
+    gInfoTableSize[Table] = GetSize();
+
+  return gInfoTableSize[Table];
+}
+
+/**
+  Allocate an info table and record its size for the startup summary.
+**/
+EFI_STATUS
+allocateInfoTable (
+  CONST CHAR16  *Name,
+  UINT32        Size,
+  UINT64        **Table
+  )
+{
+  EFI_STATUS Status;
+
+  Status = gBS->AllocatePool (EfiBootServicesData,
+                              Size,
+                              (VOID **) Table);
 
   if (EFI_ERROR(Status))
   {
@@ -75,6 +276,42 @@ createPeInfoTable (
     return Status;
   }
 
+  if (gNumFootprint < INFO_FOOTPRINT_MAX) {
+    gFootprint[gNumFootprint].Name = Name;
+    gFootprint[gNumFootprint++].Size = Size;
+  }
+
+  return Status;
+}
+
+VOID
+printInfoTableFootprint (
+  VOID
+  )
+{
+  UINT32 Index;
+  UINT32 Total = 0;
+
+  for (Index = 0; Index < gNumFootprint; Index++) {
+    Print(L"  %-10s info table: %6d bytes \n", gFootprint[Index].Name, gFootprint[Index].Size);
+    Total += gFootprint[Index].Size;
+  }
+  Print(L"  Total info tables   : %6d bytes \n", Total);
+}
+
+EFI_STATUS
+createPeInfoTable (
+)
+{
+
+  EFI_STATUS Status;
+
+  UINT64   *PeInfoTable;
+
+  Status = allocateInfoTable(L"PE", val_pe_get_info_table_size(), &PeInfoTable);
+  if (EFI_ERROR(Status))
+    return Status;
+
   Status = val_pe_create_info_table(PeInfoTable);
 
   return Status;
@@ -88,15 +325,9 @@ createGicInfoTable (
   EFI_STATUS Status;
   UINT64     *GicInfoTable;
 
-  Status = gBS->AllocatePool (EfiBootServicesData,
-                               GIC_INFO_TBL_SZ,
-                               (VOID **) &GicInfoTable);
-
+  Status = allocateInfoTable(L"GIC", val_gic_get_info_table_size(), &GicInfoTable);
   if (EFI_ERROR(Status))
-  {
-    Print(L"Allocate Pool failed %x \n", Status);
     return Status;
-  }
 
   Status = val_gic_create_info_table(GicInfoTable);
 
@@ -122,15 +353,10 @@ createTimerInfoTable(
   UINT64   *TimerInfoTable;
   EFI_STATUS Status;
 
-  Status = gBS->AllocatePool (EfiBootServicesData,
-                              TIMER_INFO_TBL_SZ,
-                              (VOID **) &TimerInfoTable);
-
+  Status = allocateInfoTable(L"Timer", infoTableSize(INFO_TABLE_TIMER, val_timer_get_info_table_size), &TimerInfoTable);
   if (EFI_ERROR(Status))
-  {
-    Print(L"Allocate Pool failed %x \n", Status);
     return Status;
-  }
+  restoreInfoTable(INFO_TABLE_TIMER, TimerInfoTable);
   val_timer_create_info_table(TimerInfoTable);
 
   return Status;
@@ -143,15 +369,10 @@ createWatchdogInfoTable(
   UINT64   *WdInfoTable;
   EFI_STATUS Status;
 
-  Status = gBS->AllocatePool (EfiBootServicesData,
-                              WD_INFO_TBL_SZ,
-                              (VOID **) &WdInfoTable);
-
+  Status = allocateInfoTable(L"Watchdog", infoTableSize(INFO_TABLE_WD, val_wd_get_info_table_size), &WdInfoTable);
   if (EFI_ERROR(Status))
-  {
-    Print(L"Allocate Pool failed %x \n", Status);
     return Status;
-  }
+  restoreInfoTable(INFO_TABLE_WD, WdInfoTable);
   val_wd_create_info_table(WdInfoTable);
 
   return Status;
@@ -165,29 +386,34 @@ createPcieVirtInfoTable(
 {
   UINT64   *PcieInfoTable;
   UINT64   *IoVirtInfoTable;
+  UINT64   *PcieBdfTable;
 
   EFI_STATUS Status;
 
-  Status = gBS->AllocatePool (EfiBootServicesData,
-                              PCIE_INFO_TBL_SZ,
-                              (VOID **) &PcieInfoTable);
-
+  Status = allocateInfoTable(L"PCIe", infoTableSize(INFO_TABLE_PCIE, val_pcie_get_info_table_size), &PcieInfoTable);
   if (EFI_ERROR(Status))
-  {
-    Print(L"Allocate Pool failed %x \n", Status);
     return Status;
+  restoreInfoTable(INFO_TABLE_PCIE, PcieInfoTable);
+
+  /* val_pcie_create_info_table reads back the device IDs of a restored BDF
+     table and enumerates again if they differ */
+  if (gSnapshotData && val_info_table_is_restored(INFO_TABLE_PCIE_BDF)) {
+    Status = allocateInfoTable(L"PCIe BDF", gInfoTableSize[INFO_TABLE_PCIE_BDF], &PcieBdfTable);
+    if (EFI_ERROR(Status))
+      return Status;
+    restoreInfoTable(INFO_TABLE_PCIE_BDF, PcieBdfTable);
+    val_pcie_set_bdf_table(PcieBdfTable);
   }
   val_pcie_create_info_table(PcieInfoTable);
 
-  Status = gBS->AllocatePool (EfiBootServicesData,
-                              IOVIRT_INFO_TBL_SZ,
-                              (VOID **) &IoVirtInfoTable);
+  /* The VAL builds the BDF table itself when none was restored or it was dropped */
+  gInfoTable[INFO_TABLE_PCIE_BDF] = val_pcie_bdf_table_ptr();
+  gInfoTableSize[INFO_TABLE_PCIE_BDF] = PCIE_DEVICE_BDF_TABLE_SZ;
 
+  Status = allocateInfoTable(L"IOVIRT", infoTableSize(INFO_TABLE_IOVIRT, val_iovirt_get_info_table_size), &IoVirtInfoTable);
   if (EFI_ERROR(Status))
-  {
-    Print(L"Allocate Pool failed %x \n", Status);
     return Status;
-  }
+  restoreInfoTable(INFO_TABLE_IOVIRT, IoVirtInfoTable);
   val_iovirt_create_info_table(IoVirtInfoTable);
 
   return Status;
@@ -202,32 +428,82 @@ createPeripheralInfoTable(
 
   EFI_STATUS Status;
 
-  Status = gBS->AllocatePool (EfiBootServicesData,
-                              PERIPHERAL_INFO_TBL_SZ,
-                              (VOID **) &PeripheralInfoTable);
+  /* USB and SATA controllers are PCIe devices, so the peripheral table is
+     only restored along with a BDF table that matched the devices present */
+  if (!val_info_table_is_restored(INFO_TABLE_PCIE_BDF))
+    val_info_table_discard(INFO_TABLE_PERIPHERAL);
 
+  Status = allocateInfoTable(L"Peripheral", infoTableSize(INFO_TABLE_PERIPHERAL, val_peripheral_get_info_table_size), &PeripheralInfoTable);
   if (EFI_ERROR(Status))
-  {
-    Print(L"Allocate Pool failed %x \n", Status);
     return Status;
-  }
+  restoreInfoTable(INFO_TABLE_PERIPHERAL, PeripheralInfoTable);
   val_peripheral_create_info_table(PeripheralInfoTable);
 
-  Status = gBS->AllocatePool (EfiBootServicesData,
-                              MEM_INFO_TBL_SZ,
-                              (VOID **) &MemoryInfoTable);
-
+  Status = allocateInfoTable(L"Memory", val_memory_get_info_table_size(), &MemoryInfoTable);
   if (EFI_ERROR(Status))
-  {
-    Print(L"Allocate Pool failed %x \n", Status);
     return Status;
-  }
 
   val_memory_create_info_table(MemoryInfoTable);
 
   return Status;
 }
 
+/* The watchdog tests and their banner only run when there is a watchdog */
+STATIC UINT32
+runWatchdogTests (
+  UINT32 NumPe,
+  UINT32 *SwView
+  )
+{
+  if (!val_wd_get_info(0, WD_INFO_COUNT))
+    return ACS_STATUS_SKIP;
+
+  val_print(ACS_PRINT_TEST, "\n      *** Starting Watchdog tests ***  ", 0);
+  return val_wd_execute_tests(NumPe, SwView);
+}
+
+/*
+ * Configure Gic Redistributor and ITS to support
+ * Generation of LPIs, used by the GIC and exerciser MSI tests.
+ * Runs after the PE and memory tests.
+ */
+STATIC UINT32
+runGicItsConfiguration (
+  UINT32 NumPe,
+  UINT32 *SwView
+  )
+{
+  if (val_test_module_is_selected(ACS_GIC_TEST_NUM_BASE) ||
+      val_test_module_is_selected(ACS_EXERCISER_TEST_NUM_BASE))
+    configureGicIts();
+
+  return ACS_STATUS_PASS;
+}
+
+STATIC UINT32
+runExerciserTests (
+  UINT32 NumPe,
+  UINT32 *SwView
+  )
+{
+  return val_exerciser_execute_tests(SwView);
+}
+
+/* Modules in run order */
+STATIC CONST TEST_MODULE gModules[] = {
+  {"\n      ***  Starting PE tests ***  ", val_pe_execute_tests},
+  {"\n      ***  Starting Memory Map tests ***  ", val_memory_execute_tests},
+  {NULL, runGicItsConfiguration},
+  {"\n      ***  Starting GIC tests ***  ", val_gic_execute_tests},
+  {"\n      *** Starting System MMU tests ***  ", val_smmu_execute_tests},
+  {"\n      *** Starting Timer tests ***  ", val_timer_execute_tests},
+  {"\n      *** Starting Power and Wakeup semantic tests ***  ", val_wakeup_execute_tests},
+  {"\n      *** Starting Peripheral tests ***  ", val_peripheral_execute_tests},
+  {NULL, runWatchdogTests},
+  {"\n      *** Starting PCIe tests ***  ", val_pcie_execute_tests},
+  {"\n      *** Starting PCIe Exerciser tests ***  ", runExerciserTests},
+};
+
 VOID
 freeBsaAcsMem()
 {
@@ -242,12 +518,56 @@ freeBsaAcsMem()
   val_free_shared_mem();
 }
 
+/**
+  Add a comma separated list of test numbers, ranges such as 801-805 and
+  module IDs such as 300 to the test selection. There is no limit on the
+  number of entries.
+**/
+EFI_STATUS
+parseTestList (
+  CONST CHAR16  *List,
+  UINT32        Exclude
+  )
+{
+  CONST CHAR16  *Pos = List;
+  UINTN         Start;
+  UINTN         End;
+
+  while (*Pos != L'\0') {
+    if ((*Pos < L'0') || (*Pos > L'9'))
+      return EFI_INVALID_PARAMETER;
+    Start = StrDecimalToUintn(Pos);
+    while ((*Pos >= L'0') && (*Pos <= L'9'))
+      Pos++;
+
+    End = Start;
+    if (*Pos == L'-') {
+      Pos++;
+      if ((*Pos < L'0') || (*Pos > L'9'))
+        return EFI_INVALID_PARAMETER;
+      End = StrDecimalToUintn(Pos);
+      while ((*Pos >= L'0') && (*Pos <= L'9'))
+        Pos++;
+    }
+
+    if (*Pos == L',')
+      Pos++;
+    else if (*Pos != L'\0')
+      return EFI_INVALID_PARAMETER;
+
+    if (val_test_select_add((UINT32)Start, (UINT32)End, Exclude))
+      return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
 VOID
 HelpMsg (
   VOID
   )
 {
-  Print (L"\nUsage: Bsa.efi [-v <n>] | [-f <filename>] | [-skip <n>]\n"
+  Print (L"\nUsage: Bsa.efi [-v <n>] | [-f <filename>] | [-skip <n>] | [-t <n>] | [-snapshot <filename>]\n"
          "Options:\n"
          "-v      Verbosity of the Prints\n"
          "        1 shows all prints, 5 shows Errors\n"
@@ -256,9 +576,13 @@ HelpMsg (
          "        Refer to section 4 of BSA_ACS_User_Guide\n"
          "        To skip a module, use Model_ID as mentioned in user guide\n"
          "        To skip a particular test within a module, use the exact testcase number\n"
+         "        Ranges are accepted, e.g. -skip 300,801-805\n"
+         "-t      Test(s) to run, all others are skipped, in the same format as -skip\n"
          "-os     Enable the execution of operating system tests\n"
          "-hyp    Enable the execution of hypervisor tests\n"
          "-ps     Enable the execution of platform security tests\n"
+         "-snapshot  File to save the platform info tables to, and to reload\n"
+         "        them from on later runs while the firmware tables are unchanged\n"
   );
 }
 
@@ -266,11 +590,13 @@ STATIC CONST SHELL_PARAM_ITEM ParamList[] = {
   {L"-v"    , TypeValue},    // -v    # Verbosity of the Prints. 1 shows all prints, 5 shows Errors
   {L"-f"    , TypeValue},    // -f    # Name of the log file to record the test results in.
   {L"-skip" , TypeValue},    // -skip # test(s) to skip execution
+  {L"-t"    , TypeValue},    // -t    # test(s) to run, all others are skipped
   {L"-help" , TypeFlag},     // -help # help : info about commands
   {L"-h"    , TypeFlag},     // -h    # help : info about commands
   {L"-os"   , TypeFlag},     // -os   # Binary Flag to enable the execution of operating system tests.
   {L"-hyp"  , TypeFlag},     // -hyp  # Binary Flag to enable the execution of hypervisor tests.
   {L"-ps"   , TypeFlag},     // -ps   # Binary Flag to enable the execution of platform security tests.
+  {L"-snapshot", TypeValue}, // -snapshot # File to save/restore the platform info tables.
   {NULL     , TypeMax}
   };
 
@@ -294,7 +620,7 @@ ShellAppMain (
   CONST CHAR16       *CmdLineArg;
   CHAR16             *ProbParam;
   UINT32             Status;
-  UINT32             i,j=0;
+  UINT64             FwChecksum = 0;
   VOID               *branch_label;
 
 
@@ -311,13 +637,21 @@ ShellAppMain (
   }
 
   // Options with Values
+  if (ShellCommandLineGetFlag (ParamPackage, L"-t")) {
+      CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-t");
+      if ((CmdLineArg == NULL) || EFI_ERROR(parseTestList(CmdLineArg, 0))) {
+          Print(L"Invalid test list passed to -t\n");
+          HelpMsg();
+          return SHELL_INVALID_PARAMETER;
+      }
+  }
+
   if (ShellCommandLineGetFlag (ParamPackage, L"-skip")) {
       CmdLineArg  = ShellCommandLineGetValue (ParamPackage, L"-skip");
-      for (i=0 ; i < StrLen(CmdLineArg) ; i++){
-        g_skip_test_num[0] = StrDecimalToUintn((CONST CHAR16 *)(CmdLineArg+0));
-          if(*(CmdLineArg+i) == L','){
-              g_skip_test_num[++j] = StrDecimalToUintn((CONST CHAR16 *)(CmdLineArg+i+1));
-          }
+      if ((CmdLineArg == NULL) || EFI_ERROR(parseTestList(CmdLineArg, 1))) {
+          Print(L"Invalid test list passed to -skip\n");
+          HelpMsg();
+          return SHELL_INVALID_PARAMETER;
       }
   }
 
@@ -364,6 +698,9 @@ ShellAppMain (
   }
 
 
+  // Options with Values
+  gSnapshotFile = ShellCommandLineGetValue (ParamPackage, L"-snapshot");
+
   // Options with Flags
   if ((ShellCommandLineGetFlag (ParamPackage, L"-help")) || (ShellCommandLineGetFlag (ParamPackage, L"-h"))){
      HelpMsg();
@@ -398,52 +735,39 @@ ShellAppMain (
   val_pe_context_save(AA64ReadSp(), (uint64_t)branch_label);
   val_pe_initialize_default_exception_handler(val_pe_default_esr);
 
+  /* PE, GIC and memory tables are always discovered, as the PAL keeps
+     state from them and the memory map changes between boots. The firmware
+     table checksum does not cover the PCIe devices, so their tables are
+     checked against the devices present when restored */
+  if (gSnapshotFile) {
+    FwChecksum = val_get_fw_table_checksum();
+    if (FwChecksum && !EFI_ERROR(loadInfoTableSnapshot(FwChecksum)))
+      Print(L" Platform information restored from %s \n", gSnapshotFile);
+  }
+
   createTimerInfoTable();
   createWatchdogInfoTable();
   createPcieVirtInfoTable();
   createPeripheralInfoTable();
 
-  val_allocate_shared_mem();
-
-  FlushImage();
-
-  Print(L"\n      ***  Starting PE tests ***  ");
-  Status = val_pe_execute_tests(val_pe_get_num(), g_sw_view);
-
-  Print(L"\n      ***  Starting Memory Map tests ***  ");
-  val_memory_execute_tests(val_pe_get_num(), g_sw_view);
-
-  /*
-   * Configure Gic Redistributor and ITS to support
-   * Generation of LPIs.
-  */
-  configureGicIts();
-
-  Print(L"\n      ***  Starting GIC tests ***  ");
-  Status |= val_gic_execute_tests(val_pe_get_num(), g_sw_view);
-
-  Print(L"\n      *** Starting System MMU tests ***  ");
-  Status |= val_smmu_execute_tests(val_pe_get_num(), g_sw_view);
-
-  Print(L"\n      *** Starting Timer tests ***  ");
-  Status |= val_timer_execute_tests(val_pe_get_num(), g_sw_view);
-
-  Print(L"\n      *** Starting Power and Wakeup semantic tests ***  ");
-  Status |= val_wakeup_execute_tests(val_pe_get_num(), g_sw_view);
+  /* Save when a table was discovered in this run, e.g. after the PCIe devices changed */
+  if (gSnapshotFile && FwChecksum && !snapshotIsCurrent()) {
+    if (EFI_ERROR(saveInfoTableSnapshot(FwChecksum)))
+      Print(L" Failed to save platform information to %s \n", gSnapshotFile);
+  }
+  if (gSnapshotData) {
+    gBS->FreePool(gSnapshotData);
+    gSnapshotData = NULL;
+  }
 
-  Print(L"\n      *** Starting Peripheral tests ***  ");
-  Status |= val_peripheral_execute_tests(val_pe_get_num(), g_sw_view);
+  val_startup_report();
+  printInfoTableFootprint();
 
-  if (val_wd_get_info(0, WD_INFO_COUNT)) {
-      Print(L"\n      *** Starting Watchdog tests ***  ");
-      Status |= val_wd_execute_tests(val_pe_get_num(), g_sw_view);
-  }
+  val_allocate_shared_mem();
 
-  Print(L"\n      *** Starting PCIe tests ***  ");
-  Status |= val_pcie_execute_tests(val_pe_get_num(), g_sw_view);
+  FlushImage();
 
-  Print(L"\n      *** Starting PCIe Exerciser tests ***  ");
-  Status |= val_exerciser_execute_tests(g_sw_view);
+  Status = val_run_modules(gModules, sizeof(gModules) / sizeof(gModules[0]), g_sw_view);
 
 print_test_status:
   val_print(ACS_PRINT_TEST, "\n     ------------------------------------------------------- \n", 0);
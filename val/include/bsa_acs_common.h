@@ -44,6 +44,40 @@
 #define ACS_WD_TEST_NUM_BASE         700
 #define ACS_PCIE_TEST_NUM_BASE       800
 #define ACS_EXERCISER_TEST_NUM_BASE  900
+
+/* Test registry: each module lists its tests as TEST_DESC entries and runs
+   them through val_run_test_list */
+#define TEST_VIEW_OS    (1 << G_SW_OS)
+#define TEST_VIEW_HYP   (1 << G_SW_HYP)
+#define TEST_VIEW_PS    (1 << G_SW_PS)
+
+/* Relative run time, val_test_select_order runs cheaper tests first */
+#define TEST_COST_LOW   0      /* register and table checks */
+#define TEST_COST_MID   1      /* walks every PCIe function or memory region */
+#define TEST_COST_HIGH  2      /* waits on timers, interrupts or DMA */
+#define TEST_COST_MAX   TEST_COST_HIGH
+
+/* Resources a test needs, a test whose resources are missing is not run */
+#define TEST_NEEDS_PCIE_DEV   0x1   /* functions in the PCIe BDF table */
+#define TEST_NEEDS_SMMU       0x2
+#define TEST_NEEDS_EXERCISER  0x4
+
+#define TEST_FLAG_ONE_PE      0x1   /* runs on the primary PE alone */
+#define TEST_FLAG_GATE        0x2   /* the rest of the module is skipped unless it passes,
+                                       listed ahead of the other tests */
+
+typedef struct {
+  uint32_t  test_num;          /* first test number the entry reports */
+  uint32_t  num_tests;         /* consecutive test numbers it reports */
+  uint32_t  (*entry)(uint32_t num_pe);
+  uint8_t   view;              /* TEST_VIEW_* the test belongs to */
+  uint8_t   cost;              /* TEST_COST_* */
+  uint16_t  needs;             /* TEST_NEEDS_* */
+  uint32_t  flags;             /* TEST_FLAG_* */
+} TEST_DESC;
+
+#define TEST_LIST_NUM(list)  (sizeof(list) / sizeof((list)[0]))
+
 #define STATE_BIT   28
 #define STATE_MASK 0xF
 
@@ -124,6 +158,10 @@ val_check_for_error(uint32_t test_num, uint32_t num_pe);
 void
 val_run_test_payload(uint32_t test_num, uint32_t num_pe, void (*payload)(void), uint64_t test_input);
 
+uint32_t
+val_run_test_list(const TEST_DESC *list, uint32_t num, uint32_t num_pe, uint32_t *g_sw_view,
+  uint32_t resources);
+
 void
 val_data_cache_ops_by_va(addr_t addr, uint32_t type);
 
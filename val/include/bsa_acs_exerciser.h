@@ -52,12 +52,12 @@ uint32_t val_exerciser_get_data(EXERCISER_DATA_TYPE type, exerciser_data_t *data
 uint32_t val_exerciser_execute_tests(uint32_t *g_sw_view);
 uint32_t val_exerciser_get_bdf(uint32_t instance);
 
-uint32_t os_e001_entry(void);
-uint32_t os_e004_entry(void);
-uint32_t os_e005_entry(void);
-uint32_t os_e006_entry(void);
-uint32_t os_e012_entry(void);
-uint32_t os_e013_entry(void);
-uint32_t os_e015_entry(void);
+uint32_t os_e001_entry(uint32_t num_pe);
+uint32_t os_e004_entry(uint32_t num_pe);
+uint32_t os_e005_entry(uint32_t num_pe);
+uint32_t os_e006_entry(uint32_t num_pe);
+uint32_t os_e012_entry(uint32_t num_pe);
+uint32_t os_e013_entry(uint32_t num_pe);
+uint32_t os_e015_entry(uint32_t num_pe);
 
 #endif
@@ -0,0 +1,154 @@
+/** @file
+ * Copyright (c) 2021, Arm Limited or its affiliates. All rights reserved.
+ * SPDX-License-Identifier : Apache-2.0
+
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ **/
+
+#ifndef __BSA_ACS_MSG_RING_H__
+#define __BSA_ACS_MSG_RING_H__
+
+/*
+ * Message ring shared between the BSA kernel module (single producer) and the
+ * Linux app (single consumer). The module exposes it by mmap of /proc/bsa_msg.
+ * Records are variable length, 8-byte aligned, and never straddle the end of
+ * the data area: a producer that would wrap writes a pad record instead.
+ * Head and tail are free-running byte counts; each side only writes its own.
+ */
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/string.h>
+#else
+#include <stdint.h>
+#include <string.h>
+#endif
+
+#define BSA_MSG_RING_MAGIC      0x52415342      /* "BSAR" */
+#define BSA_MSG_RING_VERSION    1
+#define BSA_MSG_RING_DATA_SIZE  (256 * 1024)    /* power of two */
+#define BSA_MSG_RING_MAP_SIZE   (sizeof(bsa_msg_ring_t) + BSA_MSG_RING_DATA_SIZE)
+#define BSA_MSG_MAX_LEN         1024            /* longest string, NUL included */
+
+#define BSA_MSG_LEVEL_PAD       0xFFFFFFFF      /* skip to the start of the data area */
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;            /* data area bytes */
+  uint32_t dropped;         /* records the producer found no room for */
+  uint64_t head;            /* written by the producer only */
+  uint8_t  pad0[40];        /* head and tail on separate cache lines */
+  uint64_t tail;            /* written by the consumer only */
+  uint8_t  pad1[56];
+  uint8_t  data[];
+} bsa_msg_ring_t;
+
+typedef struct {
+  uint32_t len;             /* whole record, header included, 8-byte aligned */
+  uint32_t level;           /* ACS_PRINT_* level, or BSA_MSG_LEVEL_PAD */
+  uint64_t timestamp;       /* producer clock, ns */
+  uint64_t data;            /* argument the message was printed with */
+  char     string[];        /* formatted message, NUL terminated */
+} bsa_msg_rec_t;
+
+#define BSA_MSG_REC_ALIGN(n)    (((n) + 7) & ~7u)
+
+static inline void
+bsa_msg_ring_init(bsa_msg_ring_t *ring, uint32_t size)
+{
+  memset(ring, 0, sizeof(*ring));
+  ring->size = size;
+  ring->version = BSA_MSG_RING_VERSION;
+  __atomic_store_n(&ring->magic, BSA_MSG_RING_MAGIC, __ATOMIC_RELEASE);
+}
+
+/**
+  @brief  Append one message. Never blocks: a full ring counts the record as dropped.
+  @return 0 if the record was queued, 1 if it was dropped
+**/
+static inline uint32_t
+bsa_msg_ring_put(bsa_msg_ring_t *ring, uint32_t level, uint64_t timestamp,
+                 const char *string, uint32_t str_len, uint64_t data)
+{
+  bsa_msg_rec_t *rec;
+  uint64_t head = ring->head;
+  uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  uint32_t mask = ring->size - 1;
+  uint32_t len, to_end;
+
+  if (str_len >= BSA_MSG_MAX_LEN)
+      str_len = BSA_MSG_MAX_LEN - 1;
+  len = BSA_MSG_REC_ALIGN(sizeof(bsa_msg_rec_t) + str_len + 1);
+  to_end = ring->size - (head & mask);
+
+  if (head + len + ((to_end < len) ? to_end : 0) - tail > ring->size) {
+      ring->dropped++;
+      return 1;
+  }
+
+  if (to_end < len) {
+      rec = (bsa_msg_rec_t *)&ring->data[head & mask];
+      rec->len = to_end;
+      rec->level = BSA_MSG_LEVEL_PAD;
+      head += to_end;
+  }
+
+  rec = (bsa_msg_rec_t *)&ring->data[head & mask];
+  rec->len = len;
+  rec->level = level;
+  rec->timestamp = timestamp;
+  rec->data = data;
+  memcpy(rec->string, string, str_len);
+  rec->string[str_len] = '\0';
+
+  /* Publish the record only after its contents are visible */
+  __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/**
+  @brief  Take the oldest message. The record is copied out and released.
+  @return Pointer to the copy in buf, or NULL if the ring is empty
+**/
+static inline bsa_msg_rec_t *
+bsa_msg_ring_get(bsa_msg_ring_t *ring, void *buf, uint32_t buf_size)
+{
+  bsa_msg_rec_t *rec;
+  uint64_t tail = ring->tail;
+  uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uint32_t mask = ring->size - 1;
+
+  while (tail != head) {
+      rec = (bsa_msg_rec_t *)&ring->data[tail & mask];
+      if ((rec->len < 8) || (rec->len & 7) || (rec->len > ring->size - (tail & mask))) {
+          /* Corrupt record: drop everything queued so far */
+          tail = head;
+          break;
+      }
+      if (rec->level == BSA_MSG_LEVEL_PAD) {
+          tail += rec->len;
+          continue;
+      }
+
+      memcpy(buf, rec, (rec->len < buf_size) ? rec->len : buf_size);
+      ((char *)buf)[buf_size - 1] = '\0';
+      __atomic_store_n(&ring->tail, tail + rec->len, __ATOMIC_RELEASE);
+      return (bsa_msg_rec_t *)buf;
+  }
+
+  __atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+#endif
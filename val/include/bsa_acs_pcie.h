@@ -64,7 +64,7 @@
 #define MEM_OFFSET_10   0x10
 
 /* Allows storage of 2048 valid BDFs */
-#define PCIE_DEVICE_BDF_TABLE_SZ 8192
+#define PCIE_DEVICE_BDF_TABLE_SZ 12288
 
 typedef enum {
   HEADER = 0,
@@ -136,6 +136,7 @@ typedef enum {
 typedef struct {
   uint32_t bdf;
   uint32_t rp_bdf;
+  uint32_t id;                       ///< Vendor and device ID read when the table was built
 } pcie_device_attr;
 
 typedef struct {
@@ -143,6 +144,9 @@ typedef struct {
   pcie_device_attr device[];         ///< in the format of Segment/Bus/Dev/Func
 } pcie_device_bdf_table;
 
+#define PCIE_DEVICE_BDF_TABLE_MAX \
+  ((PCIE_DEVICE_BDF_TABLE_SZ - sizeof(pcie_device_bdf_table)) / sizeof(pcie_device_attr))
+
 void     val_pcie_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
 void     val_pcie_io_write_cfg(uint32_t bdf, uint32_t offset, uint32_t data);
 uint32_t val_pcie_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data);
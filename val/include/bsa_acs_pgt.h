@@ -40,6 +40,57 @@
 #define PGT_STAGE2_AP_RO (0x1ull << 6)
 #define PGT_STAGE2_AP_RW (0x3ull << 6)
 
+/* Contiguous block of zeroed pages that holds all tables of one context */
+typedef struct {
+    uint64_t pgt_base;      /* PA of the root table, the first page */
+    uint64_t *base;
+    uint32_t num_pages;
+    uint32_t used_pages;
+} pgt_arena_t;
+
+/* Table of each level last used by the walker, with the VA bits above the
+   range that table translates */
+typedef struct {
+    uint64_t pgt_base;
+    uint64_t *table[4];
+    uint64_t va_tag[4];
+} pgt_walk_cache_t;
+
+typedef struct {
+    uint64_t num_walks;       /* Lookups of a single VA */
+    uint64_t num_desc_reads;  /* Descriptors read from memory */
+    uint64_t num_cache_hits;  /* Lookups that started below the root */
+} pgt_walk_stats_t;
+
+/* Granule, level geometry and allocator for building and walking one set of
+   translation tables. Contexts share no state, so independent tables can be
+   built concurrently. */
+typedef struct {
+    uint32_t page_size;
+    uint32_t page_size_log2;
+    uint32_t bits_per_level;
+    uint32_t num_levels;
+    uint32_t ias;
+    uint64_t addr_mask;     /* Next level table address bits of a descriptor */
+    pgt_arena_t arena;
+    pgt_walk_cache_t walk_cache;
+    pgt_walk_stats_t walk_stats;
+    void *(*alloc_pages)(uint32_t num_pages);
+    void (*free_pages)(void *page_base, uint32_t num_pages);
+    void *(*virt_to_phys)(void *va);
+    void *(*phys_to_virt)(uint64_t pa);
+} pgt_context_t;
+
+uint32_t val_pgt_context_init(pgt_context_t *ctx, uint32_t page_size_log2, uint32_t ias);
+uint32_t val_pgt_context_create(pgt_context_t *ctx, memory_region_descriptor_t *mem_desc,
+                                pgt_descriptor_t *pgt_desc);
+uint64_t val_pgt_context_get_attributes(pgt_context_t *ctx, uint64_t pgt_base,
+                                        uint64_t virtual_address, uint64_t *attributes);
+uint32_t val_pgt_context_walk(pgt_context_t *ctx, uint64_t pgt_base, uint64_t virtual_address,
+                              uint64_t length, uint64_t *attributes, uint64_t *run_length);
+void val_pgt_context_destroy(pgt_context_t *ctx);
+
+/* Contexts from a pool shared without a lock, for use on the primary PE */
 uint32_t val_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *pgt_desc);
 void val_pgt_destroy(pgt_descriptor_t pgt_desc);
 uint64_t val_pgt_get_attributes(pgt_descriptor_t pgt_desc, uint64_t virtual_address, uint64_t *attributes);
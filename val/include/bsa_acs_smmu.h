@@ -64,6 +64,9 @@ val_smmu_init(void);
 void
 val_smmu_stop(void);
 
+void
+val_smmu_clear_stats(void);
+
 uint64_t
 val_smmu_map(smmu_master_attributes_t master,
              pgt_descriptor_t pgt_desc
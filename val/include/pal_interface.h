@@ -18,7 +18,12 @@
 #ifndef __PAL_INTERFACE_H__
 #define __PAL_INTERFACE_H__
 
-#ifdef TARGET_LINUX
+#ifdef TARGET_LINUX_HOST
+/* User-space build against the host PAL, for exercising VAL off target */
+#include <stdint.h>
+#include <stddef.h>
+typedef uint64_t dma_addr_t;
+#elif defined(TARGET_LINUX)
 #include <linux/slab.h>
 #endif
 
@@ -85,7 +90,12 @@ typedef struct {
   uint32_t tg_size_log2:5;
 }PE_TCR_BF;
 
-void pal_pe_create_info_table(PE_INFO_TABLE *pe_info_table);
+/* max_entries of the create_info_table calls is the number of entries the table was
+   sized for, end markers included. The PAL stops filling there */
+#define INFO_TABLE_UNSIZED  0xFFFFFFFF  /* the caller allocated a fixed size table */
+
+void pal_pe_create_info_table(PE_INFO_TABLE *pe_info_table, uint32_t max_entries);
+uint32_t pal_pe_info_table_entries(void);
 
 /**
   @brief  Structure to Pass SMC arguments. Return data is also filled into
@@ -160,7 +170,8 @@ typedef struct {
   GIC_INFO_ENTRY gic_info[];  ///< Array of Information blocks - instantiated for each GIC type
 }GIC_INFO_TABLE;
 
-void     pal_gic_create_info_table(GIC_INFO_TABLE *gic_info_table);
+void     pal_gic_create_info_table(GIC_INFO_TABLE *gic_info_table, uint32_t max_entries);
+uint32_t pal_gic_info_table_entries(void);
 uint32_t pal_gic_install_isr(uint32_t int_id, void (*isr)(void));
 void pal_gic_end_of_interrupt(uint32_t int_id);
 uint32_t pal_gic_request_irq(unsigned int irq_num, unsigned int mapped_irq_num, void *isr);
@@ -168,9 +179,12 @@ void pal_gic_free_irq(unsigned int irq_num, unsigned int mapped_irq_num);
 uint32_t pal_gic_set_intr_trigger(uint32_t int_id, INTR_TRIGGER_INFO_TYPE_e trigger_type);
 uint32_t pal_gic_its_configure(void);
 uint32_t pal_gic_request_msi(uint32_t its_id, uint32_t DevID, uint32_t IntID, uint32_t msi_index, uint32_t *msi_addr, uint32_t *msi_data);
+uint32_t pal_gic_request_msi_range(uint32_t its_id, uint32_t DevID, uint32_t IntID, uint32_t msi_index,
+                                   uint32_t num_vectors, uint32_t *msi_addr, uint32_t *msi_data);
 void pal_gic_free_msi(uint32_t its_id, uint32_t DevID, uint32_t IntID, uint32_t msi_index);
 uint32_t pal_gic_get_max_lpi_id(void);
 uint32_t pal_bsa_gic_imp(void);
+uint64_t pal_get_fw_table_checksum(void);
 
 /** Timer tests related definitions **/
 
@@ -216,6 +230,7 @@ typedef struct {
 }TIMER_INFO_TABLE;
 
 void pal_timer_create_info_table(TIMER_INFO_TABLE *timer_info_table);
+uint32_t pal_timer_info_table_entries(void);
 
 /** Watchdog tests related definitions **/
 
@@ -244,7 +259,8 @@ typedef struct {
   WD_INFO_BLOCK  wd_info[];  ///< Array of Information blocks - instantiated for each WD Controller
 }WD_INFO_TABLE;
 
-void pal_wd_create_info_table(WD_INFO_TABLE  *wd_table);
+void pal_wd_create_info_table(WD_INFO_TABLE  *wd_table, uint32_t max_entries);
+uint32_t pal_wd_info_table_entries(void);
 
 
 /* PCIe Tests related definitions */
@@ -272,7 +288,8 @@ void     pal_pci_cfg_write(uint32_t bus, uint32_t dev, uint32_t func, int offset
 uint32_t pal_pci_cfg_read(uint32_t bus, uint32_t dev, uint32_t func, int offset, uint32_t *value);
 
 uint64_t pal_pcie_get_mcfg_ecam(void);
-void     pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable);
+void     pal_pcie_create_info_table(PCIE_INFO_TABLE *PcieTable, uint32_t max_entries);
+uint32_t pal_pcie_info_table_entries(void);
 uint32_t pal_pcie_io_read_cfg(uint32_t bdf, uint32_t offset, uint32_t *data);
 uint32_t pal_pcie_get_bdf_wrapper(uint32_t class_code, uint32_t start_bdf);
 void *pal_pci_bdf_to_dev(uint32_t bdf);
@@ -367,7 +384,9 @@ typedef struct {
   IOVIRT_BLOCK blocks[];
 }IOVIRT_INFO_TABLE;
 
-void pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *iovirt);
+/* max_size is in bytes, as IOVIRT blocks vary in size */
+void pal_iovirt_create_info_table(IOVIRT_INFO_TABLE *iovirt, uint32_t max_size);
+uint32_t pal_iovirt_info_table_entries(uint32_t *num_data_maps);
 uint32_t pal_iovirt_check_unique_ctx_intid(uint64_t smmu_block);
 uint32_t pal_iovirt_unique_rid_strid_map(uint64_t rc_block);
 uint64_t pal_iovirt_get_rc_smmu_base(IOVIRT_INFO_TABLE *iovirt, uint32_t rc_seg_num);
@@ -457,7 +476,8 @@ typedef struct {
   PERIPHERAL_INFO_BLOCK   info[]; ///< Array of Information blocks - instantiated for each peripheral
 }PERIPHERAL_INFO_TABLE;
 
-void  pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *per_info_table);
+void  pal_peripheral_create_info_table(PERIPHERAL_INFO_TABLE *per_info_table, uint32_t max_entries);
+uint32_t pal_peripheral_info_table_entries(void);
 uint32_t pal_peripheral_is_pcie(uint32_t seg, uint32_t bus, uint32_t dev, uint32_t fn);
 
 /**
@@ -570,7 +590,8 @@ typedef struct {
   MEM_INFO_BLOCK  info[];
 } MEMORY_INFO_TABLE;
 
-void  pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable);
+void  pal_memory_create_info_table(MEMORY_INFO_TABLE *memoryInfoTable, uint32_t max_entries);
+uint32_t pal_memory_info_table_entries(void);
 uint64_t pal_memory_ioremap(void *addr, uint32_t size, uint32_t attr);
 void pal_memory_unmap(void *addr);
 uint64_t pal_memory_get_unpopulated_addr(uint64_t *addr, uint32_t instance);
@@ -590,6 +611,9 @@ void    *pal_mem_virt_to_phys(void *va);
 void    *pal_mem_phys_to_virt(uint64_t pa);
 
 uint64_t pal_time_delay_ms(uint64_t time_ms);
+#ifdef TARGET_LINUX_HOST
+uint64_t pal_host_counter_read(uint64_t *freq);
+#endif
 void     pal_mem_allocate_shared(uint32_t num_pe, uint32_t sizeofentry);
 void     pal_mem_free_shared(void);
 uint64_t pal_mem_get_shared_addr(void);
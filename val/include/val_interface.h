@@ -49,8 +49,48 @@ void    *val_memcpy(void *dest_buffer, void *src_buffer, uint32_t len);
 
 uint64_t val_time_delay_ms(uint64_t time_ms);
 
+/* Test selection: include/exclude ranges of test numbers, set by the application */
+void     val_test_select_clear(void);
+uint32_t val_test_select_add(uint32_t start, uint32_t end, uint32_t exclude);
+void     val_test_select_timing(uint32_t enable);
+void     val_test_select_order(uint32_t by_cost);
+uint32_t val_test_is_selected(uint32_t test_num);
+uint32_t val_test_module_is_selected(uint32_t module_base);
+
+/* Startup profile: time, entries and bytes of each info table creation phase */
+void     val_startup_phase_begin(char8_t *name);
+void     val_startup_phase_end(uint32_t entries, uint32_t bytes);
+void     val_startup_report(void);
+
+/* A module run by val_run_modules */
+typedef struct {
+  char8_t   *banner;           /* printed before the module runs, may be NULL */
+  uint32_t  (*run)(uint32_t num_pe, uint32_t *g_sw_view);
+} TEST_MODULE;
+
+uint32_t val_run_modules(const TEST_MODULE *list, uint32_t num, uint32_t *g_sw_view);
+
+/* Info tables that may be restored from a saved snapshot instead of being rediscovered.
+   The PCIe BDF table is checked against the devices present before it is used, and the
+   peripheral table, found among those devices, is only restored along with it. */
+typedef enum {
+  INFO_TABLE_TIMER = 0,
+  INFO_TABLE_WD,
+  INFO_TABLE_PCIE,
+  INFO_TABLE_PCIE_BDF,
+  INFO_TABLE_IOVIRT,
+  INFO_TABLE_PERIPHERAL,
+  INFO_TABLE_MAX
+} INFO_TABLE_e;
+
+void     val_info_table_set_restored(uint32_t table_mask);
+uint32_t val_info_table_is_restored(INFO_TABLE_e table);
+void     val_info_table_discard(INFO_TABLE_e table);
+uint64_t val_get_fw_table_checksum(void);
+
 /* VAL PE APIs */
 uint32_t val_pe_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
+uint32_t val_pe_get_info_table_size(void);
 uint32_t val_pe_create_info_table(uint64_t *pe_info_table);
 void     val_pe_free_info_table(void);
 uint32_t val_pe_get_num(void);
@@ -65,6 +105,7 @@ void     val_execute_on_pe(uint32_t index, void (*payload)(void), uint64_t args)
 void     val_suspend_pe(uint32_t power_state, uint64_t entry, uint32_t context_id);
 
 /* GIC VAL APIs */
+uint32_t val_gic_get_info_table_size(void);
 uint32_t    val_gic_create_info_table(uint64_t *gic_info_table);
 typedef enum {
   GIC_INFO_VERSION=1,
@@ -82,12 +123,20 @@ typedef enum {
   GIC_INFO_NUM_MSI_FRAME
 }GIC_INFO_e;
 
+/* Per INTID counters kept by the BSA interrupt handler, latency in system counter ticks */
+typedef enum {
+  GIC_INTR_STATS_COUNT = 1,
+  GIC_INTR_STATS_LATENCY_TOTAL,
+  GIC_INTR_STATS_LATENCY_MAX
+}GIC_INTR_STATS_e;
+
 uint32_t
 val_gic_get_info(GIC_INFO_e type);
 void     val_gic_free_info_table(void);
 uint32_t val_gic_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
 uint32_t val_gic_install_isr(uint32_t int_id, void (*isr)(void));
 uint32_t val_gic_end_of_interrupt(uint32_t int_id);
+uint64_t val_gic_get_intr_stats(uint32_t int_id, GIC_INTR_STATS_e type);
 uint32_t val_gic_route_interrupt_to_pe(uint32_t int_id, uint64_t mpidr);
 uint32_t val_gic_get_interrupt_state(uint32_t int_id);
 void val_gic_clear_interrupt(uint32_t int_id);
@@ -98,6 +147,7 @@ void val_gic_set_intr_trigger(uint32_t int_id, INTR_TRIGGER_INFO_TYPE_e trigger_
 uint32_t val_gic_get_intr_trigger_type(uint32_t int_id, INTR_TRIGGER_INFO_TYPE_e *trigger_type);
 uint32_t val_gic_its_configure(void);
 uint32_t val_gic_request_msi(uint32_t bdf, uint32_t IntID, uint32_t msi_index);
+uint32_t val_gic_request_msi_range(uint32_t bdf, uint32_t IntID, uint32_t msi_index, uint32_t num_vectors);
 void val_gic_free_msi(uint32_t bdf, uint32_t IntID, uint32_t msi_index);
 
 /* GICv2m APIs */
@@ -134,6 +184,7 @@ typedef enum {
 
 #define BSA_TIMER_FLAG_ALWAYS_ON 0x4
 
+uint32_t val_timer_get_info_table_size(void);
 void     val_timer_create_info_table(uint64_t *timer_info_table);
 void     val_timer_free_info_table(void);
 uint32_t val_timer_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
@@ -158,6 +209,7 @@ typedef enum {
   WD_INFO_IS_EDGE
 }WD_INFO_TYPE_e;
 
+uint32_t val_wd_get_info_table_size(void);
 void     val_wd_create_info_table(uint64_t *wd_info_table);
 void     val_wd_free_info_table(void);
 uint32_t val_wd_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
@@ -167,10 +219,12 @@ uint32_t     val_wd_set_ws0(uint32_t index, uint32_t timeout);
 
 /* PCIE VAL APIs */
 void     val_pcie_enumerate(void);
+uint32_t val_pcie_get_info_table_size(void);
 void     val_pcie_create_info_table(uint64_t *pcie_info_table);
 uint32_t val_pcie_create_device_bdf_table(void);
 addr_t val_pcie_get_ecam_base(uint32_t rp_bdf);
 void *val_pcie_bdf_table_ptr(void);
+void     val_pcie_set_bdf_table(void *bdf_table);
 void     val_pcie_free_info_table(void);
 uint32_t val_pcie_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
 uint32_t val_pcie_is_devicedma_64bit(uint32_t bdf);
@@ -213,7 +267,10 @@ typedef enum {
   SMMU_IOVIRT_BLOCK,
   SMMU_SSID_BITS,
   SMMU_IN_ADDR_SIZE,
-  SMMU_OUT_ADDR_SIZE
+  SMMU_OUT_ADDR_SIZE,
+  SMMU_CMDQ_NUM_CMDS,
+  SMMU_CMDQ_NUM_INV,
+  SMMU_CMDQ_NUM_SYNC
 }SMMU_INFO_e;
 
 typedef enum {
@@ -237,6 +294,7 @@ typedef enum {
   RC_IOVIRT_BLOCK
 }PCIE_RC_INFO_e;
 
+uint32_t val_iovirt_get_info_table_size(void);
 void     val_iovirt_create_info_table(uint64_t *iovirt_info_table);
 void     val_iovirt_free_info_table(void);
 uint32_t val_iovirt_get_rc_smmu_index(uint32_t rc_seg_num);
@@ -305,6 +363,7 @@ typedef enum {
   MAX_PASIDS
 }PERIPHERAL_INFO_e;
 
+uint32_t val_peripheral_get_info_table_size(void);
 void     val_peripheral_create_info_table(uint64_t *peripheral_info_table);
 void     val_peripheral_free_info_table(void);
 uint32_t val_peripheral_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
@@ -330,6 +389,7 @@ typedef enum {
 #define MEM_DEVICE(attr) ((attr & 0xf0) == 0)
 #define MEM_SH_INNER(sh) (sh == 0x3)
 
+uint32_t val_memory_get_info_table_size(void);
 void     val_memory_create_info_table(uint64_t *memory_info_table);
 void     val_memory_free_info_table(void);
 uint32_t val_memory_execute_tests(uint32_t num_pe, uint32_t *g_sw_view);
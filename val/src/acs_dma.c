@@ -107,7 +107,10 @@ val_dma_create_info_table(uint64_t *dma_info_ptr)
 
   g_dma_info_table = (DMA_INFO_TABLE *)dma_info_ptr;
 
+  val_startup_phase_begin("DMA");
   pal_dma_create_info_table(g_dma_info_table);
+  val_startup_phase_end(g_dma_info_table->num_dma_ctrls, sizeof(DMA_INFO_TABLE) +
+                        g_dma_info_table->num_dma_ctrls * sizeof(DMA_INFO_BLOCK));
 
   val_print(ACS_PRINT_TEST, " DMA_INFO: Number of DMA CTRL in PCIe :    %x \n", val_dma_get_info(DMA_NUM_CTRL, 0));
 }
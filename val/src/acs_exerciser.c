@@ -206,6 +206,17 @@ uint32_t val_exerciser_get_data(EXERCISER_DATA_TYPE type, exerciser_data_t *data
     return pal_exerciser_get_data(type, data, bdf, ecam);
 }
 
+/* Exerciser tests, in run order. They drive the exerciser from the primary PE */
+static const TEST_DESC g_exerciser_tests[] = {
+  {ACS_EXERCISER_TEST_NUM_BASE + 1,  1, os_e001_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_EXERCISER, TEST_FLAG_ONE_PE},
+  {ACS_EXERCISER_TEST_NUM_BASE + 4,  1, os_e004_entry, TEST_VIEW_OS, TEST_COST_HIGH, TEST_NEEDS_EXERCISER, TEST_FLAG_ONE_PE},
+  {ACS_EXERCISER_TEST_NUM_BASE + 5,  1, os_e005_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_EXERCISER, TEST_FLAG_ONE_PE},
+  {ACS_EXERCISER_TEST_NUM_BASE + 6,  1, os_e006_entry, TEST_VIEW_OS, TEST_COST_HIGH, TEST_NEEDS_EXERCISER, TEST_FLAG_ONE_PE},
+  {ACS_EXERCISER_TEST_NUM_BASE + 12, 1, os_e012_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_EXERCISER, TEST_FLAG_ONE_PE},
+  {ACS_EXERCISER_TEST_NUM_BASE + 13, 1, os_e013_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_EXERCISER, TEST_FLAG_ONE_PE},
+  {ACS_EXERCISER_TEST_NUM_BASE + 15, 1, os_e015_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_EXERCISER, TEST_FLAG_ONE_PE},
+};
+
 /**
   @brief   This API executes all the Exerciser tests sequentially
            1. Caller       -  Application layer.
@@ -226,6 +237,11 @@ val_exerciser_execute_tests(uint32_t *g_sw_view)
       }
   }
 
+  if (!val_test_module_is_selected(ACS_EXERCISER_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No Exerciser tests selected \n", 0);
+      return ACS_STATUS_SKIP;
+  }
+
   /* Create the list of valid Pcie Device Functions */
   if (val_pcie_create_device_bdf_table()) {
       val_print(ACS_PRINT_WARN, "\n     Create BDF Table Failed, Skipping Exerciser tests...\n", 0);
@@ -235,23 +251,11 @@ val_exerciser_execute_tests(uint32_t *g_sw_view)
   val_exerciser_create_info_table();
   num_instances = val_exerciser_get_info(EXERCISER_NUM_CARDS, 0);
 
-  if (num_instances == 0) {
+  if (num_instances == 0)
       val_print(ACS_PRINT_WARN, "\n     No Exerciser Devices Found, Skipping tests...\n", 0);
-      return ACS_STATUS_SKIP;
-  }
-
-  if (g_sw_view[G_SW_OS]) {
-     val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
 
-     status |= os_e001_entry();
-     status |= os_e004_entry();
-     status |= os_e005_entry();
-     status |= os_e006_entry();
-     status |= os_e012_entry();
-     status |= os_e013_entry();
-     status |= os_e015_entry();
-
-  }
+  status = val_run_test_list(g_exerciser_tests, TEST_LIST_NUM(g_exerciser_tests), 1, g_sw_view,
+                             num_instances ? TEST_NEEDS_EXERCISER : 0);
 
   if (status != ACS_STATUS_PASS)
     val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
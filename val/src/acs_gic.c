@@ -22,6 +22,26 @@
 #include "sys_arch_src/gic/gic.h"
 
 GIC_INFO_TABLE  *g_gic_info_table;
+static uint32_t g_gic_info_entries = INFO_TABLE_UNSIZED;
+
+/* GIC tests, in run order */
+static const TEST_DESC g_gic_tests[] = {
+  {ACS_GIC_TEST_NUM_BASE + 1,     1, os_g001_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_GIC_TEST_NUM_BASE + 2,     1, os_g002_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_GIC_TEST_NUM_BASE + 3,     1, os_g003_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_GIC_TEST_NUM_BASE + 4,     1, os_g004_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_GIC_TEST_NUM_BASE + 5,     1, os_g005_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_GIC_TEST_NUM_BASE + 6,     1, os_g006_entry,  TEST_VIEW_OS,  TEST_COST_HIGH, 0},
+  {ACS_GIC_HYP_TEST_NUM_BASE + 1, 1, hyp_g001_entry, TEST_VIEW_HYP, TEST_COST_HIGH, 0},
+};
+
+/* GICv2m tests, run when the GIC has v2m MSI frames */
+static const TEST_DESC g_gic_v2m_tests[] = {
+  {ACS_GIC_V2M_TEST_NUM_BASE + 1, 1, os_v001_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_GIC_V2M_TEST_NUM_BASE + 2, 1, os_v002_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_GIC_V2M_TEST_NUM_BASE + 3, 1, os_v003_entry,  TEST_VIEW_OS,  TEST_COST_HIGH, 0},
+  {ACS_GIC_V2M_TEST_NUM_BASE + 4, 1, os_v004_entry,  TEST_VIEW_OS,  TEST_COST_HIGH, 0},
+};
 
 /**
   @brief   This API executes all the GIC tests sequentially
@@ -44,22 +64,12 @@ val_gic_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  status = ACS_STATUS_PASS;
-
-  if (g_sw_view[G_SW_OS]) {
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-      status |= os_g001_entry(num_pe);
-      status |= os_g002_entry(num_pe);
-      status |= os_g003_entry(num_pe);
-      status |= os_g004_entry(num_pe);
-      status |= os_g005_entry(num_pe);
-      status |= os_g006_entry(num_pe);
+  if (!val_test_module_is_selected(ACS_GIC_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No GIC tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
-  if (g_sw_view[G_SW_HYP]) {
-      val_print(ACS_PRINT_ERR, "\nHypervisor:\n", 0);
-      status |= hyp_g001_entry(num_pe);
-  }
+  status = val_run_test_list(g_gic_tests, TEST_LIST_NUM(g_gic_tests), num_pe, g_sw_view, 0);
 
   /* Run GICv2m only if GIC Version is v2m. */
   gic_version   = val_gic_get_info(GIC_INFO_VERSION);
@@ -76,13 +86,7 @@ val_gic_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
   }
 
   val_print(ACS_PRINT_ERR, "\n      *** Starting GICv2m tests ***\n", 0);
-  if (g_sw_view[G_SW_OS]) {
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-      status |= os_v001_entry(num_pe);
-      status |= os_v002_entry(num_pe);
-      status |= os_v003_entry(num_pe);
-      status |= os_v004_entry(num_pe);
-  }
+  status |= val_run_test_list(g_gic_v2m_tests, TEST_LIST_NUM(g_gic_v2m_tests), num_pe, g_sw_view, 0);
 
 test_done:
   if (status != ACS_STATUS_PASS)
@@ -95,6 +99,20 @@ test_done:
 }
 
 
+/**
+  @brief   Size the GIC info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_gic_create_info_table
+**/
+uint32_t
+val_gic_get_info_table_size(void)
+{
+  g_gic_info_entries = pal_gic_info_table_entries();
+  return sizeof(GIC_INFO_TABLE) + g_gic_info_entries * sizeof(GIC_INFO_ENTRY);
+}
+
 /**
   @brief   This API will call PAL layer to fill in the GIC information
            into the g_gic_info_table pointer.
@@ -106,6 +124,7 @@ test_done:
 uint32_t
 val_gic_create_info_table(uint64_t *gic_info_table)
 {
+  uint32_t num_entries;
 
   if (gic_info_table == NULL) {
       val_print(ACS_PRINT_ERR, "Input for Create Info table cannot be NULL \n", 0);
@@ -114,7 +133,13 @@ val_gic_create_info_table(uint64_t *gic_info_table)
 
   g_gic_info_table = (GIC_INFO_TABLE *)gic_info_table;
 
-  pal_gic_create_info_table(g_gic_info_table);
+  val_startup_phase_begin("GIC");
+  pal_gic_create_info_table(g_gic_info_table, g_gic_info_entries);
+
+  for (num_entries = 0; g_gic_info_table->gic_info[num_entries].type != 0xFF; num_entries++)
+      ;
+  val_startup_phase_end(num_entries,
+                        sizeof(GIC_INFO_TABLE) + (num_entries + 1) * sizeof(GIC_INFO_ENTRY));
 
   val_print(ACS_PRINT_TEST, " GIC_INFO: Number of GICD             : %4d \n", g_gic_info_table->header.num_gicd);
   val_print(ACS_PRINT_TEST, " GIC_INFO: Number of ITS              : %4d \n", g_gic_info_table->header.num_its);
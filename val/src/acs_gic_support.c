@@ -159,6 +159,9 @@ uint32_t val_gic_request_irq(uint32_t irq_num, uint32_t mapped_irq_num, void *is
  */
 void val_gic_free_irq(uint32_t irq_num, uint32_t mapped_irq_num)
 {
+    if (pal_bsa_gic_imp())
+        val_gic_bsa_uninstall_isr(irq_num);
+
     pal_gic_free_irq(irq_num, mapped_irq_num);
 }
 
@@ -177,6 +180,23 @@ uint32_t val_gic_end_of_interrupt(uint32_t int_id)
   return 0;
 }
 
+/**
+  @brief   This function returns the handler statistics for an interrupt. Counters are
+           only kept when the BSA GIC driver handles interrupts.
+           1. Caller       -  Test Suite
+           2. Prerequisite -  val_gic_install_isr
+  @param   int_id Interrupt ID
+  @param   type   GIC_INTR_STATS_e counter to read
+  @return  counter value, 0 if not available
+**/
+uint64_t val_gic_get_intr_stats(uint32_t int_id, GIC_INTR_STATS_e type)
+{
+  if (!pal_bsa_gic_imp())
+      return 0;
+
+  return val_gic_bsa_get_intr_stats(int_id, type);
+}
+
 uint32_t val_gic_its_configure()
 {
   uint32_t status;
@@ -268,6 +288,10 @@ void val_gic_free_msi(uint32_t bdf, uint32_t IntID, uint32_t msi_index)
   pal_gic_free_msi(its_id, device_id, IntID, msi_index);
 
   clear_msi_x_table(bdf, msi_index);
+
+  /* Release the handler slot, LPIs share a fixed size table */
+  if (pal_bsa_gic_imp())
+      val_gic_bsa_uninstall_isr(IntID);
 }
 
 /**
@@ -306,3 +330,47 @@ uint32_t val_gic_request_msi(uint32_t bdf, uint32_t IntID, uint32_t msi_index)
 
   return status;
 }
+
+/**
+  @brief   This function maps a block of consecutive MSI-X vectors of a device to
+           consecutive LPIs with a single batch of ITS commands, and programs the
+           MSI-X table entries for all of them. The batch has to fit in the free
+           space of the ITS command queue, else nothing is mapped.
+
+  @param   bdf          B:D:F for the device
+  @param   IntID        First Interrupt ID of the range
+  @param   msi_index    First msi index in the table
+  @param   num_vectors  Number of vectors to map
+
+  @return  status
+**/
+uint32_t val_gic_request_msi_range(uint32_t bdf, uint32_t IntID, uint32_t msi_index, uint32_t num_vectors)
+{
+  uint32_t status;
+  uint32_t msi_addr, msi_data;
+  uint32_t device_id, stream_id, its_id;
+  uint32_t req_id;
+  uint32_t i;
+  uint32_t bus = PCIE_EXTRACT_BDF_BUS(bdf);
+  uint32_t dev = PCIE_EXTRACT_BDF_DEV(bdf);
+  uint32_t func = PCIE_EXTRACT_BDF_FUNC(bdf);
+
+  req_id = GET_DEVICE_ID(bus, dev, func);
+
+  status = val_iovirt_get_device_info(req_id, PCIE_EXTRACT_BDF_SEG(bdf), &device_id, &stream_id, &its_id);
+  if (status) { /* Use Requester-Id if val_iovirt_get_device_info fails.*/
+    device_id = req_id;
+  }
+
+  status = pal_gic_request_msi_range(its_id, device_id, IntID, msi_index, num_vectors,
+                                     &msi_addr, &msi_data);
+  if (status) {
+    /* MSI Assignment Failed. */
+    return status;
+  }
+
+  for (i = 0; i < num_vectors; i++)
+    fill_msi_x_table(bdf, msi_index + i, msi_addr, msi_data + i);
+
+  return status;
+}
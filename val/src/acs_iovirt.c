@@ -21,6 +21,7 @@
 #include "include/bsa_acs_smmu.h"
 
 IOVIRT_INFO_TABLE *g_iovirt_info_table;
+static uint32_t g_iovirt_info_size = INFO_TABLE_UNSIZED;
 
 /**
   @brief   This API is a single point of entry to retrieve
@@ -145,35 +146,46 @@ val_iovirt_unique_rid_strid_map(uint32_t rc_index)
   return pal_iovirt_unique_rid_strid_map(block);
 }
 
+/* One ID mapping of a root complex (keyed by segment) or of an SMMU (keyed by
+   block offset), as held in the sorted ID range tables */
+typedef struct {
+  uint32_t key;
+  uint32_t in_base;
+  uint32_t in_end;          /* inclusive, as id_count is one less than the number of IDs */
+  uint32_t out_base;
+  uint32_t out_ref;
+} IOVIRT_ID_RANGE;
+
+typedef struct {
+  IOVIRT_ID_RANGE *range;   /* root complex maps, then SMMU maps */
+  uint32_t num_rid;
+  uint32_t num_sid;
+  uint32_t valid;           /* 0: answer lookups with the block walk */
+  uint32_t lookups;
+  uint32_t walks;
+} IOVIRT_ID_CACHE;
+
+static IOVIRT_ID_CACHE g_iovirt_id_cache;
+
+/* Reasons a requester ID cannot be translated */
+#define IOVIRT_ID_NO_RID_MAP   1
+#define IOVIRT_ID_BAD_RC_MAP   2
+#define IOVIRT_ID_NO_SID_MAP   3
+
 /**
-  @brief  Calculate the device id and stream id orresponding to the requestor id
-  @param  rid          Requestor ID
-  @param  segment      pci_segment_number
-  @param  *device_id   Pointer to device id
-  @param  *stream_id   Pointer to stream id
-  @param  *its_id      Pointer to its id
-  @return status
+  @brief  Translate a requester ID by walking the IOVIRT blocks and their ID mappings
+  @return 0 on success, else one of IOVIRT_ID_*
 **/
-
-int
-val_iovirt_get_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
-                           uint32_t *stream_id, uint32_t *its_id)
+static uint32_t
+iovirt_walk_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
+                        uint32_t *stream_id, uint32_t *its_id)
 {
   uint32_t i, j, id = 0;
-  uint32_t sid, did, oref;
+  uint32_t sid, did = 0, oref = 0;
   uint32_t itsid = 0;
   uint32_t mapping_found;
   IOVIRT_BLOCK *block;
   NODE_DATA_MAP *map;
-  if (g_iovirt_info_table == NULL)
-  {
-      val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: iovirt info table is not created \n", 0);
-      return ACS_STATUS_ERR;
-  }
-  if (!device_id) {
-      val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: Invalid parameters\n", 0);
-      return ACS_STATUS_ERR;
-  }
 
   /* Search for root complex block with same segment number, and in whose id */
   /* mapping range 'rid' falls. Calculate the output id */
@@ -197,11 +209,9 @@ val_iovirt_get_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
           break;
       }
   }
-  if (!mapping_found) {
-      val_print(ACS_PRINT_ERR,
-               "GET_DEVICE_ID: Requestor ID to Stream ID/Device ID mapping not found\n", 0);
-      return ACS_STATUS_ERR;
-  }
+  if (!mapping_found)
+      return IOVIRT_ID_NO_RID_MAP;
+
   /* If output reference node is to ITS group, 'id' is device id */
   block = (IOVIRT_BLOCK*)((uint8_t*)g_iovirt_info_table + oref);
   if(block->type == IOVIRT_NODE_ITS_GROUP)
@@ -234,14 +244,284 @@ val_iovirt_get_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
           itsid = block->data_map[0].id[0];
   }
   else
-  {
-    val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: Invalid mapping for RC in IORT\n", 0);
-    return ACS_STATUS_ERR;
-  }
+      return IOVIRT_ID_BAD_RC_MAP;
+
   if (!mapping_found)
+      return IOVIRT_ID_NO_SID_MAP;
+
+  *its_id = itsid;
+  *stream_id = sid;
+  *device_id = did;
+  return 0;
+}
+
+/* Range in range[0..num) with the largest (key, in_base) not above (key, id) that covers id */
+static IOVIRT_ID_RANGE *
+iovirt_id_range_find(IOVIRT_ID_RANGE *range, uint32_t num, uint32_t key, uint32_t id)
+{
+  uint32_t low = 0, high = num, mid;
+
+  while (low < high) {
+      mid = low + (high - low) / 2;
+      if ((range[mid].key < key) || ((range[mid].key == key) && (range[mid].in_base <= id)))
+          low = mid + 1;
+      else
+          high = mid;
+  }
+  if (low && (range[low - 1].key == key) && (id <= range[low - 1].in_end))
+      return &range[low - 1];
+  return NULL;
+}
+
+/**
+  @brief  Translate a requester ID through the ID range tables
+  @return 0 on success, else one of IOVIRT_ID_*
+**/
+static uint32_t
+iovirt_cache_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
+                         uint32_t *stream_id, uint32_t *its_id)
+{
+  IOVIRT_ID_RANGE *r;
+  IOVIRT_BLOCK *block;
+  uint32_t id;
+
+  r = iovirt_id_range_find(g_iovirt_id_cache.range, g_iovirt_id_cache.num_rid, segment, rid);
+  if (r == NULL)
+      return IOVIRT_ID_NO_RID_MAP;
+
+  id = rid - r->in_base + r->out_base;
+  block = (IOVIRT_BLOCK*)((uint8_t*)g_iovirt_info_table + r->out_ref);
+  if (block->type == IOVIRT_NODE_ITS_GROUP) {
+      *device_id = id;
+      *stream_id = ~((uint32_t)0);
+      *its_id = block->data_map[0].id[0];
+      return 0;
+  }
+  if (block->type != IOVIRT_NODE_SMMU && block->type != IOVIRT_NODE_SMMU_V3)
+      return IOVIRT_ID_BAD_RC_MAP;
+
+  r = iovirt_id_range_find(g_iovirt_id_cache.range + g_iovirt_id_cache.num_rid,
+                           g_iovirt_id_cache.num_sid, r->out_ref, id);
+  if (r == NULL)
+      return IOVIRT_ID_NO_SID_MAP;
+
+  *stream_id = id;
+  *device_id = id - r->in_base + r->out_base;
+  block = (IOVIRT_BLOCK*)((uint8_t*)g_iovirt_info_table + r->out_ref);
+  *its_id = (block->type == IOVIRT_NODE_ITS_GROUP) ? block->data_map[0].id[0] : 0;
+  return 0;
+}
+
+static void
+iovirt_id_range_sort(IOVIRT_ID_RANGE *range, uint32_t num)
+{
+  IOVIRT_ID_RANGE tmp;
+  uint32_t gap, i, j;
+
+  for (gap = num / 2; gap > 0; gap /= 2) {
+      for (i = gap; i < num; i++) {
+          tmp = range[i];
+          for (j = i; (j >= gap) &&
+               ((range[j - gap].key > tmp.key) ||
+                ((range[j - gap].key == tmp.key) && (range[j - gap].in_base > tmp.in_base))); j -= gap)
+              range[j] = range[j - gap];
+          range[j] = tmp;
+      }
+  }
+}
+
+/* Non-zero if two ranges of the same key overlap, where the walk's order of preference would matter */
+static uint32_t
+iovirt_id_range_overlap(IOVIRT_ID_RANGE *range, uint32_t num)
+{
+  uint32_t i;
+
+  for (i = 1; i < num; i++)
+      if ((range[i].key == range[i - 1].key) && (range[i].in_base <= range[i - 1].in_end))
+          return 1;
+  return 0;
+}
+
+/**
+  @brief  Compare the range tables with the block walk at both ends of every
+          requester ID range
+  @return Number of mismatches
+**/
+static uint32_t
+iovirt_id_cache_self_check(void)
+{
+  uint32_t i, k, rid, status, errors = 0;
+  uint32_t did[2], sid[2], itsid[2];
+
+  for (i = 0; i < g_iovirt_id_cache.num_rid; i++) {
+      for (k = 0; k < 2; k++) {
+          rid = k ? g_iovirt_id_cache.range[i].in_end : g_iovirt_id_cache.range[i].in_base;
+          did[0] = did[1] = sid[0] = sid[1] = itsid[0] = itsid[1] = 0;
+          status = iovirt_cache_device_info(rid, g_iovirt_id_cache.range[i].key,
+                                            &did[0], &sid[0], &itsid[0]);
+          if ((status != iovirt_walk_device_info(rid, g_iovirt_id_cache.range[i].key,
+                                                 &did[1], &sid[1], &itsid[1])) ||
+              (did[0] != did[1]) || (sid[0] != sid[1]) || (itsid[0] != itsid[1])) {
+              val_print(ACS_PRINT_WARN, "\n IOVIRT: ID range table mismatch for RID 0x%x", rid);
+              errors++;
+          }
+      }
+  }
+  return errors;
+}
+
+/**
+  @brief  Build the sorted requester ID and stream ID range tables from the IOVIRT
+          info table, so val_iovirt_get_device_info need not walk the blocks.
+          The walk stays in use if the tables cannot be built or disagree with it.
+**/
+static void
+iovirt_id_cache_build(void)
+{
+  IOVIRT_BLOCK *block, *rc;
+  NODE_DATA_MAP *map;
+  IOVIRT_ID_RANGE *r;
+  uint32_t i, j, k, num_rid = 0, num_sid = 0, dup;
+
+  if (g_iovirt_id_cache.range)
+      pal_mem_free(g_iovirt_id_cache.range);
+  g_iovirt_id_cache.range = NULL;
+  g_iovirt_id_cache.num_rid = 0;
+  g_iovirt_id_cache.num_sid = 0;
+  g_iovirt_id_cache.valid = 0;
+  g_iovirt_id_cache.lookups = 0;
+  g_iovirt_id_cache.walks = 0;
+
+  /* Only the first root complex of a segment is ever consulted */
+  block = &g_iovirt_info_table->blocks[0];
+  for (i = 0; i < g_iovirt_info_table->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block)) {
+      if (block->type == IOVIRT_NODE_PCI_ROOT_COMPLEX)
+          num_rid += block->num_data_map;
+      else if (block->type == IOVIRT_NODE_SMMU || block->type == IOVIRT_NODE_SMMU_V3)
+          num_sid += block->num_data_map;
+  }
+  if (num_rid == 0)
+      return;
+
+  g_iovirt_id_cache.range = pal_mem_alloc((num_rid + num_sid) * sizeof(IOVIRT_ID_RANGE));
+  if (g_iovirt_id_cache.range == NULL)
+      return;
+
+  r = g_iovirt_id_cache.range;
+  block = &g_iovirt_info_table->blocks[0];
+  for (i = 0; i < g_iovirt_info_table->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block)) {
+      if (block->type != IOVIRT_NODE_PCI_ROOT_COMPLEX)
+          continue;
+      for (dup = 0, rc = &g_iovirt_info_table->blocks[0], k = 0; k < i && !dup;
+           k++, rc = IOVIRT_NEXT_BLOCK(rc))
+          dup = (rc->type == IOVIRT_NODE_PCI_ROOT_COMPLEX) &&
+                (rc->data.rc.segment == block->data.rc.segment);
+      if (dup)
+          continue;
+      for (j = 0, map = &block->data_map[0]; j < block->num_data_map; j++, map++, r++) {
+          r->key = block->data.rc.segment;
+          r->in_base = (*map).map.input_base;
+          r->in_end = (*map).map.input_base + (*map).map.id_count;
+          r->out_base = (*map).map.output_base;
+          r->out_ref = (*map).map.output_ref;
+      }
+  }
+  g_iovirt_id_cache.num_rid = r - g_iovirt_id_cache.range;
+
+  block = &g_iovirt_info_table->blocks[0];
+  for (i = 0; i < g_iovirt_info_table->num_blocks; i++, block = IOVIRT_NEXT_BLOCK(block)) {
+      if (block->type != IOVIRT_NODE_SMMU && block->type != IOVIRT_NODE_SMMU_V3)
+          continue;
+      for (j = 0, map = &block->data_map[0]; j < block->num_data_map; j++, map++, r++) {
+          r->key = (uint8_t *)block - (uint8_t *)g_iovirt_info_table;
+          r->in_base = (*map).map.input_base;
+          r->in_end = (*map).map.input_base + (*map).map.id_count;
+          r->out_base = (*map).map.output_base;
+          r->out_ref = (*map).map.output_ref;
+      }
+  }
+  g_iovirt_id_cache.num_sid = num_sid;
+
+  iovirt_id_range_sort(g_iovirt_id_cache.range, g_iovirt_id_cache.num_rid);
+  iovirt_id_range_sort(g_iovirt_id_cache.range + g_iovirt_id_cache.num_rid, num_sid);
+
+  /* Overlapping maps resolve by table order in the walk, which sorting loses */
+  if (iovirt_id_range_overlap(g_iovirt_id_cache.range, g_iovirt_id_cache.num_rid) ||
+      iovirt_id_range_overlap(g_iovirt_id_cache.range + g_iovirt_id_cache.num_rid, num_sid)) {
+      val_print(ACS_PRINT_INFO, "\n IOVIRT: overlapping ID maps, using the block walk", 0);
+      return;
+  }
+
+  if (iovirt_id_cache_self_check()) {
+      val_print(ACS_PRINT_WARN, "\n IOVIRT: ID range tables disabled", 0);
+      return;
+  }
+
+  g_iovirt_id_cache.valid = 1;
+  val_print(ACS_PRINT_INFO, "\n IOVIRT: %d requester ID ranges cached",
+            g_iovirt_id_cache.num_rid);
+}
+
+static void
+iovirt_id_cache_free(void)
+{
+  val_print(ACS_PRINT_INFO, "\n IOVIRT: %d requester ID lookups", g_iovirt_id_cache.lookups);
+  val_print(ACS_PRINT_INFO, ", %d by block walk \n", g_iovirt_id_cache.walks);
+
+  if (g_iovirt_id_cache.range)
+      pal_mem_free(g_iovirt_id_cache.range);
+  g_iovirt_id_cache.range = NULL;
+  g_iovirt_id_cache.num_rid = 0;
+  g_iovirt_id_cache.num_sid = 0;
+  g_iovirt_id_cache.valid = 0;
+}
+
+/**
+  @brief  Calculate the device id and stream id orresponding to the requestor id
+  @param  rid          Requestor ID
+  @param  segment      pci_segment_number
+  @param  *device_id   Pointer to device id
+  @param  *stream_id   Pointer to stream id
+  @param  *its_id      Pointer to its id
+  @return status
+**/
+
+int
+val_iovirt_get_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
+                           uint32_t *stream_id, uint32_t *its_id)
+{
+  uint32_t did = 0, sid = 0, itsid = 0;
+  uint32_t status;
+
+  if (g_iovirt_info_table == NULL)
   {
-    val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: Stream ID to Device ID mapping not found\n", 0);
-    return ACS_STATUS_ERR;
+      val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: iovirt info table is not created \n", 0);
+      return ACS_STATUS_ERR;
+  }
+  if (!device_id) {
+      val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: Invalid parameters\n", 0);
+      return ACS_STATUS_ERR;
+  }
+
+  g_iovirt_id_cache.lookups++;
+  if (g_iovirt_id_cache.valid)
+      status = iovirt_cache_device_info(rid, segment, &did, &sid, &itsid);
+  else {
+      g_iovirt_id_cache.walks++;
+      status = iovirt_walk_device_info(rid, segment, &did, &sid, &itsid);
+  }
+
+  switch (status) {
+  case IOVIRT_ID_NO_RID_MAP:
+      val_print(ACS_PRINT_ERR,
+               "GET_DEVICE_ID: Requestor ID to Stream ID/Device ID mapping not found\n", 0);
+      return ACS_STATUS_ERR;
+  case IOVIRT_ID_BAD_RC_MAP:
+      val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: Invalid mapping for RC in IORT\n", 0);
+      return ACS_STATUS_ERR;
+  case IOVIRT_ID_NO_SID_MAP:
+      val_print(ACS_PRINT_ERR, "GET_DEVICE_ID: Stream ID to Device ID mapping not found\n", 0);
+      return ACS_STATUS_ERR;
   }
 
   if (its_id)
@@ -252,6 +532,27 @@ val_iovirt_get_device_info(uint32_t rid, uint32_t segment, uint32_t *device_id,
   return 0;
 }
 
+#ifndef TARGET_LINUX
+/**
+  @brief   Size the IO virtualization info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_iovirt_create_info_table
+**/
+uint32_t
+val_iovirt_get_info_table_size(void)
+{
+  uint32_t num_blocks, num_data_maps = 0;
+
+  /* One spare block: the PAL writes a candidate block before checking for duplicates */
+  num_blocks = pal_iovirt_info_table_entries(&num_data_maps) + 1;
+  g_iovirt_info_size = sizeof(IOVIRT_INFO_TABLE) + num_blocks * sizeof(IOVIRT_BLOCK) +
+                       num_data_maps * sizeof(NODE_DATA_MAP);
+  return g_iovirt_info_size;
+}
+#endif
+
 /**
   @brief   This API will call PAL layer to fill in the IO Virt information
            into the g_iovirt_info_table pointer.
@@ -264,6 +565,8 @@ void
 val_iovirt_create_info_table(uint64_t *iovirt_info_table)
 {
   uint32_t num_smmu;
+  uint32_t i;
+  IOVIRT_BLOCK *block;
 
   if (iovirt_info_table == NULL)
   {
@@ -273,15 +576,32 @@ val_iovirt_create_info_table(uint64_t *iovirt_info_table)
 
   g_iovirt_info_table = (IOVIRT_INFO_TABLE *)iovirt_info_table;
 
-  pal_iovirt_create_info_table(g_iovirt_info_table);
+  val_startup_phase_begin("IOVIRT");
+  if (!val_info_table_is_restored(INFO_TABLE_IOVIRT))
+    pal_iovirt_create_info_table(g_iovirt_info_table, g_iovirt_info_size);
+
+  block = &g_iovirt_info_table->blocks[0];
+  for (i = 0; i < g_iovirt_info_table->num_blocks; i++)
+      block = IOVIRT_NEXT_BLOCK(block);
+  val_startup_phase_end(g_iovirt_info_table->num_blocks,
+                        (uint8_t *)block - (uint8_t *)g_iovirt_info_table);
 
   num_smmu = val_iovirt_get_smmu_info(SMMU_NUM_CTRL, 0);
   val_print(ACS_PRINT_TEST,
             " SMMU_INFO: Number of SMMU CTRL       :    %x \n", num_smmu);
 
+  iovirt_id_cache_build();
+
 #ifndef TARGET_LINUX
   uint32_t instance;
 
+  /* Only the tests that DMA or translate through the SMMUs need them set up */
+  if (!val_test_module_is_selected(ACS_SMMU_TEST_NUM_BASE) &&
+      !val_test_module_is_selected(ACS_PER_TEST_NUM_BASE) &&
+      !val_test_module_is_selected(ACS_PCIE_TEST_NUM_BASE) &&
+      !val_test_module_is_selected(ACS_EXERCISER_TEST_NUM_BASE))
+      return;
+
   val_smmu_init();
 
   /* Disable All SMMU's */
@@ -302,6 +622,7 @@ void
 val_iovirt_free_info_table()
 {
   val_smmu_stop();
+  iovirt_id_cache_free();
   pal_mem_free((void *)g_iovirt_info_table);
 }
 
@@ -23,6 +23,24 @@
 
 MEMORY_INFO_TABLE  *g_memory_info_table;
 
+/* Filled once the table is sorted and coalesced in val_memory_create_info_table */
+static uint32_t     g_memory_num_entries;
+static uint64_t     g_memory_max_addr;
+#if !defined(TARGET_LINUX) || defined(TARGET_LINUX_HOST)
+static uint32_t     g_memory_info_entries = INFO_TABLE_UNSIZED;
+#endif
+
+/* Memory map tests, in run order */
+static const TEST_DESC g_memory_tests[] = {
+#ifndef TARGET_LINUX
+  {ACS_MEMORY_MAP_TEST_BASE + 1, 1, os_m001_entry, TEST_VIEW_OS, TEST_COST_LOW,  0},
+  {ACS_MEMORY_MAP_TEST_BASE + 2, 1, os_m002_entry, TEST_VIEW_OS, TEST_COST_HIGH, 0},
+  {ACS_MEMORY_MAP_TEST_BASE + 3, 1, os_m003_entry, TEST_VIEW_OS, TEST_COST_MID,  0},
+#else
+  {ACS_MEMORY_MAP_TEST_BASE + 4, 1, os_m004_entry, TEST_VIEW_OS, TEST_COST_MID,  0},
+#endif
+};
+
 /**
   @brief   This API will execute all Memory tests designated for a given compliance level
            1. Caller       -  Application layer.
@@ -43,20 +61,13 @@ val_memory_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  status = ACS_STATUS_PASS;
-
-  if (g_sw_view[G_SW_OS]) {
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-#ifndef TARGET_LINUX
-      status |= os_m001_entry(num_pe);
-      status |= os_m002_entry(num_pe);
-      status |= os_m003_entry(num_pe);
-#else
-      status |= os_m004_entry(num_pe);
-#endif
-
+  if (!val_test_module_is_selected(ACS_MEMORY_MAP_TEST_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No Memory tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
+  status = val_run_test_list(g_memory_tests, TEST_LIST_NUM(g_memory_tests), num_pe, g_sw_view, 0);
+
   if (status != ACS_STATUS_PASS)
       val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
   else
@@ -65,7 +76,8 @@ val_memory_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
   return status;
 }
 
-#ifndef TARGET_LINUX
+/* The host PAL describes a memory map, the kernel module has none */
+#if !defined(TARGET_LINUX) || defined(TARGET_LINUX_HOST)
 /**
   @brief  Free the memory allocated for the Memory Info table
 **/
@@ -75,6 +87,73 @@ val_memory_free_info_table()
   pal_mem_free((void *)g_memory_info_table);
 }
 
+/**
+  @brief   Sorts the memory info table by physical address and merges neighbouring
+           regions of the same type so that lookups can binary search it. Also records
+           the number of entries and the highest address.
+           1. Caller       - VAL
+           2. Prerequisite - pal_memory_create_info_table
+  @return  None
+**/
+static void
+val_memory_sort_info_table(void)
+{
+  MEM_INFO_BLOCK  *info = g_memory_info_table->info;
+  MEM_INFO_BLOCK  tmp;
+  uint32_t        num = 0;
+  uint32_t        gap, i, j, last;
+
+  while (info[num].type != MEMORY_TYPE_LAST_ENTRY)
+      num++;
+
+  /* Shell sort, memory maps are mostly in order already */
+  for (gap = num / 2; gap > 0; gap /= 2) {
+      for (i = gap; i < num; i++) {
+          tmp = info[i];
+          for (j = i; (j >= gap) && (info[j - gap].phy_addr > tmp.phy_addr); j -= gap)
+              info[j] = info[j - gap];
+          info[j] = tmp;
+      }
+  }
+
+  /* Merge contiguous regions whose type, attributes and mapping match */
+  last = 0;
+  for (i = 1; i < num; i++) {
+      if ((info[i].type == info[last].type) &&
+          (info[i].flags == info[last].flags) &&
+          (info[i].phy_addr == info[last].phy_addr + info[last].size) &&
+          (info[i].virt_addr == (info[last].virt_addr ?
+                                 info[last].virt_addr + info[last].size : 0))) {
+          info[last].size += info[i].size;
+          continue;
+      }
+      info[++last] = info[i];
+  }
+
+  g_memory_num_entries = num ? last + 1 : 0;
+  info[g_memory_num_entries].type = MEMORY_TYPE_LAST_ENTRY;
+
+  g_memory_max_addr = 0;
+  for (i = 0; i < g_memory_num_entries; i++) {
+      if ((info[i].phy_addr + info[i].size) > g_memory_max_addr)
+          g_memory_max_addr = info[i].phy_addr + info[i].size;
+  }
+}
+
+/**
+  @brief   Size the memory info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_memory_create_info_table
+**/
+uint32_t
+val_memory_get_info_table_size(void)
+{
+  g_memory_info_entries = pal_memory_info_table_entries();
+  return sizeof(MEMORY_INFO_TABLE) + g_memory_info_entries * sizeof(MEM_INFO_BLOCK);
+}
+
 /**
   @brief   This function will call PAL layer to fill all relevant peripheral
            information into the g_peripheral_info_table pointer.
@@ -88,11 +167,16 @@ val_memory_free_info_table()
 void
 val_memory_create_info_table(uint64_t *memory_info_table)
 {
-
   g_memory_info_table = (MEMORY_INFO_TABLE *)memory_info_table;
 
-  pal_memory_create_info_table(g_memory_info_table);
+  val_startup_phase_begin("Memory");
+  pal_memory_create_info_table(g_memory_info_table, g_memory_info_entries);
+
+  val_memory_sort_info_table();
+  val_startup_phase_end(g_memory_num_entries,
+                        sizeof(MEMORY_INFO_TABLE) + (g_memory_num_entries + 1) * sizeof(MEM_INFO_BLOCK));
 
+  val_print(ACS_PRINT_INFO, " MEMORY_INFO: Number of regions      : %4d \n", g_memory_num_entries);
 }
 #endif
 
@@ -111,7 +195,7 @@ val_memory_get_entry_index(uint32_t type, uint32_t instance)
 {
   uint32_t  i = 0;
 
-  while (g_memory_info_table->info[i].type != MEMORY_TYPE_LAST_ENTRY) {
+  while (i < g_memory_num_entries) {
       if (g_memory_info_table->info[i].type == type) {
           if (instance == 0)
              return i;
@@ -177,17 +261,23 @@ uint64_t
 val_memory_get_info(addr_t addr, uint64_t *attr)
 {
 
-  uint32_t index = 0;
-
-  while (g_memory_info_table->info[index].type != MEMORY_TYPE_LAST_ENTRY) {
-      if ((addr >= g_memory_info_table->info[index].phy_addr) &&
-        (addr < (g_memory_info_table->info[index].phy_addr +
-        g_memory_info_table->info[index].size))) {
-          *attr =  g_memory_info_table->info[index].flags;
-          return g_memory_info_table->info[index].type;
-       }
-       index++;
-      // val_print(ACS_PRINT_INFO," .", 0);
+  MEM_INFO_BLOCK *info = g_memory_info_table->info;
+  uint32_t low = 0;
+  uint32_t high = g_memory_num_entries;
+  uint32_t mid;
+
+  /* Find the last region starting at or below addr */
+  while (low < high) {
+      mid = low + (high - low) / 2;
+      if (info[mid].phy_addr <= addr)
+          low = mid + 1;
+      else
+          high = mid;
+  }
+
+  if ((low > 0) && (addr < (info[low - 1].phy_addr + info[low - 1].size))) {
+      *attr = info[low - 1].flags;
+      return info[low - 1].type;
   }
 
   return MEM_TYPE_NOT_POPULATED;
@@ -205,16 +295,7 @@ uint64_t
 val_get_max_memory()
 {
 
-  uint32_t index = 0;
-  uint64_t addr = 0;
-
-  while (g_memory_info_table->info[index].type != MEMORY_TYPE_LAST_ENTRY) {
-      if ((g_memory_info_table->info[index].phy_addr) > addr)
-              addr = (g_memory_info_table->info[index].phy_addr +
-                      g_memory_info_table->info[index].size);
-      index++;
-  }
-  return addr;
+  return g_memory_max_addr;
 
 }
 
@@ -281,7 +362,15 @@ val_memory_phys_to_virt(uint64_t pa)
 uint64_t
 val_memory_get_unpopulated_addr(addr_t *addr, uint32_t instance)
 {
-  return pal_memory_get_unpopulated_addr(addr, instance);
+  uint64_t base = 0;
+  uint64_t status;
+
+  /* addr_t is signed on Linux, the PAL fills an unsigned address */
+  status = pal_memory_get_unpopulated_addr(&base, instance);
+  if (status == 0)
+      *addr = base;
+
+  return status;
 }
 
 uint32_t val_memory_page_size(void)
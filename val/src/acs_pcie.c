@@ -23,6 +23,7 @@
 
 #define WARN_STR_LEN 7
 PCIE_INFO_TABLE *g_pcie_info_table;
+static uint32_t g_pcie_info_entries = INFO_TABLE_UNSIZED;
 pcie_device_bdf_table *g_pcie_bdf_table;
 
 uint64_t
@@ -249,6 +250,58 @@ void val_pcie_enumerate(void)
   pal_pcie_enumerate();
 }
 
+/* PCIe tests, in run order */
+static const TEST_DESC g_pcie_tests[] = {
+  {ACS_PCIE_TEST_NUM_BASE + 1,  1, os_p001_entry, TEST_VIEW_OS, TEST_COST_LOW,  0, TEST_FLAG_GATE},
+#ifdef TARGET_LINUX
+  {ACS_PCIE_TEST_NUM_BASE + 5,  1, os_p005_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 6,  1, os_p006_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 7,  1, os_p007_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 11, 1, os_p011_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 12, 1, os_p012_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 16, 1, os_p016_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+#else
+  {ACS_PCIE_TEST_NUM_BASE + 2,  1, os_p002_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 20, 1, os_p020_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 21, 1, os_p021_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 22, 1, os_p022_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 23, 1, os_p023_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 24, 1, os_p024_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 25, 1, os_p025_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 26, 1, os_p026_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 27, 1, os_p027_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 28, 1, os_p028_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 29, 1, os_p029_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 30, 1, os_p030_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 31, 1, os_p031_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 32, 1, os_p032_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 33, 1, os_p033_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 34, 1, os_p034_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 35, 1, os_p035_entry, TEST_VIEW_OS, TEST_COST_HIGH, TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 36, 1, os_p036_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 37, 1, os_p037_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 38, 1, os_p038_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 39, 1, os_p039_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 41, 1, os_p041_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 42, 1, os_p042_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 44, 1, os_p044_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 48, 1, os_p048_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 50, 1, os_p050_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 51, 1, os_p051_entry, TEST_VIEW_OS, TEST_COST_HIGH, TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 52, 1, os_p052_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 53, 1, os_p053_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 54, 1, os_p054_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 55, 1, os_p055_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 56, 1, os_p056_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 57, 1, os_p057_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 58, 1, os_p058_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 59, 1, os_p059_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 60, 1, os_p060_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 61, 1, os_p061_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+  {ACS_PCIE_TEST_NUM_BASE + 62, 1, os_p062_entry, TEST_VIEW_OS, TEST_COST_MID,  TEST_NEEDS_PCIE_DEV},
+#endif
+};
+
 /**
   @brief   This API executes all the PCIe tests sequentially
            1. Caller       -  Application layer.
@@ -271,6 +324,11 @@ val_pcie_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
+  if (!val_test_module_is_selected(ACS_PCIE_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No PCIe tests selected \n", 0);
+      return ACS_STATUS_SKIP;
+  }
+
   num_ecam = val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
   if (!num_ecam) {
       val_print(ACS_PRINT_WARN, "\n     *** No ECAM region found, Skipping PCIE tests *** \n", 0);
@@ -284,71 +342,13 @@ val_pcie_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       val_print(ACS_PRINT_ERR, "    : Result:  PASS", 0);
       val_print(ACS_PRINT_ERR, "\n       RE_CFG_1: Recognise RW request in ECAM reg          ", 0);
       val_print(ACS_PRINT_ERR, "    : Result:  PASS", 0);
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-
-      status |= os_p001_entry(num_pe);
-      if (status != ACS_STATUS_PASS) {
-        val_print(ACS_PRINT_WARN, "\n     *** Skipping remaining PCIE tests *** \n", 0);
-        return status;
-      }
   }
 
-  if (g_pcie_bdf_table->num_entries == 0) {
+  if (g_pcie_bdf_table->num_entries == 0)
       val_print(ACS_PRINT_WARN, "\n     *** No Valid Devices Found, Skipping PCIE tests *** \n", 0);
-      return ACS_STATUS_SKIP;
-  }
 
-  if (g_sw_view[G_SW_OS]) {
-#ifdef TARGET_LINUX
-      status |= os_p005_entry(num_pe);
-      status |= os_p006_entry(num_pe);
-      status |= os_p007_entry(num_pe);
-      status |= os_p011_entry(num_pe);
-      status |= os_p012_entry(num_pe);
-      status |= os_p016_entry(num_pe);
-#else
-      status |= os_p002_entry(num_pe);
-      status |= os_p020_entry(num_pe);
-      status |= os_p021_entry(num_pe);
-      status |= os_p022_entry(num_pe);
-      status |= os_p023_entry(num_pe);
-      status |= os_p024_entry(num_pe);
-      status |= os_p025_entry(num_pe);
-      status |= os_p026_entry(num_pe);
-      status |= os_p027_entry(num_pe);
-      status |= os_p028_entry(num_pe);
-      status |= os_p029_entry(num_pe);
-      status |= os_p030_entry(num_pe);
-      status |= os_p031_entry(num_pe);
-      status |= os_p032_entry(num_pe);
-      status |= os_p033_entry(num_pe);
-      status |= os_p034_entry(num_pe);
-      status |= os_p035_entry(num_pe);
-      status |= os_p036_entry(num_pe);
-      status |= os_p037_entry(num_pe);
-      status |= os_p038_entry(num_pe);
-      status |= os_p039_entry(num_pe);
-      status |= os_p041_entry(num_pe);
-      status |= os_p042_entry(num_pe);
-      status |= os_p044_entry(num_pe);
-      status |= os_p048_entry(num_pe);
-      status |= os_p050_entry(num_pe);
-      status |= os_p051_entry(num_pe);
-      status |= os_p052_entry(num_pe);
-      status |= os_p053_entry(num_pe);
-      status |= os_p054_entry(num_pe);
-      status |= os_p055_entry(num_pe);
-      status |= os_p056_entry(num_pe);
-      status |= os_p057_entry(num_pe);
-      status |= os_p058_entry(num_pe);
-      status |= os_p059_entry(num_pe);
-      status |= os_p060_entry(num_pe);
-      status |= os_p061_entry(num_pe);
-      status |= os_p062_entry(num_pe);
-
-#endif
-
-  }
+  status = val_run_test_list(g_pcie_tests, TEST_LIST_NUM(g_pcie_tests), num_pe, g_sw_view,
+                             g_pcie_bdf_table->num_entries ? TEST_NEEDS_PCIE_DEV : 0);
 
   if (status != ACS_STATUS_PASS)
     val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
@@ -441,6 +441,55 @@ val_pcie_print_device_info(void)
   }
 }
 
+#ifndef TARGET_LINUX
+/**
+  @brief   Size the PCIe info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_pcie_create_info_table
+**/
+uint32_t
+val_pcie_get_info_table_size(void)
+{
+  g_pcie_info_entries = pal_pcie_info_table_entries();
+  return sizeof(PCIE_INFO_TABLE) + g_pcie_info_entries * sizeof(PCIE_INFO_BLOCK);
+}
+#endif
+
+/**
+  @brief  Check that a BDF table restored from a snapshot still describes the
+          devices present, by reading back the vendor and device ID of each
+          function. A table that does not match is dropped, to be rebuilt.
+
+  @param  None
+  @return None
+**/
+static void
+val_pcie_check_saved_bdf_table(void)
+{
+  uint32_t i;
+  uint32_t reg_value;
+
+  if ((g_pcie_bdf_table == NULL) || !val_info_table_is_restored(INFO_TABLE_PCIE_BDF))
+      return;
+
+  if (g_pcie_bdf_table->num_entries <= PCIE_DEVICE_BDF_TABLE_MAX) {
+      for (i = 0; i < g_pcie_bdf_table->num_entries; i++) {
+          if (val_pcie_read_cfg(g_pcie_bdf_table->device[i].bdf, TYPE01_VIDR, &reg_value) ||
+              (reg_value != g_pcie_bdf_table->device[i].id))
+              break;
+      }
+      if (i == g_pcie_bdf_table->num_entries)
+          return;
+  }
+
+  val_print(ACS_PRINT_TEST, " PCIE_INFO: Devices differ from the snapshot, enumerating again \n", 0);
+  pal_mem_free(g_pcie_bdf_table);
+  g_pcie_bdf_table = NULL;
+  val_info_table_discard(INFO_TABLE_PCIE_BDF);
+}
+
 /**
   @brief   This API will call PAL layer to fill in the PCIe information
            into the g_pcie_info_table pointer.
@@ -462,21 +511,40 @@ val_pcie_create_info_table(uint64_t *pcie_info_table)
 
   g_pcie_info_table = (PCIE_INFO_TABLE *)pcie_info_table;
 
-  pal_pcie_create_info_table(g_pcie_info_table);
+  val_startup_phase_begin("PCIe");
+  if (!val_info_table_is_restored(INFO_TABLE_PCIE))
+    pal_pcie_create_info_table(g_pcie_info_table, g_pcie_info_entries);
 
   num_ecam = val_pcie_get_info(PCIE_INFO_NUM_ECAM, 0);
+  val_startup_phase_end(num_ecam, sizeof(PCIE_INFO_TABLE) + num_ecam * sizeof(PCIE_INFO_BLOCK));
+
+  val_pcie_check_saved_bdf_table();
 
   val_print(ACS_PRINT_TEST, " PCIE_INFO: Number of ECAM regions    :    %lx \n", num_ecam);
   if (num_ecam == 0)
       return;
 
+  /* Only the PCIe, exerciser and memory map tests walk the device list */
+  if (!val_test_module_is_selected(ACS_PCIE_TEST_NUM_BASE) &&
+      !val_test_module_is_selected(ACS_EXERCISER_TEST_NUM_BASE) &&
+      !val_test_module_is_selected(ACS_MEMORY_MAP_TEST_BASE)) {
+      val_print(ACS_PRINT_TEST, " PCIE_INFO: No PCIe tests selected, not enumerating \n", 0);
+      return;
+  }
+
+  val_startup_phase_begin("PCIe enumeration");
   val_pcie_enumerate();
+  val_startup_phase_end(0, 0);
 
   /* Create the list of valid Pcie Device Functions */
+  val_startup_phase_begin("PCIe BDF table");
   if (val_pcie_create_device_bdf_table()) {
+      val_startup_phase_end(0, 0);
       val_print(ACS_PRINT_ERR, " Create Bdf table failed.\n", 0);
       return;
   }
+  val_startup_phase_end(g_pcie_bdf_table->num_entries, sizeof(pcie_device_bdf_table) +
+                        g_pcie_bdf_table->num_entries * sizeof(pcie_device_attr));
 
   val_pcie_print_device_info();
 }
@@ -596,6 +664,12 @@ val_pcie_create_device_bdf_table()
                       if (p_cap != PCIE_SUCCESS)
                           continue;
 
+                      if (g_pcie_bdf_table->num_entries == PCIE_DEVICE_BDF_TABLE_MAX) {
+                          val_print(ACS_PRINT_WARN,
+                            "\n       BDF table full, ignoring 0x%x", bdf);
+                          continue;
+                      }
+                      g_pcie_bdf_table->device[g_pcie_bdf_table->num_entries].id = reg_value;
                       g_pcie_bdf_table->device[g_pcie_bdf_table->num_entries++].bdf = bdf;
                   }
                   else
@@ -679,6 +753,22 @@ val_pcie_bdf_table_ptr()
   return g_pcie_bdf_table;
 }
 
+/**
+  @brief   Adopt a BDF table saved by an earlier run, so that val_pcie_create_device_bdf_table
+           does not scan the ECAM again. val_pcie_create_info_table checks it against the
+           devices present first. The table must be PCIE_DEVICE_BDF_TABLE_SZ bytes and
+           allocated from the pool pal_mem_free returns memory to.
+
+  @param   bdf_table  BDF table restored by the application
+
+  @return  None
+**/
+void
+val_pcie_set_bdf_table(void *bdf_table)
+{
+  g_pcie_bdf_table = (pcie_device_bdf_table *)bdf_table;
+}
+
 /**
   @brief  Free the memory allocated for the pcie_info_table
 **/
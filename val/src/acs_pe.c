@@ -31,6 +31,36 @@ extern PE_INFO_TABLE *g_pe_info_table;
 extern ARM_SMC_ARGS g_smc_args;
 
 
+/* PE tests, in run order */
+static const TEST_DESC g_pe_tests[] = {
+  {ACS_PE_TEST_NUM_BASE + 1,     1, os_c001_entry,  TEST_VIEW_OS,  TEST_COST_HIGH, 0},
+  {ACS_PE_TEST_NUM_BASE + 2,     1, os_c002_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 3,     1, os_c003_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 4,     1, os_c004_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 5,     1, os_c005_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 6,     1, os_c006_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 7,     1, os_c007_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 8,     1, os_c008_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 9,     1, os_c009_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 10,    1, os_c010_entry,  TEST_VIEW_OS,  TEST_COST_HIGH, 0},
+  {ACS_PE_TEST_NUM_BASE + 11,    1, os_c011_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 12,    1, os_c012_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 13,    1, os_c013_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 14,    1, os_c014_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 15,    1, os_c015_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 16,    1, os_c016_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 17,    1, os_c017_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 18,    1, os_c018_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 19,    1, os_c019_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_TEST_NUM_BASE + 20,    1, os_c020_entry,  TEST_VIEW_OS,  TEST_COST_LOW,  0},
+  {ACS_PE_HYP_TEST_NUM_BASE + 1, 1, hyp_c001_entry, TEST_VIEW_HYP, TEST_COST_LOW,  0},
+  {ACS_PE_HYP_TEST_NUM_BASE + 2, 1, hyp_c002_entry, TEST_VIEW_HYP, TEST_COST_LOW,  0},
+  {ACS_PE_HYP_TEST_NUM_BASE + 3, 1, hyp_c003_entry, TEST_VIEW_HYP, TEST_COST_LOW,  0},
+  {ACS_PE_HYP_TEST_NUM_BASE + 4, 1, hyp_c004_entry, TEST_VIEW_HYP, TEST_COST_LOW,  0},
+  {ACS_PE_HYP_TEST_NUM_BASE + 5, 1, hyp_c005_entry, TEST_VIEW_HYP, TEST_COST_LOW,  0},
+  {ACS_PE_PS_TEST_NUM_BASE + 1,  1, ps_c001_entry,  TEST_VIEW_PS,  TEST_COST_LOW,  0},
+};
+
 /**
   @brief   This API will execute all PE tests designated for a given compliance level
            1. Caller       -  Application layer.
@@ -50,45 +80,12 @@ val_pe_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  status = ACS_STATUS_PASS;
-
-  if (g_sw_view[G_SW_OS]) {
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-      status |= os_c001_entry(num_pe);
-      status |= os_c002_entry(num_pe);
-      status |= os_c003_entry(num_pe);
-      status |= os_c004_entry(num_pe);
-      status |= os_c005_entry(num_pe);
-      status |= os_c006_entry(num_pe);
-      status |= os_c007_entry(num_pe);
-      status |= os_c008_entry(num_pe);
-      status |= os_c009_entry(num_pe);
-      status |= os_c010_entry(num_pe);
-      status |= os_c011_entry(num_pe);
-      status |= os_c012_entry(num_pe);
-      status |= os_c013_entry(num_pe);
-      status |= os_c014_entry(num_pe);
-      status |= os_c015_entry(num_pe);
-      status |= os_c016_entry(num_pe);
-      status |= os_c017_entry(num_pe);
-      status |= os_c018_entry(num_pe);
-      status |= os_c019_entry(num_pe);
-      status |= os_c020_entry(num_pe);
-  }
-
-  if (g_sw_view[G_SW_HYP]) {
-      val_print(ACS_PRINT_ERR, "\nHypervisor:\n", 0);
-      status |= hyp_c001_entry(num_pe);
-      status |= hyp_c002_entry(num_pe);
-      status |= hyp_c003_entry(num_pe);
-      status |= hyp_c004_entry(num_pe);
-      status |= hyp_c005_entry(num_pe);
+  if (!val_test_module_is_selected(ACS_PE_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No PE tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
-  if (g_sw_view[G_SW_PS]) {
-      val_print(ACS_PRINT_ERR, "\nPlatform Security:\n", 0);
-      status |= ps_c001_entry(num_pe);
-  }
+  status = val_run_test_list(g_pe_tests, TEST_LIST_NUM(g_pe_tests), num_pe, g_sw_view, 0);
 
   if (status != ACS_STATUS_PASS)
       val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
@@ -25,12 +25,29 @@
   @brief   Pointer to the memory location of the PE Information table
 **/
 PE_INFO_TABLE *g_pe_info_table;
+static uint32_t g_pe_info_entries = INFO_TABLE_UNSIZED;
 /**
   @brief   global structure to pass and retrieve arguments for the SMC call
 **/
 ARM_SMC_ARGS g_smc_args;
 
 
+#ifndef TARGET_LINUX
+/**
+  @brief   Size the PE info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_pe_create_info_table
+**/
+uint32_t
+val_pe_get_info_table_size(void)
+{
+  g_pe_info_entries = pal_pe_info_table_entries();
+  return sizeof(PE_INFO_TABLE) + g_pe_info_entries * sizeof(PE_INFO_ENTRY);
+}
+#endif
+
 /**
   @brief   This API will call PAL layer to fill in the PE information
            into the g_pe_info_table pointer.
@@ -50,8 +67,11 @@ val_pe_create_info_table(uint64_t *pe_info_table)
 
   g_pe_info_table = (PE_INFO_TABLE *)pe_info_table;
 
-  pal_pe_create_info_table(g_pe_info_table);
+  val_startup_phase_begin("PE");
+  pal_pe_create_info_table(g_pe_info_table, g_pe_info_entries);
   val_data_cache_ops_by_va((addr_t)&g_pe_info_table, CLEAN_AND_INVALIDATE);
+  val_startup_phase_end(val_pe_get_num(),
+                        sizeof(PE_INFO_TABLE) + val_pe_get_num() * sizeof(PE_INFO_ENTRY));
 
   val_print(ACS_PRINT_TEST, " PE_INFO: Number of PE detected       : %4d \n", val_pe_get_num());
 
@@ -21,6 +21,18 @@
 #include "include/bsa_acs_pcie.h"
 
 PERIPHERAL_INFO_TABLE  *g_peripheral_info_table;
+static uint32_t g_peripheral_info_entries = INFO_TABLE_UNSIZED;
+
+/* Peripheral tests, in run order */
+static const TEST_DESC g_peripheral_tests[] = {
+#ifndef TARGET_LINUX
+  {ACS_PER_TEST_NUM_BASE + 1, 1, os_d001_entry, TEST_VIEW_OS, TEST_COST_MID,  0},
+  {ACS_PER_TEST_NUM_BASE + 2, 1, os_d002_entry, TEST_VIEW_OS, TEST_COST_MID,  0},
+  {ACS_PER_TEST_NUM_BASE + 3, 2, os_d003_entry, TEST_VIEW_OS, TEST_COST_HIGH, 0},
+#else
+  {ACS_PER_TEST_NUM_BASE + 5, 1, os_d004_entry, TEST_VIEW_OS, TEST_COST_MID,  0},
+#endif
+};
 
 /**
   @brief  Sequentially execute all the peripheral tests
@@ -45,17 +57,13 @@ val_peripheral_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  if (g_sw_view[G_SW_OS]) {
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-#ifndef TARGET_LINUX
-      status |= os_d001_entry(num_pe);
-      status |= os_d002_entry(num_pe);
-      status |= os_d003_entry(num_pe);
-#else
-      status |= os_d004_entry(num_pe);
-#endif
+  if (!val_test_module_is_selected(ACS_PER_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No Peripheral tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
+  status = val_run_test_list(g_peripheral_tests, TEST_LIST_NUM(g_peripheral_tests), num_pe, g_sw_view, 0);
+
   if (status != ACS_STATUS_PASS)
     val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
   else
@@ -206,6 +214,22 @@ val_peripheral_get_info(PERIPHERAL_INFO_e info_type, uint32_t instance)
   return 0;
 }
 
+#ifndef TARGET_LINUX
+/**
+  @brief   Size the peripheral info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_peripheral_create_info_table
+**/
+uint32_t
+val_peripheral_get_info_table_size(void)
+{
+  g_peripheral_info_entries = pal_peripheral_info_table_entries();
+  return sizeof(PERIPHERAL_INFO_TABLE) + g_peripheral_info_entries * sizeof(PERIPHERAL_INFO_BLOCK);
+}
+#endif
+
 /*
  * val_create_peripheralinfo_table:
  *    Caller         Application layer.
@@ -227,9 +251,18 @@ void
 val_peripheral_create_info_table(uint64_t *peripheral_info_table)
 {
 
+  uint32_t num_entries;
+
   g_peripheral_info_table = (PERIPHERAL_INFO_TABLE *)peripheral_info_table;
 
-  pal_peripheral_create_info_table(g_peripheral_info_table);
+  val_startup_phase_begin("Peripheral");
+  if (!val_info_table_is_restored(INFO_TABLE_PERIPHERAL))
+    pal_peripheral_create_info_table(g_peripheral_info_table, g_peripheral_info_entries);
+
+  num_entries = g_peripheral_info_table->header.num_usb + g_peripheral_info_table->header.num_sata +
+                g_peripheral_info_table->header.num_uart;
+  val_startup_phase_end(num_entries, sizeof(PERIPHERAL_INFO_TABLE) +
+                        (num_entries + 1) * sizeof(PERIPHERAL_INFO_BLOCK));
 
   val_print(ACS_PRINT_TEST, " Peripheral: Num of USB controllers   :    %d \n",
     val_peripheral_get_info(NUM_USB, 0));
@@ -20,14 +20,24 @@
 
 #include "include/bsa_acs_pgt.h"
 #include "include/bsa_acs_memory.h"
+#ifndef TARGET_LINUX_HOST
+#include "include/bsa_acs_timer_support.h"
+#endif
 
 #define get_min(a, b) ((a) < (b))?(a):(b)
 
 #define PGT_DEBUG_LEVEL ACS_PRINT_INFO
 
-static uint32_t page_size;
-static uint32_t bits_per_level;
-static uint64_t pgt_addr_mask;
+/* Contexts backing the val_pgt_create/val_pgt_destroy interface, found again
+ * from pgt_base on destroy. The pool doubles when every context is in use and
+ * is freed with the last one. It is not locked, so that interface is for the
+ * primary PE; callers that build tables concurrently use their own
+ * pgt_context_t with the val_pgt_context_* interface instead.
+ */
+#define PGT_POOL_INIT_CONTEXTS 16
+
+static pgt_context_t *pgt_context_pool;
+static uint32_t pgt_context_pool_size;
 
 typedef struct
 {
@@ -40,10 +50,118 @@ typedef struct
     uint32_t nbits;
 } tt_descriptor_t;
 
-uint32_t fill_translation_table(tt_descriptor_t tt_desc, memory_region_descriptor_t *mem_desc)
+static uint32_t pgt_arena_reserve(pgt_context_t *ctx, uint32_t num_pages)
+{
+    pgt_arena_t *arena = &ctx->arena;
+
+    arena->base = ctx->alloc_pages(num_pages);
+    if (arena->base == NULL)
+        return ACS_STATUS_ERR;
+
+    val_memory_set(arena->base, num_pages * ctx->page_size, 0);
+    arena->num_pages = num_pages;
+    arena->used_pages = 0;
+    arena->pgt_base = 0;
+    return 0;
+}
+
+static uint64_t *pgt_arena_alloc_page(pgt_context_t *ctx)
+{
+    pgt_arena_t *arena = &ctx->arena;
+    uint64_t *page;
+
+    if (arena->used_pages == arena->num_pages)
+        return NULL;
+
+    page = (uint64_t *)((uint8_t *)arena->base + (uint64_t)arena->used_pages * ctx->page_size);
+    arena->used_pages++;
+    return page;
+}
+
+static void pgt_arena_release(pgt_context_t *ctx)
+{
+    pgt_arena_t *arena = &ctx->arena;
+
+    val_memory_set(&ctx->walk_cache, sizeof(ctx->walk_cache), 0);
+
+    if (arena->base != NULL)
+        ctx->free_pages(arena->base, arena->num_pages);
+    arena->base = NULL;
+    arena->pgt_base = 0;
+    arena->num_pages = 0;
+    arena->used_pages = 0;
+}
+
+static pgt_context_t *pgt_context_get(void)
+{
+    pgt_context_t *pool;
+    uint32_t index, size;
+
+    for (index = 0; index < pgt_context_pool_size; index++)
+    {
+        if (pgt_context_pool[index].arena.base == NULL)
+            return &pgt_context_pool[index];
+    }
+
+    size = pgt_context_pool_size ? pgt_context_pool_size * 2 : PGT_POOL_INIT_CONTEXTS;
+    pool = val_memory_alloc(size * sizeof(pgt_context_t));
+    if (pool == NULL)
+        return NULL;
+
+    val_memory_set(pool, size * sizeof(pgt_context_t), 0);
+    for (index = 0; index < pgt_context_pool_size; index++)
+        pool[index] = pgt_context_pool[index];
+    if (pgt_context_pool)
+        val_memory_free(pgt_context_pool);
+
+    pgt_context_pool = pool;
+    pgt_context_pool_size = size;
+    return &pgt_context_pool[index];
+}
+
+static void pgt_context_put(pgt_context_t *ctx)
+{
+    uint32_t index;
+
+    val_pgt_context_destroy(ctx);
+
+    for (index = 0; index < pgt_context_pool_size; index++)
+    {
+        if (pgt_context_pool[index].arena.base != NULL)
+            return;
+    }
+
+    val_memory_free(pgt_context_pool);
+    pgt_context_pool = NULL;
+    pgt_context_pool_size = 0;
+}
+
+static uint64_t pgt_counter_read(uint64_t *freq)
+{
+#ifdef TARGET_LINUX_HOST
+    return pal_host_counter_read(freq);
+#else
+    if (freq)
+        *freq = val_timer_get_info(TIMER_INFO_CNTFREQ, 0);
+    return ArmArchTimerReadReg(CntPct);
+#endif
+}
+
+static uint64_t pgt_elapsed_us(uint64_t start)
+{
+    uint64_t freq;
+    uint64_t now = pgt_counter_read(&freq);
+
+    if (freq == 0)
+        return 0;
+    return ((now - start) * 1000000) / freq;
+}
+
+uint32_t fill_translation_table(pgt_context_t *ctx, tt_descriptor_t tt_desc,
+                                memory_region_descriptor_t *mem_desc)
 {
     uint64_t block_size = 0x1ull << tt_desc.size_log2;
-    uint64_t input_address, output_address, table_index, *tt_base_next_level, *table_desc;
+    uint64_t input_address, output_address, input_next, table_index, *tt_base_next_level, *table_desc;
     tt_descriptor_t tt_desc_next_level;
 
     val_print(PGT_DEBUG_LEVEL, "\n      tt_desc.level: %d     ", tt_desc.level);
@@ -53,10 +171,13 @@ uint32_t fill_translation_table(tt_descriptor_t tt_desc, memory_region_descripto
     val_print(PGT_DEBUG_LEVEL, "\n      tt_desc.size_log2: %d     ", tt_desc.size_log2);
     val_print(PGT_DEBUG_LEVEL, "\n      tt_desc.nbits: %d     ", tt_desc.nbits);
 
+    /* Step window by window, so an unaligned base still places each address in
+       the entry that covers it */
     for (input_address = tt_desc.input_base, output_address = tt_desc.output_base;
          input_address < tt_desc.input_top;
-         input_address += block_size, output_address += block_size)
+         output_address += input_next - input_address, input_address = input_next)
     {
+        input_next = (input_address | (block_size - 1)) + 1;
         table_index = input_address >> tt_desc.size_log2 & ((0x1ull << tt_desc.nbits) - 1);
         table_desc = &tt_desc.tt_base[table_index];
 
@@ -66,7 +187,7 @@ uint32_t fill_translation_table(tt_descriptor_t tt_desc, memory_region_descripto
         {
             //Create level 3 page descriptor entry
             *table_desc = PGT_ENTRY_PAGE_MASK | PGT_ENTRY_VALID_MASK;
-            *table_desc |= (output_address & ~(page_size - 1));
+            *table_desc |= (output_address & ~(uint64_t)(ctx->page_size - 1));
             *table_desc |= mem_desc->attributes;
             val_print(PGT_DEBUG_LEVEL, "\n      page_descriptor = 0x%llx     ", *table_desc);
             continue;
@@ -90,33 +211,29 @@ uint32_t fill_translation_table(tt_descriptor_t tt_desc, memory_region_descripto
         */
         if (*table_desc == 0 || IS_PGT_ENTRY_BLOCK(*table_desc))
         {
-            tt_base_next_level = val_memory_alloc_pages(1);
+            tt_base_next_level = pgt_arena_alloc_page(ctx);
             if (tt_base_next_level == NULL)
             {
                 val_print(ACS_PRINT_ERR, "\n      fill_translation_table: page allocation failed     ", 0);
                 return ACS_STATUS_ERR;
             }
-            val_memory_set(tt_base_next_level, page_size, 0);
         }
         else
-            tt_base_next_level = val_memory_phys_to_virt(*table_desc & pgt_addr_mask);
+            tt_base_next_level = ctx->phys_to_virt(*table_desc & ctx->addr_mask);
 
         tt_desc_next_level.tt_base = tt_base_next_level;
         tt_desc_next_level.input_base = input_address;
-        tt_desc_next_level.input_top = get_min(tt_desc.input_top, (input_address + block_size - 1));
+        tt_desc_next_level.input_top = get_min(tt_desc.input_top, input_next - 1);
         tt_desc_next_level.output_base = output_address;
         tt_desc_next_level.level = tt_desc.level + 1;
-        tt_desc_next_level.size_log2 = tt_desc.size_log2 - bits_per_level;
-        tt_desc_next_level.nbits = bits_per_level;
+        tt_desc_next_level.size_log2 = tt_desc.size_log2 - ctx->bits_per_level;
+        tt_desc_next_level.nbits = ctx->bits_per_level;
 
-        if (fill_translation_table(tt_desc_next_level, mem_desc))
-        {
-            val_memory_free_pages(tt_base_next_level, 1);
+        if (fill_translation_table(ctx, tt_desc_next_level, mem_desc))
             return ACS_STATUS_ERR;
-        }
 
         *table_desc = PGT_ENTRY_TABLE_MASK | PGT_ENTRY_VALID_MASK;
-        *table_desc |= (uint64_t)val_memory_virt_to_phys(tt_base_next_level) & ~(page_size - 1);
+        *table_desc |= (uint64_t)ctx->virt_to_phys(tt_base_next_level) & ~(uint64_t)(ctx->page_size - 1);
         val_print(PGT_DEBUG_LEVEL, "\n      table_descriptor = 0x%llx     ", *table_desc);
     }
     return 0;
@@ -136,162 +253,363 @@ uint32_t log2_page_size(uint64_t size)
 }
 
 /**
-  @brief Create stage 1 or stage 2 page table, with given memory addresses and attributes
+  @brief Initialise a translation table context for a granule and input address size.
+         The allocator and address conversion hooks default to the VAL memory APIs and
+         may be replaced by the caller before the context is used.
+  @param ctx - context to initialise.
+  @param page_size_log2 - log2 of the translation granule.
+  @param ias - input address size in bits.
+  @return status
+**/
+uint32_t val_pgt_context_init(pgt_context_t *ctx, uint32_t page_size_log2, uint32_t ias)
+{
+    if ((ctx == NULL) || (page_size_log2 <= 3) || (ias <= page_size_log2))
+        return ACS_STATUS_ERR;
+
+    ctx->page_size_log2 = page_size_log2;
+    ctx->page_size = 0x1u << page_size_log2;
+    ctx->bits_per_level = page_size_log2 - 3;
+    ctx->ias = ias;
+    ctx->num_levels = (ias - page_size_log2 + ctx->bits_per_level - 1)/ctx->bits_per_level;
+    ctx->addr_mask = ((0x1ull << (48 - page_size_log2)) - 1) << page_size_log2;
+
+    ctx->arena.base = NULL;
+    ctx->arena.pgt_base = 0;
+    ctx->arena.num_pages = 0;
+    ctx->arena.used_pages = 0;
+
+    val_memory_set(&ctx->walk_cache, sizeof(ctx->walk_cache), 0);
+    val_memory_set(&ctx->walk_stats, sizeof(ctx->walk_stats), 0);
+
+    ctx->alloc_pages = val_memory_alloc_pages;
+    ctx->free_pages = val_memory_free_pages;
+    ctx->virt_to_phys = val_memory_virt_to_phys;
+    ctx->phys_to_virt = val_memory_phys_to_virt;
+
+    return 0;
+}
+
+/**
+  @brief Create stage 1 or stage 2 page table in the given context. The context owns the
+         tables until val_pgt_context_destroy.
+  @param ctx - initialised context with no tables.
   @param mem_desc - Array of memory addresses and attributes needed for page table creation.
   @param pgt_desc - Data structure for output page table base and input translation attributes.
   @return status
 **/
-uint32_t val_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *pgt_desc)
+uint32_t val_pgt_context_create(pgt_context_t *ctx, memory_region_descriptor_t *mem_desc,
+                                pgt_descriptor_t *pgt_desc)
 {
     uint64_t *tt_base;
     tt_descriptor_t tt_desc;
-    uint32_t num_pgt_levels, page_size_log2;
+    uint32_t level, num_pages;
+    uint64_t input_base, input_top, span_log2, start_time;
+    uint64_t block_first, block_end;
     memory_region_descriptor_t *mem_desc_iter;
 
-    page_size = val_memory_page_size();
-    page_size_log2 = log2_page_size(page_size);
-    bits_per_level = page_size_log2 - 3;
-    num_pgt_levels = (pgt_desc->ias - page_size_log2 + bits_per_level - 1)/bits_per_level;
-    val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_create: nbits_per_level = %d    ", bits_per_level);
-    val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_create: page_size_log2 = %d     ", page_size_log2);
+    if (ctx->arena.base != NULL)
+        return ACS_STATUS_ERR;
+
+    start_time = pgt_counter_read(NULL);
+    val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_create: nbits_per_level = %d    ", ctx->bits_per_level);
+    val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_create: page_size_log2 = %d     ", ctx->page_size_log2);
+
+    /* Upper bound on table pages: the root, plus at every lower level one table
+       for each window of the parent entry size that a region touches, less the
+       windows the parent maps with a block. fill_translation_table steps through
+       the region window by window and uses a block for each window inside the
+       region when input and output are aligned alike */
+    num_pages = 1;
+    for (mem_desc_iter = mem_desc; mem_desc_iter->length != 0; ++mem_desc_iter)
+    {
+        input_base = mem_desc_iter->virtual_address & ((0x1ull << ctx->ias) - 1);
+        input_top = input_base + mem_desc_iter->length - 1;
+        for (level = 5 - ctx->num_levels; level <= 3; level++)
+        {
+            span_log2 = ctx->page_size_log2 + (4 - level) * ctx->bits_per_level;
+            num_pages += (input_top >> span_log2) - (input_base >> span_log2) + 1;
+            if (((input_base ^ mem_desc_iter->physical_address) & ((0x1ull << span_log2) - 1)) == 0)
+            {
+                block_first = (input_base + (0x1ull << span_log2) - 1) >> span_log2;
+                block_end = (input_top + 1) >> span_log2;
+                if (block_end > block_first)
+                    num_pages -= block_end - block_first;
+            }
+        }
+    }
 
-    tt_base = (uint64_t*) val_memory_alloc_pages(1);
-    if (tt_base == NULL)
+    if (pgt_arena_reserve(ctx, num_pages))
     {
         val_print(ACS_PRINT_ERR, "\n      val_pgt_create: page allocation failed     ", 0);
         return ACS_STATUS_ERR;
     }
-    val_memory_set(tt_base, page_size, 0);
+    tt_base = pgt_arena_alloc_page(ctx);
     tt_desc.tt_base = tt_base;
-    pgt_addr_mask = ((0x1ull << (48 - page_size_log2)) - 1) << page_size_log2;
 
     for (mem_desc_iter = mem_desc; mem_desc_iter->length != 0; ++mem_desc_iter)
     {
-        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: input addr = 0x%x     ", mem_desc->virtual_address);
-        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: output addr = 0x%x     ", mem_desc->physical_address);
-        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: length = 0x%x\n     ", mem_desc->length);
-        if ((mem_desc->virtual_address & (uint64_t)(page_size - 1)) != 0 ||
-            (mem_desc->physical_address & (uint64_t)(page_size - 1)) != 0)
+        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: input addr = 0x%x     ", mem_desc_iter->virtual_address);
+        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: output addr = 0x%x     ", mem_desc_iter->physical_address);
+        val_print(PGT_DEBUG_LEVEL, "      val_pgt_create: length = 0x%x\n     ", mem_desc_iter->length);
+        if ((mem_desc_iter->virtual_address & (uint64_t)(ctx->page_size - 1)) != 0 ||
+            (mem_desc_iter->physical_address & (uint64_t)(ctx->page_size - 1)) != 0)
             {
                 val_print(ACS_PRINT_ERR, "\n      val_pgt_create: address alignment error     ", 0);
+                pgt_arena_release(ctx);
                 return ACS_STATUS_ERR;
             }
 
-        if (mem_desc->physical_address >= (0x1ull << pgt_desc->oas))
+        if (mem_desc_iter->physical_address >= (0x1ull << pgt_desc->oas))
         {
             val_print(ACS_PRINT_ERR, "\n      val_pgt_create: output address size error     ", 0);
+            pgt_arena_release(ctx);
             return ACS_STATUS_ERR;
         }
 
-        if (mem_desc->virtual_address >= (0x1ull << pgt_desc->ias))
+        if (mem_desc_iter->virtual_address >= (0x1ull << ctx->ias))
         {
-            val_print(ACS_PRINT_WARN, "\n      val_pgt_create: input address size error, truncating to %d-bits     ", pgt_desc->ias);
-            mem_desc->virtual_address &= ((0x1ull << pgt_desc->ias) - 1);
+            val_print(ACS_PRINT_WARN, "\n      val_pgt_create: input address size error, truncating to %d-bits     ", ctx->ias);
+            mem_desc_iter->virtual_address &= ((0x1ull << ctx->ias) - 1);
         }
 
-        if ((pgt_desc->tcr.tg_size_log2) != page_size_log2)
+        if ((pgt_desc->tcr.tg_size_log2) != ctx->page_size_log2)
         {
             val_print(ACS_PRINT_ERR, "\n      val_pgt_create: input page_size 0x%x not supported     ", (0x1 << pgt_desc->tcr.tg_size_log2));
+            pgt_arena_release(ctx);
             return ACS_STATUS_ERR;
         }
 
-        tt_desc.input_base = mem_desc->virtual_address & ((0x1ull << pgt_desc->ias) - 1);
-        tt_desc.input_top = tt_desc.input_base + mem_desc->length - 1;
-        tt_desc.output_base = mem_desc->physical_address & ((0x1ull << pgt_desc->oas) - 1);
-        tt_desc.level = 4 - num_pgt_levels;
-        tt_desc.size_log2 = (num_pgt_levels - 1) * bits_per_level + page_size_log2;
-        tt_desc.nbits = pgt_desc->ias - tt_desc.size_log2;
+        tt_desc.input_base = mem_desc_iter->virtual_address & ((0x1ull << ctx->ias) - 1);
+        tt_desc.input_top = tt_desc.input_base + mem_desc_iter->length - 1;
+        tt_desc.output_base = mem_desc_iter->physical_address & ((0x1ull << pgt_desc->oas) - 1);
+        tt_desc.level = 4 - ctx->num_levels;
+        tt_desc.size_log2 = (ctx->num_levels - 1) * ctx->bits_per_level + ctx->page_size_log2;
+        tt_desc.nbits = ctx->ias - tt_desc.size_log2;
 
-        if (fill_translation_table(tt_desc, mem_desc))
+        if (fill_translation_table(ctx, tt_desc, mem_desc_iter))
         {
-            val_memory_free_pages(tt_base, 1);
+            pgt_arena_release(ctx);
             return ACS_STATUS_ERR;
         }
     }
 
-    pgt_desc->pgt_base = (uint64_t)val_memory_virt_to_phys(tt_base);
+    pgt_desc->pgt_base = (uint64_t)ctx->virt_to_phys(tt_base);
+    ctx->arena.pgt_base = pgt_desc->pgt_base;
+
+    val_print(ACS_PRINT_DEBUG, "\n      val_pgt_create: table pages used %d", ctx->arena.used_pages);
+    val_print(ACS_PRINT_DEBUG, " of %d reserved", ctx->arena.num_pages);
+    val_print(ACS_PRINT_DEBUG, ", %d us", pgt_elapsed_us(start_time));
 
     return 0;
 }
 
 /**
-  @brief Get attributes of a page corresponding to a given virtual address.
-  @param pgt_desc - page table base and translation attributes.
-  @param virtual_address - virtual address of memory region base whose attribute is to be read.
-  @param attributes - output attributes
+  @brief Create stage 1 or stage 2 page table, with given memory addresses and attributes
+  @param mem_desc - Array of memory addresses and attributes needed for page table creation.
+  @param pgt_desc - Data structure for output page table base and input translation attributes.
   @return status
 **/
-uint64_t val_pgt_get_attributes(pgt_descriptor_t pgt_desc, uint64_t virtual_address, uint64_t *attributes)
+uint32_t val_pgt_create(memory_region_descriptor_t *mem_desc, pgt_descriptor_t *pgt_desc)
 {
-    uint32_t ias, index, num_pgt_levels, this_level;
-    uint32_t bits_at_this_level, bits_remaining;
-    uint64_t val64, tt_base_phys, *tt_base_virt;
-    uint32_t page_size_log2 = pgt_desc.tcr.tg_size_log2;
+    pgt_context_t *ctx;
+    uint32_t status;
 
-    if (attributes == NULL)
+    ctx = pgt_context_get();
+    if (ctx == NULL)
+    {
+        val_print(ACS_PRINT_ERR, "\n      val_pgt_create: context allocation failed     ", 0);
         return ACS_STATUS_ERR;
+    }
 
-    if (!pgt_desc.pgt_base)
-        return ACS_STATUS_ERR;
+    status = val_pgt_context_init(ctx, log2_page_size(val_memory_page_size()), pgt_desc->ias);
+    if (status == 0)
+        status = val_pgt_context_create(ctx, mem_desc, pgt_desc);
 
-    ias = 64 - pgt_desc.tcr.tsz;
-
-    bits_per_level = page_size_log2 - 3;
-    num_pgt_levels = (ias - page_size_log2 + bits_per_level - 1)/bits_per_level;
-    this_level = 4 - num_pgt_levels;
-    bits_remaining = (num_pgt_levels - 1) * bits_per_level + page_size_log2;
-    bits_at_this_level = ias - bits_remaining;
-    tt_base_phys = pgt_desc.pgt_base;
-
-    while (1) {
-        index = (virtual_address >> bits_remaining) & ((0x1u << bits_at_this_level) - 1);
-        tt_base_virt = (uint64_t*)val_memory_phys_to_virt(tt_base_phys);
-        val64 = tt_base_virt[index];
-
-        val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_get_attributes: this_level = %d     ", this_level);
-        val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_get_attributes: index = %d     ", index);
-        val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_get_attributes: bits_remaining = %d     ", bits_remaining);
-        val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_get_attributes: tt_base_virt = %x     ", (uint64_t)tt_base_virt);
-        val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_get_attributes: val64 = %x     ", val64);
-        if (this_level == 3)
+    /* A context that holds no tables frees the pool if it is the last */
+    if (status)
+        pgt_context_put(ctx);
+    return status;
+}
+
+/**
+  @brief Find the leaf descriptor translating a virtual address. The descent starts from
+         the deepest table cached for the address instead of the root.
+  @param ctx - context describing the granule and levels of the tables.
+  @param pgt_base - physical address of the root table.
+  @param virtual_address - address to translate.
+  @param desc - output leaf descriptor.
+  @param leaf_log2 - output log2 of the size translated by the leaf descriptor.
+  @return status
+**/
+static uint32_t pgt_walk_leaf(pgt_context_t *ctx, uint64_t pgt_base, uint64_t virtual_address,
+                              uint64_t *desc, uint32_t *leaf_log2)
+{
+    pgt_walk_cache_t *cache = &ctx->walk_cache;
+    uint32_t root_level = 4 - ctx->num_levels;
+    uint32_t level, cached, entry_log2, nbits;
+    uint64_t *table, val64;
+
+    if (cache->pgt_base != pgt_base)
+    {
+        val_memory_set(cache, sizeof(*cache), 0);
+        cache->pgt_base = pgt_base;
+    }
+
+    ctx->walk_stats.num_walks++;
+
+    level = root_level;
+    table = (uint64_t *)ctx->phys_to_virt(pgt_base);
+    for (cached = 3; cached > root_level; cached--)
+    {
+        /* A table at this level translates the entry size of the level above */
+        if (cache->table[cached] &&
+            cache->va_tag[cached] == (virtual_address >> (ctx->page_size_log2 +
+                                      (4 - cached) * ctx->bits_per_level)))
+        {
+            level = cached;
+            table = cache->table[cached];
+            ctx->walk_stats.num_cache_hits++;
+            break;
+        }
+    }
+
+    while (1)
+    {
+        entry_log2 = ctx->page_size_log2 + (3 - level) * ctx->bits_per_level;
+        nbits = (level == root_level) ? (ctx->ias - entry_log2) : ctx->bits_per_level;
+        val64 = table[(virtual_address >> entry_log2) & ((0x1ull << nbits) - 1)];
+        ctx->walk_stats.num_desc_reads++;
+
+        if (!(val64 & PGT_ENTRY_VALID_MASK))
+            return ACS_STATUS_ERR;
+
+        if (level == 3)
         {
             if (!IS_PGT_ENTRY_PAGE(val64))
                 return ACS_STATUS_ERR;
-            *attributes = PGT_DESC_ATTRIBUTES(val64);
-            return 0;
+            break;
         }
-        if (IS_PGT_ENTRY_BLOCK(val64)) {
-            *attributes = PGT_DESC_ATTRIBUTES(val64);
-            return 0;
-        }
-        tt_base_phys = val64 & (((0x1ull << (ias - page_size_log2)) - 1) << page_size_log2);
-        ++this_level;
-        bits_remaining -= bits_at_this_level;
-        bits_at_this_level = bits_per_level;
+        if (IS_PGT_ENTRY_BLOCK(val64))
+            break;
+
+        table = (uint64_t *)ctx->phys_to_virt(val64 & ctx->addr_mask);
+        ++level;
+        cache->table[level] = table;
+        cache->va_tag[level] = virtual_address >> entry_log2;
     }
+
+    *desc = val64;
+    *leaf_log2 = entry_log2;
+    return 0;
 }
 
-static void free_translation_table(uint64_t *tt_base, uint32_t bits_at_this_level, uint32_t this_level)
+/**
+  @brief Get attributes of a page corresponding to a given virtual address.
+  @param ctx - context describing the granule and levels of the tables.
+  @param pgt_base - physical address of the root table.
+  @param virtual_address - virtual address of memory region base whose attribute is to be read.
+  @param attributes - output attributes
+  @return status
+**/
+uint64_t val_pgt_context_get_attributes(pgt_context_t *ctx, uint64_t pgt_base,
+                                        uint64_t virtual_address, uint64_t *attributes)
 {
-    uint32_t index;
-    uint64_t *tt_base_next_virt;
+    uint64_t desc;
+    uint32_t leaf_log2;
 
-    if (this_level == 3)
-        return;
-    for (index = 0; index < (0x1ul << bits_at_this_level); ++index)
+    if ((attributes == NULL) || !pgt_base)
+        return ACS_STATUS_ERR;
+
+    if (pgt_walk_leaf(ctx, pgt_base, virtual_address, &desc, &leaf_log2))
+        return ACS_STATUS_ERR;
+
+    *attributes = PGT_DESC_ATTRIBUTES(desc);
+    return 0;
+}
+
+/**
+  @brief Resolve a virtual address range. Returns the attributes at virtual_address and the
+         length of the run from it, up to length, mapped with identical attributes.
+  @param ctx - context describing the granule and levels of the tables.
+  @param pgt_base - physical address of the root table.
+  @param virtual_address - start of the range.
+  @param length - length of the range.
+  @param attributes - output attributes of the run.
+  @param run_length - output length of the run.
+  @return status
+**/
+uint32_t val_pgt_context_walk(pgt_context_t *ctx, uint64_t pgt_base, uint64_t virtual_address,
+                              uint64_t length, uint64_t *attributes, uint64_t *run_length)
+{
+    uint64_t desc, end, limit;
+    uint32_t leaf_log2;
+
+    if ((attributes == NULL) || (run_length == NULL) || !pgt_base || (length == 0))
+        return ACS_STATUS_ERR;
+
+    if (pgt_walk_leaf(ctx, pgt_base, virtual_address, &desc, &leaf_log2))
+        return ACS_STATUS_ERR;
+
+    *attributes = PGT_DESC_ATTRIBUTES(desc);
+    limit = virtual_address + length;
+    end = (virtual_address | ((0x1ull << leaf_log2) - 1)) + 1;
+
+    /* Following leaves mostly sit in the cached last level table */
+    while (end < limit)
     {
-        if (tt_base[index] != 0)
-        {
-            if (IS_PGT_ENTRY_BLOCK(tt_base[index]))
-                continue;
-            tt_base_next_virt = val_memory_phys_to_virt((tt_base[index] & pgt_addr_mask));
-            if (tt_base_next_virt == NULL)
-                continue;
-            free_translation_table(tt_base_next_virt, bits_per_level, this_level+1);
-            val_print(PGT_DEBUG_LEVEL, "\n      free_translation_table: tt_base_next_virt = %llx     ", (uint64_t)tt_base_next_virt);
-            val_memory_free_pages(tt_base_next_virt, 1);
-        }
+        if (pgt_walk_leaf(ctx, pgt_base, end, &desc, &leaf_log2) ||
+            (PGT_DESC_ATTRIBUTES(desc) != *attributes))
+            break;
+        end += 0x1ull << leaf_log2;
     }
+
+    if (end > limit)
+        end = limit;
+    *run_length = end - virtual_address;
+    return 0;
+}
+
+/**
+  @brief Get attributes of a page corresponding to a given virtual address.
+  @param pgt_desc - page table base and translation attributes.
+  @param virtual_address - virtual address of memory region base whose attribute is to be read.
+  @param attributes - output attributes
+  @return status
+**/
+uint64_t val_pgt_get_attributes(pgt_descriptor_t pgt_desc, uint64_t virtual_address, uint64_t *attributes)
+{
+    pgt_context_t ctx;
+
+    if (val_pgt_context_init(&ctx, pgt_desc.tcr.tg_size_log2, 64 - pgt_desc.tcr.tsz))
+        return ACS_STATUS_ERR;
+
+    if (val_pgt_context_get_attributes(&ctx, pgt_desc.pgt_base, virtual_address, attributes))
+        return ACS_STATUS_ERR;
+
+    val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_get_attributes: attributes = 0x%llx     ", *attributes);
+    return 0;
+}
+
+/**
+  @brief Free all page tables owned by a context.
+  @param ctx - context passed to val_pgt_context_create.
+  @return void
+**/
+void val_pgt_context_destroy(pgt_context_t *ctx)
+{
+    uint32_t num_pages;
+    uint64_t start_time;
+
+    if (ctx->arena.base == NULL)
+        return;
+
+    val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_destroy: pgt_base = %llx     ", ctx->arena.pgt_base);
+
+    start_time = pgt_counter_read(NULL);
+    num_pages = ctx->arena.num_pages;
+    pgt_arena_release(ctx);
+    val_print(ACS_PRINT_DEBUG, "\n      val_pgt_destroy: released %d pages", num_pages);
+    val_print(ACS_PRINT_DEBUG, ", %d us", pgt_elapsed_us(start_time));
 }
 
 /**
@@ -301,21 +619,20 @@ static void free_translation_table(uint64_t *tt_base, uint32_t bits_at_this_leve
 **/
 void val_pgt_destroy(pgt_descriptor_t pgt_desc)
 {
-    uint32_t page_size_log2, num_pgt_levels;
-    uint64_t *pgt_base_virt = val_memory_phys_to_virt(pgt_desc.pgt_base);
+    uint32_t index;
 
     if (!pgt_desc.pgt_base)
         return;
 
-    val_print(PGT_DEBUG_LEVEL, "\n      val_pgt_destroy: pgt_base = %llx     ", pgt_desc.pgt_base);
-    page_size = val_memory_page_size();
-    page_size_log2 = log2_page_size(page_size);
-    bits_per_level =  page_size_log2 - 3;
-    pgt_addr_mask = ((0x1ull << (pgt_desc.ias - page_size_log2)) - 1) << page_size_log2;
-    num_pgt_levels = (pgt_desc.ias - page_size_log2 + bits_per_level - 1)/bits_per_level;
-
-    free_translation_table(pgt_base_virt,
-                           pgt_desc.ias - ((num_pgt_levels - 1) * bits_per_level + page_size_log2),
-                           4 - num_pgt_levels);
-    val_memory_free_pages(pgt_base_virt, 1);
+    for (index = 0; index < pgt_context_pool_size; index++)
+    {
+        if ((pgt_context_pool[index].arena.base != NULL) &&
+            (pgt_context_pool[index].arena.pgt_base == pgt_desc.pgt_base)) {
+            pgt_context_put(&pgt_context_pool[index]);
+            return;
+        }
+    }
+
+    val_print(ACS_PRINT_WARN, "\n      val_pgt_destroy: 0x%llx not created by val_pgt_create     ",
+              pgt_desc.pgt_base);
 }
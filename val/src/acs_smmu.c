@@ -44,6 +44,24 @@ val_smmu_read_cfg(uint32_t offset, uint32_t index)
 
 #ifndef TARGET_LINUX
 
+/* SMMU tests, in run order */
+static const TEST_DESC g_smmu_tests[] = {
+  {ACS_SMMU_TEST_NUM_BASE + 1,     1, os_i001_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 2,     1, os_i002_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 3,     1, os_i003_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 4,     1, os_i004_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 5,     1, os_i005_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 6,     1, os_i006_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 7,     1, os_i007_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 8,     1, os_i008_entry,  TEST_VIEW_OS,                 TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_TEST_NUM_BASE + 9,     1, os_i009_entry,  TEST_VIEW_OS | TEST_VIEW_HYP, TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_HYP_TEST_NUM_BASE + 1, 1, hyp_i001_entry, TEST_VIEW_HYP,                TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_HYP_TEST_NUM_BASE + 2, 1, hyp_i002_entry, TEST_VIEW_HYP,                TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_HYP_TEST_NUM_BASE + 3, 1, hyp_i003_entry, TEST_VIEW_HYP,                TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_HYP_TEST_NUM_BASE + 4, 1, hyp_i004_entry, TEST_VIEW_HYP,                TEST_COST_LOW, TEST_NEEDS_SMMU},
+  {ACS_SMMU_HYP_TEST_NUM_BASE + 5, 1, hyp_i005_entry, TEST_VIEW_HYP,                TEST_COST_LOW, TEST_NEEDS_SMMU},
+};
+
 /**
   @brief   This API executes all the SMMU tests sequentially
            1. Caller       -  Application layer.
@@ -66,37 +84,17 @@ val_smmu_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  num_smmu = val_iovirt_get_smmu_info(SMMU_NUM_CTRL, 0);
-  if (num_smmu == 0) {
-    val_print(ACS_PRINT_WARN, "\n     No SMMU Controller Found, Skipping SMMU tests...\n", 0);
-    return ACS_STATUS_SKIP;
-  }
-
-  if (g_sw_view[G_SW_OS]) {
-       val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-       status |= os_i001_entry(num_pe);
-       status |= os_i002_entry(num_pe);
-       status |= os_i003_entry(num_pe);
-       status |= os_i004_entry(num_pe);
-       status |= os_i005_entry(num_pe);
-       status |= os_i006_entry(num_pe);
-       status |= os_i007_entry(num_pe);
-       status |= os_i008_entry(num_pe);
+  if (!val_test_module_is_selected(ACS_SMMU_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No SMMU tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
-  if (g_sw_view[G_SW_OS] || g_sw_view[G_SW_HYP]) {
-       status |= os_i009_entry(num_pe);
-  }
-
-  if (g_sw_view[G_SW_HYP]) {
-       val_print(ACS_PRINT_ERR, "\nHypervisor:\n", 0);
-       status |= hyp_i001_entry(num_pe);
-       status |= hyp_i002_entry(num_pe);
-       status |= hyp_i003_entry(num_pe);
-       status |= hyp_i004_entry(num_pe);
-       status |= hyp_i005_entry(num_pe);
-  }
+  num_smmu = val_iovirt_get_smmu_info(SMMU_NUM_CTRL, 0);
+  if (num_smmu == 0)
+    val_print(ACS_PRINT_WARN, "\n     No SMMU Controller Found, Skipping SMMU tests...\n", 0);
 
+  status = val_run_test_list(g_smmu_tests, TEST_LIST_NUM(g_smmu_tests), num_pe, g_sw_view,
+                             num_smmu ? TEST_NEEDS_SMMU : 0);
 
   if (status != ACS_STATUS_PASS)
     val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
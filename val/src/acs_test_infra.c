@@ -18,8 +18,65 @@
 #include "include/bsa_acs_val.h"
 #include "include/bsa_acs_pe.h"
 #include "include/bsa_acs_common.h"
+#include "include/bsa_acs_memory.h"
+#include "include/bsa_acs_smmu.h"
+#ifndef TARGET_LINUX
+#include "include/bsa_acs_timer_support.h"
+#endif
 #include "sys_arch_src/gic/bsa_exception.h"
 
+/* Bitmask of INFO_TABLE_e entries whose contents were restored by the application */
+static uint32_t g_info_table_restored;
+
+/* Number of entries each module owns above its test number base */
+#define TEST_SELECT_MODULE_SPAN  100
+#define TEST_SELECT_MIN_RANGES   16
+/* Test numbers covered by the selection bitmap, past the last module */
+#define TEST_SELECT_MAX_TEST     (ACS_EXERCISER_TEST_NUM_BASE + TEST_SELECT_MODULE_SPAN)
+
+typedef struct {
+  uint32_t start;
+  uint32_t end;                 /* inclusive */
+  uint32_t exclude;
+} TEST_SELECT_RANGE;
+
+/* Test selection set by the application, empty means every test runs */
+static struct {
+  TEST_SELECT_RANGE *range;
+  uint32_t num;
+  uint32_t max;
+  uint32_t num_include;
+  uint32_t timing;              /* report the wall time of each test */
+  uint32_t by_cost;             /* run the cheaper tests of a view first */
+  uint32_t compiled;            /* bitmap matches the ranges */
+  uint32_t bitmap[(TEST_SELECT_MAX_TEST + 31) / 32];
+} g_test_select;
+
+/* State of the test between val_initialize_test and val_check_for_error */
+static struct {
+  uint32_t test_num;
+  uint32_t deselected;
+  uint64_t start;
+} g_test_run;
+
+#define STARTUP_MAX_PHASE  16
+
+typedef struct {
+  char8_t  *name;
+  uint64_t start;
+  uint64_t ticks;
+  uint32_t entries;
+  uint32_t bytes;
+} STARTUP_PHASE;
+
+/* Info table creation phases, recorded until the next val_startup_report */
+static struct {
+  STARTUP_PHASE phase[STARTUP_MAX_PHASE];
+  uint32_t num;
+  uint32_t open;                /* phase[num] has begun and not ended */
+  uint64_t first;               /* counter when the first phase began */
+} g_startup;
+
 /**
   @brief  This API calls PAL layer to print a formatted string
           to the output console.
@@ -202,6 +259,233 @@ val_mmio_write64(addr_t addr, uint64_t data)
   pal_mmio_write64(addr, data);
 }
 
+/* The Linux module does not build the timer support sources, read the counter here */
+static uint64_t
+test_counter_read(uint64_t *freq)
+{
+#ifndef TARGET_LINUX
+  if (freq)
+      *freq = ArmArchTimerReadReg(CntFrq);
+  return ArmArchTimerReadReg(CntPct);
+#elif defined(TARGET_LINUX_HOST)
+  return pal_host_counter_read(freq);
+#else
+  uint64_t count;
+
+  if (freq)
+      __asm__ volatile("mrs %0, cntfrq_el0" : "=r" (*freq));
+  __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r" (count) :: "memory");
+  return count;
+#endif
+}
+
+static uint64_t
+test_elapsed_us(uint64_t start)
+{
+  uint64_t freq;
+  uint64_t now = test_counter_read(&freq);
+
+  if (freq == 0)
+      return 0;
+  return ((now - start) * 1000000) / freq;
+}
+
+/**
+  @brief  Drop the test selection, so that every test runs again
+          1. Caller       - Application layer
+          2. Prerequisite - None.
+
+  @param  None
+
+  @return None
+**/
+void
+val_test_select_clear(void)
+{
+  if (g_test_select.range)
+      val_memory_free(g_test_select.range);
+
+  val_memory_set(&g_test_select, sizeof(g_test_select), 0);
+}
+
+/**
+  @brief  Add a range of test numbers to the selection. With no include
+          ranges every test is selected; an exclude range always wins.
+          A module number base (e.g. 300) given as a single number covers
+          the whole module.
+          1. Caller       - Application layer
+          2. Prerequisite - None.
+
+  @param  start    first test number of the range
+  @param  end      last test number of the range, inclusive
+  @param  exclude  1 to deselect the range, 0 to select it
+
+  @return ACS_STATUS_PASS, or ACS_STATUS_ERR if the range could not be stored
+**/
+uint32_t
+val_test_select_add(uint32_t start, uint32_t end, uint32_t exclude)
+{
+  TEST_SELECT_RANGE *range;
+  uint32_t max;
+
+  if (end < start)
+      return ACS_STATUS_ERR;
+
+  if ((start == end) && ((start % TEST_SELECT_MODULE_SPAN) == 0))
+      end = start + TEST_SELECT_MODULE_SPAN - 1;
+
+  if (g_test_select.num == g_test_select.max) {
+      max = g_test_select.max ? (g_test_select.max * 2) : TEST_SELECT_MIN_RANGES;
+      range = val_memory_alloc(max * sizeof(TEST_SELECT_RANGE));
+      if (range == NULL) {
+          val_print(ACS_PRINT_ERR, "\n       Test selection allocation failed ", 0);
+          return ACS_STATUS_ERR;
+      }
+      if (g_test_select.range) {
+          val_memcpy(range, g_test_select.range, g_test_select.num * sizeof(TEST_SELECT_RANGE));
+          val_memory_free(g_test_select.range);
+      }
+      g_test_select.range = range;
+      g_test_select.max = max;
+  }
+
+  range = &g_test_select.range[g_test_select.num++];
+  range->start = start;
+  range->end = end;
+  range->exclude = exclude ? 1 : 0;
+  if (!exclude)
+      g_test_select.num_include++;
+  g_test_select.compiled = 0;
+
+  return ACS_STATUS_PASS;
+}
+
+/**
+  @brief  Set or clear the bits of a range of test numbers in the bitmap
+**/
+static void
+val_test_select_mark(uint32_t start, uint32_t end, uint32_t set)
+{
+  uint32_t num;
+
+  if (end >= TEST_SELECT_MAX_TEST)
+      end = TEST_SELECT_MAX_TEST - 1;
+
+  for (num = start; num <= end; num++) {
+      if (set)
+          g_test_select.bitmap[num / 32] |= (1u << (num % 32));
+      else
+          g_test_select.bitmap[num / 32] &= ~(1u << (num % 32));
+  }
+}
+
+/**
+  @brief  Fold the ranges into one bit per test number, so that the check
+          made for every test does not depend on the number of ranges.
+          Include ranges are applied first and exclude ranges over them.
+**/
+static void
+val_test_select_compile(void)
+{
+  uint32_t i;
+
+  val_memory_set(g_test_select.bitmap, sizeof(g_test_select.bitmap),
+                 g_test_select.num_include ? 0 : 0xFF);
+
+  for (i = 0; i < g_test_select.num; i++) {
+      if (!g_test_select.range[i].exclude && (g_test_select.range[i].start < TEST_SELECT_MAX_TEST))
+          val_test_select_mark(g_test_select.range[i].start, g_test_select.range[i].end, 1);
+  }
+  for (i = 0; i < g_test_select.num; i++) {
+      if (g_test_select.range[i].exclude && (g_test_select.range[i].start < TEST_SELECT_MAX_TEST))
+          val_test_select_mark(g_test_select.range[i].start, g_test_select.range[i].end, 0);
+  }
+
+  g_test_select.compiled = 1;
+}
+
+/**
+  @brief  Enable or disable the per-test wall time report
+          1. Caller       - Application layer
+          2. Prerequisite - None.
+
+  @param  enable  1 to print the time each test took after its result
+
+  @return None
+**/
+void
+val_test_select_timing(uint32_t enable)
+{
+  g_test_select.timing = enable;
+}
+
+/**
+  @brief  Choose the order val_run_test_list runs the tests of a module in
+          1. Caller       - Application layer
+          2. Prerequisite - None.
+
+  @param  by_cost  1 to run the tests of each view by increasing TEST_COST_*,
+                   0 to keep the order of the registry
+
+  @return None
+**/
+void
+val_test_select_order(uint32_t by_cost)
+{
+  g_test_select.by_cost = by_cost;
+}
+
+/**
+  @brief  Check a test number against the selection
+
+  @param  test_num  unique test number
+
+  @return 1 if the test should run, 0 if the user deselected it
+**/
+uint32_t
+val_test_is_selected(uint32_t test_num)
+{
+  uint32_t i;
+  uint32_t included = (g_test_select.num_include == 0);
+
+  if (test_num < TEST_SELECT_MAX_TEST) {
+      if (!g_test_select.compiled)
+          val_test_select_compile();
+      return (g_test_select.bitmap[test_num / 32] >> (test_num % 32)) & 1;
+  }
+
+  for (i = 0; i < g_test_select.num; i++) {
+      if ((test_num < g_test_select.range[i].start) || (test_num > g_test_select.range[i].end))
+          continue;
+      if (g_test_select.range[i].exclude)
+          return 0;
+      included = 1;
+  }
+
+  return included;
+}
+
+/**
+  @brief  Check whether any test of a module is selected, so that the
+          module set up can be skipped when none is.
+
+  @param  module_base  test number base of the module
+
+  @return 1 if at least one test of the module may run, 0 otherwise
+**/
+uint32_t
+val_test_module_is_selected(uint32_t module_base)
+{
+  uint32_t num;
+
+  for (num = module_base; num < module_base + TEST_SELECT_MODULE_SPAN; num++) {
+      if (val_test_is_selected(num))
+          return 1;
+  }
+
+  return 0;
+}
+
 /**
   @brief  This API prinst the test number, description and
           sets the test status to pending for the input number of PEs.
@@ -222,6 +506,26 @@ val_initialize_test(uint32_t test_num, char8_t *desc, uint32_t num_pe)
   uint32_t i;
   uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
 
+  g_test_run.test_num = test_num;
+  g_test_run.deselected = 0;
+
+  /* Tests outside the user's selection are not reported at all */
+  if (!val_test_is_selected(test_num)) {
+      g_test_run.deselected = 1;
+      if (num_pe == 1)
+          val_set_status(index, RESULT_SKIP(test_num, 0));
+      else
+          for (i = 0; i < num_pe; i++)
+              val_set_status(i, RESULT_SKIP(test_num, 0));
+      return ACS_STATUS_SKIP;
+  }
+
+  /* The SMMU command queue statistics count the commands of this test only */
+  val_smmu_clear_stats();
+
+  if (g_test_select.timing)
+      g_test_run.start = test_counter_read(NULL);
+
   val_print(ACS_PRINT_ERR, "%4d : ", test_num); //Always print this
   val_print(ACS_PRINT_TEST, desc, 0);
   val_report_status(0, BSA_ACS_START(test_num));
@@ -229,8 +533,12 @@ val_initialize_test(uint32_t test_num, char8_t *desc, uint32_t num_pe)
 
   g_bsa_tests_total++;
 
-  for (i = 0; i < num_pe; i++)
-      val_set_status(i, RESULT_PENDING(test_num));
+  /* A single-PE test reports from the PE that runs it */
+  if (num_pe == 1)
+      val_set_status(index, RESULT_PENDING(test_num));
+  else
+      for (i = 0; i < num_pe; i++)
+          val_set_status(i, RESULT_PENDING(test_num));
 
   for (i=0 ; i<MAX_TEST_SKIP_NUM ; i++){
       if (g_skip_test_num[i] == test_num) {
@@ -414,6 +722,145 @@ val_run_test_payload(uint32_t test_num, uint32_t num_pe, void (*payload)(void),
   val_wait_for_test_completion(test_num, num_pe, TIMEOUT_LARGE);
 }
 
+/**
+  @brief  Check whether any of the tests of a registry entry is selected
+**/
+static uint32_t
+val_test_desc_is_selected(const TEST_DESC *test)
+{
+  uint32_t i;
+
+  for (i = 0; i < test->num_tests; i++) {
+      if (val_test_is_selected(test->test_num + i))
+          return 1;
+  }
+
+  return 0;
+}
+
+/**
+  @brief  Run one registry entry. When the platform lacks a resource the
+          entry needs, each of its selected tests is reported as skipped
+          instead, so that it still shows up and counts in the total.
+**/
+static uint32_t
+val_run_test_desc(const TEST_DESC *test, uint32_t num_pe, uint32_t resources)
+{
+  uint32_t index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint32_t test_num, i;
+
+  if ((test->needs & resources) == test->needs)
+      return test->entry((test->flags & TEST_FLAG_ONE_PE) ? 1 : num_pe);
+
+  for (i = 0; i < test->num_tests; i++) {
+      test_num = test->test_num + i;
+      if (val_initialize_test(test_num, "Platform lacks a resource for this test      ", 1)
+          != ACS_STATUS_SKIP)
+          val_set_status(index, RESULT_SKIP(test_num, 0));
+      val_check_for_error(test_num, 1);
+      val_report_status(0, BSA_ACS_END(test_num));
+  }
+
+  return ACS_STATUS_SKIP;
+}
+
+/**
+  @brief  Run the tests of a module from its registry. The tests of each
+          enabled view run in turn; a test listed in several views runs
+          once, with the first of them that is enabled. A failing
+          TEST_FLAG_GATE entry ends the run.
+          1. Caller       - VAL module
+          2. Prerequisite - val_allocate_shared_mem
+
+  @param  list       registry of the module, in run order
+  @param  num        number of entries in the registry
+  @param  num_pe     number of PEs to run the tests on
+  @param  g_sw_view  software views enabled by the application
+  @param  resources  TEST_NEEDS_* resources the platform provides
+
+  @return Consolidated status of the tests run
+**/
+uint32_t
+val_run_test_list(const TEST_DESC *list, uint32_t num, uint32_t num_pe, uint32_t *g_sw_view,
+  uint32_t resources)
+{
+  static char8_t *view_name[] = {"\nOperating System:\n", "\nHypervisor:\n",
+                                 "\nPlatform Security:\n"};
+  uint32_t status = ACS_STATUS_PASS;
+  uint32_t views = 0;
+  uint32_t view, cost, i, header;
+  uint32_t first, test_status;
+
+  for (view = G_SW_OS; view <= G_SW_PS; view++) {
+      if (g_sw_view[view])
+          views |= (1u << view);
+  }
+
+  for (view = G_SW_OS; view <= G_SW_PS; view++) {
+      if (!(views & (1u << view)))
+          continue;
+
+      header = 0;
+      for (cost = 0; cost <= TEST_COST_MAX; cost++) {
+          for (i = 0; i < num; i++) {
+              /* Lowest enabled view of the entry */
+              first = list[i].view & views;
+              if ((first & (0u - first)) != (1u << view))
+                  continue;
+              /* Gates run in the first pass whatever their cost */
+              if (g_test_select.by_cost &&
+                  (((list[i].flags & TEST_FLAG_GATE) ? TEST_COST_LOW : list[i].cost) != cost))
+                  continue;
+              if (!val_test_desc_is_selected(&list[i]))
+                  continue;
+
+              /* The view header only goes out once one of its tests does */
+              if (!header) {
+                  val_print(ACS_PRINT_ERR, view_name[view], 0);
+                  header = 1;
+              }
+              test_status = val_run_test_desc(&list[i], num_pe, resources);
+              status |= test_status;
+              if ((list[i].flags & TEST_FLAG_GATE) && (test_status != ACS_STATUS_PASS)) {
+                  val_print(ACS_PRINT_WARN, "\n     *** Skipping remaining tests of the module *** \n", 0);
+                  return status;
+              }
+          }
+          if (!g_test_select.by_cost)
+              break;
+      }
+  }
+
+  return status;
+}
+
+/**
+  @brief  Run the modules one after another in the order of the list.
+          1. Caller       - Application layer
+          2. Prerequisite - val_allocate_shared_mem
+
+  @param  list       Modules, in run order
+  @param  num        Number of entries in list
+  @param  g_sw_view  Software views to run
+
+  @return Consolidated status of the modules
+**/
+uint32_t
+val_run_modules(const TEST_MODULE *list, uint32_t num, uint32_t *g_sw_view)
+{
+  uint32_t num_pe = val_pe_get_num();
+  uint32_t status = ACS_STATUS_PASS;
+  uint32_t i;
+
+  for (i = 0; i < num; i++) {
+      if (list[i].banner)
+          val_print(ACS_PRINT_TEST, list[i].banner, 0);
+      status |= list[i].run(num_pe, g_sw_view);
+  }
+
+  return status;
+}
+
 /**
   @brief  Prints the status of the completed test
           1. Caller       - Test Suite
@@ -431,12 +878,23 @@ val_check_for_error(uint32_t test_num, uint32_t num_pe)
   uint32_t status = 0;
   uint32_t error_flag = 0;
   uint32_t my_index = val_pe_get_index_mpid(val_pe_get_mpid());
+  uint32_t timed = g_test_select.timing && (g_test_run.test_num == test_num);
+  uint64_t elapsed = 0;
+
+  if (g_test_run.deselected && (g_test_run.test_num == test_num))
+      return ACS_STATUS_SKIP;
+
+  /* Measure before reporting, print after so the result line stays intact */
+  if (timed)
+      elapsed = test_elapsed_us(g_test_run.start);
 
   /* this special case is needed when the Main PE is not the first entry
      of pe_info_table but num_pe is 1 for SOC tests */
   if (num_pe == 1) {
       status = val_get_status(my_index);
       val_report_status(my_index, status);
+      if (timed)
+          val_print(ACS_PRINT_ERR, "       Time : %d us \n", elapsed);
       if (IS_TEST_PASS(status)) {
           g_bsa_tests_pass++;
           return ACS_STATUS_PASS;
@@ -460,6 +918,8 @@ val_check_for_error(uint32_t test_num, uint32_t num_pe)
 
   if (!error_flag)
       val_report_status(my_index, status);
+  if (timed)
+      val_print(ACS_PRINT_ERR, "       Time : %d us \n", elapsed);
 
   if (IS_TEST_PASS(status)) {
       g_bsa_tests_pass++;
@@ -570,3 +1030,159 @@ val_time_delay_ms(uint64_t timer_ms)
 {
   return pal_time_delay_ms(timer_ms);
 }
+
+/**
+  @brief  Mark info tables as restored from a snapshot. The create_info_table
+          APIs then adopt the supplied table as is, skipping PAL discovery.
+          1. Caller       - Application layer
+          2. Prerequisite - None.
+
+  @param  table_mask  Bitmask of (1 << INFO_TABLE_e) values
+
+  @return None
+**/
+void
+val_info_table_set_restored(uint32_t table_mask)
+{
+  g_info_table_restored = table_mask;
+}
+
+/**
+  @brief  Check whether an info table was restored from a snapshot
+
+  @param  table  Info table identifier
+
+  @return 1 if restored, 0 if it has to be discovered
+**/
+uint32_t
+val_info_table_is_restored(INFO_TABLE_e table)
+{
+  return (g_info_table_restored >> table) & 1;
+}
+
+/**
+  @brief  Drop a restored info table that no longer matches the platform, so
+          that it is discovered again and the snapshot is rewritten.
+
+  @param  table  Info table identifier
+
+  @return None
+**/
+void
+val_info_table_discard(INFO_TABLE_e table)
+{
+  g_info_table_restored &= ~(1u << table);
+}
+
+/**
+  @brief  Return a checksum of the firmware description tables (ACPI or DT),
+          used to decide whether a saved info table snapshot is still valid.
+
+  @param  None
+
+  @return 64-bit checksum, 0 if the tables could not be located
+**/
+uint64_t
+val_get_fw_table_checksum(void)
+{
+#ifndef TARGET_LINUX
+  return pal_get_fw_table_checksum();
+#else
+  return 0;
+#endif
+}
+
+/**
+  @brief  Start timing an info table creation phase. Phases do not nest; the
+          name must stay valid until val_startup_report.
+          1. Caller       - VAL create_info_table APIs, Application layer
+          2. Prerequisite - None.
+
+  @param  name  Phase name printed in the startup table
+
+  @return None
+**/
+void
+val_startup_phase_begin(char8_t *name)
+{
+  STARTUP_PHASE *phase;
+
+  if (g_startup.num == STARTUP_MAX_PHASE)
+      return;
+
+  phase = &g_startup.phase[g_startup.num];
+  phase->name = name;
+  phase->entries = 0;
+  phase->bytes = 0;
+  phase->start = test_counter_read(NULL);
+  if (g_startup.num == 0)
+      g_startup.first = phase->start;
+  g_startup.open = 1;
+}
+
+/**
+  @brief  Finish the phase started by val_startup_phase_begin
+
+  @param  entries  Number of entries the phase discovered
+  @param  bytes    Bytes of the info table the entries occupy
+
+  @return None
+**/
+void
+val_startup_phase_end(uint32_t entries, uint32_t bytes)
+{
+  STARTUP_PHASE *phase;
+
+  if (!g_startup.open)
+      return;
+
+  phase = &g_startup.phase[g_startup.num++];
+  phase->ticks = test_counter_read(NULL) - phase->start;
+  phase->entries = entries;
+  phase->bytes = bytes;
+  g_startup.open = 0;
+}
+
+/**
+  @brief  Print the recorded phases as the startup table, then forget them so a
+          later table creation is reported on its own.
+          1. Caller       - Application layer
+          2. Prerequisite - Info tables created.
+
+  @param  None
+
+  @return None
+**/
+void
+val_startup_report(void)
+{
+  STARTUP_PHASE *phase;
+  uint64_t freq, now, total;
+  uint32_t i, bytes = 0;
+
+  if (g_startup.num == 0)
+      return;
+
+  now = test_counter_read(&freq);
+  if (freq == 0)
+      freq = 1;
+
+  val_print(ACS_PRINT_TEST, "\n  Time (us)   Entries     Bytes  Startup phase\n", 0);
+  for (i = 0; i < g_startup.num; i++) {
+      phase = &g_startup.phase[i];
+      val_print(ACS_PRINT_TEST, " %10ld", (phase->ticks * 1000000) / freq);
+      val_print(ACS_PRINT_TEST, " %9d", phase->entries);
+      val_print(ACS_PRINT_TEST, " %9d  ", phase->bytes);
+      val_print(ACS_PRINT_TEST, phase->name, 0);
+      val_print(ACS_PRINT_TEST, "\n", 0);
+      bytes += phase->bytes;
+  }
+
+  /* Wall time includes the application's work between phases */
+  total = ((now - g_startup.first) * 1000000) / freq;
+  val_print(ACS_PRINT_TEST, " %10ld", total);
+  val_print(ACS_PRINT_TEST, "           %9d  Total\n", bytes);
+
+  g_startup.num = 0;
+  g_startup.open = 0;
+}
@@ -24,6 +24,15 @@
 
 TIMER_INFO_TABLE  *g_timer_info_table;
 
+/* Timer tests, in run order */
+static const TEST_DESC g_timer_tests[] = {
+  {ACS_TIMER_TEST_NUM_BASE + 1, 1, os_t001_entry, TEST_VIEW_OS, TEST_COST_LOW,  0},
+  {ACS_TIMER_TEST_NUM_BASE + 2, 1, os_t002_entry, TEST_VIEW_OS, TEST_COST_LOW,  0},
+  {ACS_TIMER_TEST_NUM_BASE + 3, 1, os_t003_entry, TEST_VIEW_OS, TEST_COST_LOW,  0},
+  {ACS_TIMER_TEST_NUM_BASE + 4, 1, os_t004_entry, TEST_VIEW_OS, TEST_COST_HIGH, 0},
+  {ACS_TIMER_TEST_NUM_BASE + 5, 1, os_t005_entry, TEST_VIEW_OS, TEST_COST_LOW,  0},
+};
+
 /**
   @brief   This API executes all the timer tests sequentially
            1. Caller       -  Application layer.
@@ -45,15 +54,13 @@ val_timer_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  if (g_sw_view[G_SW_OS]) {
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-      status |= os_t001_entry(num_pe);
-      status |= os_t002_entry(num_pe);
-      status |= os_t003_entry(num_pe);
-      status |= os_t004_entry(num_pe);
-      status |= os_t005_entry(num_pe);
+  if (!val_test_module_is_selected(ACS_TIMER_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No Timer tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
+  status = val_run_test_list(g_timer_tests, TEST_LIST_NUM(g_timer_tests), num_pe, g_sw_view, 0);
+
   if (status != ACS_STATUS_PASS)
     val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
   else
@@ -284,6 +291,19 @@ val_timer_set_vir_el2(uint64_t timeout)
 
 }
 
+/**
+  @brief   Size the timer info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_timer_create_info_table
+**/
+uint32_t
+val_timer_get_info_table_size(void)
+{
+  return sizeof(TIMER_INFO_TABLE) + pal_timer_info_table_entries() * sizeof(TIMER_INFO_GTBLOCK);
+}
+
 /**
   @brief   This API will call PAL layer to fill in the Timer information
            into the g_timer_info_table pointer.
@@ -303,7 +323,12 @@ val_timer_create_info_table(uint64_t *timer_info_table)
 
   g_timer_info_table = (TIMER_INFO_TABLE *)timer_info_table;
 
-  pal_timer_create_info_table(g_timer_info_table);
+  val_startup_phase_begin("Timer");
+  if (!val_info_table_is_restored(INFO_TABLE_TIMER))
+    pal_timer_create_info_table(g_timer_info_table);
+  val_startup_phase_end(g_timer_info_table->header.num_platform_timer,
+                        sizeof(TIMER_INFO_TABLE) +
+                        g_timer_info_table->header.num_platform_timer * sizeof(TIMER_INFO_GTBLOCK));
 
   /* UEFI or other EL1 software may have enabled the el1 physical timer.
      Disable the timer to prevent interrupts at un-expected times */
@@ -22,6 +22,12 @@
 
 #include "include/bsa_acs_wakeup.h"
 
+/* Power and wakeup tests, in run order */
+static const TEST_DESC g_wakeup_tests[] = {
+  {ACS_WAKEUP_TEST_NUM_BASE + 1, 5, os_u001_entry, TEST_VIEW_OS, TEST_COST_HIGH, 0},
+  /* os_u002 needs multi-PE interrupt handling support */
+};
+
 /**
   @brief   This API executes all the wakeup tests sequentially
            1. Caller       -  Application layer.
@@ -43,13 +49,13 @@ val_wakeup_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  if (g_sw_view[G_SW_OS]) {
-      val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-      status |= os_u001_entry(num_pe);
-     // Test needs multi-PE interrupt handling support
-     // status |= os_u002_entry(num_pe);
+  if (!val_test_module_is_selected(ACS_WAKEUP_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No Wakeup tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
+  status = val_run_test_list(g_wakeup_tests, TEST_LIST_NUM(g_wakeup_tests), num_pe, g_sw_view, 0);
+
   if (status != ACS_STATUS_PASS)
     val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
   else
@@ -22,6 +22,13 @@
 
 
 WD_INFO_TABLE  *g_wd_info_table;
+static uint32_t g_wd_info_entries = INFO_TABLE_UNSIZED;
+
+/* Watchdog tests, in run order */
+static const TEST_DESC g_wd_tests[] = {
+  {ACS_WD_TEST_NUM_BASE + 1, 1, os_w001_entry, TEST_VIEW_OS, TEST_COST_LOW,  0},
+  {ACS_WD_TEST_NUM_BASE + 2, 1, os_w002_entry, TEST_VIEW_OS, TEST_COST_HIGH, 0},
+};
 
 /**
   @brief   This API executes all the Watchdog tests sequentially
@@ -44,12 +51,13 @@ val_wd_execute_tests(uint32_t num_pe, uint32_t *g_sw_view)
       }
   }
 
-  if (g_sw_view[G_SW_OS]) {
-    val_print(ACS_PRINT_ERR, "\nOperating System:\n", 0);
-    status |= os_w001_entry(num_pe);
-    status |= os_w002_entry(num_pe);
+  if (!val_test_module_is_selected(ACS_WD_TEST_NUM_BASE)) {
+      val_print(ACS_PRINT_TEST, "\n      No Watchdog tests selected \n", 0);
+      return ACS_STATUS_SKIP;
   }
 
+  status = val_run_test_list(g_wd_tests, TEST_LIST_NUM(g_wd_tests), num_pe, g_sw_view, 0);
+
   if (status != ACS_STATUS_PASS)
     val_print(ACS_PRINT_TEST, "\n      *** One or more tests have Failed/Skipped.*** \n", 0);
   else
@@ -91,6 +99,20 @@ val_wd_get_info(uint32_t index, WD_INFO_TYPE_e info_type)
   }
 }
 
+/**
+  @brief   Size the watchdog info table from the number of entries the PAL will fill
+           1. Caller       -  Application layer.
+           2. Prerequisite -  None.
+  @param   None
+  @return  Size in bytes to allocate for val_wd_create_info_table
+**/
+uint32_t
+val_wd_get_info_table_size(void)
+{
+  g_wd_info_entries = pal_wd_info_table_entries();
+  return sizeof(WD_INFO_TABLE) + g_wd_info_entries * sizeof(WD_INFO_BLOCK);
+}
+
 /**
   @brief   This API will call PAL layer to fill in the Watchdog information
            into the address pointed by g_wd_info_table pointer.
@@ -110,7 +132,11 @@ val_wd_create_info_table(uint64_t *wd_info_table)
 
   g_wd_info_table = (WD_INFO_TABLE *)wd_info_table;
 
-  pal_wd_create_info_table(g_wd_info_table);
+  val_startup_phase_begin("Watchdog");
+  if (!val_info_table_is_restored(INFO_TABLE_WD))
+    pal_wd_create_info_table(g_wd_info_table, g_wd_info_entries);
+  val_startup_phase_end(g_wd_info_table->header.num_wd,
+                        sizeof(WD_INFO_TABLE) + g_wd_info_table->header.num_wd * sizeof(WD_INFO_BLOCK));
 
   val_print(ACS_PRINT_TEST, " WATCHDOG_INFO: Number of Watchdogs   : %4d \n", val_wd_get_info(0, WD_INFO_COUNT));
 }
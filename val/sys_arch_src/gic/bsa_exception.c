@@ -20,24 +20,82 @@
 #include "include/bsa_acs_val.h"
 #include "include/bsa_acs_common.h"
 #include "include/bsa_acs_pe.h"
+#include "include/bsa_acs_timer_support.h"
 
 typedef void (*bsa_fp) (uint64_t, void *);
 bsa_fp g_esr_handler[4];
 
 typedef void (*irq_handler) (void);
-irq_handler g_intr_handler[NUM_ARM_MAX_INTERRUPT];
+
+typedef struct {
+  uint32_t    int_id;
+  irq_handler handler;
+  uint32_t    count;          /* Number of times the interrupt was acknowledged */
+  uint64_t    latency_total;  /* Acknowledge to EOI, in system counter ticks */
+  uint64_t    latency_max;
+} intr_entry_t;
+
+/* INTIDs below NUM_ARM_DIRECT_INTERRUPT index g_intr_direct, all others
+ * (extended PPI/SPI and LPI) live in an open addressed table where a
+ * zero int_id marks a free slot, as INTID 0 is always direct, and
+ * INTR_ENTRY_REMOVED a slot freed by uninstall, which lookups probe past.
+ */
+#define INTR_ENTRY_REMOVED  0xFFFFFFFF
+
+static intr_entry_t g_intr_direct[NUM_ARM_DIRECT_INTERRUPT];
+static intr_entry_t g_intr_sparse[NUM_ARM_SPARSE_INTERRUPT];
+
+static intr_entry_t *intr_entry(uint32_t interrupt_id, uint32_t insert)
+{
+  uint32_t      slot;
+  uint32_t      probe;
+  intr_entry_t *entry;
+  intr_entry_t *removed = NULL;
+
+  if (interrupt_id < NUM_ARM_DIRECT_INTERRUPT)
+      return &g_intr_direct[interrupt_id];
+
+  /* LPIs are allocated in runs, so the low bits already spread them out */
+  slot = interrupt_id & (NUM_ARM_SPARSE_INTERRUPT - 1);
+  for (probe = 0; probe < NUM_ARM_SPARSE_INTERRUPT; probe++) {
+      entry = &g_intr_sparse[(slot + probe) & (NUM_ARM_SPARSE_INTERRUPT - 1)];
+      if (entry->int_id == interrupt_id)
+          return entry;
+      if ((entry->int_id == INTR_ENTRY_REMOVED) && (removed == NULL))
+          removed = entry;
+      if (entry->int_id == 0)
+          break;
+  }
+
+  if (!insert)
+      return NULL;
+
+  /* Reuse the first removed slot on the probe path, else the free slot ending it */
+  if (removed)
+      entry = removed;
+  else if (probe == NUM_ARM_SPARSE_INTERRUPT)
+      return NULL;
+
+  entry->int_id = interrupt_id;
+  return entry;
+}
 
 void default_irq_handler(uint64_t exception_type, void *context)
 {
-  uint32_t ack_interrupt;
-  uint32_t iar_ack_val;
+  uint32_t      ack_interrupt;
+  uint32_t      iar_ack_val;
+  uint64_t      ack_time;
+  uint64_t      latency;
+  intr_entry_t *entry;
 
   iar_ack_val = val_bsa_gic_acknowledgeInterrupt();
+  ack_time = ArmReadCntPct();
   ack_interrupt = iar_ack_val & 0xFFFFFF;
 
   /* Call Interrupt handler if installed otherwise print err. */
-  if (g_intr_handler[ack_interrupt]) {
-      g_intr_handler[ack_interrupt]();
+  entry = intr_entry(ack_interrupt, 0);
+  if (entry && entry->handler) {
+      entry->handler();
   } else {
       val_print(ACS_PRINT_ERR,
                 "\n       GIC_INIT: Unregistered Handler for the interrupt_id : 0x%x",
@@ -47,6 +105,14 @@ void default_irq_handler(uint64_t exception_type, void *context)
   /* End Of Interrupt */
   val_bsa_gic_endofInterrupt(ack_interrupt);
 
+  if (entry) {
+      latency = ArmReadCntPct() - ack_time;
+      entry->count++;
+      entry->latency_total += latency;
+      if (latency > entry->latency_max)
+          entry->latency_max = latency;
+  }
+
   return;
 }
 
@@ -63,11 +129,23 @@ void bsa_gic_vector_table_init(void)
 
 uint32_t val_gic_bsa_install_isr(uint32_t interrupt_id, void (*isr)(void))
 {
+  intr_entry_t *entry;
+
+  entry = intr_entry(interrupt_id, 1);
+  if (entry == NULL) {
+      val_print(ACS_PRINT_ERR, "\n       GIC_INIT: No free handler slot for interrupt_id : 0x%x",
+                interrupt_id);
+      return ACS_STATUS_ERR;
+  }
+
   /* Step 1: Disable Interrupt before registering Handler */
   val_bsa_gic_disableInterruptSource(interrupt_id);
 
-  /* Step 2: Register ISR for the particular interrupt */
-  g_intr_handler[interrupt_id] = (irq_handler) isr;
+  /* Step 2: Register ISR for the particular interrupt, statistics start afresh */
+  entry->handler = (irq_handler) isr;
+  entry->count = 0;
+  entry->latency_total = 0;
+  entry->latency_max = 0;
 
   /* Step 3: Enable Interrupt */
   val_bsa_gic_enableInterruptSource(interrupt_id);
@@ -75,13 +153,54 @@ uint32_t val_gic_bsa_install_isr(uint32_t interrupt_id, void (*isr)(void))
   return 0;
 }
 
+void val_gic_bsa_uninstall_isr(uint32_t interrupt_id)
+{
+  intr_entry_t *entry;
+
+  entry = intr_entry(interrupt_id, 0);
+  if (entry == NULL)
+      return;
+
+  val_bsa_gic_disableInterruptSource(interrupt_id);
+
+  entry->handler = NULL;
+  if (interrupt_id >= NUM_ARM_DIRECT_INTERRUPT)
+      entry->int_id = INTR_ENTRY_REMOVED;
+}
+
 void val_gic_bsa_install_esr(uint32_t exception_type, void (*esr)(uint64_t, void *))
 {
   g_esr_handler[exception_type] = (bsa_fp) esr;
 }
 
+uint64_t val_gic_bsa_get_intr_stats(uint32_t interrupt_id, GIC_INTR_STATS_e type)
+{
+  intr_entry_t *entry;
+
+  entry = intr_entry(interrupt_id, 0);
+  if (entry == NULL)
+      return 0;
+
+  switch (type) {
+  case GIC_INTR_STATS_COUNT:
+      return entry->count;
+  case GIC_INTR_STATS_LATENCY_TOTAL:
+      return entry->latency_total;
+  case GIC_INTR_STATS_LATENCY_MAX:
+      return entry->latency_max;
+  default:
+      return 0;
+  }
+}
+
 uint32_t common_exception_handler(uint32_t exception_type)
 {
+  /* Interrupts take the silent path so that printing does not add to their latency */
+  if (exception_type == EXCEPT_AARCH64_IRQ) {
+      g_esr_handler[exception_type](exception_type, NULL);
+      return 0;
+  }
+
   val_print(ACS_PRINT_DEBUG, "\n       GIC_INIT: In Exception Handler Type : %x", exception_type);
 
   /* Call Handler for exception, Handler would have
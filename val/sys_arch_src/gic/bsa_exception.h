@@ -18,7 +18,8 @@
 #include "include/bsa_acs_val.h"
 #include "include/bsa_acs_common.h"
 
-#define NUM_ARM_MAX_INTERRUPT 16384
+#define NUM_ARM_DIRECT_INTERRUPT  1024 /* SGIs, PPIs and SPIs are indexed directly */
+#define NUM_ARM_SPARSE_INTERRUPT  256  /* Extended PPIs/SPIs and LPIs, power of 2 */
 #define ICC_IAR1_EL1    S3_0_C12_C12_0
 #define ICC_EOIR1_EL1   S3_0_C12_C12_1
 
@@ -34,5 +35,7 @@ uint32_t common_exception_handler(uint32_t exception_type);
 
 void val_gic_bsa_install_esr(uint32_t exception_type, void (*esr)(uint64_t, void *));
 uint32_t val_gic_bsa_install_isr(uint32_t interrupt_id, void (*isr)(void));
+void val_gic_bsa_uninstall_isr(uint32_t interrupt_id);
+uint64_t val_gic_bsa_get_intr_stats(uint32_t interrupt_id, GIC_INTR_STATS_e type);
 
 
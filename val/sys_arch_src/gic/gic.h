@@ -39,6 +39,9 @@
 #define GICR_CTLR_FRAME_SIZE     0x00010000
 #define GICR_SGI_PPI_FRAME_SIZE  0x00010000
 #define GICR_TYPER_AFF           (0xFFFFFFFFULL << 32)
+#define GICR_TYPER_VLPIS         (1 << 1)
+#define GICR_TYPER_LAST          (1 << 4)
+#define GICR_VLPI_FRAME_SIZE     0x00020000
 
 #define GIC_ICDIPTR         0x800
 #define GIC_ICCICR          0x00
@@ -48,9 +51,9 @@
 #define GIC_ICCEIOR         0x10
 
 #define PE_AFF0   0xFF
-#define PE_AFF1   (0xFF < 8)
-#define PE_AFF2   (0xFF < 16)
-#define PE_AFF3   (0xFFULL < 32)
+#define PE_AFF1   (0xFF << 8)
+#define PE_AFF2   (0xFF << 16)
+#define PE_AFF3   (0xFFULL << 32)
 
 void val_bsa_gic_init(void);
 void val_bsa_gic_disableInterruptSource(uint32_t int_id);
@@ -19,10 +19,13 @@
 #include "include/bsa_acs_gic.h"
 #include "include/bsa_acs_gic_support.h"
 #include "include/bsa_acs_pe.h"
+#include "include/bsa_acs_memory.h"
 #include "gic_v3.h"
 #include "gic.h"
 #include "bsa_exception.h"
 
+extern GIC_INFO_TABLE *g_gic_info_table;
+
 /**
   @brief  checks if given int id is spi
   @param  int id
@@ -37,51 +40,164 @@ IsSpi(uint32_t int_id)
       return 0;
 }
 
+typedef struct {
+  uint64_t affinity;    /* GICR_TYPER.Affinity_Value of the frame */
+  uint64_t rd_base;     /* RD_base of the frame, 0 if none found */
+} GICR_MAP_ENTRY;
+
+static GICR_MAP_ENTRY *g_gicr_map;
+static uint32_t        g_gicr_map_num_pe;
+
 /**
-  @brief  derives current pe rd base
-  @param  rd base
-  @param  rd base length
-  @return pe rd base
+  @brief  converts an MPIDR value to the GICR_TYPER affinity layout
+  @param  mpidr
+  @return affinity as reported in GICR_TYPER[63:32]
 **/
 static uint64_t
-CurrentCpuRDBase(uint64_t mGicRedistributorBase, uint32_t length)
+MpidrToGicrAffinity(uint64_t Mpidr)
 {
-  uint64_t     Affinity, CpuAffinity;
-  uint64_t     GicRedistributorGranularity;
-  uint64_t     GicCpuRedistributorBase;
-  uint64_t     Mpidr;
+  return (Mpidr & (PE_AFF0 | PE_AFF1 | PE_AFF2)) | ((Mpidr & PE_AFF3) >> 8);
+}
 
-  Mpidr = ArmReadMpidr();
+/**
+  @brief  records a redistributor frame in the per-PE map
+  @param  rd base of the frame
+  @param  value of GICR_TYPER read from the frame
+  @return none
+**/
+static void
+GicrMapAddFrame(uint64_t rd_base, uint64_t typer)
+{
+  uint32_t index;
+  uint64_t affinity;
 
-  CpuAffinity = (Mpidr & (PE_AFF0 | PE_AFF1 | PE_AFF2)) | ((Mpidr & PE_AFF3) >> 8);
+  affinity = (typer & GICR_TYPER_AFF) >> 32;
 
-  GicRedistributorGranularity = GICR_CTLR_FRAME_SIZE + GICR_SGI_PPI_FRAME_SIZE;
+  for (index = 0; index < g_gicr_map_num_pe; index++) {
+    if (g_gicr_map[index].affinity == affinity) {
+      g_gicr_map[index].rd_base = rd_base;
+      return;
+    }
+  }
 
-  GicCpuRedistributorBase = mGicRedistributorBase;
+  val_print(ACS_PRINT_DEBUG, " \nGIC_INIT: No PE for GICR frame 0x%llx", rd_base);
+}
+
+/**
+  @brief  walks one GICR region and records the frames found in it.
+          The walk stops at the frame with GICR_TYPER.Last set; a region whose
+          length does not agree with the Last frame is reported.
+  @param  rd base of the region
+  @param  length of the region, 0 if the base describes a single PE frame
+  @return none
+**/
+static void
+GicrMapAddRegion(uint64_t region_base, uint32_t length)
+{
+  uint64_t     rd_base;
+  uint64_t     typer;
+  uint64_t     stride;
 
   /* If information is present in GICC Structure */
-  if (length == 0)
-  {
-      Affinity = (val_mmio_read64(GicCpuRedistributorBase + GICR_TYPER) & GICR_TYPER_AFF) >> 32;
-      if (Affinity == CpuAffinity) {
-        return GicCpuRedistributorBase;
-      }
-      return 0;
+  if (length == 0) {
+      GicrMapAddFrame(region_base, val_mmio_read64(region_base + GICR_TYPER));
+      return;
   }
 
   /* If information is present in GICR Structure */
-  while (GicCpuRedistributorBase < (mGicRedistributorBase + length))
+  rd_base = region_base;
+  while (rd_base < (region_base + length))
   {
-    Affinity = (val_mmio_read64(GicCpuRedistributorBase + GICR_TYPER) & GICR_TYPER_AFF) >> 32;
-    if (Affinity == CpuAffinity) {
-      return GicCpuRedistributorBase;
-    }
+    typer = val_mmio_read64(rd_base + GICR_TYPER);
+    GicrMapAddFrame(rd_base, typer);
+
+    /* GICv4 redistributors carry two extra frames for vLPIs */
+    stride = GICR_CTLR_FRAME_SIZE + GICR_SGI_PPI_FRAME_SIZE;
+    if (typer & GICR_TYPER_VLPIS)
+        stride += GICR_VLPI_FRAME_SIZE;
 
     /* Move to the next GIC Redistributor frame */
-    GicCpuRedistributorBase += GicRedistributorGranularity;
+    rd_base += stride;
+
+    if (typer & GICR_TYPER_LAST) {
+        if (rd_base != (region_base + length))
+            val_print(ACS_PRINT_WARN, "\n       GICR_TYPER.Last set before end of region 0x%llx",
+                      region_base);
+        return;
+    }
   }
 
-  return 0;
+  val_print(ACS_PRINT_WARN, "\n       GICR_TYPER.Last not set in region 0x%llx", region_base);
+}
+
+/**
+  @brief  builds the per-PE redistributor map from all GICR entries of
+          the GIC info table. Called once during GIC initialisation.
+  @param  none
+  @return none
+**/
+static void
+GicrMapInit(void)
+{
+  GIC_INFO_ENTRY  *gic_entry;
+  uint32_t         index;
+
+  if (g_gicr_map != NULL)
+      return;
+
+  if (g_gic_info_table == NULL)
+      return;
+
+  g_gicr_map_num_pe = val_pe_get_num();
+  g_gicr_map = val_memory_alloc(g_gicr_map_num_pe * sizeof(GICR_MAP_ENTRY));
+  if (g_gicr_map == NULL) {
+      g_gicr_map_num_pe = 0;
+      return;
+  }
+
+  for (index = 0; index < g_gicr_map_num_pe; index++) {
+      g_gicr_map[index].affinity = MpidrToGicrAffinity(val_pe_get_mpid_index(index));
+      g_gicr_map[index].rd_base = 0;
+  }
+
+  gic_entry = g_gic_info_table->gic_info;
+  while (gic_entry->type != 0xFF) {
+      if (gic_entry->type == ENTRY_TYPE_GICR_GICRD)
+          GicrMapAddRegion(gic_entry->base, gic_entry->length);
+      else if (gic_entry->type == ENTRY_TYPE_GICC_GICRD)
+          GicrMapAddRegion(gic_entry->base, 0);
+      gic_entry++;
+  }
+
+  for (index = 0; index < g_gicr_map_num_pe; index++) {
+      if (g_gicr_map[index].rd_base == 0)
+          val_print(ACS_PRINT_WARN, "\n       No GICR frame for PE index %d", index);
+  }
+}
+
+/**
+  @brief  derives current pe rd base from the per-PE redistributor map
+  @param  none
+  @return pe rd base, 0 if not found
+**/
+static uint64_t
+CurrentCpuRDBase(void)
+{
+  uint32_t     index;
+  uint64_t     Mpidr;
+
+  GicrMapInit();
+  if (g_gicr_map == NULL)
+      return 0;
+
+  Mpidr = ArmReadMpidr();
+
+  index = val_pe_get_index_mpid(Mpidr & MPIDR_AFF_MASK);
+  if ((index >= g_gicr_map_num_pe) ||
+      (g_gicr_map[index].affinity != MpidrToGicrAffinity(Mpidr)))
+      return 0;
+
+  return g_gicr_map[index].rd_base;
 }
 
 /**
@@ -92,13 +208,10 @@ CurrentCpuRDBase(uint64_t mGicRedistributorBase, uint32_t length)
 static void
 WakeUpRD(void)
 {
-  uint32_t                rdbase_len;
-  uint64_t                rd_base;
   uint64_t                cpuRd_base;
   uint32_t                tmp;
 
-  rd_base = val_get_gicr_base(&rdbase_len);
-  cpuRd_base = CurrentCpuRDBase(rd_base, rdbase_len);
+  cpuRd_base = CurrentCpuRDBase();
   if (cpuRd_base == 0) {
     return;
   }
@@ -144,8 +257,6 @@ v3_DisableInterruptSource(uint32_t int_id)
 {
   uint32_t                regOffset;
   uint32_t                regShift;
-  uint32_t                rdbase_len;
-  uint64_t                rd_base;
   uint64_t                cpuRd_base;
 
   /* Calculate register offset and bit position */
@@ -155,8 +266,7 @@ v3_DisableInterruptSource(uint32_t int_id)
   if (IsSpi(int_id)) {
       val_mmio_write(val_get_gicd_base() + GICD_ICENABLER + (4 * regOffset), 1 << regShift);
   } else {
-    rd_base = val_get_gicr_base(&rdbase_len);
-    cpuRd_base = CurrentCpuRDBase(rd_base, rdbase_len);
+    cpuRd_base = CurrentCpuRDBase();
     if (cpuRd_base == 0) {
       return;
     }
@@ -175,8 +285,6 @@ v3_EnableInterruptSource(uint32_t int_id)
 {
   uint32_t                regOffset;
   uint32_t                regShift;
-  uint32_t                rdbase_len;
-  uint64_t                rd_base;
   uint64_t                cpuRd_base;
 
   /* Calculate register offset and bit position */
@@ -186,8 +294,7 @@ v3_EnableInterruptSource(uint32_t int_id)
   if (IsSpi(int_id)) {
       val_mmio_write(val_get_gicd_base() + GICD_ISENABLER + (4 * regOffset), 1 << regShift);
   } else {
-    rd_base = val_get_gicr_base(&rdbase_len);
-    cpuRd_base = CurrentCpuRDBase(rd_base, rdbase_len);
+    cpuRd_base = CurrentCpuRDBase();
     if (cpuRd_base == 0) {
       return;
     }
@@ -207,8 +314,6 @@ v3_SetInterruptPriority(uint32_t int_id, uint32_t priority)
 {
   uint32_t                regOffset;
   uint32_t                regShift;
-  uint32_t                rdbase_len;
-  uint64_t                rd_base;
   uint64_t                cpuRd_base;
 
   /* Calculate register offset and bit position */
@@ -220,8 +325,7 @@ v3_SetInterruptPriority(uint32_t int_id, uint32_t priority)
                     (val_mmio_read(val_get_gicd_base() + GICD_IPRIORITYR + (4 * regOffset)) &
                      ~(0xff << regShift)) | priority << regShift);
   } else {
-    rd_base = val_get_gicr_base(&rdbase_len);
-    cpuRd_base = CurrentCpuRDBase(rd_base, rdbase_len);
+    cpuRd_base = CurrentCpuRDBase();
     if (cpuRd_base == 0) {
       return;
     }
@@ -255,6 +359,9 @@ v3_Init(void)
   val_print(ACS_PRINT_DEBUG, " \nGIC_INIT: D base %x\n", gicd_base);
   val_print(ACS_PRINT_DEBUG, " \nGIC_INIT: Interrupts %d\n", max_num_interrupts);
 
+  /* Build the per-PE redistributor map once, before any RD access */
+  GicrMapInit();
+
   /* Disable all interrupt */
   for (index = 0; index < max_num_interrupts; index++) {
     v3_DisableInterruptSource(index);
@@ -23,6 +23,8 @@
 
 #define BITFIELD_GET(name, val) ((val >> name##_SHIFT) & name##_MASK)
 #define BITFIELD_SET(name, val) ((val & name##_MASK) << name##_SHIFT)
+/* Address fields hold the address bits in place, msb down to lsb */
+#define BITFIELD_ADDR(name, addr) ((addr) & (name##_MASK << name##_SHIFT))
 
 #define BYTES_PER_DWORD 8
 
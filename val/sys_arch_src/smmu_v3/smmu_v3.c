@@ -113,7 +113,25 @@ static int smmu_cmdq_issue_cmd(smmu_dev_t *smmu,
         return -1;
     }
 
-    return smmu_cmdq_write_cmd(smmu, cmd);
+    if (smmu_cmdq_write_cmd(smmu, cmd))
+        return -1;
+
+    smmu->stats.num_cmds++;
+    switch (opcode) {
+    case CMDQ_OP_CFGI_STE:
+    case CMDQ_OP_CFGI_ALL:
+        smmu->stats.num_cfgi++;
+        break;
+    case CMDQ_OP_TLBI_EL2_ALL:
+    case CMDQ_OP_TLBI_NSNH_ALL:
+        smmu->stats.num_tlbi++;
+        break;
+    case CMDQ_OP_CMD_SYNC:
+        smmu->stats.num_sync++;
+        break;
+    }
+
+    return 0;
 }
 
 static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
@@ -130,6 +148,7 @@ static void smmu_cmdq_poll_until_consumed(smmu_dev_t *smmu)
         if (smmu_queue_empty(&queue))
             break;
         queue.cons = val_mmio_read((uint64_t)cmdq->cons_reg);
+        timeout--;
     }
 
     if (!timeout) {
@@ -178,7 +197,7 @@ static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste)
               STRTAB_STE_2_S2PTW | STRTAB_STE_2_S2AA64 |
               STRTAB_STE_2_S2R);
 
-        ste[3] = (stage2_cfg->vttbr & STRTAB_STE_3_S2TTB_MASK);
+        ste[3] = BITFIELD_ADDR(STRTAB_STE_3_S2TTB, stage2_cfg->vttbr);
 
         val |= BITFIELD_SET(STRTAB_STE_0_CONFIG, STRTAB_STE_0_CONFIG_S2_TRANS);
     }
@@ -190,7 +209,7 @@ static void smmu_strtab_write_ste(smmu_master_t *master, uint64_t *ste)
              BITFIELD_SET(STRTAB_STE_1_S1CSH, SMMU_SH_ISH) |
              BITFIELD_SET(STRTAB_STE_1_EATS, 0x1);
 
-        val |= (stage1_cfg->cdcfg.cdtab_phys & STRTAB_STE_0_S1CONTEXTPTR_MASK) |
+        val |= BITFIELD_ADDR(STRTAB_STE_0_S1CONTEXTPTR, stage1_cfg->cdcfg.cdtab_phys) |
             BITFIELD_SET(STRTAB_STE_0_CONFIG, STRTAB_STE_0_CONFIG_S1_TRANS) |
             BITFIELD_SET(STRTAB_STE_0_S1CDMAX, stage1_cfg->s1cdmax) |
             BITFIELD_SET(STRTAB_STE_0_S1FMT, stage1_cfg->s1fmt);
@@ -245,7 +264,7 @@ static uint32_t smmu_cmd_queue_init(smmu_dev_t *smmu)
     cmdq->entry_size = CMDQ_DWORDS_PER_ENT << 3;
 
     cmdq->queue_base = QUEUE_BASE_RWA |
-                       (cmdq->base_phys & QUEUE_BASE_ADDR_MASK) |
+                       BITFIELD_ADDR(QUEUE_BASE_ADDR, cmdq->base_phys) |
                        BITFIELD_SET(QUEUE_BASE_LOG2SIZE, cmdq->queue.log2nent);
 
     cmdq->queue.prod = cmdq->queue.cons = 0;
@@ -279,7 +298,7 @@ smmu_strtab_write_level1_desc(uint64_t *dst, smmu_strtab_l1_desc_t *desc)
     uint64_t val = 0;
 
     val |= BITFIELD_SET(STRTAB_L1_DESC_SPAN, desc->span);
-    val |= desc->l2desc_phys & STRTAB_L1_DESC_L2PTR_MASK;
+    val |= BITFIELD_ADDR(STRTAB_L1_DESC_L2PTR, desc->l2desc_phys);
     *dst = val;
 }
 
@@ -383,7 +402,7 @@ static uint32_t smmu_strtab_init(smmu_dev_t *smmu)
     }
 
     /* Set the strtab base address */
-    data = smmu->strtab_cfg.strtab_phys & STRTAB_BASE_ADDR_MASK;
+    data = BITFIELD_ADDR(STRTAB_BASE_ADDR, smmu->strtab_cfg.strtab_phys);
     data |= STRTAB_BASE_RA;
     smmu->strtab_cfg.strtab_base = data;
 
@@ -642,7 +661,7 @@ static void dump_cdtab(uint64_t *ctx_desc)
 static void smmu_cdtab_write_l1_desc(uint64_t *dst,
                       smmu_cdtab_l1_ctx_desc_t *l1_desc)
 {
-    uint64_t val = (l1_desc->l2desc_phys & CDTAB_L1_DESC_L2PTR_MASK) |
+    uint64_t val = BITFIELD_ADDR(CDTAB_L1_DESC_L2PTR, l1_desc->l2desc_phys) |
           CDTAB_L1_DESC_V;
 
     *dst = val;
@@ -704,7 +723,7 @@ static int smmu_cdtab_write_ctx_desc(smmu_master_t *master,
         return 0;
     }
 
-    cdptr[1] = cd->ttbr & CDTAB_CD_1_TTB0_MASK;
+    cdptr[1] = BITFIELD_ADDR(CDTAB_CD_1_TTB0, cd->ttbr);
     cdptr[2] = 0;
     cdptr[3] = cd->mair;
 
@@ -771,6 +790,10 @@ static int smmu_cdtab_alloc(smmu_master_t *master)
         l1_tbl_size = cdmax * (CDTAB_CD_DWORDS << 3);
     }
 
+    /* S1ContextPtr holds address bits 51:6, a small L1 table still needs 64 byte alignment */
+    if (l1_tbl_size < (CDTAB_CD_DWORDS << 3))
+        l1_tbl_size = CDTAB_CD_DWORDS << 3;
+
     cdcfg->cdtab_ptr = val_memory_alloc(l1_tbl_size * 2);
     if (!cdcfg->cdtab_ptr) {
         val_print(ACS_PRINT_ERR, "\n      smmu_cdtab_alloc: alloc failed     ", 0);
@@ -952,7 +975,7 @@ void val_smmu_unmap(smmu_master_attributes_t master_attr)
     if (master_attr.streamid >= (0x1ul << master->smmu->sid_bits))
         return;
 
-    strtab = master->smmu->strtab_cfg.strtab64 + master_attr.streamid * STRTAB_STE_DWORDS;
+    strtab = smmu_strtab_get_ste_for_sid(master->smmu, master_attr.streamid);
     smmu_strtab_write_ste(NULL, strtab);
 
     smmu_cdtab_free(master);
@@ -999,11 +1022,34 @@ void val_smmu_stop(void)
         if (smmu->base == 0)
             continue;
         smmu_dev_disable(smmu);
+        val_print(ACS_PRINT_DEBUG, "\n      SMMU %d command queue stats: ", i);
+        val_print(ACS_PRINT_DEBUG, "cmds %d ", smmu->stats.num_cmds);
+        val_print(ACS_PRINT_DEBUG, "cfgi %d ", smmu->stats.num_cfgi);
+        val_print(ACS_PRINT_DEBUG, "tlbi %d ", smmu->stats.num_tlbi);
+        val_print(ACS_PRINT_DEBUG, "sync %d", smmu->stats.num_sync);
         if (smmu->cmdq.base_ptr)
             val_memory_free(smmu->cmdq.base_ptr);
         smmu_free_strtab(smmu);
     }
     val_memory_free(g_smmu);
+    g_smmu = NULL;
+    g_num_smmus = 0;
+}
+
+/**
+  @brief  Zero the command queue statistics of all SMMUs, so that they count
+          the commands of one test
+  @return void
+**/
+void val_smmu_clear_stats(void)
+{
+    uint32_t i;
+
+    if (g_smmu == NULL)
+        return;
+
+    for (i = 0; i < g_num_smmus; i++)
+        val_memory_set(&g_smmu[i].stats, sizeof(g_smmu[i].stats), 0);
 }
 
 /**
@@ -1066,6 +1112,12 @@ val_smmu_get_info(SMMU_INFO_e type, uint32_t smmu_index)
             return smmu->ias;
         case SMMU_OUT_ADDR_SIZE:
             return smmu->oas;
+        case SMMU_CMDQ_NUM_CMDS:
+            return smmu->stats.num_cmds;
+        case SMMU_CMDQ_NUM_INV:
+            return smmu->stats.num_cfgi + smmu->stats.num_tlbi;
+        case SMMU_CMDQ_NUM_SYNC:
+            return smmu->stats.num_sync;
         default:
             return val_iovirt_get_smmu_info(type, smmu_index);
     }
@@ -102,6 +102,13 @@ typedef struct {
     uint32_t strtab_base_cfg;
 } smmu_strtab_config_t;
 
+typedef struct {
+    uint32_t num_cmds;
+    uint32_t num_cfgi;
+    uint32_t num_tlbi;
+    uint32_t num_sync;
+} smmu_cmdq_stats_t;
+
 typedef struct {
     uint64_t base;
     uint64_t ias;
@@ -110,6 +117,7 @@ typedef struct {
     uint32_t sid_bits;
     smmu_cmd_queue_t cmdq;
     smmu_strtab_config_t strtab_cfg;
+    smmu_cmdq_stats_t stats;
     union {
         struct {
            uint32_t st_level_2lvl:1;